@@ -0,0 +1,219 @@
+//------------------------------------------------------------------------------------
+// gpio_route.c
+//------------------------------------------------------------------------------------
+//
+// Event-driven GPIO routing table, see gpio_route.h.
+//
+//------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------
+#include "gpio_route.h"
+#include "stm32f7xx_hal.h"
+
+//------------------------------------------------------------------------------------
+// Compiled table
+//------------------------------------------------------------------------------------
+typedef struct {
+    volatile uint32_t *idr;     // input data register
+    uint16_t inMask;
+    uint16_t outMask;
+    uint8_t  slot;              // output port slot
+    uint8_t  invert;
+    uint8_t  exti;              // 1 = edge interrupt, 0 = polled
+    uint8_t  raw;               // last raw level seen
+    uint8_t  stable;            // debounced level used for the output
+    uint16_t debounceMs;
+    uint32_t changedAt;         // HAL tick of the last raw change
+} Route;
+
+static Route routes[GPIO_ROUTE_MAX];
+static int numRoutes;
+
+static GPIO_TypeDef *outPorts[GPIO_ROUTE_OUT_PORTS];
+static int numOutPorts;
+
+static uint16_t extiMask;       // EXTI lines owned by this module
+static uint32_t lastPoll;
+
+static GpioRouteStats stats;
+
+//------------------------------------------------------------------------------------
+// Output update: one BSRR write per output port
+//------------------------------------------------------------------------------------
+static void routeApply(void)
+{
+    uint32_t bsrr[GPIO_ROUTE_OUT_PORTS] = {0};
+
+    for (int i = 0; i < numRoutes; i++) {
+        Route *r = &routes[i];
+        uint8_t level = r->debounceMs ? r->stable : ((*r->idr & r->inMask) != 0);
+
+        if (level ^ r->invert) {
+            bsrr[r->slot] |= r->outMask;                    // set
+        } else {
+            bsrr[r->slot] |= (uint32_t)r->outMask << 16;    // reset
+        }
+    }
+
+    for (int s = 0; s < numOutPorts; s++) {
+        outPorts[s]->BSRR = bsrr[s];
+    }
+}
+
+// Record raw level changes so debounced routes know how long they have been stable
+static void routeSample(uint32_t now)
+{
+    for (int i = 0; i < numRoutes; i++) {
+        Route *r = &routes[i];
+        uint8_t level = (*r->idr & r->inMask) != 0;
+        if (level != r->raw) {
+            r->raw = level;
+            r->changedAt = now;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------
+// EXTI handlers: every line this module armed lands here
+//------------------------------------------------------------------------------------
+static void routeIrq(void)
+{
+    uint32_t t0 = DWT->CYCCNT;
+    uint32_t pending = EXTI->PR & extiMask;
+
+    if (!pending) return;
+    EXTI->PR = pending; // write 1 to clear
+
+    routeSample(HAL_GetTick());
+    routeApply();
+
+    uint32_t dt = DWT->CYCCNT - t0;
+    stats.events++;
+    stats.irqSum += dt;
+    if (dt > stats.irqMax) stats.irqMax = dt;
+}
+
+void EXTI0_IRQHandler(void)     { routeIrq(); }
+void EXTI1_IRQHandler(void)     { routeIrq(); }
+void EXTI2_IRQHandler(void)     { routeIrq(); }
+void EXTI3_IRQHandler(void)     { routeIrq(); }
+void EXTI4_IRQHandler(void)     { routeIrq(); }
+void EXTI9_5_IRQHandler(void)   { routeIrq(); }
+void EXTI15_10_IRQHandler(void) { routeIrq(); }
+
+static IRQn_Type extiIrq(uint8_t line)
+{
+    if (line <= 4)  return (IRQn_Type)(EXTI0_IRQn + line); // EXTI0..4 are consecutive
+    if (line <= 9)  return EXTI9_5_IRQn;
+    return EXTI15_10_IRQn;
+}
+
+//------------------------------------------------------------------------------------
+// Public API
+//------------------------------------------------------------------------------------
+int gpio_route_init(const GpioRoute *table, int n)
+{
+    numRoutes = 0;
+    numOutPorts = 0;
+    extiMask = 0;
+    stats = (GpioRouteStats){0};
+
+    // Cycle counter for the latency stats
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    __HAL_RCC_SYSCFG_CLK_ENABLE();
+
+    for (int i = 0; i < n && numRoutes < GPIO_ROUTE_MAX; i++) {
+        const GpioRoute *t = &table[i];
+
+        // Find or add the output port slot
+        int slot = 0;
+        while (slot < numOutPorts && outPorts[slot] != t->outPort) slot++;
+        if (slot == numOutPorts) {
+            if (numOutPorts == GPIO_ROUTE_OUT_PORTS) continue;
+            outPorts[numOutPorts++] = t->outPort;
+        }
+
+        Route *r = &routes[numRoutes];
+        r->idr        = &t->inPort->IDR;
+        r->inMask     = (uint16_t)(1U << t->inPin);
+        r->outMask    = (uint16_t)(1U << t->outPin);
+        r->slot       = (uint8_t)slot;
+        r->invert     = t->invert ? 1 : 0;
+        r->debounceMs = t->debounceMs;
+        r->raw        = (*r->idr & r->inMask) != 0;
+        r->stable     = r->raw;
+        r->changedAt  = HAL_GetTick();
+
+        // Claim the EXTI line unless another port already has it
+        uint8_t line = t->inPin;
+        r->exti = !(extiMask & (1U << line));
+        if (r->exti) {
+            uint32_t port = ((uint32_t)t->inPort - GPIOA_BASE) / (GPIOB_BASE - GPIOA_BASE);
+            uint32_t shift = (line % 4) * 4;
+            SYSCFG->EXTICR[line / 4] = (SYSCFG->EXTICR[line / 4] & ~(0xFU << shift)) | (port << shift);
+            extiMask |= (uint16_t)(1U << line);
+        } else {
+            stats.polledMask |= (uint16_t)(1U << numRoutes);
+        }
+        numRoutes++;
+    }
+
+    routeApply();
+
+    // Both edges, then unmask
+    EXTI->RTSR |= extiMask;
+    EXTI->FTSR |= extiMask;
+    EXTI->PR    = extiMask;
+    EXTI->IMR  |= extiMask;
+
+    for (uint8_t line = 0; line < 16; line++) {
+        if (extiMask & (1U << line)) {
+            HAL_NVIC_SetPriority(extiIrq(line), 0x05, 0);
+            HAL_NVIC_EnableIRQ(extiIrq(line));
+        }
+    }
+
+    lastPoll = DWT->CYCCNT;
+    return numRoutes;
+}
+
+void gpio_route_poll(void)
+{
+    uint32_t now = DWT->CYCCNT;
+    uint32_t gap = now - lastPoll;
+    lastPoll = now;
+    if (gap > stats.pollGapMax) stats.pollGapMax = gap;
+
+    uint32_t tick = HAL_GetTick();
+    uint8_t update = 0;
+
+    __disable_irq(); // the EXTI handler shares routes[] and the BSRR images
+    for (int i = 0; i < numRoutes; i++) {
+        Route *r = &routes[i];
+        uint8_t level = (*r->idr & r->inMask) != 0;
+
+        if (!r->exti && level != r->raw) {
+            update = 1; // no interrupt for this input: the poll is the event
+        }
+        if (level != r->raw) {
+            r->raw = level;
+            r->changedAt = tick;
+        }
+        if (r->debounceMs && r->stable != r->raw && (tick - r->changedAt) >= r->debounceMs) {
+            r->stable = r->raw;
+            update = 1;
+        }
+    }
+    if (update) {
+        routeApply();
+        stats.pollUpdates++;
+    }
+    __enable_irq();
+}
+
+const GpioRouteStats *gpio_route_stats(void)
+{
+    return &stats;
+}
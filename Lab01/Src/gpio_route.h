@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------------
+// gpio_route.h
+//------------------------------------------------------------------------------------
+//
+// Event-driven GPIO mirroring for Lab 1 task 3.
+//
+// The wiring is a table of routes (input pin -> output pin, polarity,
+// debounce). gpio_route_init() compiles it into per-route masks plus one
+// output slot per port, so every update is a single BSRR write per output
+// port, and arms EXTI on both edges of every input.
+//
+// An EXTI line can only watch one port: PC6 and PF6 both need EXTI6. The
+// first route to claim a line gets it; later routes on the same line fall
+// back to polling in gpio_route_poll(), which the main loop must keep calling
+// (it also completes debounced routes).
+//
+// Pins must already be configured as inputs/outputs by the caller.
+//
+//------------------------------------------------------------------------------------
+#ifndef GPIO_ROUTE_H
+#define GPIO_ROUTE_H
+
+#include "stm32f769xx.h"
+#include <stdint.h>
+
+#define GPIO_ROUTE_MAX       8
+#define GPIO_ROUTE_OUT_PORTS 4
+
+typedef struct {
+    GPIO_TypeDef *inPort;
+    uint8_t       inPin;       // 0..15
+    GPIO_TypeDef *outPort;
+    uint8_t       outPin;      // 0..15
+    uint8_t       invert;      // 1 = output is the inverse of the input
+    uint16_t      debounceMs;  // 0 = follow every edge immediately
+} GpioRoute;
+
+typedef struct {
+    uint32_t events;      // EXTI-driven updates
+    uint32_t irqMax;      // worst cycles from ISR entry to the last BSRR write
+    uint32_t irqSum;      // for the average
+    uint32_t pollUpdates; // updates triggered by polled inputs / debounce
+    uint32_t pollGapMax;  // worst cycles between gpio_route_poll() calls
+    uint16_t polledMask;  // routes (bit n = table entry n) without an EXTI line
+} GpioRouteStats;
+
+// Returns the number of routes accepted (extra routes / output ports are ignored)
+int  gpio_route_init(const GpioRoute *routes, int n);
+void gpio_route_poll(void);
+
+const GpioRouteStats *gpio_route_stats(void);
+
+#endif // GPIO_ROUTE_H
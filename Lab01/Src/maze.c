@@ -0,0 +1,257 @@
+//------------------------------------------------------------------------------------
+// maze.c
+//------------------------------------------------------------------------------------
+//
+// Bit-packed maze engine, see maze.h.
+//
+//------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------
+#include "maze.h"
+#include "fmt.h"
+#include <string.h>
+
+// Directions: 0 = up, 1 = right, 2 = down, 3 = left
+static const int8_t dirX[4] = { 0, 1, 0, -1 };
+static const int8_t dirY[4] = { -1, 0, 1, 0 };
+
+static inline uint32_t get2(const uint32_t *a, uint32_t i)
+{
+    return (a[i >> 4] >> ((i & 15) * 2)) & 3U;
+}
+
+static inline void put2(uint32_t *a, uint32_t i, uint32_t v)
+{
+    uint32_t s = (i & 15) * 2;
+    a[i >> 4] = (a[i >> 4] & ~(3U << s)) | (v << s);
+}
+
+//------------------------------------------------------------------------------------
+// Grid
+//------------------------------------------------------------------------------------
+void maze_init(Maze *m, uint16_t w, uint16_t h, uint32_t *bits)
+{
+    m->w = w;
+    m->h = h;
+    m->bits = bits;
+}
+
+void maze_fill(Maze *m, uint8_t wall)
+{
+    memset(m->bits, wall ? 0xFF : 0x00, MAZE_WORDS(m->w, m->h) * sizeof(uint32_t));
+}
+
+void maze_set(Maze *m, int x, int y, uint8_t wall)
+{
+    if ((unsigned)x >= m->w || (unsigned)y >= m->h) return;
+    uint32_t i = (uint32_t)y * m->w + (uint32_t)x;
+    if (wall) m->bits[i >> 5] |= 1U << (i & 31);
+    else      m->bits[i >> 5] &= ~(1U << (i & 31));
+}
+
+//------------------------------------------------------------------------------------
+// Generator
+//------------------------------------------------------------------------------------
+static uint32_t xorshift32(uint32_t *s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *s = x;
+}
+
+void maze_generate(Maze *m, uint32_t seed, uint32_t *scratch)
+{
+    uint32_t rng = seed ? seed : 0x9E3779B9U;
+    uint32_t cw = m->w / 2;         // passage cells per row
+
+    maze_fill(m, 1);
+
+    int x = 1, y = 1;
+    maze_set(m, x, y, 0);
+
+    for (;;) {
+        // Unvisited passage cells two steps away are still solid wall
+        uint8_t open[4];
+        int n = 0;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + 2 * dirX[d], ny = y + 2 * dirY[d];
+            if (nx > 0 && ny > 0 && nx < m->w - 1 && ny < m->h - 1 && maze_wall(m, nx, ny)) {
+                open[n++] = (uint8_t)d;
+            }
+        }
+
+        if (n) {
+            int d = open[xorshift32(&rng) % (uint32_t)n];
+            maze_set(m, x + dirX[d], y + dirY[d], 0);
+            x += 2 * dirX[d];
+            y += 2 * dirY[d];
+            maze_set(m, x, y, 0);
+            put2(scratch, (uint32_t)(y / 2) * cw + (uint32_t)(x / 2), (uint32_t)(d ^ 2)); // way back
+        } else {
+            if (x == 1 && y == 1) break;
+            int back = (int)get2(scratch, (uint32_t)(y / 2) * cw + (uint32_t)(x / 2));
+            x += 2 * dirX[back];
+            y += 2 * dirY[back];
+        }
+    }
+
+    maze_set(m, m->w - 2, m->h - 1, 0); // exit opening below the last cell
+}
+
+//------------------------------------------------------------------------------------
+// Solver
+//------------------------------------------------------------------------------------
+int32_t maze_solve(const Maze *m, int sx, int sy, int gx, int gy,
+                   uint32_t *scratch, uint32_t *queue, uint32_t qcap, uint32_t *path)
+{
+    uint32_t words = MAZE_WORDS(m->w, m->h);
+    uint32_t *visited = scratch;            // 1 bit per cell
+    uint32_t *parent  = scratch + words;    // 2 bits per cell
+
+    memset(visited, 0, words * sizeof(uint32_t));
+    if (path) memset(path, 0, words * sizeof(uint32_t));
+    if (maze_wall(m, sx, sy) || maze_wall(m, gx, gy)) return -1;
+
+    uint32_t start = (uint32_t)sy * m->w + (uint32_t)sx;
+    uint32_t goal  = (uint32_t)gy * m->w + (uint32_t)gx;
+    uint32_t head = 0, tail = 0;
+
+    visited[start >> 5] |= 1U << (start & 31);
+    queue[tail++ % qcap] = start;
+
+    int found = (start == goal);
+    while (!found && head != tail) {
+        uint32_t c = queue[head++ % qcap];
+        int cx = (int)(c % m->w), cy = (int)(c / m->w);
+
+        for (int d = 0; d < 4; d++) {
+            int nx = cx + dirX[d], ny = cy + dirY[d];
+            if (maze_wall(m, nx, ny)) continue;
+
+            uint32_t n = (uint32_t)ny * m->w + (uint32_t)nx;
+            if (visited[n >> 5] & (1U << (n & 31))) continue;
+
+            visited[n >> 5] |= 1U << (n & 31);
+            put2(parent, n, (uint32_t)(d ^ 2)); // direction back towards the start
+            if (n == goal) { found = 1; break; }
+
+            if (tail - head >= qcap) return -2;
+            queue[tail++ % qcap] = n;
+        }
+    }
+    if (!found) return -1;
+
+    // Walk the parents back from the goal
+    int32_t steps = 0;
+    int x = gx, y = gy;
+    for (;;) {
+        uint32_t i = (uint32_t)y * m->w + (uint32_t)x;
+        if (path) path[i >> 5] |= 1U << (i & 31);
+        if (i == start) break;
+        int d = (int)get2(parent, i);
+        x += dirX[d];
+        y += dirY[d];
+        steps++;
+    }
+    return steps;
+}
+
+//------------------------------------------------------------------------------------
+// Viewport
+//------------------------------------------------------------------------------------
+void maze_view_init(MazeView *v, const Maze *m, uint8_t vw, uint8_t vh,
+                    uint8_t row, uint8_t col, MazeSink sink)
+{
+    v->maze = m;
+    v->vw = (vw > MAZE_VIEW_MAX_W) ? MAZE_VIEW_MAX_W : vw;
+    v->vh = (vh > MAZE_VIEW_MAX_H) ? MAZE_VIEW_MAX_H : vh;
+    if (v->vw > m->w) v->vw = (uint8_t)m->w;
+    if (v->vh > m->h) v->vh = (uint8_t)m->h;
+    v->row = row;
+    v->col = col;
+    v->ox = v->oy = 0;
+    v->margin = (uint8_t)((v->vw < v->vh ? v->vw : v->vh) / 4);
+    v->sink = sink;
+    v->cellsSent = 0;
+    maze_view_invalidate(v);
+}
+
+void maze_view_invalidate(MazeView *v)
+{
+    memset(v->shown, 0, sizeof(v->shown)); // 0 never matches a drawn character
+}
+
+static int clampi(int x, int lo, int hi)
+{
+    return (x < lo) ? lo : (x > hi) ? hi : x;
+}
+
+// 256-colour foreground per character class: player, path, walls
+static uint8_t cellColor(char ch)
+{
+    return (ch == 'O') ? 220 : (ch == '.') ? 46 : 21;
+}
+
+static char cellChar(const MazeView *v, int x, int y, int px, int py, const uint32_t *path)
+{
+    const Maze *m = v->maze;
+
+    if (x == px && y == py) return 'O';
+    if (maze_wall(m, x, y)) return (y == 0 || y == m->h - 1) ? '-' : '|';
+    if (path) {
+        uint32_t i = (uint32_t)y * m->w + (uint32_t)x;
+        if (path[i >> 5] & (1U << (i & 31))) return '.';
+    }
+    return ' ';
+}
+
+uint32_t maze_view_render(MazeView *v, int px, int py, const uint32_t *path)
+{
+    const Maze *m = v->maze;
+
+    // Scroll only when the player gets within 'margin' of an edge
+    if (px < v->ox + v->margin)              v->ox = px - v->margin;
+    if (px > v->ox + v->vw - 1 - v->margin)  v->ox = px - (v->vw - 1 - v->margin);
+    if (py < v->oy + v->margin)              v->oy = py - v->margin;
+    if (py > v->oy + v->vh - 1 - v->margin)  v->oy = py - (v->vh - 1 - v->margin);
+    v->ox = clampi(v->ox, 0, m->w - v->vw);
+    v->oy = clampi(v->oy, 0, m->h - v->vh);
+
+    char out[512];
+    uint32_t len = 0, sent = 0;
+    int curRow = -1, curCol = -1;    // terminal cursor after the last write
+    int curFg = -1;                  // colour unknown until the first cell
+
+    for (int r = 0; r < v->vh; r++) {
+        for (int c = 0; c < v->vw; c++) {
+            char ch = cellChar(v, v->ox + c, v->oy + r, px, py, path);
+            if (v->shown[r][c] == ch) continue;
+            v->shown[r][c] = ch;
+
+            if (len > sizeof(out) - (FMT_CUP_MAX + 16)) {
+                v->sink(out, len);
+                len = 0;
+            }
+            int tr = v->row + r, tc = v->col + c;
+            if (tr != curRow || tc != curCol) {
+                len = (uint32_t)(fmt_cup(out + len, (unsigned)tr, (unsigned)tc) - out);
+            }
+            if (cellColor(ch) != curFg) {
+                curFg = cellColor(ch);
+                len = (uint32_t)(fmt_str(out + len, "\033[38;5;") - out);
+                len = (uint32_t)(fmt_u32(out + len, (uint32_t)curFg) - out);
+                out[len++] = 'm';
+            }
+            out[len++] = ch;
+            curRow = tr;
+            curCol = tc + 1;
+            sent++;
+        }
+    }
+    if (len) v->sink(out, len);
+
+    v->cellsSent = sent;
+    return sent;
+}
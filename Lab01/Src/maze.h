@@ -0,0 +1,90 @@
+//------------------------------------------------------------------------------------
+// maze.h
+//------------------------------------------------------------------------------------
+//
+// Bit-packed maze engine for Lab 1 task 4.
+//
+// A maze is a w x h grid of cells, one bit each (1 = wall), in caller-owned
+// storage of MAZE_WORDS(w, h) words, so a 1024 x 1024 maze is 128 KB instead
+// of 4 MB of ints. Coordinates outside the grid read as wall.
+//
+// Generated mazes use the usual odd-grid layout: passages on odd (x, y),
+// walls in between, w and h odd. The entry is (1, 1), the exit is
+// (w - 2, h - 2) with the border below it opened.
+//
+// Nothing here allocates: the generator and solver take scratch buffers
+// sized by the macros below. The viewport shows a window of the maze on the
+// terminal and only sends the cells whose character changed (walls blue,
+// player 'O' yellow, solution path '.' green; the caller sets the background).
+//
+//------------------------------------------------------------------------------------
+#ifndef MAZE_H
+#define MAZE_H
+
+#include <stdint.h>
+
+#define MAZE_WORDS(w, h)        ((((uint32_t)(w) * (uint32_t)(h)) + 31U) / 32U)
+// Generator: 2-bit back pointer per passage cell
+#define MAZE_GEN_WORDS(w, h)    (((((uint32_t)(w) / 2U) * ((uint32_t)(h) / 2U)) * 2U + 31U) / 32U)
+// Solver: 2-bit parent direction + visited bit per cell
+#define MAZE_SOLVE_WORDS(w, h)  (MAZE_WORDS(w, h) * 3U)
+
+typedef struct {
+    uint16_t  w, h;
+    uint32_t *bits;     // 1 = wall, row-major
+} Maze;
+
+void maze_init(Maze *m, uint16_t w, uint16_t h, uint32_t *bits);
+void maze_fill(Maze *m, uint8_t wall);
+
+static inline int maze_wall(const Maze *m, int x, int y)
+{
+    if ((unsigned)x >= m->w || (unsigned)y >= m->h) return 1;
+    uint32_t i = (uint32_t)y * m->w + (uint32_t)x;
+    return (m->bits[i >> 5] >> (i & 31)) & 1U;
+}
+
+void maze_set(Maze *m, int x, int y, uint8_t wall);
+
+// Recursive backtracker, run iteratively with back pointers in 'scratch'
+// (MAZE_GEN_WORDS words). w and h must be odd and >= 3.
+void maze_generate(Maze *m, uint32_t seed, uint32_t *scratch);
+
+// Breadth-first search from (sx, sy) to (gx, gy).
+// scratch: MAZE_SOLVE_WORDS words. queue: ring of qcap cell indices.
+// path (optional, MAZE_WORDS words): cleared, then the bits on the shortest
+// path are set. Returns the path length in steps, -1 if unreachable,
+// -2 if the queue was too small.
+int32_t maze_solve(const Maze *m, int sx, int sy, int gx, int gy,
+                   uint32_t *scratch, uint32_t *queue, uint32_t qcap, uint32_t *path);
+
+//------------------------------------------------------------------------------------
+// Viewport
+//------------------------------------------------------------------------------------
+#define MAZE_VIEW_MAX_W  64
+#define MAZE_VIEW_MAX_H  18
+
+typedef void (*MazeSink)(const char *buf, uint32_t len);
+
+typedef struct {
+    const Maze *maze;
+    uint8_t  vw, vh;          // window size in cells
+    uint8_t  row, col;        // top-left terminal position (1-based)
+    int      ox, oy;          // maze coordinates of the top-left view cell
+    uint8_t  margin;          // keep the player this far from the edges
+    char     shown[MAZE_VIEW_MAX_H][MAZE_VIEW_MAX_W]; // what the terminal shows
+    MazeSink sink;
+    uint32_t cellsSent;       // cells written by the last render
+} MazeView;
+
+void maze_view_init(MazeView *v, const Maze *m, uint8_t vw, uint8_t vh,
+                    uint8_t row, uint8_t col, MazeSink sink);
+
+// Forget what the terminal shows (after a clear screen) so the next render repaints
+void maze_view_invalidate(MazeView *v);
+
+// Scrolls to keep (px, py) in view, then sends only the changed cells.
+// path may be NULL. Returns the number of cells sent.
+uint32_t maze_view_render(MazeView *v, int px, int py, const uint32_t *path);
+
+#endif // MAZE_H
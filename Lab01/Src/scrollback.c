@@ -0,0 +1,75 @@
+//------------------------------------------------------------------------------------
+// scrollback.c
+//------------------------------------------------------------------------------------
+//
+// Circular line buffer, see scrollback.h.
+//
+//------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------
+#include "scrollback.h"
+#include <string.h>
+
+#define SB_MASK (SB_LINES - 1)
+
+//------------------------------------------------------------------------------------
+// Window helpers
+//------------------------------------------------------------------------------------
+
+// Absolute number of the oldest line still in the ring
+static uint32_t sb_oldest(const Scrollback *sb)
+{
+    return (sb->head >= SB_LINES) ? sb->head - (SB_LINES - 1) : 0;
+}
+
+// Absolute number of the top line of the live window. Until the window has
+// filled, it stays at line 0 so text starts at the top like the old log.
+static uint32_t sb_live_top(const Scrollback *sb, int rows)
+{
+    return (sb->head + 1 > (uint32_t)rows) ? sb->head + 1 - (uint32_t)rows : 0;
+}
+
+//------------------------------------------------------------------------------------
+// Public API
+//------------------------------------------------------------------------------------
+void sb_init(Scrollback *sb, char blank)
+{
+    memset(sb->line, blank, sizeof(sb->line));
+    sb->head  = 0;
+    sb->col   = 0;
+    sb->view  = 0;
+    sb->blank = blank;
+}
+
+void sb_putc(Scrollback *sb, char c)
+{
+    sb->line[sb->head & SB_MASK][sb->col] = c;
+
+    if (++sb->col == SB_COLS) {
+        // Start the next line in the slot of the oldest one
+        sb->col = 0;
+        sb->head++;
+        memset(sb->line[sb->head & SB_MASK], sb->blank, SB_COLS);
+    }
+
+    sb->view = 0; // new input snaps back to the live view
+}
+
+void sb_scroll(Scrollback *sb, int delta, int rows)
+{
+    uint32_t top    = sb_live_top(sb, rows);
+    uint32_t oldest = sb_oldest(sb);
+    int32_t  max    = (top > oldest) ? (int32_t)(top - oldest) : 0;
+    int32_t  v      = (int32_t)sb->view + delta;
+
+    if (v < 0)   v = 0;
+    if (v > max) v = max;
+    sb->view = (uint16_t)v;
+}
+
+const char *sb_row(const Scrollback *sb, int row, int rows)
+{
+    uint32_t n = sb_live_top(sb, rows) - sb->view + (uint32_t)row;
+
+    return sb->line[n & SB_MASK];
+}
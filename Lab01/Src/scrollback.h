@@ -0,0 +1,43 @@
+//------------------------------------------------------------------------------------
+// scrollback.h
+//------------------------------------------------------------------------------------
+//
+// Circular line buffer for the Lab 1 character log.
+//
+// Lines live in a ring of SB_LINES x SB_COLS cells. 'head' counts every line
+// ever started, so the current line is line[head % SB_LINES] and appending a
+// character never moves existing text: it is one store, plus clearing the next
+// slot when a line fills up. The oldest line is overwritten once the ring wraps.
+//
+// The visible window (rows lines) normally ends on the current line; 'view'
+// scrolls it back into history. sb_row() returns a pointer straight into the
+// ring, so rendering copies nothing.
+//
+//------------------------------------------------------------------------------------
+#ifndef SCROLLBACK_H
+#define SCROLLBACK_H
+
+#include <stdint.h>
+
+#define SB_COLS   72
+#define SB_LINES  64   // history depth, power of two
+
+typedef struct {
+    char     line[SB_LINES][SB_COLS];
+    uint32_t head;   // absolute number of the current line
+    uint8_t  col;    // next column on the current line
+    uint16_t view;   // lines scrolled back from the bottom, 0 = live
+    char     blank;  // fill character for empty cells
+} Scrollback;
+
+void sb_init(Scrollback *sb, char blank);
+void sb_putc(Scrollback *sb, char c);
+
+// Move the window by delta lines (positive = back into history), clamped to
+// what the ring still holds for a window of 'rows' lines.
+void sb_scroll(Scrollback *sb, int delta, int rows);
+
+// Row 0..rows-1 of the current window, SB_COLS chars, not NUL terminated.
+const char *sb_row(const Scrollback *sb, int row, int rows);
+
+#endif // SCROLLBACK_H
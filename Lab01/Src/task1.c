@@ -12,6 +12,7 @@
 //------------------------------------------------------------------------------------
 #include "stm32f769xx.h"
 #include "hello.h"
+#include "console_rx.h"
 #include <stdint.h>
 
 #define ESC_KEY 27
@@ -22,6 +23,7 @@
 int main(void)
 {
     Sys_Init();
+    console_rx_init(); // keyboard bytes arrive by interrupt
 
     printf("\033[2J\033[;H"); // Erase screen & move cursor to home position
     fflush(stdout);
@@ -37,20 +39,24 @@ int main(void)
 
     HAL_Delay(1000);
 
-    char inputChar;
+    int inputChar;
 
     printf("\0333[44;33m"); // blue background and yellow characters
-    fflush();
+    fflush(stdout);
     printf("\033[2;19H"); 	// center instruction text on line 2
-    fflush();
+    fflush(stdout);
     printf("Enter <ESC> or <CTRL> + [ to terminate\r\n\n");
     printf("\033[4;1H");
-    fflush();
+    fflush(stdout);
 
     while(1)
     {
 
-    	inputChar = getchar();
+    	inputChar = console_getc();
+    	if (inputChar < 0) { // nothing typed yet, sleep until the next interrupt
+    		__WFI();
+    		continue;
+    	}
 
     	if (inputChar == ESC_KEY) { // terminate program
     		printf("program terminated.\r\n\n");
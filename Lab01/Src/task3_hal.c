@@ -9,10 +9,22 @@
 //------------------------------------------------------------------------------------
 #include "stm32f769xx.h"
 #include "hello.h"
+#include "gpio_route.h"
 #include <stdint.h>
 
+// 1 = EXTI-driven routing table, 0 = original polled GPIOrun() (for comparison)
+#define USE_GPIO_ROUTE 1
+
 void GPIOrun();
 
+// Input -> LED wiring for this task
+static const GpioRoute routeTable[] = {
+    { GPIOC, 7, GPIOJ, 13, 0, 0 }, // PC7 -> LED1 (PJ13)
+    { GPIOC, 6, GPIOJ, 5,  0, 0 }, // PC6 -> LED2 (PJ5)
+    { GPIOF, 6, GPIOA, 12, 0, 0 }, // PF6 -> LED3 (PA12), EXTI6 belongs to PC6 so this one is polled
+    { GPIOJ, 1, GPIOD, 4,  1, 0 }, // PJ1 -> LED4 (PD4), inverted
+};
+
 //------------------------------------------------------------------------------------
 // MAIN Routine
 //------------------------------------------------------------------------------------
@@ -63,10 +75,43 @@ int main(void)
     GPIO_InitStruct.Pin  = GPIO_PIN_4;
     HAL_GPIO_Init(GPIOD, &GPIO_InitStruct); //PD4
 
+#if USE_GPIO_ROUTE
+    gpio_route_init(routeTable, sizeof(routeTable) / sizeof(routeTable[0]));
+#else
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // cycle counter for the loop gap
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    uint32_t lastRun = DWT->CYCCNT;
+    uint32_t gapMax = 0;
+#endif
+    uint32_t lastReport = HAL_GetTick();
+
     while(1)
     {
 
+#if USE_GPIO_ROUTE
+    	gpio_route_poll();	// polled fallback + debounce, edges are handled by EXTI
+#else
     	GPIOrun();
+
+    	// worst time between two passes = worst input-to-output latency
+    	uint32_t now = DWT->CYCCNT;
+    	if (now - lastRun > gapMax) gapMax = now - lastRun;
+    	lastRun = now;
+#endif
+
+    	// latency report once a second
+    	if (HAL_GetTick() - lastReport >= 1000) {
+    		lastReport = HAL_GetTick();
+#if USE_GPIO_ROUTE
+    		const GpioRouteStats *st = gpio_route_stats();
+    		printf("\033[1;1Hroute: %lu events, irq max %lu avg %lu cyc, poll gap max %lu cyc, polled 0x%x\033[K",
+    		       st->events, st->irqMax, st->events ? st->irqSum / st->events : 0,
+    		       st->pollGapMax, st->polledMask);
+#else
+    		printf("\033[1;1HGPIOrun: loop gap max %lu cyc\033[K", gapMax);
+#endif
+    		fflush(stdout);
+    	}
     }
 
 }
@@ -16,6 +16,12 @@
 //------------------------------------------------------------------------------------
 #include "stm32f769xx.h" // STM32 HAL header
 #include "hello.h"       // Custom header for this program
+#include "vterm.h"       // Diff-based virtual screen
+#include "scrollback.h"  // Circular character log
+#include "console_tx.h"  // DMA-backed stdout
+#include "fmt.h"         // Heap-free formatting
+#include "console_rx.h"  // Interrupt-driven keyboard input
+#include "gpio_route.h"  // EXTI-driven input -> LED routing
 #include <stdint.h>       // Fixed-width integer types
 
 //------------------------------------------------------------------------------------
@@ -23,13 +29,23 @@
 //------------------------------------------------------------------------------------
 uint8_t fault = 0; // Indicates if a non-printable character was received
 #define ESC_KEY 27 // ASCII value for the Escape key
+#define CTRL_U  21 // Scroll the log back
+#define CTRL_D  4  // Scroll the log forward
+#define LOG_ROWS 10 // Visible rows of the log
+
+// 1 = EXTI-driven routing table, 0 = original polled GPIOrun() (for comparison)
+#define USE_GPIO_ROUTE 1
 
 void drawScreen(); // Function prototype for drawing the screen
 void GPIOrun();    // Function prototype for GPIO logic
+void vtSink(const char *buf, size_t len); // Virtual screen output
+
+// Virtual screen: drawScreen() paints into it, only changed cells are sent
+VTerm vt;
+enum { A_PLAIN, A_TEXT, A_ERR, A_FLASH }; // colour attributes
 
-// Buffer to store characters for display (10 rows, 72 columns + null terminator)
-char arr[10][73];
-uint16_t id = 0;          // Current index in the buffer
+// Character log: ring of lines with history beyond the 10 visible rows
+Scrollback sb;
 uint16_t PrintChar = 0;   // Count of printable characters received
 uint16_t NotPrintChar = 0; // Count of non-printable characters received
 
@@ -38,12 +54,30 @@ char badList[22] = {127, 9, 12, 13, 16, 17, 18, 19, 20, 33, 34, 35, 36, 37, 38,
 
 char inputChar; // Variable to store the current input character
 
+// Worst gap between two GPIOrun() passes (= worst mirroring latency), in DWT cycles
+uint32_t latIdleMax = 0; // passes with no key handled
+uint32_t latKeyMax = 0;  // passes that handled a key and redrew the screen
+
+// Input -> output wiring for this task
+static const GpioRoute routeTable[] = {
+    { GPIOC, 6, GPIOJ, 13, 0, 0 }, // PC6 -> LED1 (PJ13)
+    { GPIOC, 7, GPIOJ, 5,  0, 0 }, // PC7 -> LED2 (PJ5)
+    { GPIOJ, 1, GPIOA, 12, 0, 0 }, // PJ1 -> PA12
+    { GPIOF, 6, GPIOD, 4,  1, 0 }, // PF6 -> PD4, inverted; EXTI6 belongs to PC6 so this one is polled
+};
+
 //------------------------------------------------------------------------------------
 // MAIN Routine
 //------------------------------------------------------------------------------------
 int main(void)
 {
     Sys_Init(); // Initialize the system (defined in init.c)
+    console_tx_init(); // printf queues, USART1 TX drains on DMA
+    console_rx_init(); // keyboard bytes arrive by interrupt, getchar no longer blocks the loop
+
+    // Cycle counter for the latency measurement
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
     printf("\033[2J\033[;H"); // Clear the screen and move the cursor to the home position
 
@@ -51,6 +85,12 @@ int main(void)
 
     HAL_Delay(1000); // Pause for a second
 
+    vt_init(&vt, vtSink);
+    vt_attr_define(&vt, A_PLAIN, 7, 0);    // terminal default
+    vt_attr_define(&vt, A_TEXT, 220, 24);  // yellow on blue
+    vt_attr_define(&vt, A_ERR, 196, 24);   // red on blue
+    vt_attr_define(&vt, A_FLASH, 196, 196); // red block
+
     // Enable the clock for GPIO ports
     RCC->AHB1ENR |= RCC_AHB1ENR_GPIOCEN;  // Enable GPIOC clock
     RCC->AHB1ENR |= RCC_AHB1ENR_GPIOJEN;  // Enable GPIOJ clock
@@ -79,30 +119,55 @@ int main(void)
     GPIOD->MODER &= ~(3U << (4 * 2));                     // Clear PD4
     GPIOD->MODER |= (1U << (4 * 2));                      // Set PD4 as output
 
-    // Initialize the display buffer with '.' characters
-    for (int i = 0; i < 10; i++) {
-        for (int j = 0; j < 72; j++) {
-            arr[i][j] = '.';
-        }
-        arr[i][72] = '\0'; // Null terminator for each row
-    }
+#if USE_GPIO_ROUTE
+    gpio_route_init(routeTable, sizeof(routeTable) / sizeof(routeTable[0]));
+#endif
+
+    // Initialize the log with '.' characters
+    sb_init(&sb, '.');
+
+    uint8_t dirty = 1;      // Screen needs a redraw
+    uint8_t keyPass = 0;    // This pass handled a key
+    uint32_t lastRun = DWT->CYCCNT;
 
     while (1) {
-        drawScreen(); // Update the screen
+        if (dirty) {
+            drawScreen(); // Update the screen only when something changed
+            dirty = 0;
+        }
+#if USE_GPIO_ROUTE
+        gpio_route_poll(); // Edges arrive by EXTI; this covers the polled route
+#else
         GPIOrun();    // Run GPIO logic
-
-        // Clear Overrun Error if it occurred
-        if (USART1->ISR & USART_ISR_ORE) {
-            volatile char dump = (char)USART1->RDR; // Read RDR to clear the error
-            (void)dump;
-            USART1->ICR |= USART_ICR_ORECF; // Clear the overrun flag
+#endif
+
+        // Track the worst time between GPIOrun() passes
+        uint32_t now = DWT->CYCCNT;
+        uint32_t gap = now - lastRun;
+        lastRun = now;
+        if (keyPass) {
+            if (gap > latKeyMax) latKeyMax = gap;
+        } else if (gap > latIdleMax) {
+            latIdleMax = gap;
         }
+        keyPass = 0;
+
+        int c = console_getc(); // -1 when nothing was typed, never blocks
+        if (c >= 0) {
+            inputChar = (char)c;
+            keyPass = 1;
+            dirty = 1;
 
-        if ((inputChar = 0) != EOF) {//if you want to run the terminal thing put getChar instead of 0, get char blocks the GPIO from updating and I am not doing interups for ts
             if (inputChar == ESC_KEY) {
                 break; // Exit the loop if the Escape key is pressed
             }
 
+            // Ctrl-U / Ctrl-D page through the log history
+            if (inputChar == CTRL_U || inputChar == CTRL_D) {
+                sb_scroll(&sb, (inputChar == CTRL_U) ? LOG_ROWS / 2 : -LOG_ROWS / 2, LOG_ROWS);
+                continue;
+            }
+
             uint8_t good = 1; // Flag to check if the character is printable
             for (int k = 0; k < 22; k++) {
                 if (inputChar == badList[k]) {
@@ -115,26 +180,7 @@ int main(void)
                 fault = 0; // Reset fault flag
                 PrintChar++; // Increment printable character count
 
-                if (id >= 720) {
-                    id = id - 73; // Adjust index to prevent overflow
-
-                    // Shift rows up to make space for new data
-                    for (int i = 0; i < 9; i++) {
-                        for (int j = 0; j < 72; j++) {
-                            arr[i][j] = arr[i + 1][j];
-                        }
-                    }
-
-                    // Clear the last row
-                    for (int j = 0; j < 72; j++) {
-                        arr[9][j] = '.'; // ASCII for period
-                    }
-                } else {
-                    // Save the character in the buffer
-                    arr[id / 72][id % 72] = inputChar;
-                }
-
-                id++; // Increment the buffer index
+                sb_putc(&sb, inputChar); // Append to the log, O(1)
             } else {
                 fault = 1; // Set fault flag
                 NotPrintChar++; // Increment non-printable character count
@@ -142,6 +188,10 @@ int main(void)
             }
         }
     }
+
+    // Show what the console output cost, then let it drain before returning
+    console_tx_report();
+    console_tx_flush();
 }
 
 //------------------------------------------------------------------------------------
@@ -178,70 +228,68 @@ void GPIOrun() {
     }
 }
 
+//------------------------------------------------------------------------------------
+// Output sink for the virtual screen: the whole frame goes out in one write
+//------------------------------------------------------------------------------------
+void vtSink(const char *buf, size_t len) {
+    fwrite(buf, 1, len, stdout);
+    fflush(stdout);
+}
+
 //------------------------------------------------------------------------------------
 // Function to draw the screen
 //------------------------------------------------------------------------------------
 void drawScreen() {
-    printf("\033[?25l"); // Hide the cursor
-    printf("\033[38;5;220m"); // Set foreground color
-    printf("\033[48;5;24m"); // Set background color
-    printf("\033[2;19H");
-    printf("Enter <ESC> or <CTRL> + [ to terminate\r\n\n");
-
-    // Print a line of dashes to mark the start of the printable zone
-    printf("\033[3;0H");
-    for (int i = 0; i < 80; i++) {
-        printf("-");
-    }
+    vt_fill(&vt, ' ', A_PLAIN);
 
-    // Print the buffer content
-    for (int i = 0; i < 10; i++) {
-        printf("\033[%d;5H", i + 4); // Move to row i+4, column 5
-        printf("%.*s", 72, arr[i]); // Print 72 characters from the row
-    }
+    vt_puts(&vt, 2, 19, "Enter <ESC> or <CTRL> + [ to terminate", A_TEXT);
+
+    // Lines of dashes mark the start and end of the printable zone
+    vt_hline(&vt, 3, 1, 80, '-', A_TEXT);
+    vt_hline(&vt, 14, 1, 80, '-', A_TEXT);
 
-    // Print a line of dashes to mark the end of the printable zone
-    printf("\033[14;0H");
-    for (int i = 0; i < 80; i++) {
-        printf("-");
+    // Log window, rows 4..13 from column 5
+    for (int i = 0; i < LOG_ROWS; i++) {
+        vt_putn(&vt, i + 4, 5, sb_row(&sb, i, LOG_ROWS), SB_COLS, A_TEXT);
     }
+    if (sb.view > 0) {
+        vt_printf(&vt, 14, 5, A_TEXT, "[ history -%u, Ctrl-D to return ]", sb.view);
+    }
+
+    // Error message area (cleared when there is no fault)
+    vt_hline(&vt, 16, 1, 80, ' ', A_TEXT);
+
+    // Display character counts
+    vt_puts(&vt, 21, 1, "# of Characters Received:", A_TEXT);
+    vt_puts(&vt, 22, 1, "Printable             Non-Printable", A_TEXT);
+    vt_printf(&vt, 23, 1, A_TEXT, "%d", PrintChar);
+    vt_printf(&vt, 23, 22, A_TEXT, "%d", NotPrintChar);
+
+    // Worst GPIO mirroring latency so far, with and without typing
+    uint32_t cyclesPerUs = SystemCoreClock / 1000000U;
+    vt_printf(&vt, 18, 1, A_TEXT, "GPIO latency max: idle %lu us, typing %lu us",
+              (unsigned long)(latIdleMax / cyclesPerUs), (unsigned long)(latKeyMax / cyclesPerUs));
+#if USE_GPIO_ROUTE
+    // EXTI routes: ISR entry to BSRR write, independent of the loop above
+    const GpioRouteStats *st = gpio_route_stats();
+    vt_printf(&vt, 19, 1, A_TEXT, "EXTI routes: %lu events, max %lu cyc, avg %lu cyc (polled 0x%x)",
+              (unsigned long)st->events, (unsigned long)st->irqMax,
+              (unsigned long)(st->events ? st->irqSum / st->events : 0), st->polledMask);
+#endif
 
     if (fault == 1) {
-        // Display error message for non-printable character
-        printf("\033[16;0H");
-        printf("\033[38;5;196m"); // Set foreground color to red
-        printf("The received value $%x is ’not printable’ ", inputChar);
-        printf("\033[38;5;220m"); // Reset foreground color
+        // Flash the error message: red text, red block, red text
+        char msg[64];
+        fmt_snprintf(msg, sizeof(msg), "The received value $%x is 'not printable'", inputChar);
 
-        fflush(stdout);
+        vt_puts(&vt, 16, 1, msg, A_ERR);
+        vt_flush(&vt);
         HAL_Delay(100);
-        printf("\033[16;0H");
-        printf("\033[48;5;196m"); // Set background color to red
-        printf("The received value $%x is ’not printable’ ", inputChar);
-        fflush(stdout);
+        vt_puts(&vt, 16, 1, msg, A_FLASH);
+        vt_flush(&vt);
         HAL_Delay(100);
-        printf("\033[16;0H");
-        printf("The received value $%x is ’not printable’ ", inputChar);
-        printf("\033[48;5;24m"); // Reset background color
-        fflush(stdout);
-    } else {
-        // Clear the error message area
-        printf("\033[16;0H");
-        for (int i = 0; i < 80; i++) {
-            printf(" ");
-        }
+        vt_puts(&vt, 16, 1, msg, A_ERR);
     }
 
-    // Display character counts
-    printf("\033[21;0H");
-    printf("# of Characters Received:");
-    printf("\033[22;0H");
-    printf("Printable             Non-Printable");
-    printf("\033[23;0H");
-    printf("%d", PrintChar);
-    printf("\033[23;22H");
-    printf("%d", NotPrintChar);
-
-    printf("\033[?25h"); // Show the cursor
-    fflush(stdout);
+    vt_flush(&vt);
 }
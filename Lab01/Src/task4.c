@@ -4,16 +4,60 @@
 //
 // Task 4: [Depth] Maze
 //
+// Runs on the bit-packed maze engine (maze.c): starts on the original 12x12
+// maze, 'g' generates a large random maze shown through a scrolling viewport,
+// 'h' toggles the shortest path to the exit.
+//
 //------------------------------------------------------------------------------------
 // Includes
 //------------------------------------------------------------------------------------
 #include "stm32f769xx.h"
 #include "hello.h"
+#include "console_rx.h"
+#include "maze.h"
 #include <stdint.h>
 
+// Generated maze size (odd) and the window it is shown through
+#define GEN_W   127
+#define GEN_H   63
+#define VIEW_W  60
+#define VIEW_H  18
+#define VIEW_ROW 4   // screen position of the maze's top-left cell
+#define VIEW_COL 19
+
 void drawMaze();
-void setMazeArray();
-int reachedExit(uint8_t posx, uint8_t posy);
+void loadDefaultMaze();
+void mazeSink(const char *buf, uint32_t len);
+int reachedExit(int posx, int posy);
+
+// the original maze, '|' and '-' are walls
+static const char *defaultMaze[12] = {
+    "------------",
+    "|      |   |",
+    "| | || |   |",
+    "| |  | |   |",
+    "|  | |  || |",
+    "|| | ||  | |",
+    "|  |   |   |",
+    "| |||| |||||",
+    "|    | |   |",
+    "|||| | | | |",
+    "|    |   | |",
+    "---------- -",
+};
+
+// maze storage, sized for the largest (generated) maze
+static uint32_t mazeBits[MAZE_WORDS(GEN_W, GEN_H)];
+static uint32_t genScratch[MAZE_GEN_WORDS(GEN_W, GEN_H)];
+static uint32_t solveScratch[MAZE_SOLVE_WORDS(GEN_W, GEN_H)];
+static uint32_t solveQueue[512];
+static uint32_t pathBits[MAZE_WORDS(GEN_W, GEN_H)];
+
+static Maze maze;
+static MazeView view;
+
+// exit cell: reaching it ends the game
+static int exitX, exitY;
 
 //------------------------------------------------------------------------------------
 // MAIN Routine
@@ -21,6 +65,7 @@ int reachedExit(uint8_t posx, uint8_t posy);
 int main(void)
 {
     Sys_Init();
+    console_rx_init(); // keyboard bytes arrive by interrupt
 
     printf("\033[2J\033[;H"); // Erase screen & move cursor to home position
     fflush(stdout);
@@ -43,237 +88,124 @@ int main(void)
 
     // player's starting x and y positions
     // measured from the top left of the maze
-	uint8_t posx = 1;
-	uint8_t posy = 1;
+	int posx = 1;
+	int posy = 1;
 
-	char inputChar;
+	int inputChar;
 	uint8_t blueButton;
+	uint8_t lastButton = 0;
+	uint8_t showPath = 0;
 
-	// stores 10x10 maze with an extra 2 rows and 2 columns
-	// for the top, bottom, left, and right side of the maze
-	// represented by 0's and 1's. 0 ==> no wall, 1 ==> wall
-	int mazeArr[12][12];
-
+	loadDefaultMaze();
 	drawMaze();
-	setMazeArray(mazeArr);
-
-	printf("\033[?25l");
-    printf("\033[5;20H");		// place cursor at beginning of maze
-	printf("\033[38;5;220m");	// foreground - white
-	printf("O");				// print player character
-    printf("\033[5;20H");
+	maze_view_render(&view, posx, posy, NULL);
 	fflush(stdout);
 
     while(1)
     {
 
-    	inputChar = getchar();
+    	// non-blocking: the button is checked even when no key is pressed
+    	inputChar = console_getc();
 
-    	// check if blue button is pushed
+    	// check if blue button is pushed (act once per press)
     	blueButton = HAL_GPIO_ReadPin(GPIOA, GPIO_PIN_0);  // read PE5
-    	if (blueButton) {
-    		// reset maze and place player back at the start
-    	    printf("\033[2J\033[;H"); 	// Erase screen & move cursor to home position
-    	    drawMaze();
-    	    printf("\033[?25l");
-    	    printf("\033[5;20H");		// place cursor at beginning of maze
-    		printf("\033[38;5;220m");	// foreground - white
-    		printf("O");				// print player character
-    	    printf("\033[5;20H");
-    		fflush(stdout);
+    	uint8_t pressed = blueButton && !lastButton;
+    	lastButton = blueButton;
+    	if (pressed) {
+    		// place player back at the start and repaint
     		posx = 1;
     		posy = 1;
+    	    drawMaze();
+    	} else if (inputChar < 0) {
     		continue;
     	}
 
-    	// move the player if keys w, a, s, or d are pressed
+    	int nx = posx, ny = posy;
+
     	switch (inputChar) {
-			case 119: // w
-				posy--;
-				if (reachedExit(posx, posy)) return 0;;
-				if (mazeArr[posy][posx]) {
-					// wall collision
-					posy++; // backtrack
-				} else {
-					// move up
-					printf("\033[%d;%dH", posy+5, posx+19); // delete previous character
-					printf(" ");
-					printf("\033[%d;%dH", posy+4, posx+19); // move player's character up
-					printf("O");
-					fflush(stdout);
-				}
-				break;
-			case 97: // a
-				posx--;
-				if (reachedExit(posx, posy)) return 0;;
-				if (mazeArr[posy][posx]) {
-					// wall collision
-					posx++; // backtrack
-				} else {
-					// move left
-					printf("\033[%d;%dH", posy+4, posx+20); // delete previous character
-					printf(" ");
-					printf("\033[%d;%dH", posy+4, posx+19); // move player's character left
-					printf("O");
-					fflush(stdout);
-				}
+			case 'w': ny--; break;
+			case 'a': nx--; break;
+			case 's': ny++; break;
+			case 'd': nx++; break;
+			case 'g':
+				// new random maze, seeded from the time of the key press
+				maze_init(&maze, GEN_W, GEN_H, mazeBits);
+				maze_generate(&maze, HAL_GetTick() * 2654435761U, genScratch);
+				exitX = GEN_W - 2;
+				exitY = GEN_H - 2;
+				nx = ny = posx = posy = 1;
+				drawMaze();
 				break;
-			case 115: // s
-				posy++;
-				if (reachedExit(posx, posy)) return 0;
-				if (mazeArr[posy][posx]) {
-					// wall collision
-					posy--; // backtrack
-				} else {
-					// move down
-					printf("\033[%d;%dH", posy+3, posx+19); // delete previous character
-					printf(" ");
-					printf("\033[%d;%dH", posy+4, posx+19); // move player's character down
-					printf("O");
-					fflush(stdout);
-				}
-				break;
-			case 100: // d
-				posx++;
-				if (reachedExit(posx, posy)) return 0;
-				if (mazeArr[posy][posx]) {
-					// wall collision
-					posx--; // backtrack
-				} else {
-					// move right
-					printf("\033[%d;%dH", posy+4, posx+18); // delete previous character
-					printf(" ");
-					printf("\033[%d;%dH", posy+4, posx+19); // move player's character right
-					printf("O");
-					fflush(stdout);
-				}
+			case 'h':
+				showPath = !showPath;
 				break;
     	}
+
+    	// move the player unless the new cell is a wall
+    	if (!maze_wall(&maze, nx, ny)) {
+    		posx = nx;
+    		posy = ny;
+    	}
+
+    	if (showPath) {
+    		maze_solve(&maze, posx, posy, exitX, exitY, solveScratch,
+    		           solveQueue, sizeof(solveQueue) / sizeof(solveQueue[0]), pathBits);
+    	}
+
+    	// only the cells that changed go out
+    	maze_view_render(&view, posx, posy, showPath ? pathBits : NULL);
+    	fflush(stdout);
+
+    	if (reachedExit(posx, posy)) return 0;
     }
 
     return 0;
 
 }
 
+// loads the original hand-drawn maze into the engine
+void loadDefaultMaze() {
+
+	maze_init(&maze, 12, 12, mazeBits);
+	for (int y = 0; y < 12; y++) {
+		for (int x = 0; x < 12; x++) {
+			maze_set(&maze, x, y, defaultMaze[y][x] != ' ');
+		}
+	}
+	exitX = 10; // exit is at (10, 10) on the maze
+	exitY = 10;
+}
+
+// clears the screen, prints the help text and sets up the maze window
 void drawMaze() {
 
-	printf("WASD to move\r\n");
+	printf("\033[2J\033[;H"); 	// Erase screen & move cursor to home position
+	printf("WASD to move, G for a new maze, H for a hint\r\n");
 	printf("Push blue button to reset\r\n\n");
 
 	printf("\033[?25l"); 		// make the cursor invisible
-	printf("\033[38;5;21m");	//foreground - blue
     printf("\033[48;5;0m");		//background - black
 
-    // fill entire screen black
-    for (int i = 0; i < 20; i++) {
-    	for (int j = 0; j < 80; j++) {
-    		printf(" ");
-    	}
-    }
-
-    // print maze
-    printf("\033[4;19H");
-    printf("------------");
-    printf("\033[5;19H");
-    printf("|      |   |");
-    printf("\033[6;19H");
-    printf("| | || |   |");
-    printf("\033[7;19H");
-    printf("| |  | |   |");
-    printf("\033[8;19H");
-    printf("|  | |  || |");
-    printf("\033[9;19H");
-    printf("|| | ||  | |");
-    printf("\033[10;19H");
-    printf("|  |   |   |");
-    printf("\033[11;19H");
-    printf("| |||| |||||");
-    printf("\033[12;19H");
-    printf("|    | |   |");
-    printf("\033[13;19H");
-    printf("|||| | | | |");
-    printf("\033[14;19H");
-    printf("|    |   | |");
-    printf("\033[15;19H");
-    printf("---------- -");
-
-    fflush(stdout);
-
+	maze_view_init(&view, &maze, VIEW_W, VIEW_H, VIEW_ROW, VIEW_COL, mazeSink);
 }
 
-void setMazeArray(int mazeArr[][12]) {
-
-	// fill maze array with zeroes
-	for (int i = 0; i < 12; i++) {
-		for (int j = 0; j < 12; j++) {
-			mazeArr[i][j] = 0;
-		}
-	}
-
-	// place 1s where there are walls
-	for (int i = 0; i < 12; i++) {
-		// outer sides of the maze
-		mazeArr[0][i] = 1;
-		mazeArr[i][0] = 1;
-		mazeArr[11][i] = 1;
-		mazeArr[i][11] = 1;
-	}
+// output for the maze view
+void mazeSink(const char *buf, uint32_t len) {
 
-	// walls inside of the maze
-	mazeArr[1][7] = 1;
-	mazeArr[2][2] = 1;
-	mazeArr[2][4] = 1;
-	mazeArr[2][5] = 1;
-	mazeArr[2][7] = 1;
-	mazeArr[2][9] = 1;
-	mazeArr[2][10] = 1;
-	mazeArr[3][2] = 1;
-	mazeArr[3][5] = 1;
-	mazeArr[3][7] = 1;
-	mazeArr[4][3] = 1;
-	mazeArr[4][5] = 1;
-	mazeArr[4][7] = 1;
-	mazeArr[5][1] = 1;
-	mazeArr[5][3] = 1;
-	mazeArr[5][5] = 1;
-	mazeArr[5][6] = 1;
-	mazeArr[5][9] = 1;
-	mazeArr[6][3] = 1;
-	mazeArr[6][7] = 1;
-	mazeArr[7][2] = 1;
-	mazeArr[7][3] = 1;
-	mazeArr[7][4] = 1;
-	mazeArr[7][5] = 1;
-	mazeArr[7][7] = 1;
-	mazeArr[7][8] = 1;
-	mazeArr[7][9] = 1;
-	mazeArr[7][10] = 1;
-	mazeArr[8][5] = 1;
-	mazeArr[8][7] = 1;
-	mazeArr[9][1] = 1;
-	mazeArr[9][2] = 1;
-	mazeArr[9][3] = 1;
-	mazeArr[9][5] = 1;
-	mazeArr[9][7] = 1;
-	mazeArr[9][9] = 1;
-	mazeArr[10][5] = 1;
-	mazeArr[10][9] = 1;
+	fwrite(buf, 1, len, stdout);
 }
 
 // prints message and returns 1 if player has reached the exit
 // return 0 if player has not yet reached the exit
-int reachedExit(uint8_t posx, uint8_t posy) {
+int reachedExit(int posx, int posy) {
 
-	if (posx == 10 && posy == 10) { // exit is at (10, 10) on the maze
+	if (posx == exitX && posy == exitY) {
 
     	GPIOJ->ODR ^= (uint16_t)GPIO_PIN_5; // turn on LED
 
-    	printf("\033[16;0H");
+    	printf("\033[%d;0H", VIEW_ROW + view.vh + 1);
+    	printf("\033[38;5;220m");
     	printf("You've reached the exit!\r\n\n");
-		printf("\033[%d;%dH", posy+3, posx+19); // delete previous character
-		printf(" ");
-		printf("\033[%d;%dH", posy+4, posx+19); // move character down
-		printf("O");
     	fflush(stdout);
 
 		return 1;
@@ -0,0 +1,246 @@
+//------------------------------------------------------------------------------------
+// vterm.c
+//------------------------------------------------------------------------------------
+//
+// Diff-based virtual terminal, see vterm.h.
+//
+//------------------------------------------------------------------------------------
+// Includes
+//------------------------------------------------------------------------------------
+#include "vterm.h"
+#include "fmt.h"
+#include <stdarg.h>
+#include <string.h>
+
+#define VT_BRIDGE_MAX 8   // unchanged cells worth re-sending instead of a cursor move
+
+//------------------------------------------------------------------------------------
+// Output buffer
+//------------------------------------------------------------------------------------
+static void out_drain(VTerm *vt)
+{
+    if (vt->out_len == 0) return;
+    vt->sink(vt->out, vt->out_len);
+    vt->bytes_last  += (uint32_t)vt->out_len;
+    vt->bytes_total += (uint32_t)vt->out_len;
+    vt->out_len = 0;
+}
+
+static void out_byte(VTerm *vt, char c)
+{
+    if (vt->out_len == VT_OUT_MAX) out_drain(vt); // only on pathological frames
+    vt->out[vt->out_len++] = c;
+}
+
+static void out_str(VTerm *vt, const char *s)
+{
+    while (*s) out_byte(vt, *s++);
+}
+
+static void out_uint(VTerm *vt, unsigned v)
+{
+    char tmp[10];
+    int n = 0;
+    do { tmp[n++] = (char)('0' + v % 10); v /= 10; } while (v);
+    while (n) out_byte(vt, tmp[--n]);
+}
+
+static int digits(unsigned v)
+{
+    return (v >= 100) ? 3 : (v >= 10) ? 2 : 1;
+}
+
+//------------------------------------------------------------------------------------
+// Setup and drawing
+//------------------------------------------------------------------------------------
+void vt_init(VTerm *vt, VtSink sink)
+{
+    memset(vt, 0, sizeof(*vt));
+    vt->sink = sink;
+    for (int i = 0; i < VT_MAX_ATTRS; i++) {
+        vt->fg[i] = 7;  // white on black until defined
+        vt->bg[i] = 0;
+    }
+    vt->park_row = -1;
+    vt->park_col = -1;
+    vt_fill(vt, ' ', 0);
+    vt_invalidate(vt);
+}
+
+void vt_attr_define(VTerm *vt, uint8_t attr, uint8_t fg, uint8_t bg)
+{
+    if (attr >= VT_MAX_ATTRS) return;
+    vt->fg[attr] = fg;
+    vt->bg[attr] = bg;
+    vt->cur_attr = -1; // colours may have changed under the same id
+}
+
+void vt_invalidate(VTerm *vt)
+{
+    // 0 never matches a drawn character, so every cell is sent next time
+    for (int r = 0; r < VT_ROWS; r++)
+        for (int c = 0; c < VT_COLS; c++)
+            vt->front[r][c].ch = 0;
+    vt->cur_row = -1;
+    vt->cur_col = -1;
+    vt->cur_attr = -1;
+}
+
+void vt_fill(VTerm *vt, char ch, uint8_t attr)
+{
+    for (int r = 0; r < VT_ROWS; r++)
+        for (int c = 0; c < VT_COLS; c++) {
+            vt->back[r][c].ch = ch;
+            vt->back[r][c].attr = attr;
+        }
+}
+
+void vt_put(VTerm *vt, int row, int col, char ch, uint8_t attr)
+{
+    if (row < 1 || row > VT_ROWS || col < 1 || col > VT_COLS) return;
+    vt->back[row - 1][col - 1].ch = ch;
+    vt->back[row - 1][col - 1].attr = attr;
+}
+
+void vt_putn(VTerm *vt, int row, int col, const char *s, int n, uint8_t attr)
+{
+    for (int i = 0; i < n && s[i]; i++) vt_put(vt, row, col + i, s[i], attr);
+}
+
+void vt_puts(VTerm *vt, int row, int col, const char *s, uint8_t attr)
+{
+    for (int i = 0; s[i]; i++) vt_put(vt, row, col + i, s[i], attr);
+}
+
+void vt_hline(VTerm *vt, int row, int col, int n, char ch, uint8_t attr)
+{
+    for (int i = 0; i < n; i++) vt_put(vt, row, col + i, ch, attr);
+}
+
+void vt_printf(VTerm *vt, int row, int col, uint8_t attr, const char *fmt, ...)
+{
+    char tmp[VT_COLS + 1];
+    va_list ap;
+    va_start(ap, fmt);
+    fmt_vsnprintf(tmp, sizeof(tmp), fmt, ap);
+    va_end(ap);
+    vt_puts(vt, row, col, tmp, attr);
+}
+
+void vt_park(VTerm *vt, int row, int col)
+{
+    vt->park_row = (row > 0) ? row - 1 : -1;
+    vt->park_col = (row > 0) ? col - 1 : -1;
+}
+
+//------------------------------------------------------------------------------------
+// Frame emission
+//------------------------------------------------------------------------------------
+static void set_attr(VTerm *vt, uint8_t a)
+{
+    if (vt->cur_attr >= 0 &&
+        vt->fg[vt->cur_attr] == vt->fg[a] && vt->bg[vt->cur_attr] == vt->bg[a]) {
+        vt->cur_attr = a;
+        return;
+    }
+    out_str(vt, "\033[38;5;");
+    out_uint(vt, vt->fg[a]);
+    out_str(vt, ";48;5;");
+    out_uint(vt, vt->bg[a]);
+    out_byte(vt, 'm');
+    vt->cur_attr = a;
+}
+
+static void put_cell(VTerm *vt, int r, int c)
+{
+    VtCell *b = &vt->back[r][c];
+    set_attr(vt, b->attr);
+    out_byte(vt, b->ch);
+    vt->front[r][c] = *b;
+
+    // after the last column the cursor sits in the pending-wrap state
+    vt->cur_col = (c + 1 < VT_COLS) ? c + 1 : -1;
+}
+
+// Cheapest way from the tracked cursor to (r, c), 0-based
+static void move_to(VTerm *vt, int r, int c)
+{
+    if (vt->cur_row == r && vt->cur_col == c) return;
+
+    // same row, short gap of unchanged cells in the current colours: resend them
+    if (vt->cur_row == r && vt->cur_col >= 0 && vt->cur_col < c &&
+        c - vt->cur_col <= VT_BRIDGE_MAX) {
+        int ok = 1;
+        for (int i = vt->cur_col; i < c; i++)
+            if (vt->back[r][i].attr != vt->cur_attr) { ok = 0; break; }
+        if (ok && c - vt->cur_col <= 3 + digits((unsigned)(c - vt->cur_col))) {
+            for (int i = vt->cur_col; i < c; i++) put_cell(vt, r, i);
+            return;
+        }
+    }
+
+    int cup = 2 + digits((unsigned)r + 1) + ((c > 0) ? 1 + digits((unsigned)c + 1) : 0) + 1;
+    int best = cup, how = 0; // 0 CUP, 1 CUF, 2 CR(+CUF), 3 CRLF(+CUF)
+
+    if (vt->cur_row == r && vt->cur_col >= 0 && vt->cur_col < c) {
+        int n = c - vt->cur_col;
+        int cost = 2 + ((n > 1) ? digits((unsigned)n) : 0) + 1;
+        if (cost < best) { best = cost; how = 1; }
+    }
+    if (vt->cur_row == r) {
+        int cost = 1 + ((c > 0) ? 2 + ((c > 1) ? digits((unsigned)c) : 0) + 1 : 0);
+        if (cost < best) { best = cost; how = 2; }
+    }
+    if (vt->cur_row >= 0 && vt->cur_row + 1 == r) {
+        int cost = 2 + ((c > 0) ? 2 + ((c > 1) ? digits((unsigned)c) : 0) + 1 : 0);
+        if (cost < best) { best = cost; how = 3; }
+    }
+
+    if (how == 0) {
+        out_str(vt, "\033[");
+        out_uint(vt, (unsigned)r + 1);
+        if (c > 0) { out_byte(vt, ';'); out_uint(vt, (unsigned)c + 1); }
+        out_byte(vt, 'H');
+    } else {
+        int from = vt->cur_col;
+        if (how == 2) { out_byte(vt, '\r'); from = 0; }
+        if (how == 3) { out_str(vt, "\r\n"); from = 0; }
+        int n = c - from;
+        if (n > 0) {
+            out_str(vt, "\033[");
+            if (n > 1) out_uint(vt, (unsigned)n);
+            out_byte(vt, 'C');
+        }
+    }
+    vt->cur_row = r;
+    vt->cur_col = c;
+}
+
+size_t vt_flush(VTerm *vt)
+{
+    vt->bytes_last = 0;
+    vt->out_len = 0;
+
+    int dirty = 0;
+    for (int r = 0; r < VT_ROWS; r++) {
+        for (int c = 0; c < VT_COLS; c++) {
+            VtCell *b = &vt->back[r][c];
+            VtCell *f = &vt->front[r][c];
+            if (b->ch == f->ch && b->attr == f->attr) continue;
+
+            if (!dirty) { out_str(vt, "\033[?25l"); dirty = 1; } // hide while drawing
+            move_to(vt, r, c);
+            put_cell(vt, r, c);
+        }
+    }
+
+    if (vt->park_row >= 0 &&
+        (dirty || vt->cur_row != vt->park_row || vt->cur_col != vt->park_col)) {
+        move_to(vt, vt->park_row, vt->park_col);
+        out_str(vt, "\033[?25h");
+    }
+
+    out_drain(vt);
+    vt->frames++;
+    return vt->bytes_last;
+}
@@ -0,0 +1,78 @@
+//------------------------------------------------------------------------------------
+// vterm.h
+//------------------------------------------------------------------------------------
+//
+// Diff-based virtual terminal for the Lab 1 console UIs.
+//
+// Drawing goes into a back buffer of cells (character + attribute). vt_flush()
+// compares it with the front buffer (what the terminal is showing), emits only
+// the cursor moves, colour changes and character runs needed for the cells
+// that changed, and hands the whole frame to the sink in ONE write.
+//
+// Attributes are small ids (0..VT_MAX_ATTRS-1) bound to a 256-colour fg/bg
+// pair with vt_attr_define(). Characters are single bytes (keep text ASCII).
+//
+// No HAL dependencies; the sink decides where the bytes go.
+//
+//------------------------------------------------------------------------------------
+#ifndef VTERM_H
+#define VTERM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define VT_ROWS       24
+#define VT_COLS       80
+#define VT_MAX_ATTRS  8
+#define VT_OUT_MAX    4096   // worst case full repaint with colour changes fits
+
+typedef struct {
+    char    ch;
+    uint8_t attr;
+} VtCell;
+
+typedef void (*VtSink)(const char *buf, size_t len);
+
+typedef struct {
+    VtCell front[VT_ROWS][VT_COLS];  // what the terminal shows
+    VtCell back[VT_ROWS][VT_COLS];   // what the next frame should show
+
+    uint8_t fg[VT_MAX_ATTRS];
+    uint8_t bg[VT_MAX_ATTRS];
+
+    char    out[VT_OUT_MAX];
+    size_t  out_len;
+
+    int     cur_row, cur_col;        // terminal cursor, 0-based; -1 = unknown
+    int     cur_attr;                // attribute in effect; -1 = unknown
+    int     park_row, park_col;      // where to leave the cursor; -1 = hidden
+
+    VtSink  sink;
+
+    uint32_t frames;
+    uint32_t bytes_last;             // bytes sent by the last vt_flush()
+    uint32_t bytes_total;
+} VTerm;
+
+void vt_init(VTerm *vt, VtSink sink);
+void vt_attr_define(VTerm *vt, uint8_t attr, uint8_t fg, uint8_t bg);
+
+// Back-buffer drawing (rows/cols are 1-based like ANSI; clipped to the screen)
+void vt_fill(VTerm *vt, char ch, uint8_t attr);
+void vt_put(VTerm *vt, int row, int col, char ch, uint8_t attr);
+void vt_puts(VTerm *vt, int row, int col, const char *s, uint8_t attr);
+void vt_putn(VTerm *vt, int row, int col, const char *s, int n, uint8_t attr);
+void vt_hline(VTerm *vt, int row, int col, int n, char ch, uint8_t attr);
+// vt_printf takes the fmt.h printf subset (integers and strings, no float)
+void vt_printf(VTerm *vt, int row, int col, uint8_t attr, const char *fmt, ...);
+
+// Show the cursor at row/col after the next flush (row <= 0 hides it)
+void vt_park(VTerm *vt, int row, int col);
+
+// Forget what the terminal shows; the next flush repaints everything
+void vt_invalidate(VTerm *vt);
+
+// Emit the differences as a single sink write; returns bytes written
+size_t vt_flush(VTerm *vt);
+
+#endif // VTERM_H
@@ -6,6 +6,10 @@
 #include "stm32f769xx.h"
 #include "stm32f7xx_hal.h"
 #include <stdio.h>
+#include "dlog.h"   // Deferred logging out of the ISRs
+#include "swtimer.h" // Software timers on one hardware timer (Part 4)
+#include "gesture.h" // Button gestures from edge timestamps (Part 4)
+#include "pulse_seq.h" // Timer-DMA pulse trains (Part 3)
 
 // ===========================================
 // Select which part to run
@@ -16,6 +20,23 @@
 // 4 = Depth Task
 #define SELECT_PART 4
 
+// ===========================================
+// ISR logging
+// ===========================================
+// 1 = handlers queue messages with DLOG() and the main loop prints them
+// 0 = original printf/fflush inside the handlers (for the timing comparison)
+#define DEFER_ISR_LOG 1
+
+#if DEFER_ISR_LOG
+#define ISR_LOG(...) DLOG(__VA_ARGS__)
+#define ISR_FLUSH()
+#else
+#define ISR_LOG(...) printf(__VA_ARGS__)
+#define ISR_FLUSH()  fflush(stdout)
+#endif
+
+#define ISR_REPORT_MS 10000 // how often the main loop prints handler timing
+
 // ===========================================
 // Globals used by various parts
 // ===========================================
@@ -23,8 +44,20 @@ volatile uint8_t reg_button_pressed = 0;
 volatile uint8_t hal_button_pressed = 0;
 
 volatile uint32_t tenths = 0; // for Part2 Register
-TIM_HandleTypeDef htim7;      // for Part2 HAL and Part 4
-TIM_HandleTypeDef htim6;      // for Part 4
+TIM_HandleTypeDef htim7;      // for Part2 HAL
+
+// Handler execution time in CPU cycles (DWT)
+typedef struct {
+    uint32_t count;
+    uint32_t max;
+    uint32_t sum;
+} IsrTime;
+
+volatile IsrTime isrTim;      // timer handler of Parts 2-4 (TIM6, TIM7, TIM2)
+volatile IsrTime isrExti;     // button handler of Part 4
+
+#define ISR_TIME_BEGIN()  uint32_t isr_t0 = DWT->CYCCNT
+#define ISR_TIME_END(t)   isrTimeAdd(&(t), DWT->CYCCNT - isr_t0)
 
 // ===========================================
 // Prototypes
@@ -33,6 +66,13 @@ void part1_main(void);
 void part2reg_main(void);
 void part2hal_main(void);
 void depth_main(void);
+void background_loop(void);
+
+static inline void isrTimeAdd(volatile IsrTime *t, uint32_t cycles) {
+    t->count++;
+    t->sum += cycles;
+    if (cycles > t->max) t->max = cycles;
+}
 
 // ===========================================
 // Main
@@ -40,6 +80,12 @@ void depth_main(void);
 int main(void) {
     // System Initialization
     Sys_Init();
+    dlog_init();
+
+    // Cycle counter for the handler timing
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
     // Clear the console screen
     printf("\033[2J\033[;H");
     fflush(stdout);
@@ -56,8 +102,41 @@ int main(void) {
     #error "SELECT_PART must be 1–4"
 #endif
 
-    // Infinite loop
-    while (1) {}
+    background_loop();
+}
+
+// ===========================================
+// Background loop: print what the handlers queued
+// ===========================================
+static void isrTimeReport(const char *name, volatile IsrTime *t) {
+    if (t->count == 0) return;
+    uint32_t mhz = SystemCoreClock / 1000000;
+    printf("%s: %lu calls, avg %lu cycles, max %lu cycles (%lu us)\r\n",
+           name, t->count, t->sum / t->count, t->max, t->max / mhz);
+}
+
+void background_loop(void) {
+    uint32_t lastReport = HAL_GetTick();
+    uint32_t lastCalls = 0;
+
+    while (1) {
+        dlog_drain(0);
+
+        // Timing summary, only when a handler ran since the last one
+        uint32_t calls = isrTim.count + isrExti.count;
+        if (HAL_GetTick() - lastReport >= ISR_REPORT_MS && calls != lastCalls) {
+            const DlogStats *st = dlog_stats();
+            printf("\r\n[ISR timing, %s]\r\n", DEFER_ISR_LOG ? "deferred log" : "printf in ISR");
+            isrTimeReport("Timer ISR ", &isrTim);
+            isrTimeReport("Button ISR", &isrExti);
+            printf("dlog: %lu queued, %lu dropped, high water %lu/%u\r\n\r\n",
+                   st->pushed, st->dropped, st->high_water, DLOG_SIZE);
+            fflush(stdout);
+            lastReport = HAL_GetTick();
+            lastCalls = calls;
+        }
+        __WFI();
+    }
 }
 
 // ===========================================
@@ -141,16 +220,17 @@ void Init_Timer_Reg(void) {
 
 void part2reg_main(void) {
     Init_Timer_Reg();
-    while (1) {}
 }
 
 void TIM6_DAC_IRQHandler(void) {
+    ISR_TIME_BEGIN();
     if (TIM6->SR & TIM_SR_UIF) {
         TIM6->SR &= ~TIM_SR_UIF;
         tenths++;
-        printf("Elapsed time: %lu tenths of a second\r\n", tenths);
-        fflush(stdout);
+        ISR_LOG("Elapsed time: %lu tenths of a second\r\n", tenths);
+        ISR_FLUSH();
     }
+    ISR_TIME_END(isrTim);
 }
 #endif
 
@@ -159,6 +239,13 @@ void TIM6_DAC_IRQHandler(void) {
 // ===========================================
 #if SELECT_PART == 3
 
+// 1 = play the 1..100 ms toggle ramp with the TIM1 DMA pulse sequencer on
+//     D10 (PA11): no interrupt per edge
+// 0 = original TIM7 version that rewrites ARR in every update interrupt (LD on PJ13)
+#define PART3_PULSE_SEQ 1
+
+#define RAMP_STEPS 50
+
 uint32_t period = 1;
 
 void Init_Timer_HAL(void) {
@@ -184,19 +271,51 @@ void Init_Timer_HAL(void) {
 }
 
 void part2hal_main(void) {
+#if PART3_PULSE_SEQ
+    static PulseStep ramp[RAMP_STEPS];
+    static uint32_t image[RAMP_STEPS * PULSE_SEQ_WORDS];
+    PulseProgram prog;
+    PulseVerify check;
+
+    // Same waveform as the TIM7 version: the pin toggles after 1, 2, ... 100 ms.
+    // Each step is one high/low pair: high k ms, then low k+1 ms.
+    for (uint32_t i = 0; i < RAMP_STEPS; i++) {
+        uint32_t k = 2 * i + 1;
+        ramp[i].periodUs = (2 * k + 1) * 1000;
+        ramp[i].pulseUs  = k * 1000;
+        ramp[i].repeat   = 0;
+    }
+
+    pulse_seq_init();
+    int rc = pulse_seq_compile(ramp, RAMP_STEPS, pulse_seq_timer_hz(),
+                               image, RAMP_STEPS * PULSE_SEQ_WORDS, &prog);
+    if (rc != PULSE_OK) {
+        printf("Pulse table rejected (%d)\r\n", rc);
+        return;
+    }
+    rc = pulse_seq_verify(&prog, ramp, RAMP_STEPS, 1000, &check);
+    printf("Pulse sequencer on D10 (PA11): %u steps, PSC %u, max error %lu ns, "
+           "pass %lu ms, verify %s\r\n", prog.steps, prog.psc, prog.maxErrNs,
+           (uint32_t)(check.totalNs / 1000000), rc == 0 ? "ok" : "FAILED");
+    fflush(stdout);
+
+    pulse_seq_start(&prog, 1);
+#else
     Init_Timer_HAL();
     HAL_TIM_Base_Start_IT(&htim7);
-    while (1) {}
+#endif
 }
 
 void TIM7_IRQHandler(void) {
+    ISR_TIME_BEGIN();
     HAL_TIM_IRQHandler(&htim7);
+    ISR_TIME_END(isrTim);
 }
 
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
     if (htim->Instance == TIM7) {
         HAL_GPIO_TogglePin(GPIOJ, GPIO_PIN_13);
-        printf("HAL Timer tick: %lu ms\r\n", period);
+        ISR_LOG("HAL Timer tick: %lu ms\r\n", period);
         period++;
         if (period > 100) {
             period = 1;
@@ -216,26 +335,59 @@ volatile uint32_t recorded_numbers[100];
 volatile uint8_t  num_count = 0;
 volatile uint32_t current_num = 0;
 volatile uint32_t place_value = 1;
-volatile uint8_t  is_button_pressed = 0;
+
+// Quick press (<1s) is a TAP; a release after HOLD (1-3s) or LONG_HOLD
+// (>3s) arrives as RELEASE with the level reached
+static const GestureConfig button_cfg = {
+    .debounce_ms = 20,
+    .tap_ms      = 1000,
+    .hold_ms     = 1000,
+    .long_ms     = 3000,
+};
+Gesture button;
 
 // --- Timer and GPIO Initializations for Part 4 ---
 
-// TIM6 is used for the 1-second INACTIVITY timer.
-void Init_Inactivity_Timer(void) {
-    __HAL_RCC_TIM6_CLK_ENABLE();
-    TIM6->PSC = 10800 - 1;   // Prescaler for 10kHz from 108MHz clock
-    TIM6->ARR = 10000 - 1;   // Auto-reload for 1 second (10000 counts @ 10kHz)
-    TIM6->DIER |= TIM_DIER_UIE;
-    TIM6->CR1 &= ~TIM_CR1_CEN;  // Ensure timer is disabled initially
-    NVIC_EnableIRQ(TIM6_DAC_IRQn);
+// All Part 4 timeouts are software timers on TIM2: a free-running 32-bit
+// counter whose CC1 compare is set to the next expiry. Button hold times
+// come from edge timestamps (HAL_GetTick), so no timer runs per button.
+#define SWT_TICKS_PER_MS   10      // TIM2 counts at 10 kHz
+#define INACTIVITY_MS      1000
+
+SwWheel  wheel;
+SwTimer  inactivity_timer;
+
+void inactivity_expired(SwTimer *t, void *arg);
+void button_gesture(const GestureEvent *e, void *ctx);
+
+uint32_t tim2_now(void) {
+    return TIM2->CNT;
 }
 
-// TIM7 is used to measure the DURATION of a button press.
-void Init_Hold_Timer(void) {
-    __HAL_RCC_TIM7_CLK_ENABLE();
-    TIM7->PSC = 108000 - 1;  // Prescaler for 1kHz (1ms ticks) from 108MHz clock
-    TIM7->ARR = 0xFFFF;      // Max period, we'll read the counter directly
-    TIM7->CR1 &= ~TIM_CR1_CEN; // Ensure timer is disabled initially
+void tim2_arm(uint32_t tick) {
+    TIM2->CCR1 = tick;
+    TIM2->SR = ~TIM_SR_CC1IF;
+    TIM2->DIER |= TIM_DIER_CC1IE;
+    // Already passed while we were setting it up: take the interrupt now
+    if ((int32_t)(TIM2->CNT - tick) >= 0) NVIC_SetPendingIRQ(TIM2_IRQn);
+}
+
+void Init_Software_Timers(void) {
+    static const SwTimerPort port = { tim2_now, tim2_arm };
+
+    __HAL_RCC_TIM2_CLK_ENABLE();
+    TIM2->PSC = 10800 - 1;   // 108MHz / 10800 = 10 kHz (PSC is only 16 bits)
+    TIM2->ARR = 0xFFFFFFFF;  // 32-bit free run, wraps after ~5 days
+    TIM2->EGR = TIM_EGR_UG;  // load the prescaler now
+    TIM2->SR = 0;
+    TIM2->CR1 |= TIM_CR1_CEN;
+
+    swt_init(&wheel, &port);
+    swt_setup(&inactivity_timer, inactivity_expired, NULL);
+
+    // Same priority as EXTI0 so wheel calls never preempt each other
+    HAL_NVIC_SetPriority(TIM2_IRQn, 2, 0);
+    NVIC_EnableIRQ(TIM2_IRQn);
 }
 
 void Init_GPIO_Button(void) {
@@ -270,74 +422,85 @@ void depth_main(void) {
     printf("- Inactivity (>1s): Saves the current number and resets.\r\n");
     fflush(stdout);
 
+    Init_Software_Timers();
+    gesture_init(&button, 0, &button_cfg, button_gesture, NULL);
     Init_GPIO_Button();
-    Init_Inactivity_Timer();
-    Init_Hold_Timer();
 }
 
 // --- Interrupt Handlers for Part 4 ---
 
 void EXTI0_IRQHandler(void) {
+    ISR_TIME_BEGIN();
     if (EXTI->PR & EXTI_PR_PR0) {
         EXTI->PR = EXTI_PR_PR0; // Clear the interrupt flag
+        gesture_edge(&button, GPIOA->IDR & GPIO_PIN_0, HAL_GetTick());
+    }
+    ISR_TIME_END(isrExti);
+}
 
-        uint8_t button_state = (GPIOA->IDR & GPIO_PIN_0);
+// Called from gesture_edge() above
+void button_gesture(const GestureEvent *e, void *ctx) {
+    (void)ctx;
+
+    switch (e->type) {
+    case GESTURE_PRESS:
+        swt_cancel(&wheel, &inactivity_timer);
+        return;
+
+    case GESTURE_TAP: {
+        uint32_t current_digit = (current_num / place_value) % 10;
+        current_num -= current_digit * place_value;
+        current_digit = (current_digit + 1) % 10;
+        current_num += current_digit * place_value;
+        ISR_LOG("Current Number: %lu\r\n", current_num);
+        break;
+    }
 
-        if (button_state && !is_button_pressed) {
-            is_button_pressed = 1;
-            TIM6->CR1 &= ~TIM_CR1_CEN; // Stop inactivity timer
-            TIM7->CNT = 0;
-            TIM7->CR1 |= TIM_CR1_CEN; // Start hold timer
-        }
-        else if (!button_state && is_button_pressed) {
-            is_button_pressed = 0;
-            TIM7->CR1 &= ~TIM_CR1_CEN; // Stop hold timer
-            uint32_t hold_duration_ms = TIM7->CNT;
-
-            if (hold_duration_ms >= 3000) {
-                printf("\r\n--- Recorded Numbers ---\r\n");
-                if (num_count == 0) printf("No numbers recorded yet.\r\n");
-                else {
-                    for (uint8_t i = 0; i < num_count; i++) {
-                        printf("Entry %d: %lu\r\n", i, recorded_numbers[i]);
-                    }
-                }
-                printf("------------------------\r\n");
-            }
-            else if (hold_duration_ms >= 1000) {
-                place_value *= 10;
-                printf("-> Moved to next digit. Current Number: %lu\r\n", current_num);
-            }
+    case GESTURE_RELEASE:
+        if (e->level == GESTURE_LONG_HOLD) {
+            ISR_LOG("\r\n--- Recorded Numbers ---\r\n");
+            if (num_count == 0) ISR_LOG("No numbers recorded yet.\r\n");
             else {
-                uint32_t current_digit = (current_num / place_value) % 10;
-                current_num -= current_digit * place_value;
-                current_digit = (current_digit + 1) % 10;
-                current_num += current_digit * place_value;
-                printf("Current Number: %lu\r\n", current_num);
+                for (uint8_t i = 0; i < num_count; i++) {
+                    ISR_LOG("Entry %d: %lu\r\n", i, recorded_numbers[i]);
+                }
             }
-            TIM6->CNT = 0;
-            TIM6->CR1 |= TIM_CR1_CEN; // Restart inactivity timer
-            fflush(stdout);
+            ISR_LOG("------------------------\r\n");
+        } else {
+            place_value *= 10;
+            ISR_LOG("-> Moved to next digit. Current Number: %lu\r\n", current_num);
         }
+        break;
+
+    default:
+        return; // HOLD / LONG_HOLD thresholds: act on release
     }
+    swt_start(&wheel, &inactivity_timer, INACTIVITY_MS * SWT_TICKS_PER_MS, 0);
+    ISR_FLUSH();
 }
 
-void TIM6_DAC_IRQHandler(void) {
-    if (TIM6->SR & TIM_SR_UIF) {
-        TIM6->SR &= ~TIM_SR_UIF; // Clear flag
-        TIM6->CR1 &= ~TIM_CR1_CEN; // Stop timer
-
-        if (current_num > 0 || place_value > 1) {
-            if (num_count < 100) {
-                recorded_numbers[num_count++] = current_num;
-                printf("\r\n(Inactivity) Number saved: %lu. Ready for next number.\r\n", current_num);
-            } else {
-                printf("\r\nNumber array full. Cannot save %lu.\r\n", current_num);
-            }
-            current_num = 0;
-            place_value = 1;
-            fflush(stdout);
+void TIM2_IRQHandler(void) {
+    ISR_TIME_BEGIN();
+    TIM2->SR = ~TIM_SR_CC1IF;
+    swt_service(&wheel);
+    ISR_TIME_END(isrTim);
+}
+
+// 1 s without a press: save the number being entered
+void inactivity_expired(SwTimer *t, void *arg) {
+    (void)t;
+    (void)arg;
+
+    if (current_num > 0 || place_value > 1) {
+        if (num_count < 100) {
+            recorded_numbers[num_count++] = current_num;
+            ISR_LOG("\r\n(Inactivity) Number saved: %lu. Ready for next number.\r\n", current_num);
+        } else {
+            ISR_LOG("\r\nNumber array full. Cannot save %lu.\r\n", current_num);
         }
+        current_num = 0;
+        place_value = 1;
+        ISR_FLUSH();
     }
 }
 #endif
@@ -0,0 +1,362 @@
+//------------------------------------------------------------------------------------
+// pulse_seq.c
+//------------------------------------------------------------------------------------
+//
+// See pulse_seq.h. The compiler/verifier half is plain C; the TIM1/DMA2
+// driver below it is left out of host builds.
+//
+//------------------------------------------------------------------------------------
+#include "pulse_seq.h"
+
+#define W_PSC  0
+#define W_ARR  1
+#define W_RCR  2
+#define W_CCR  (2 + PULSE_SEQ_CH)
+
+//------------------------------------------------------------------------------------
+// Table compiler
+//------------------------------------------------------------------------------------
+
+// Ticks for us at the given prescaler, rounded to nearest
+static uint32_t toTicks(uint32_t us, uint32_t hz, uint32_t psc) {
+    uint64_t div = 1000000ULL * (psc + 1U);
+    return (uint32_t)(((uint64_t)us * hz + div / 2) / div);
+}
+
+// 64-bit: a period can be up to 65536 * 65536 ticks, far more than 2^32 ns
+static uint64_t ticksNs(uint32_t ticks, uint32_t hz, uint32_t psc) {
+    return ((uint64_t)ticks * (psc + 1U) * 1000000000ULL + hz / 2) / hz;
+}
+
+static uint64_t absDiff(uint64_t a, uint64_t b) {
+    return a > b ? a - b : b - a;
+}
+
+static uint32_t clampNs(uint64_t ns) {
+    return ns > 0xFFFFFFFEULL ? 0xFFFFFFFEU : (uint32_t)ns;
+}
+
+// Worst rounding error (ns) of the table at this prescaler, or UINT32_MAX
+// if a period does not fit ARR
+static uint32_t tableError(const PulseStep *s, uint16_t n, uint32_t hz, uint32_t psc) {
+    uint32_t worst = 0;
+
+    for (uint16_t i = 0; i < n; i++) {
+        uint32_t pt = toTicks(s[i].periodUs, hz, psc);
+        uint32_t ht = toTicks(s[i].pulseUs, hz, psc);
+        if (pt < 2 || pt > 65536U) return 0xFFFFFFFFU;
+        if (ht > pt) ht = pt;
+
+        uint32_t e1 = clampNs(absDiff(ticksNs(pt, hz, psc), (uint64_t)s[i].periodUs * 1000U));
+        uint32_t e2 = clampNs(absDiff(ticksNs(ht, hz, psc), (uint64_t)s[i].pulseUs * 1000U));
+        if (e1 > worst) worst = e1;
+        if (e2 > worst) worst = e2;
+    }
+    return worst;
+}
+
+int pulse_seq_compile(const PulseStep *steps, uint16_t n, uint32_t timerHz,
+                      uint32_t *image, uint32_t capWords, PulseProgram *out) {
+    if (n == 0) return PULSE_ERR_EMPTY;
+
+    uint32_t maxUs = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        if (steps[i].pulseUs > steps[i].periodUs) return PULSE_ERR_PULSE;
+        if (steps[i].repeat > PULSE_SEQ_RCR_MAX)  return PULSE_ERR_REPEAT;
+        if (steps[i].periodUs > maxUs) maxUs = steps[i].periodUs;
+    }
+
+    uint16_t outSteps = (n < 2) ? 2 : n;   // the driver primes two steps
+    if ((uint32_t)outSteps * PULSE_SEQ_WORDS > capWords) return PULSE_ERR_SPACE;
+
+    // Smallest prescaler that fits the longest period, then the most exact
+    // one up to twice that (e.g. one that divides the clock into whole us)
+    uint64_t maxTicks = ((uint64_t)maxUs * timerHz + 999999ULL) / 1000000ULL;
+    uint32_t pscMin = (uint32_t)((maxTicks + 65535ULL) / 65536ULL);
+    pscMin = pscMin ? pscMin - 1U : 0;
+    uint32_t pscMax = pscMin * 2U + 1U;
+    if (pscMax > 65535U) pscMax = 65535U;
+
+    uint32_t bestPsc = 0, bestErr = 0xFFFFFFFFU;
+    for (uint32_t psc = pscMin; psc <= pscMax; psc++) {
+        uint32_t err = tableError(steps, n, timerHz, psc);
+        if (err < bestErr) { bestErr = err; bestPsc = psc; }
+        if (err == 0) break;
+    }
+    if (bestErr == 0xFFFFFFFFU) return PULSE_ERR_RANGE;
+
+    for (uint16_t i = 0; i < outSteps; i++) {
+        const PulseStep *s = &steps[i % n];
+        uint32_t *w = &image[(uint32_t)i * PULSE_SEQ_WORDS];
+        uint32_t pt = toTicks(s->periodUs, timerHz, bestPsc);
+        uint32_t ht = toTicks(s->pulseUs, timerHz, bestPsc);
+        if (ht > pt) ht = pt;
+
+        for (int k = 0; k < PULSE_SEQ_WORDS; k++) w[k] = 0;
+        w[W_PSC] = bestPsc;
+        w[W_ARR] = pt - 1U;
+        w[W_RCR] = s->repeat;
+        w[W_CCR] = ht;               // PWM1: high while CNT < CCR
+    }
+
+    out->image    = image;
+    out->steps    = outSteps;
+    out->psc      = (uint16_t)bestPsc;
+    out->timerHz  = timerHz;
+    out->maxErrNs = bestErr;
+    return PULSE_OK;
+}
+
+//------------------------------------------------------------------------------------
+// Verifier: replay the image as TIM1 would and compare with the request. Each
+// step plays at the PSC word in its own burst.
+//------------------------------------------------------------------------------------
+int pulse_seq_verify(const PulseProgram *prog, const PulseStep *steps, uint16_t n,
+                     uint32_t tolNs, PulseVerify *r) {
+    uint64_t wantNs = 0;
+
+    r->checked  = 0;
+    r->maxErrNs = 0;
+    r->totalNs  = 0;
+    r->driftNs  = 0;
+    r->firstBad = -1;
+
+    for (uint16_t i = 0; i < prog->steps; i++) {
+        const uint32_t *w = &prog->image[(uint32_t)i * PULSE_SEQ_WORDS];
+        const PulseStep *s = &steps[i % n];
+
+        // Only the driven channel may carry a compare value, and PSC, ARR
+        // and RCR must fit their registers
+        for (int k = W_RCR + 1; k < W_CCR; k++) {
+            if (w[k] != 0 && r->firstBad < 0) r->firstBad = (int16_t)i;
+        }
+        if ((w[W_PSC] > 0xFFFFU || w[W_ARR] > 0xFFFFU || w[W_RCR] > PULSE_SEQ_RCR_MAX) &&
+            r->firstBad < 0) r->firstBad = (int16_t)i;
+
+        uint32_t psc      = w[W_PSC] & 0xFFFFU;
+        uint64_t periodNs = ticksNs(w[W_ARR] + 1U, prog->timerHz, psc);
+        uint32_t clamped  = w[W_CCR] > w[W_ARR] + 1U ? w[W_ARR] + 1U : w[W_CCR];
+        uint64_t highNs   = ticksNs(clamped, prog->timerHz, psc);
+
+        // RCR+1 identical periods per burst
+        for (uint32_t rep = 0; rep <= w[W_RCR]; rep++) {
+            uint64_t e1 = absDiff(periodNs, (uint64_t)s->periodUs * 1000U);
+            uint64_t e2 = absDiff(highNs, (uint64_t)s->pulseUs * 1000U);
+            uint32_t e  = clampNs(e1 > e2 ? e1 : e2);
+
+            if (e > r->maxErrNs) r->maxErrNs = e;
+            if (e > tolNs && r->firstBad < 0) r->firstBad = (int16_t)i;
+            r->checked++;
+            r->totalNs += periodNs;
+            wantNs     += (uint64_t)s->periodUs * 1000U;
+        }
+        if (w[W_RCR] != s->repeat && r->firstBad < 0) r->firstBad = (int16_t)i;
+    }
+
+    r->driftNs = (int64_t)r->totalNs - (int64_t)wantNs;
+    return r->firstBad < 0 ? 0 : -(r->firstBad + 1);
+}
+
+#ifndef HOST_BUILD
+//------------------------------------------------------------------------------------
+// Driver: TIM1 CH4 on PA11, burst DMA on DMA2 Stream 5 / Channel 6
+//------------------------------------------------------------------------------------
+#include "stm32f769xx.h"
+#include "stm32f7xx_hal.h"
+
+#define SEQ_STREAM  DMA2_Stream5
+#define SEQ_FLAGS   (DMA_HIFCR_CTCIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTEIF5 | \
+                     DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CFEIF5)
+
+static const PulseProgram *volatile cur;
+static const PulseProgram *volatile next;
+static volatile uint8_t curLoop, nextLoop;
+static volatile uint8_t circular;     // stream is in circular mode over cur
+static volatile uint8_t ending;       // one-shot tail: update IRQs left
+static volatile uint8_t running;
+static PulseSeqStats seqStats;
+
+static void cleanImage(const PulseProgram *p) {
+    if (SCB->CCR & SCB_CCR_DC_Msk) {
+        uint32_t a = (uint32_t)p->image & ~31U;
+        uint32_t end = (uint32_t)p->image + (uint32_t)p->steps * PULSE_SEQ_WORDS * 4U;
+        SCB_CleanDCache_by_Addr((uint32_t *)a, (int32_t)(end - a));
+    }
+}
+
+static void dmaRun(const uint32_t *words, uint32_t count, int circ) {
+    SEQ_STREAM->CR &= ~DMA_SxCR_EN;
+    while (SEQ_STREAM->CR & DMA_SxCR_EN) {}
+    DMA2->HIFCR = SEQ_FLAGS;
+
+    SEQ_STREAM->M0AR = (uint32_t)words;
+    SEQ_STREAM->NDTR = count;
+    if (circ) SEQ_STREAM->CR |= DMA_SxCR_CIRC;
+    else      SEQ_STREAM->CR &= ~DMA_SxCR_CIRC;
+    circular = (uint8_t)circ;
+    SEQ_STREAM->CR |= DMA_SxCR_EN;
+}
+
+// Nothing left to stream: let the last step play, then hold the output low
+static void beginTail(void) {
+    TIM1->DIER &= ~TIM_DIER_UDE;
+    TIM1->SR = ~TIM_SR_UIF;
+    ending = 2;
+    TIM1->DIER |= TIM_DIER_UIE;
+}
+
+uint32_t pulse_seq_timer_hz(void) {
+    // APB2 timers run at 2x PCLK2 whenever the APB2 prescaler is not 1
+    uint32_t hz = HAL_RCC_GetPCLK2Freq();
+    if ((RCC->CFGR & RCC_CFGR_PPRE2) != RCC_CFGR_PPRE2_DIV1) hz *= 2U;
+    return hz;
+}
+
+void pulse_seq_init(void) {
+    GPIO_InitTypeDef gpio = {0};
+
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_TIM1_CLK_ENABLE();
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    gpio.Pin       = GPIO_PIN_11;
+    gpio.Mode      = GPIO_MODE_AF_PP;
+    gpio.Pull      = GPIO_NOPULL;
+    gpio.Speed     = GPIO_SPEED_FREQ_HIGH;
+    gpio.Alternate = GPIO_AF1_TIM1;
+    HAL_GPIO_Init(GPIOA, &gpio);
+
+    TIM1->CR1   = TIM_CR1_ARPE;                               // ARR preloaded
+    TIM1->CCMR2 = (6U << TIM_CCMR2_OC4M_Pos) | TIM_CCMR2_OC4PE; // PWM1, CCR4 preloaded
+    TIM1->CCER  = TIM_CCER_CC4E;
+    TIM1->BDTR  = TIM_BDTR_MOE;
+    TIM1->CCR4  = 0;
+    TIM1->DCR   = ((PULSE_SEQ_WORDS - 1U) << TIM_DCR_DBL_Pos)    // burst length - 1
+                | ((uint32_t)(&TIM1->PSC - &TIM1->CR1) << TIM_DCR_DBA_Pos);
+
+    SEQ_STREAM->CR &= ~DMA_SxCR_EN;
+    while (SEQ_STREAM->CR & DMA_SxCR_EN) {}
+    SEQ_STREAM->PAR = (uint32_t)&TIM1->DMAR;
+    SEQ_STREAM->CR  = (6U << DMA_SxCR_CHSEL_Pos)   // channel 6 = TIM1_UP
+                    | DMA_SxCR_DIR_0               // memory to peripheral
+                    | DMA_SxCR_MINC
+                    | DMA_SxCR_MSIZE_1 | DMA_SxCR_PSIZE_1
+                    | DMA_SxCR_PL_1
+                    | DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+    SEQ_STREAM->FCR = 0;                           // direct mode
+    DMA2->HIFCR = SEQ_FLAGS;
+
+    HAL_NVIC_SetPriority(DMA2_Stream5_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(DMA2_Stream5_IRQn);
+    HAL_NVIC_SetPriority(TIM1_UP_TIM10_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(TIM1_UP_TIM10_IRQn);
+}
+
+int pulse_seq_start(const PulseProgram *p, int loop) {
+    const uint32_t *w = p->image;
+    uint32_t words = (uint32_t)p->steps * PULSE_SEQ_WORDS;
+
+    if (p->steps < 2) return PULSE_ERR_EMPTY;
+    pulse_seq_stop();
+    cleanImage(p);
+
+    cur = p;
+    curLoop = (uint8_t)loop;
+    next = 0;
+    ending = 0;
+
+    // Step 0 straight into the shadow registers, step 1 into preload
+    TIM1->PSC = w[W_PSC];
+    TIM1->ARR = w[W_ARR];
+    TIM1->RCR = w[W_RCR];
+    TIM1->CCR4 = w[W_CCR];
+    TIM1->EGR = TIM_EGR_UG;
+    TIM1->SR = 0;
+    TIM1->PSC = w[PULSE_SEQ_WORDS + W_PSC];
+    TIM1->ARR = w[PULSE_SEQ_WORDS + W_ARR];
+    TIM1->RCR = w[PULSE_SEQ_WORDS + W_RCR];
+    TIM1->CCR4 = w[PULSE_SEQ_WORDS + W_CCR];
+
+    // DMA feeds from step 2 on; each update loads one step ahead
+    if (p->steps > 2)  dmaRun(w + 2 * PULSE_SEQ_WORDS, words - 2 * PULSE_SEQ_WORDS, 0);
+    else if (loop)     dmaRun(w, words, 1);
+
+    running = 1;
+    if (p->steps > 2 || loop) TIM1->DIER = TIM_DIER_UDE;
+    else                      beginTail();
+    TIM1->CR1 |= TIM_CR1_CEN;
+    return PULSE_OK;
+}
+
+void pulse_seq_chain(const PulseProgram *p, int loop) {
+    if (!running || ending) {
+        pulse_seq_start(p, loop);
+        return;
+    }
+    cleanImage(p);
+    NVIC_DisableIRQ(DMA2_Stream5_IRQn);
+    nextLoop = (uint8_t)loop;
+    next = p;
+    NVIC_EnableIRQ(DMA2_Stream5_IRQn);
+}
+
+void pulse_seq_stop(void) {
+    TIM1->CR1 &= ~TIM_CR1_CEN;
+    TIM1->DIER = 0;
+    SEQ_STREAM->CR &= ~DMA_SxCR_EN;
+    while (SEQ_STREAM->CR & DMA_SxCR_EN) {}
+    DMA2->HIFCR = SEQ_FLAGS;
+    TIM1->CCR4 = 0;
+    TIM1->EGR = TIM_EGR_UG;    // output low
+    running = 0;
+    ending = 0;
+}
+
+const PulseSeqStats *pulse_seq_stats(void) {
+    return &seqStats;
+}
+
+// End of a pass: loop, hand over to the queued program, or wind down
+void DMA2_Stream5_IRQHandler(void) {
+    uint32_t isr = DMA2->HISR;
+    DMA2->HIFCR = SEQ_FLAGS;
+
+    if (isr & DMA_HISR_TEIF5) {
+        seqStats.errors++;
+        pulse_seq_stop();
+        return;
+    }
+    if (!(isr & DMA_HISR_TCIF5)) return;
+    seqStats.passes++;
+
+    if (next) {
+        // next's first burst carries its PSC, so the prescaler changes on
+        // the update that starts next's step 0 and not a step early
+        cur = next;
+        curLoop = nextLoop;
+        next = 0;
+        seqStats.chains++;
+        dmaRun(cur->image, (uint32_t)cur->steps * PULSE_SEQ_WORDS, curLoop);
+    } else if (curLoop) {
+        if (!circular) dmaRun(cur->image, (uint32_t)cur->steps * PULSE_SEQ_WORDS, 1);
+    } else {
+        beginTail();
+    }
+}
+
+// Only enabled for the one-shot tail: first update loads the last step
+// (queue the idle level behind it), the second one starts the idle level
+void TIM1_UP_TIM10_IRQHandler(void) {
+    if (!(TIM1->SR & TIM_SR_UIF)) return;
+    TIM1->SR = ~TIM_SR_UIF;
+
+    if (ending == 2) {
+        TIM1->CCR4 = 0;
+        ending = 1;
+    } else {
+        TIM1->DIER &= ~TIM_DIER_UIE;
+        ending = 0;
+        running = 0;
+    }
+}
+#endif
@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------------------
+// pulse_seq.h
+//------------------------------------------------------------------------------------
+//
+// Timer-DMA pulse-train sequencer.
+//
+// A pulse train is a table of steps (period, high time, repeat count). The
+// table compiler turns it into a DMA burst image for TIM1: per step the
+// words PSC, ARR, RCR, CCR1..CCR4 (DCR/DMAR burst starting at PSC). On
+// every update event TIM1 requests one burst, so the next step lands in the
+// preload registers while the current one plays: no CPU per edge. RCR
+// holds the repeat count, so a step can last many periods with a single
+// burst. PSC rides in the burst too: when DMA finishes a pass the preload
+// registers already hold that program's last step, so a chained program's
+// PSC written by the CPU there would time that step; in the burst it lands
+// with the step it belongs to.
+//
+// Output: TIM1_CH4, PWM mode 1, on PA11 (Arduino D10). DMA2 Stream 5 /
+// Channel 6 (TIM1_UP). Looping costs one interrupt per pass of the table
+// (the first pass starts at step 2 because steps 0 and 1 are primed by
+// hand); chaining another program costs one interrupt at the hand-over.
+//
+// pulse_seq_compile() and pulse_seq_verify() have no HAL dependencies and
+// also build on the host (HOST_BUILD), where the verifier replays the
+// image the way the timer would and checks it against the request.
+//
+//------------------------------------------------------------------------------------
+#ifndef PULSE_SEQ_H
+#define PULSE_SEQ_H
+
+#include <stdint.h>
+
+#define PULSE_SEQ_CH     4                        // TIM1 channel driven
+#define PULSE_SEQ_WORDS  (3 + PULSE_SEQ_CH)       // PSC, ARR, RCR, CCR1..CCRn per step
+#define PULSE_SEQ_RCR_MAX 255                     // portable RCR width
+
+typedef struct {
+    uint32_t periodUs;   // step period (up to 65536 * 65536 timer ticks, ~19.8 s at 216 MHz)
+    uint32_t pulseUs;    // high time within the period (0..periodUs)
+    uint16_t repeat;     // extra periods of the same step (0 = once)
+} PulseStep;
+
+typedef struct {
+    uint32_t *image;     // steps * PULSE_SEQ_WORDS burst words
+    uint16_t  steps;
+    uint16_t  psc;       // common TIM1 prescaler for the whole table
+    uint32_t  timerHz;   // TIM1 kernel clock the table was compiled for
+    uint32_t  maxErrNs;  // worst rounding error of any period or pulse
+} PulseProgram;
+
+typedef struct {
+    uint32_t checked;     // periods replayed
+    uint32_t maxErrNs;    // worst edge error seen
+    uint64_t totalNs;     // length of one pass
+    int64_t  driftNs;     // total pass length error (replayed - requested)
+    int16_t  firstBad;    // first step out of tolerance, -1 if none
+} PulseVerify;
+
+enum {
+    PULSE_OK          =  0,
+    PULSE_ERR_EMPTY   = -1,   // fewer than 1 step
+    PULSE_ERR_PULSE   = -2,   // pulse longer than the period
+    PULSE_ERR_RANGE   = -3,   // period too long (or too short) for any prescaler
+    PULSE_ERR_REPEAT  = -4,   // repeat > PULSE_SEQ_RCR_MAX
+    PULSE_ERR_SPACE   = -5,   // image buffer too small
+};
+
+// Compile n steps into image (capacity in words). Steps shorter than 2 are
+// padded by repeating, since the driver primes two steps before DMA takes over.
+int  pulse_seq_compile(const PulseStep *steps, uint16_t n, uint32_t timerHz,
+                       uint32_t *image, uint32_t capWords, PulseProgram *out);
+
+// Replay prog and compare every period against steps. Returns 0 when all
+// edges are within tolNs, else the (negative) index of the first bad step - 1.
+int  pulse_seq_verify(const PulseProgram *prog, const PulseStep *steps, uint16_t n,
+                      uint32_t tolNs, PulseVerify *report);
+
+#ifndef HOST_BUILD
+typedef struct {
+    uint32_t passes;     // DMA transfer-complete interrupts
+    uint32_t chains;     // hand-overs to a queued program
+    uint32_t errors;     // DMA transfer errors
+} PulseSeqStats;
+
+void     pulse_seq_init(void);
+uint32_t pulse_seq_timer_hz(void);
+int      pulse_seq_start(const PulseProgram *prog, int loop);
+// Play next after the current program (which must be one-shot, or looping:
+// the switch happens at the end of the current pass)
+void     pulse_seq_chain(const PulseProgram *next, int loop);
+void     pulse_seq_stop(void);
+const PulseSeqStats *pulse_seq_stats(void);
+#endif
+
+#endif // PULSE_SEQ_H
@@ -0,0 +1,182 @@
+//------------------------------------------------------------------------------------
+// cmd.c
+//------------------------------------------------------------------------------------
+//
+// See cmd.h.
+//
+//------------------------------------------------------------------------------------
+#include "cmd.h"
+#include <string.h>
+
+#define KEY_BS   0x08
+#define KEY_DEL  0x7F
+
+//------------------------------------------------------------------------------------
+// Line assembly
+//------------------------------------------------------------------------------------
+void cmd_line_init(CmdLine *l, char *buf, uint16_t cap) {
+    l->buf = buf;
+    l->cap = cap;
+    l->len = 0;
+    l->overflow = 0;
+    l->lastCr = 0;
+    buf[0] = '\0';
+}
+
+int cmd_line_feed(CmdLine *l, char c) {
+    uint8_t afterCr = l->lastCr;
+
+    l->lastCr = (c == '\r');
+    if (c == '\r' || c == '\n') {
+        if (c == '\n' && afterCr) return 0;   // CR LF is one line end
+        l->buf[l->len] = '\0';
+        l->len = 0;
+        return 1;
+    }
+
+    if (c == KEY_BS || c == KEY_DEL) {
+        if (l->len > 0) l->len--;
+    } else if (c == '\t' || ((uint8_t)c >= 32 && (uint8_t)c < 127)) {
+        if (l->len < l->cap - 1) l->buf[l->len++] = c;
+        else                     l->overflow = 1;
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------------
+// Tokenizer
+//------------------------------------------------------------------------------------
+static int isSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+// Split in place: every token is NUL-terminated inside line
+int cmd_tokenize(char *line, CmdArgs *a) {
+    char *p = line;
+
+    a->argc = 0;
+    for (;;) {
+        while (isSpace(*p)) p++;
+        if (*p == '\0') break;
+        if (a->argc == CMD_MAX_ARGS) return CMD_ERR_MANY;
+
+        if (*p == '"') {
+            char *end = strchr(++p, '"');
+            if (!end) return CMD_ERR_QUOTE;
+            a->argv[a->argc++] = p;
+            *end = '\0';
+            p = end + 1;
+        } else {
+            a->argv[a->argc++] = p;
+            while (*p && !isSpace(*p)) p++;
+            if (*p) *p++ = '\0';
+        }
+    }
+    return a->argc ? CMD_OK : CMD_EMPTY;
+}
+
+//------------------------------------------------------------------------------------
+// Table
+//------------------------------------------------------------------------------------
+const CmdEntry *cmd_find(const CmdTable *t, const char *name) {
+    int lo = 0, hi = (int)t->count - 1;
+
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int c = strcmp(name, t->entries[mid].name);
+        if (c == 0) return &t->entries[mid];
+        if (c < 0) hi = mid - 1;
+        else       lo = mid + 1;
+    }
+    return NULL;
+}
+
+int cmd_check(const CmdTable *t) {
+    for (int i = 1; i < (int)t->count; i++) {
+        if (strcmp(t->entries[i - 1].name, t->entries[i].name) >= 0) return i;
+    }
+    return -1;
+}
+
+int cmd_exec_str(const CmdTable *t, char *line, void *ctx) {
+    CmdArgs a;
+    int st = cmd_tokenize(line, &a);
+    if (st != CMD_OK) return st;
+
+    const char *name = a.argv[0];
+    if (name[0] == '#') name++;
+
+    const CmdEntry *e = cmd_find(t, name);
+    if (!e) return CMD_ERR_UNKNOWN;
+    if (e->parse && e->parse(&a) != CMD_OK) return CMD_ERR_ARGS;
+    e->fn(&a, ctx);
+    return CMD_OK;
+}
+
+int cmd_exec(const CmdTable *t, CmdLine *l, void *ctx) {
+    if (l->overflow) {
+        l->overflow = 0;
+        return CMD_ERR_LONG;
+    }
+    return cmd_exec_str(t, l->buf, ctx);
+}
+
+const char *cmd_error_str(int status) {
+    switch (status) {
+        case CMD_EMPTY:       return "empty";
+        case CMD_OK:          return "ok";
+        case CMD_ERR_UNKNOWN: return "unknown command";
+        case CMD_ERR_ARGS:    return "bad arguments";
+        case CMD_ERR_MANY:    return "too many arguments";
+        case CMD_ERR_QUOTE:   return "missing closing quote";
+        case CMD_ERR_LONG:    return "line too long";
+    }
+    return "?";
+}
+
+//------------------------------------------------------------------------------------
+// Stock parsers
+//------------------------------------------------------------------------------------
+int cmd_parse_int(const char *s, int32_t *out) {
+    int neg = 0, sign = 0;
+    uint32_t base = 10, v = 0;
+
+    if (*s == '-' || *s == '+') {
+        sign = 1;
+        neg = (*s++ == '-');
+    }
+    if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        // Hex is a bit pattern: no sign in front of it
+        if (sign) return CMD_ERR_ARGS;
+        base = 16;
+        s += 2;
+    }
+    if (*s == '\0') return CMD_ERR_ARGS;
+
+    for (; *s; s++) {
+        uint32_t d;
+        if (*s >= '0' && *s <= '9')                    d = (uint32_t)(*s - '0');
+        else if (base == 16 && *s >= 'a' && *s <= 'f') d = (uint32_t)(*s - 'a' + 10);
+        else if (base == 16 && *s >= 'A' && *s <= 'F') d = (uint32_t)(*s - 'A' + 10);
+        else return CMD_ERR_ARGS;
+
+        // Hex may use all 32 bits (0xFFFFFFFF), decimal stays in int32 range
+        uint32_t limit = (base == 16) ? 0xFFFFFFFFU : 0x7FFFFFFFU + (uint32_t)neg;
+        if (v > (limit - d) / base) return CMD_ERR_ARGS;
+        v = v * base + d;
+    }
+    *out = neg ? (int32_t)(0U - v) : (int32_t)v;
+    return CMD_OK;
+}
+
+int cmd_parse_none(CmdArgs *a) {
+    return a->argc == 1 ? CMD_OK : CMD_ERR_ARGS;
+}
+
+int cmd_parse_ints(CmdArgs *a) {
+    a->num[0] = 0;
+    for (int i = 1; i < a->argc; i++) {
+        if (cmd_parse_int(a->argv[i], &a->num[i]) != CMD_OK) return CMD_ERR_ARGS;
+    }
+    return CMD_OK;
+}
@@ -0,0 +1,94 @@
+//------------------------------------------------------------------------------------
+// cmd.h
+//------------------------------------------------------------------------------------
+//
+// Line-oriented console command interpreter.
+//
+// Bytes go in one at a time with cmd_line_feed() (main loop, straight from
+// an RX ring); CR or LF completes the line, BS/DEL erase, an over-long line
+// is flagged rather than cut. cmd_exec() then splits the line in place into
+// whitespace-separated tokens ("double quotes" keep spaces), looks the first
+// one up in a command table and runs the entry:
+//
+//   static const CmdEntry table[] = {          // sorted by name (strcmp)
+//       { "clear", cmd_parse_none, do_clear, "clear the terminal" },
+//       { "led",   parse_led,      do_led,   "led [on|off]" },
+//   };
+//   static const CmdTable cmds = { table, 2 };
+//
+//   if (cmd_line_feed(&line, c)) status = cmd_exec(&cmds, &line, ctx);
+//
+// The lookup is a binary search, so the table must be sorted; cmd_check()
+// returns the first entry out of order (or -1). A leading '#' on the command
+// word is dropped, so the old two-key commands ("#c") still work as lines.
+//
+// The parser fills CmdArgs and can reject the arguments before the handler
+// runs. Nothing here touches hardware: it runs the same on the host.
+//
+//------------------------------------------------------------------------------------
+#ifndef CMD_H
+#define CMD_H
+
+#include <stdint.h>
+
+#define CMD_MAX_ARGS  8       // including the command word
+
+enum {
+    CMD_EMPTY       =  1,     // blank line, nothing run
+    CMD_OK          =  0,
+    CMD_ERR_UNKNOWN = -1,
+    CMD_ERR_ARGS    = -2,     // rejected by the entry's parser
+    CMD_ERR_MANY    = -3,     // more than CMD_MAX_ARGS tokens
+    CMD_ERR_QUOTE   = -4,     // unterminated "
+    CMD_ERR_LONG    = -5,     // line longer than its buffer
+};
+
+typedef struct {
+    int         argc;
+    char       *argv[CMD_MAX_ARGS];
+    int32_t     num[CMD_MAX_ARGS];   // filled by the numeric parsers
+} CmdArgs;
+
+typedef int  (*CmdParse)(CmdArgs *a);                 // CMD_OK or CMD_ERR_ARGS
+typedef void (*CmdHandler)(const CmdArgs *a, void *ctx);
+
+typedef struct {
+    const char *name;
+    CmdParse    parse;
+    CmdHandler  fn;
+    const char *help;
+} CmdEntry;
+
+typedef struct {
+    const CmdEntry *entries;
+    uint16_t        count;
+} CmdTable;
+
+typedef struct {
+    char    *buf;
+    uint16_t cap;        // including the NUL
+    uint16_t len;
+    uint8_t  overflow;
+    uint8_t  lastCr;
+} CmdLine;
+
+void cmd_line_init(CmdLine *l, char *buf, uint16_t cap);
+
+// Returns 1 when c completed a line (buf is then NUL-terminated and stays
+// valid until the next feed), 0 otherwise
+int  cmd_line_feed(CmdLine *l, char c);
+
+int  cmd_tokenize(char *line, CmdArgs *a);
+const CmdEntry *cmd_find(const CmdTable *t, const char *name);
+int  cmd_exec(const CmdTable *t, CmdLine *l, void *ctx);
+int  cmd_exec_str(const CmdTable *t, char *line, void *ctx);
+int  cmd_check(const CmdTable *t);
+
+const char *cmd_error_str(int status);
+
+// Stock parsers
+int  cmd_parse_none(CmdArgs *a);     // no arguments
+int  cmd_parse_ints(CmdArgs *a);     // every argument an integer -> num[]
+int  cmd_parse_int(const char *s, int32_t *out);   // signed decimal, or unsigned 0x hex
+
+#endif // CMD_H
@@ -0,0 +1,209 @@
+//------------------------------------------------------------------------------------
+// spi_batch.c
+//------------------------------------------------------------------------------------
+//
+// See spi_batch.h. The core comes first and is plain C; the STM32 port
+// (SPI2, DMA1) follows and is left out of host builds.
+//
+// RX alternates between two halves of rxBuf, so the next batch is already
+// on the wire while the callback reads the one that just finished.
+//
+//------------------------------------------------------------------------------------
+#include "spi_batch.h"
+#include <stddef.h>
+#include <string.h>
+
+#define RING_MASK (SPI_BATCH_RING - 1U)
+
+//------------------------------------------------------------------------------------
+// Core
+//------------------------------------------------------------------------------------
+void spi_batch_init(SpiBatch *s, const SpiBatchOps *ops, uint8_t *ring, uint8_t *rxBuf) {
+    SpiBatchStats zero = {0};
+
+    s->ops   = *ops;
+    s->rx    = NULL;
+    s->rxCtx = NULL;
+    s->ring  = ring;
+    s->rxBuf = rxBuf;
+    s->head  = 0;
+    s->tail  = 0;
+    s->busy  = 0;
+    s->half  = 0;
+    s->st    = zero;
+}
+
+void spi_batch_hook(SpiBatch *s, SpiBatchRx rx, void *ctx) {
+    s->rx = rx;
+    s->rxCtx = ctx;
+}
+
+// Start the next contiguous run if the bus is idle
+static void kick(SpiBatch *s) {
+    uint32_t queued = s->head - s->tail;
+    if (s->busy || queued == 0) return;
+
+    uint32_t off = s->tail & RING_MASK;
+    uint32_t len = SPI_BATCH_RING - off;      // up to the end of the ring
+    if (len > queued) len = queued;
+    if (len > SPI_BATCH_MAX) len = SPI_BATCH_MAX;
+
+    s->busy = len;
+    s->st.batches++;
+    if (len > s->st.maxBatch) s->st.maxBatch = len;
+    s->ops.start(s->ring + off, s->rxBuf + s->half * SPI_BATCH_MAX, len);
+}
+
+uint32_t spi_batch_write(SpiBatch *s, const uint8_t *p, uint32_t len) {
+    uint32_t room = SPI_BATCH_RING - (s->head - s->tail);
+    if (len > room) {
+        len = room;
+        s->st.full++;
+    }
+
+    uint32_t off = s->head & RING_MASK;
+    uint32_t first = SPI_BATCH_RING - off;
+    if (first > len) first = len;
+    memcpy(s->ring + off, p, first);
+    memcpy(s->ring, p + first, len - first);
+    s->head += len;
+
+    if (s->head - s->tail > s->st.maxFill) s->st.maxFill = s->head - s->tail;
+    kick(s);
+    return len;
+}
+
+uint32_t spi_batch_poll(SpiBatch *s) {
+    if (!s->busy) {
+        kick(s);
+        return 0;
+    }
+
+    int r = s->ops.done();
+    if (r == 0) return 0;
+
+    uint32_t len = s->busy;
+    const uint8_t *in = s->rxBuf + s->half * SPI_BATCH_MAX;
+
+    s->busy = 0;
+    s->tail += len;
+    s->half ^= 1U;
+    kick(s);                       // next batch runs while the callback works
+
+    if (r < 0) {
+        s->st.errors++;
+        return 0;
+    }
+    s->st.txBytes += len;
+    if (s->rx) s->rx(in, len, s->rxCtx);
+    return len;
+}
+
+#ifndef HOST_BUILD
+//------------------------------------------------------------------------------------
+// STM32 port: SPI2 RX DMA1 S3 / TX S4 (ch 0)
+//------------------------------------------------------------------------------------
+//
+// RX is armed before TX is enabled, so no byte can arrive unclaimed. The RX
+// completion marks the end of a batch: the last byte has then been clocked
+// both ways (TX completes as soon as the DMA has filled the FIFO).
+#include "stm32f769xx.h"
+#include "stm32f7xx_hal.h"
+
+#define RX_STREAM  DMA1_Stream3
+#define TX_STREAM  DMA1_Stream4
+#define RX_FLAGS   (DMA_LISR_TCIF3 | DMA_LISR_HTIF3 | DMA_LISR_TEIF3 | DMA_LISR_DMEIF3 | DMA_LISR_FEIF3)
+#define TX_FLAGS   (DMA_HISR_TCIF4 | DMA_HISR_HTIF4 | DMA_HISR_TEIF4 | DMA_HISR_DMEIF4 | DMA_HISR_FEIF4)
+
+static uint8_t ring[SPI_BATCH_RING] __attribute__((aligned(32)));
+static uint8_t rxBufs[2 * SPI_BATCH_MAX] __attribute__((aligned(32)));
+static uint8_t *hwRx;
+static uint32_t hwLen;
+
+SpiBatch spi2_batch;
+
+static void streamOff(DMA_Stream_TypeDef *s) {
+    s->CR &= ~DMA_SxCR_EN;
+    while (s->CR & DMA_SxCR_EN) {}
+}
+
+static void hwStart(const uint8_t *tx, uint8_t *rx, uint32_t len) {
+    // DMA reads SRAM directly; push the queued bytes out of the D-cache
+    if (SCB->CCR & SCB_CCR_DC_Msk) {
+        uint32_t a = (uint32_t)tx & ~31U;
+        SCB_CleanDCache_by_Addr((uint32_t *)a, (int32_t)(((uint32_t)tx + len) - a));
+    }
+
+    hwRx = rx;
+    hwLen = len;
+    DMA1->LIFCR     = RX_FLAGS;
+    DMA1->HIFCR     = TX_FLAGS;
+    RX_STREAM->M0AR = (uint32_t)rx;
+    RX_STREAM->NDTR = len;
+    TX_STREAM->M0AR = (uint32_t)tx;
+    TX_STREAM->NDTR = len;
+    RX_STREAM->CR  |= DMA_SxCR_EN;
+    TX_STREAM->CR  |= DMA_SxCR_EN;
+}
+
+static int hwDone(void) {
+    if ((DMA1->LISR & DMA_LISR_TEIF3) || (DMA1->HISR & DMA_HISR_TEIF4)) {
+        streamOff(RX_STREAM);
+        streamOff(TX_STREAM);
+        while (SPI2->SR & SPI_SR_BSY) {}
+        while (SPI2->SR & SPI_SR_RXNE) (void)*(volatile uint8_t *)&SPI2->DR;
+        return -1;
+    }
+    if (!(DMA1->LISR & DMA_LISR_TCIF3)) return 0;
+
+    // Drop stale lines so the CPU sees what the DMA wrote (halves are
+    // 32-byte aligned and sized, so rounding up stays inside this one)
+    if (SCB->CCR & SCB_CCR_DC_Msk)
+        SCB_InvalidateDCache_by_Addr((uint32_t *)hwRx, (int32_t)((hwLen + 31U) & ~31U));
+    return 1;
+}
+
+static const SpiBatchOps hwOps = { hwStart, hwDone };
+
+void spi_batch_hw_init(void) {
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    streamOff(RX_STREAM);
+    streamOff(TX_STREAM);
+    DMA1->LIFCR = RX_FLAGS;
+    DMA1->HIFCR = TX_FLAGS;
+
+    RX_STREAM->PAR = (uint32_t)&SPI2->DR;
+    RX_STREAM->CR  = (0U << DMA_SxCR_CHSEL_Pos)    // peripheral to memory, bytes
+                   | DMA_SxCR_MINC
+                   | DMA_SxCR_PL_1;                // RX ahead of TX
+    RX_STREAM->FCR = 0;                            // direct mode
+
+    TX_STREAM->PAR = (uint32_t)&SPI2->DR;          // byte writes: one frame each
+    TX_STREAM->CR  = (0U << DMA_SxCR_CHSEL_Pos)
+                   | DMA_SxCR_DIR_0                // memory to peripheral
+                   | DMA_SxCR_MINC;
+    TX_STREAM->FCR = 0;
+
+    spi_batch_init(&spi2_batch, &hwOps, ring, rxBufs);
+    spi_batch_hw_start();
+}
+
+void spi_batch_hw_start(void) {
+    SPI2->CR2 |= SPI_CR2_RXDMAEN;
+    SPI2->CR2 |= SPI_CR2_TXDMAEN;
+    SPI2->CR1 |= SPI_CR1_SPE;
+}
+
+void spi_batch_hw_stop(void) {
+    while (spi_batch_pending(&spi2_batch)) spi_batch_poll(&spi2_batch);
+    SPI2->CR2 &= ~(SPI_CR2_TXDMAEN | SPI_CR2_RXDMAEN);
+}
+
+void spi_batch_hw_prescaler(uint32_t br) {
+    while (SPI2->SR & SPI_SR_BSY) {}
+    SPI2->CR1 &= ~SPI_CR1_SPE;
+    SPI2->CR1  = (SPI2->CR1 & ~SPI_CR1_BR) | (br & SPI_CR1_BR);
+    SPI2->CR1 |= SPI_CR1_SPE;
+}
+#endif
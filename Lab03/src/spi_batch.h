@@ -0,0 +1,84 @@
+//------------------------------------------------------------------------------------
+// spi_batch.h
+//------------------------------------------------------------------------------------
+//
+// Pipelined full-duplex SPI: bytes are queued in a TX ring and go out as
+// DMA batches; what comes back is handed to a callback a batch at a time.
+//
+// spi_batch_write() only copies into the ring. spi_batch_poll(), called
+// from the main loop, retires a finished batch (callback gets the received
+// bytes in one call) and starts the next one from everything that queued up
+// meanwhile, up to SPI_BATCH_MAX bytes in one contiguous run of the ring.
+// At typing speed a batch is a keystroke; when the writer outruns the wire
+// the batches grow and the bus stays busy. Nothing waits on the SPI.
+//
+// A batch that ends in error is dropped (counted) and not retried.
+//
+// The core is hardware-free: the port layer supplies SpiBatchOps. The STM32
+// port (SPI2, DMA1) is at the bottom of spi_batch.c; host/spi_batch_host.c
+// runs the same core against a simulated bus.
+//
+//------------------------------------------------------------------------------------
+#ifndef SPI_BATCH_H
+#define SPI_BATCH_H
+
+#include <stdint.h>
+
+#define SPI_BATCH_RING  1024U    // TX ring, power of two
+#define SPI_BATCH_MAX   256U     // longest single DMA batch
+
+typedef struct {
+    void (*start)(const uint8_t *tx, uint8_t *rx, uint32_t len);  // full duplex
+    int  (*done)(void);       // 0 running, 1 finished, -1 finished with an error
+} SpiBatchOps;
+
+typedef void (*SpiBatchRx)(const uint8_t *p, uint32_t len, void *ctx);
+
+typedef struct {
+    uint32_t txBytes;      // bytes clocked out (and in)
+    uint32_t batches;
+    uint32_t maxBatch;
+    uint32_t maxFill;      // worst backlog in the ring
+    uint32_t full;         // writes cut short by a full ring
+    uint32_t errors;       // batches dropped
+} SpiBatchStats;
+
+typedef struct {
+    SpiBatchOps    ops;
+    SpiBatchRx     rx;
+    void          *rxCtx;
+    uint8_t       *ring;          // SPI_BATCH_RING bytes
+    uint8_t       *rxBuf;         // 2 * SPI_BATCH_MAX bytes, DMA target
+    uint32_t       head, tail;    // free-running; queued = head - tail
+    uint32_t       busy;          // batch on the wire, 0 = idle
+    uint32_t       half;          // rxBuf half it lands in
+    SpiBatchStats  st;
+} SpiBatch;
+
+void     spi_batch_init(SpiBatch *s, const SpiBatchOps *ops, uint8_t *ring, uint8_t *rxBuf);
+void     spi_batch_hook(SpiBatch *s, SpiBatchRx rx, void *ctx);
+
+// Queues as much of p as fits; returns the bytes taken
+uint32_t spi_batch_write(SpiBatch *s, const uint8_t *p, uint32_t len);
+
+// Retire / start batches; returns the bytes delivered to the callback
+uint32_t spi_batch_poll(SpiBatch *s);
+
+// Bytes written but not yet received back
+static inline uint32_t spi_batch_pending(const SpiBatch *s) {
+    return s->head - s->tail;
+}
+
+#ifndef HOST_BUILD
+// STM32 port: SPI2 (already set up by HAL_SPI_Init, 8-bit frames) on DMA1
+// Stream 3 (RX) / Stream 4 (TX), channel 0. Polled from the main loop, no
+// interrupts. spi_batch_hw_stop() hands SPI2 back to blocking HAL calls.
+extern SpiBatch spi2_batch;
+
+void spi_batch_hw_init(void);                 // DMA set up, core reset, SPI2 enabled
+void spi_batch_hw_stop(void);                 // send what is queued, release SPI2
+void spi_batch_hw_start(void);
+void spi_batch_hw_prescaler(uint32_t br);     // SPI_BAUDRATEPRESCALER_x, while idle
+#endif
+
+#endif // SPI_BATCH_H
@@ -0,0 +1,388 @@
+//------------------------------------------------------------------------------------
+// spi_bus.c
+//------------------------------------------------------------------------------------
+//
+// See spi_bus.h. The core comes first and is plain C; the STM32 port
+// (SPI2 on DMA1, TIM7 for the CS delays) follows and is left out of host
+// builds.
+//
+// Each device has its own queue with free-running indices: the main loop
+// owns head and tail, the ISR owns run. The ISR only ever
+// works on q[run] of the device it picked, so a submit to any queue can run
+// alongside a frame on the wire.
+//
+//------------------------------------------------------------------------------------
+#include "spi_bus.h"
+#include <stddef.h>
+#include <string.h>
+
+#define Q_MASK     (SPI_BUS_QUEUE - 1U)
+#define MODE_NONE  0xFFU
+
+// Slot contents must be in memory before the index that publishes them
+#define BARRIER() __asm__ volatile("" ::: "memory")
+
+enum { S_IDLE, S_SETUP, S_XFER, S_HOLD, S_GAP };
+
+//------------------------------------------------------------------------------------
+// Core
+//------------------------------------------------------------------------------------
+void spi_bus_init(SpiBus *b, const SpiBusOps *ops, uint32_t pclkHz) {
+    SpiBusStats zero = {0};
+
+    b->ops    = *ops;
+    b->nDev   = 0;
+    b->pclkHz = pclkHz;
+    b->state  = S_IDLE;
+    b->cur    = 0;
+    b->mode   = MODE_NONE;
+    b->st     = zero;
+}
+
+int spi_bus_add(SpiBus *b, const SpiDevCfg *cfg) {
+    if (b->nDev == SPI_BUS_DEVS) return -1;
+
+    SpiDev *d = &b->dev[b->nDev];
+    memset(d, 0, sizeof(*d));
+    d->cfg   = *cfg;
+    d->br    = (uint8_t)spi_bus_prescaler(b->pclkHz, cfg->maxHz);
+    d->sckHz = b->pclkHz / (2U << d->br);
+    b->ops.cs(&d->cfg, 1);
+    return (int)b->nDev++;
+}
+
+// Everything SPI2 has to be set up for; equal keys share a configuration
+static uint8_t modeOf(const SpiDev *d) {
+    return (uint8_t)(d->br | (d->cfg.cpol ? 0x08U : 0U) | (d->cfg.cpha ? 0x10U : 0U) |
+                     (d->cfg.lsbFirst ? 0x20U : 0U));
+}
+
+int spi_bus_submit(SpiBus *b, uint32_t dev, const uint8_t *tx, uint32_t len,
+                   SpiFrameDone done, void *ctx) {
+    if (dev >= b->nDev || len == 0 || len > SPI_BUS_FRAME) return 0;
+
+    SpiDev *d = &b->dev[dev];
+    uint32_t h = d->head;
+
+    if (h - d->tail >= SPI_BUS_QUEUE) {
+        d->full++;
+        b->st.full++;
+        return 0;
+    }
+
+    SpiFrame *f = &d->q[h & Q_MASK];
+    f->dev    = (uint8_t)dev;
+    f->len    = (uint8_t)len;
+    memcpy(f->tx, tx, len);
+    f->status = SPI_BUS_OK;
+    f->done   = done;
+    f->ctx    = ctx;
+    BARRIER();
+    d->head = h + 1;
+
+    b->ops.kick();
+    return 1;
+}
+
+uint32_t spi_bus_poll_dev(SpiBus *b, uint32_t dev) {
+    SpiDev *d = &b->dev[dev];
+    uint32_t end = d->run, n = 0;
+
+    BARRIER();
+    while (d->tail != end) {
+        // Copy out and free the slot first, so the callback can submit
+        SpiFrame f = d->q[d->tail & Q_MASK];
+        d->tail++;
+        if (f.done) f.done(&f, f.ctx);
+        n++;
+    }
+    return n;
+}
+
+uint32_t spi_bus_poll(SpiBus *b) {
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < b->nDev; i++) n += spi_bus_poll_dev(b, i);
+    return n;
+}
+
+int spi_bus_idle(const SpiBus *b) {
+    for (uint32_t i = 0; i < b->nDev; i++) {
+        if (b->dev[i].head != b->dev[i].tail) return 0;
+    }
+    return 1;
+}
+
+// Highest priority with a frame waiting; ties go round robin from the
+// device after the one served last
+static int pick(const SpiBus *b) {
+    int best = -1;
+
+    for (uint32_t k = 1; k <= b->nDev; k++) {
+        uint32_t i = (b->cur + k) % b->nDev;
+        const SpiDev *d = &b->dev[i];
+        if (d->run == d->head) continue;
+        if (best < 0 || d->cfg.prio > b->dev[best].cfg.prio) best = (int)i;
+    }
+    return best;
+}
+
+// Select the next device, setting SPI2 up for it first if need be, or go idle
+static void begin(SpiBus *b) {
+    int i = pick(b);
+    if (i < 0) {
+        b->state = S_IDLE;
+        return;
+    }
+
+    SpiDev *d = &b->dev[i];
+    uint8_t m = modeOf(d);
+    if (m != b->mode) {
+        b->ops.configure(&d->cfg, d->br);    // every CS is high here
+        b->mode = m;
+        b->st.reconfigs++;
+    }
+    if ((uint8_t)i != b->cur) b->st.switches++;
+    b->cur   = (uint8_t)i;
+    b->state = S_SETUP;
+    b->ops.cs(&d->cfg, 0);
+    b->ops.delay(d->cfg.setupUs);
+}
+
+void spi_bus_kick(SpiBus *b) {
+    if (b->state != S_IDLE) return;
+    begin(b);
+    if (b->state != S_IDLE) b->st.bursts++;
+}
+
+void spi_bus_timer(SpiBus *b) {
+    SpiDev *d = &b->dev[b->cur];
+    SpiFrame *f = &d->q[d->run & Q_MASK];
+
+    switch (b->state) {
+    case S_SETUP:
+        b->state = S_XFER;
+        b->ops.xfer(f->tx, f->rx, f->len);
+        break;
+
+    case S_HOLD:
+        b->ops.cs(&d->cfg, 1);
+        BARRIER();
+        d->run++;                          // the main loop may call it back now
+        d->frames++;
+        b->st.frames++;
+        b->state = S_GAP;
+        b->ops.delay(d->cfg.gapUs);
+        break;
+
+    case S_GAP:
+        begin(b);
+        if (b->state != S_IDLE) b->st.chained++;
+        break;
+
+    default:
+        break;
+    }
+}
+
+void spi_bus_xfer_done(SpiBus *b, int ok) {
+    if (b->state != S_XFER) return;
+
+    SpiDev *d = &b->dev[b->cur];
+    if (!ok) {
+        SpiFrame *f = &d->q[d->run & Q_MASK];
+        f->status = SPI_BUS_ERR;
+        memset(f->rx, 0, sizeof(f->rx));
+        b->st.errors++;
+    }
+    b->state = S_HOLD;
+    b->ops.delay(d->cfg.holdUs);
+}
+
+#ifndef HOST_BUILD
+//------------------------------------------------------------------------------------
+// STM32 port: SPI2 RX DMA1 S3 / TX S4 (ch 0), TIM7 one-shot in microseconds
+//------------------------------------------------------------------------------------
+//
+// TIM7 runs in one-pulse mode at 1 MHz; each delay reloads ARR and starts
+// it. A basic timer with ARR = 0 never updates, so delays under
+// SPI_BUS_MIN_TIMER_US skip it: 1 us is busy-waited on CYCCNT, then the
+// TIM7 IRQ is pended with a step flag and runs spi_bus_timer() as if UIF
+// had fired. spi_bus_kick() pends the same IRQ without either, so every
+// state change happens at the one engine priority. RX completion ends the
+// transfer. CPOL/CPHA/LSBFIRST/BR may only change with SPE clear; SCK then
+// settles at the new idle level before any CS goes low.
+#include "stm32f769xx.h"
+
+#define BUS_IRQ_PRIO   2
+#define RX_STREAM      DMA1_Stream3
+#define TX_STREAM      DMA1_Stream4
+#define RX_FLAGS       (DMA_LISR_TCIF3 | DMA_LISR_HTIF3 | DMA_LISR_TEIF3 | DMA_LISR_DMEIF3 | DMA_LISR_FEIF3)
+#define TX_FLAGS       (DMA_HISR_TCIF4 | DMA_HISR_HTIF4 | DMA_HISR_TEIF4 | DMA_HISR_DMEIF4 | DMA_HISR_FEIF4)
+#define CR1_BUS_BITS   (SPI_CR1_BR | SPI_CR1_CPOL | SPI_CR1_CPHA | SPI_CR1_LSBFIRST)
+
+static uint8_t dmaTx[32] __attribute__((aligned(32)));
+static uint8_t dmaRx[32] __attribute__((aligned(32)));
+static uint8_t *xferRx;
+static uint32_t xferLen;
+static volatile uint32_t isrCycles;
+static volatile uint8_t stepNow;          // short delay over: step, don't kick
+static uint32_t cyclesPerUs;
+
+SpiBus spi2_bus;
+
+static void streamOff(DMA_Stream_TypeDef *s) {
+    s->CR &= ~DMA_SxCR_EN;
+    while (s->CR & DMA_SxCR_EN) {}
+}
+
+static void hwConfigure(const SpiDevCfg *cfg, uint32_t br) {
+    uint32_t cr1 = (br << SPI_CR1_BR_Pos)
+                 | (cfg->cpol ? SPI_CR1_CPOL : 0U)
+                 | (cfg->cpha ? SPI_CR1_CPHA : 0U)
+                 | (cfg->lsbFirst ? SPI_CR1_LSBFIRST : 0U);
+
+    while (SPI2->SR & SPI_SR_BSY) {}
+    SPI2->CR1 &= ~SPI_CR1_SPE;
+    SPI2->CR1  = (SPI2->CR1 & ~CR1_BUS_BITS) | cr1;
+    SPI2->CR1 |= SPI_CR1_SPE;
+}
+
+static void hwCs(const SpiDevCfg *cfg, int level) {
+    GPIO_TypeDef *port = (GPIO_TypeDef *)cfg->csPort;
+    port->BSRR = level ? (uint32_t)cfg->csPin : (uint32_t)cfg->csPin << 16;
+}
+
+static void hwDelay(uint32_t us) {
+    if (us < SPI_BUS_MIN_TIMER_US) {
+        uint32_t t0 = DWT->CYCCNT;
+        while (DWT->CYCCNT - t0 < us * cyclesPerUs) {}
+        stepNow = 1;
+        NVIC_SetPendingIRQ(TIM7_IRQn);
+        return;
+    }
+    TIM7->ARR  = us - 1U;                   // >= 1: counts us ticks, then updates
+    TIM7->CNT  = 0;
+    TIM7->CR1 |= TIM_CR1_CEN;               // OPM clears CEN at the update
+}
+
+static void hwXfer(const uint8_t *tx, uint8_t *rx, uint32_t len) {
+    memcpy(dmaTx, tx, len);
+    xferRx  = rx;
+    xferLen = len;
+    if (SCB->CCR & SCB_CCR_DC_Msk) SCB_CleanDCache_by_Addr((uint32_t *)dmaTx, 32);
+
+    DMA1->LIFCR     = RX_FLAGS;
+    DMA1->HIFCR     = TX_FLAGS;
+    RX_STREAM->NDTR = len;
+    TX_STREAM->NDTR = len;
+    RX_STREAM->CR  |= DMA_SxCR_EN;          // RX armed before the first clock
+    TX_STREAM->CR  |= DMA_SxCR_EN;
+}
+
+static void hwKick(void) {
+    NVIC_SetPendingIRQ(TIM7_IRQn);
+}
+
+static const SpiBusOps hwOps = { hwConfigure, hwCs, hwDelay, hwXfer, hwKick };
+
+static void xferFailed(void) {
+    streamOff(RX_STREAM);
+    streamOff(TX_STREAM);
+    DMA1->LIFCR = RX_FLAGS;
+    DMA1->HIFCR = TX_FLAGS;
+    while (SPI2->SR & SPI_SR_BSY) {}
+    while (SPI2->SR & SPI_SR_RXNE) (void)*(volatile uint8_t *)&SPI2->DR;
+    spi_bus_xfer_done(&spi2_bus, 0);
+}
+
+void TIM7_IRQHandler(void) {
+    uint32_t t0 = DWT->CYCCNT;
+
+    if ((TIM7->SR & TIM_SR_UIF) || stepNow) {
+        TIM7->SR = 0;
+        stepNow  = 0;
+        spi_bus_timer(&spi2_bus);
+    } else {
+        spi_bus_kick(&spi2_bus);
+    }
+    isrCycles += DWT->CYCCNT - t0;
+}
+
+void DMA1_Stream3_IRQHandler(void) {
+    uint32_t t0 = DWT->CYCCNT;
+    uint32_t isr = DMA1->LISR;
+
+    if (isr & DMA_LISR_TEIF3) {
+        xferFailed();
+    } else if (isr & DMA_LISR_TCIF3) {
+        DMA1->LIFCR = RX_FLAGS;
+        if (SCB->CCR & SCB_CCR_DC_Msk) SCB_InvalidateDCache_by_Addr((uint32_t *)dmaRx, 32);
+        memcpy(xferRx, dmaRx, xferLen);
+        spi_bus_xfer_done(&spi2_bus, 1);
+    }
+    isrCycles += DWT->CYCCNT - t0;
+}
+
+void DMA1_Stream4_IRQHandler(void) {
+    if (DMA1->HISR & DMA_HISR_TEIF4) xferFailed();
+    else DMA1->HIFCR = TX_FLAGS;
+}
+
+void spi_bus_hw_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;                  // CYCCNT stays at 0 without a debugger otherwise
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    cyclesPerUs = SystemCoreClock / 1000000U;
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    __HAL_RCC_TIM7_CLK_ENABLE();
+
+    // TIM7: 1 MHz one-shot (APB1 timers run at 2x PCLK1 when APB1 is divided)
+    uint32_t timclk = HAL_RCC_GetPCLK1Freq();
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) timclk *= 2U;
+    TIM7->CR1  = 0;
+    TIM7->PSC  = timclk / 1000000U - 1U;
+    TIM7->EGR  = TIM_EGR_UG;                // load PSC
+    TIM7->CR1  = TIM_CR1_OPM | TIM_CR1_URS; // only overflows raise UIF
+    TIM7->SR   = 0;
+    TIM7->DIER = TIM_DIER_UIE;
+
+    streamOff(RX_STREAM);
+    streamOff(TX_STREAM);
+    DMA1->LIFCR = RX_FLAGS;
+    DMA1->HIFCR = TX_FLAGS;
+
+    RX_STREAM->PAR  = (uint32_t)&SPI2->DR;
+    RX_STREAM->M0AR = (uint32_t)dmaRx;
+    RX_STREAM->CR   = (0U << DMA_SxCR_CHSEL_Pos)   // peripheral to memory, bytes
+                    | DMA_SxCR_MINC | DMA_SxCR_PL_1
+                    | DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+    RX_STREAM->FCR  = 0;                           // direct mode
+
+    TX_STREAM->PAR  = (uint32_t)&SPI2->DR;
+    TX_STREAM->M0AR = (uint32_t)dmaTx;
+    TX_STREAM->CR   = (0U << DMA_SxCR_CHSEL_Pos)
+                    | DMA_SxCR_DIR_0               // memory to peripheral
+                    | DMA_SxCR_MINC | DMA_SxCR_TEIE;
+    TX_STREAM->FCR  = 0;
+
+    SPI2->CR2 |= SPI_CR2_RXDMAEN;
+    SPI2->CR2 |= SPI_CR2_TXDMAEN;
+    SPI2->CR1 |= SPI_CR1_SPE;
+
+    // SPI2 hangs off APB1; the first frame sets CR1 up for its device
+    isrCycles = 0;
+    spi_bus_init(&spi2_bus, &hwOps, HAL_RCC_GetPCLK1Freq());
+
+    HAL_NVIC_SetPriority(TIM7_IRQn, BUS_IRQ_PRIO, 0);
+    HAL_NVIC_SetPriority(DMA1_Stream3_IRQn, BUS_IRQ_PRIO, 0);
+    HAL_NVIC_SetPriority(DMA1_Stream4_IRQn, BUS_IRQ_PRIO, 0);
+    HAL_NVIC_EnableIRQ(TIM7_IRQn);
+    HAL_NVIC_EnableIRQ(DMA1_Stream3_IRQn);
+    HAL_NVIC_EnableIRQ(DMA1_Stream4_IRQn);
+}
+
+uint32_t spi_bus_hw_isr_cycles(void) {
+    return isrCycles;
+}
+#endif
@@ -0,0 +1,172 @@
+//------------------------------------------------------------------------------------
+// spi_bus.h
+//------------------------------------------------------------------------------------
+//
+// Several devices sharing SPI2, each with its own chip select and its own
+// SPI settings.
+//
+// A device is added once with a SpiDevCfg: CS pin, CPOL/CPHA, bit order,
+// the fastest SCK it accepts, its CS timings and an arbitration priority.
+// spi_bus_add() works out the SPI2 baud rate prescaler for it (the fastest
+// one not above maxHz). Frames (up to SPI_BUS_FRAME bytes full duplex under
+// one CS low) are queued per device and only copied in by spi_bus_submit().
+//
+// The engine runs from interrupts:
+//
+//   pick -> [reconfigure] -> CS low -> setup -> DMA -> hold -> CS high -> gap
+//
+// When a frame's gap ends, the next one is picked: the highest priority
+// device with something queued, and among equals the first one after the
+// device served last (round robin). A device at a higher priority that
+// always has frames queued starves the ones below it. SPI2 is only
+// reprogrammed when the picked device's mode, bit order or prescaler differ
+// from what SPI2 has now, and always with every CS high.
+//
+// Results: the ISR fills in frame rx / status; spi_bus_poll() (main loop)
+// runs the callbacks, in submission order for each device (no order is kept
+// between devices). spi_bus_poll_dev() does the same for one device, so a
+// driver on the bus can poll its own frames. Callbacks may submit more
+// frames.
+//
+// Device drivers sit on top as clients: stats_txn registers the STaTS as
+// one device and turns its register ops into 2-byte frames. Task3's
+// loopback has no CS and no engine of its own, but takes its SPI2
+// settings from a SpiDevCfg all the same.
+//
+// The core is hardware-free: the port layer supplies SpiBusOps and calls
+// spi_bus_timer() / spi_bus_xfer_done() / spi_bus_kick() from its
+// interrupts (all at one priority). The STM32 port is at the bottom of
+// spi_bus.c and is the only code that drives SPI2 from interrupts;
+// host/spi_bus_host.c runs the core against four STaTS models with
+// different SPI settings.
+//
+//------------------------------------------------------------------------------------
+#ifndef SPI_BUS_H
+#define SPI_BUS_H
+
+#include <stdint.h>
+
+#define SPI_BUS_DEVS    4U      // devices on the bus
+#define SPI_BUS_QUEUE   32U     // frames waiting per device, power of two
+#define SPI_BUS_FRAME   8U      // longest frame, bytes
+
+// Shortest delay the STM32 port times on TIM7. Shorter setup/hold/gap
+// values (0 or 1 us) are allowed: the port waits them out on the cycle
+// counter inside the engine IRQ and steps on from a pended IRQ, so each
+// costs up to 1 us of CPU plus an interrupt.
+#define SPI_BUS_MIN_TIMER_US  2U
+
+enum { SPI_BUS_OK = 0, SPI_BUS_ERR = -1 };
+
+typedef struct {
+    void     *csPort;          // port layer's handle (GPIO_TypeDef * on the STM32)
+    uint16_t  csPin;
+    uint8_t   cpol, cpha;      // SPI mode
+    uint8_t   lsbFirst;
+    uint32_t  maxHz;           // fastest SCK the device accepts
+    uint8_t   prio;            // higher is served first
+    uint16_t  setupUs;         // CS low to first SCK edge  (see SPI_BUS_MIN_TIMER_US)
+    uint16_t  holdUs;          // last SCK edge to CS high
+    uint16_t  gapUs;           // CS high after the frame
+} SpiDevCfg;
+
+struct SpiFrame;
+typedef void (*SpiFrameDone)(const struct SpiFrame *f, void *ctx);
+
+typedef struct SpiFrame {
+    uint8_t       dev, len;
+    uint8_t       tx[SPI_BUS_FRAME];
+    uint8_t       rx[SPI_BUS_FRAME];
+    int8_t        status;
+    SpiFrameDone  done;        // may be NULL
+    void         *ctx;
+} SpiFrame;
+
+typedef struct {
+    void (*configure)(const SpiDevCfg *cfg, uint32_t br);         // SPI2 idle, every CS high
+    void (*cs)(const SpiDevCfg *cfg, int level);                  // 0 = selected
+    void (*delay)(uint32_t us);                                   // one-shot, ends in spi_bus_timer()
+    void (*xfer)(const uint8_t *tx, uint8_t *rx, uint32_t len);   // ends in spi_bus_xfer_done()
+    void (*kick)(void);                                           // have spi_bus_kick() run at ISR level
+} SpiBusOps;
+
+typedef struct {
+    SpiDevCfg      cfg;
+    uint8_t        br;            // prescaler: SCK = pclk / (2 << br)
+    uint32_t       sckHz;
+    SpiFrame       q[SPI_BUS_QUEUE];
+    volatile uint32_t head;       // submitted (main loop)
+    volatile uint32_t run;        // finished by the ISR
+    uint32_t       tail;          // callbacks done (main loop)
+    uint32_t       frames;
+    uint32_t       full;
+} SpiDev;
+
+typedef struct {
+    uint32_t frames;       // completed, all devices
+    uint32_t errors;
+    uint32_t reconfigs;    // SPI2 reprogrammed between frames
+    uint32_t switches;     // frame went to a different device than the last one
+    uint32_t bursts;       // runs started from idle
+    uint32_t chained;      // frames started straight after the previous one's gap
+    uint32_t full;         // submits refused
+} SpiBusStats;
+
+typedef struct {
+    SpiDev         dev[SPI_BUS_DEVS];
+    uint32_t       nDev;
+    uint32_t       pclkHz;
+    SpiBusOps      ops;
+    volatile uint8_t state;
+    uint8_t        cur;           // device on the bus, or served last
+    uint8_t        mode;          // settings SPI2 has now, MODE_NONE before the first frame
+    SpiBusStats    st;
+} SpiBus;
+
+void spi_bus_init(SpiBus *b, const SpiBusOps *ops, uint32_t pclkHz);
+
+// Returns the device number, or -1 when the bus is full
+int  spi_bus_add(SpiBus *b, const SpiDevCfg *cfg);
+
+// Prescaler exponent (0..7, SCK = pclk / (2 << br)) for the fastest SCK not
+// above maxHz; 7 when even that is too fast
+static inline uint32_t spi_bus_prescaler(uint32_t pclkHz, uint32_t maxHz) {
+    for (uint32_t br = 0; br < 7U; br++) {
+        if (pclkHz / (2U << br) <= maxHz) return br;
+    }
+    return 7U;
+}
+
+// Queue a frame; returns 0 when the device's queue is full (nothing queued)
+int  spi_bus_submit(SpiBus *b, uint32_t dev, const uint8_t *tx, uint32_t len,
+                    SpiFrameDone done, void *ctx);
+
+// Main loop: run callbacks of finished frames, all devices or one; returns
+// how many ran
+uint32_t spi_bus_poll(SpiBus *b);
+uint32_t spi_bus_poll_dev(SpiBus *b, uint32_t dev);
+
+static inline uint32_t spi_bus_pending(const SpiBus *b, uint32_t dev) {
+    return b->dev[dev].head - b->dev[dev].tail;
+}
+int spi_bus_idle(const SpiBus *b);
+
+// From the port layer's interrupts
+void spi_bus_timer(SpiBus *b);
+void spi_bus_xfer_done(SpiBus *b, int ok);
+void spi_bus_kick(SpiBus *b);
+
+#ifndef HOST_BUILD
+// STM32 port: SPI2 already set up by HAL_SPI_Init (master, 8-bit frames,
+// software NSS) and every CS a GPIO output, high. CPOL/CPHA, LSBFIRST and BR
+// are then the bus's. Takes over DMA1 Stream 3 (RX) / Stream 4 (TX)
+// channel 0 and TIM7, and defines their IRQ handlers.
+#include "stm32f7xx_hal.h"
+
+extern SpiBus spi2_bus;
+
+void     spi_bus_hw_init(void);        // then add the devices (stats_txn_init, spi_bus_add)
+uint32_t spi_bus_hw_isr_cycles(void);  // DWT cycles spent in the engine IRQs
+#endif
+
+#endif // SPI_BUS_H
@@ -0,0 +1,124 @@
+//------------------------------------------------------------------------------------
+// stats_cache.c
+//------------------------------------------------------------------------------------
+//
+// See stats_cache.h. Plain C over the stats_txn core, no hardware access.
+//
+//------------------------------------------------------------------------------------
+#include "stats_cache.h"
+#include "stats_regs.h"
+#include <stddef.h>
+
+// Transfers after which rx[0] no longer describes the device
+static int changesSts(const StatsOp *op) {
+    if (op->reg == REG_CH_BUF) return 1;
+    if (op->we) return op->reg == REG_CTL;
+    return op->reg == REG_TMP_HI;
+}
+
+static void invalidateAll(StatsCache *c) {
+    for (int r = 0; r < 16; r++) {
+        if (r != REG_VERSION) c->valid[r] = 0;
+    }
+}
+
+static void record(StatsCache *c, uint8_t reg, uint8_t val, uint64_t now) {
+    if (c->maxAge[reg] == STATS_AGE_NEVER) return;
+    c->val[reg] = val;
+    c->valid[reg] = 1;
+    c->at[reg] = now;
+}
+
+// Monitor: runs for every finished op, before its callback
+static void observe(const StatsOp *op, void *ctx) {
+    StatsCache *c = (StatsCache *)ctx;
+    uint8_t reg = op->reg & 0x0FU;
+
+    c->st.busOps[reg]++;
+
+    if (op->we && c->wrPending[reg]) c->wrPending[reg]--;
+    if (op->we && reg == REG_CTL) {
+        invalidateAll(c);
+        return;
+    }
+    if (op->status != STATS_TXN_OK || c->wrPending[REG_CTL]) return;
+
+    uint64_t now = c->nowUs();
+    if (changesSts(op)) {
+        c->valid[REG_STS] = 0;
+    } else {
+        record(c, REG_STS, op->sts, now);
+        if (op->we || reg != REG_STS) c->st.stsFree++;
+    }
+
+    if (op->we)                   c->valid[reg] = 0;
+    else if (!c->wrPending[reg])  record(c, reg, op->data, now);
+}
+
+void stats_cache_init(StatsCache *c, StatsTxn *t, uint64_t (*nowUs)(void)) {
+    StatsCacheStats zero = {0};
+
+    for (int r = 0; r < 16; r++) {
+        c->val[r] = 0;
+        c->valid[r] = 0;
+        c->at[r] = 0;
+        c->maxAge[r] = STATS_AGE_NEVER;
+        c->wrPending[r] = 0;
+    }
+    c->maxAge[REG_VERSION] = STATS_AGE_STATIC;
+    c->maxAge[REG_DEVID]   = STATS_AGE_STATIC;
+    c->maxAge[REG_STS]     = STATS_STS_MAX_AGE_US;
+    c->maxAge[REG_DIG]     = STATS_DIG_MAX_AGE_US;
+
+    c->txn = t;
+    c->nowUs = nowUs;
+    c->st = zero;
+    stats_txn_monitor(t, observe, c);
+}
+
+void stats_cache_policy(StatsCache *c, uint8_t reg, uint32_t maxAgeUs) {
+    reg &= 0x0FU;
+    c->maxAge[reg] = maxAgeUs;
+    if (maxAgeUs == STATS_AGE_NEVER) c->valid[reg] = 0;
+}
+
+int stats_cache_peek(const StatsCache *c, uint8_t reg, uint8_t *val) {
+    reg &= 0x0FU;
+    uint32_t age = c->maxAge[reg];
+
+    if (!c->valid[reg] || (age != STATS_AGE_STATIC && c->nowUs() - c->at[reg] > age)) return 0;
+    *val = c->val[reg];
+    return 1;
+}
+
+int stats_cache_get(StatsCache *c, uint8_t reg, uint8_t *val) {
+    if (stats_cache_peek(c, reg, val)) {
+        c->st.hits++;
+        return 1;
+    }
+    c->st.misses++;
+    return 0;
+}
+
+int stats_cache_read(StatsCache *c, uint8_t reg, StatsDone done, void *ctx) {
+    return stats_txn_read(c->txn, reg, done, ctx);
+}
+
+int stats_cache_write(StatsCache *c, uint8_t reg, uint8_t val, StatsDone done, void *ctx) {
+    if (!stats_txn_write(c->txn, reg, val, done, ctx)) return 0;
+
+    reg &= 0x0FU;
+    c->wrPending[reg]++;
+    if (reg == REG_CTL) {
+        c->st.invalidations++;
+        invalidateAll(c);
+    } else {
+        c->valid[reg] = 0;
+    }
+    return 1;
+}
+
+void stats_cache_invalidate(StatsCache *c) {
+    invalidateAll(c);
+    c->valid[REG_VERSION] = 0;
+}
@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------------
+// stats_cache.h
+//------------------------------------------------------------------------------------
+//
+// Shadow copies of STaTS registers, kept up to date from the transactions
+// that go by anyway, so callers can skip a bus read when the last value is
+// recent enough.
+//
+// It sits on a StatsTxn as its monitor and sees every finished op:
+//   - rx[0] of every transfer is STS, so STS is refreshed for free by
+//     whatever ran last
+//   - a read refreshes the register it read
+// Each register has a policy:
+//   STATS_AGE_NEVER   not cached (side effects or paired reads: CH_BUF,
+//                     TMP_LO/HI, CTL)
+//   STATS_AGE_STATIC  valid until invalidated (VERSION, DEVID)
+//   n                 valid for n microseconds after it was seen
+//                     (STS, DIG)
+//
+// Coherency rules:
+//   - A write to CTL (reset, terminal, light, temperature, ID unlock)
+//     invalidates every entry but VERSION when it is submitted and again
+//     when it completes; ops that finish between the two ran before the
+//     write and are not recorded.
+//   - A write to any other register does the same for that register
+//     alone.
+//   - Ops that change STS themselves (CH_BUF pops and pushes, TMP_HI
+//     reads, which clear TRDY) sampled STS before the change: their STS
+//     byte invalidates the entry instead of refreshing it.
+//   - Failed transfers record nothing.
+// Ages start when the main loop sees the op (stats_txn_poll), which can be
+// as late as the rest of the queue takes to run; STS can also be changed
+// by a pop still in the queue. Both are bounded by the max age, which is
+// why STS and DIG have one.
+//
+// stats_cache_get() answers from the shadow or says no; it never queues.
+// Reads and writes that must reach the device go through
+// stats_cache_read()/stats_cache_write() (writes must, for the rules
+// above). Reads with side effects may use stats_txn_read() directly.
+//
+//------------------------------------------------------------------------------------
+#ifndef STATS_CACHE_H
+#define STATS_CACHE_H
+
+#include "stats_txn.h"
+#include <stdint.h>
+
+#define STATS_AGE_NEVER       0U
+#define STATS_AGE_STATIC      0xFFFFFFFFU
+
+#define STATS_STS_MAX_AGE_US  50000U   // defaults set by stats_cache_init
+#define STATS_DIG_MAX_AGE_US  20000U
+
+typedef struct {
+    uint32_t hits;           // stats_cache_get() answered from the shadow
+    uint32_t misses;
+    uint32_t stsFree;        // STS refreshed by a transfer that did not read it
+    uint32_t invalidations;  // CTL writes seen (submitted)
+    uint32_t busOps[16];     // finished transactions per register
+} StatsCacheStats;
+
+typedef struct {
+    uint8_t    val[16];
+    uint8_t    valid[16];
+    uint64_t   at[16];        // when it was seen, nowUs() time
+    uint32_t   maxAge[16];
+    uint16_t   wrPending[16]; // writes submitted, not yet seen finishing
+    StatsTxn  *txn;
+    uint64_t (*nowUs)(void);
+    StatsCacheStats st;
+} StatsCache;
+
+// Registers itself as t's monitor; VERSION/DEVID static, STS and DIG aged
+void stats_cache_init(StatsCache *c, StatsTxn *t, uint64_t (*nowUs)(void));
+void stats_cache_policy(StatsCache *c, uint8_t reg, uint32_t maxAgeUs);
+
+// 1 and *val set when the shadow is valid and young enough
+int  stats_cache_get(StatsCache *c, uint8_t reg, uint8_t *val);
+// The same, not counted in hits/misses (for looks every loop pass)
+int  stats_cache_peek(const StatsCache *c, uint8_t reg, uint8_t *val);
+
+// Queue through the cache (same returns as stats_txn_read/write)
+int  stats_cache_read(StatsCache *c, uint8_t reg, StatsDone done, void *ctx);
+int  stats_cache_write(StatsCache *c, uint8_t reg, uint8_t val, StatsDone done, void *ctx);
+
+void stats_cache_invalidate(StatsCache *c);
+
+#endif // STATS_CACHE_H
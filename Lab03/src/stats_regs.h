@@ -0,0 +1,45 @@
+//------------------------------------------------------------------------------------
+// stats_regs.h
+//------------------------------------------------------------------------------------
+//
+// STaTS register numbers and bits, shared by task4 and the register cache
+// (stats_cache.c).
+//
+//------------------------------------------------------------------------------------
+#ifndef STATS_REGS_H
+#define STATS_REGS_H
+
+/* ===== STaTS register numbers (bit-reversed nibble mapping you provided) ===== */
+enum {
+  REG_CTL     = 0,
+  REG_STS     = 8,
+  REG_DIG     = 4,
+  REG_TMP_AVG = 12,
+  REG_TMP_LO  = 2,
+  REG_TMP_HI  = 10,
+  REG_CH_BUF  = 6,
+  REG_TXT_ATTR= 14,
+  REG_VERSION = 1,
+  REG_DEVID   = 9
+};
+
+/* CTL_REG bits */
+#define CTL_RST      (1u<<0)
+#define CTL_RDTMP    (1u<<1)
+#define CTL_TRMCLR   (1u<<2)
+#define CTL_TRMRST   (1u<<3)
+#define CTL_CHBCLR   (1u<<4)
+#define CTL_LGT_TGL  (1u<<5)
+#define CTL_ULKDID   (1u<<7)
+
+/* STS_REG bits */
+#define STS_RDY      (1u<<0)
+#define STS_DIG      (1u<<1)
+#define STS_LGT_ON   (1u<<2)
+#define STS_TBUSY    (1u<<3)
+#define STS_TRDY     (1u<<4)
+#define STS_NCHBF0   (1u<<5)
+#define STS_NCHBF1   (1u<<6)
+#define STS_CHBOV    (1u<<7)
+
+#endif // STATS_REGS_H
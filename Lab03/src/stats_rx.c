@@ -0,0 +1,90 @@
+//------------------------------------------------------------------------------------
+// stats_rx.c
+//------------------------------------------------------------------------------------
+//
+// See stats_rx.h.
+//
+//------------------------------------------------------------------------------------
+#include "stats_rx.h"
+#include "stats_regs.h"
+#include <stddef.h>
+
+#define NCHBF(sts)  (((sts) >> 5) & 0x03U)
+
+static void onPop(const StatsOp *op, void *ctx);
+
+static void pop(StatsRx *r, uint32_t n) {
+    while (n-- && stats_txn_read(r->txn, REG_CH_BUF, onPop, r)) r->inFlight++;
+}
+
+static void idle(StatsRx *r, uint32_t intervalUs) {
+    r->intervalUs = intervalUs;
+    r->nextUs = r->nowUs() + intervalUs;
+    r->burst = 0;
+}
+
+static void onPop(const StatsOp *op, void *ctx) {
+    StatsRx *r = (StatsRx *)ctx;
+
+    r->inFlight--;
+    r->st.pops++;
+    if (op->status != STATS_TXN_OK) {
+        if (!r->inFlight) idle(r, STATS_RX_FAST_US);
+        return;
+    }
+    if (op->sts & STS_CHBOV) r->st.overflows++;
+
+    // STS is from before the header; a byte can land after it
+    uint32_t level = NCHBF(op->sts);
+    if (op->data == 0x00) {
+        r->st.empty++;
+    } else {
+        r->st.bytes++;
+        if (++r->burst > r->st.maxBurst) r->st.maxBurst = r->burst;
+        if (r->rx) r->rx(op->data, r->rxCtx);
+    }
+
+    // What was waiting, less this byte and the pops already queued behind it
+    uint32_t want = level == 3 ? STATS_RX_DEPTH : (level ? level - 1 : 0);
+    if (want > r->inFlight) pop(r, want - r->inFlight);
+    if (r->inFlight) return;
+
+    if (r->burst) {
+        idle(r, STATS_RX_FAST_US);
+    } else {
+        uint32_t next = r->intervalUs * 2U;
+        idle(r, next > STATS_RX_IDLE_US ? STATS_RX_IDLE_US : next);
+    }
+}
+
+void stats_rx_init(StatsRx *r, StatsTxn *t, StatsCache *c, uint64_t (*nowUs)(void),
+                   StatsRxChar rx, void *ctx) {
+    StatsRxStats zero = {0};
+
+    r->txn        = t;
+    r->cache      = c;
+    r->rx         = rx;
+    r->rxCtx      = ctx;
+    r->nowUs      = nowUs;
+    r->inFlight   = 0;
+    r->burst      = 0;
+    r->intervalUs = STATS_RX_IDLE_US;
+    r->nextUs     = 0;
+    r->st         = zero;
+}
+
+void stats_rx_poll(StatsRx *r) {
+    if (r->inFlight) return;
+
+    // Another transfer's STS may already show bytes waiting. An empty one
+    // is not trusted: it may be older than the poll that is due.
+    uint8_t sts;
+    if (r->cache && stats_cache_peek(r->cache, REG_STS, &sts) && NCHBF(sts)) {
+        r->st.hinted++;
+        pop(r, NCHBF(sts) == 3 ? STATS_RX_DEPTH : NCHBF(sts));
+        return;
+    }
+    if (r->nowUs() < r->nextUs) return;
+    r->st.polls++;
+    pop(r, 1);
+}
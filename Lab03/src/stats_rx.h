@@ -0,0 +1,65 @@
+//------------------------------------------------------------------------------------
+// stats_rx.h
+//------------------------------------------------------------------------------------
+//
+// STaTS keyboard receive: pops CH_BUF in bursts sized from the NCHBF level
+// bits, at a poll interval that follows the traffic.
+//
+// Every pop returns STS as sampled just before it, so each one tells how
+// many bytes were waiting (NCHBF: 0-2, or 3 for three or more). When a pop
+// completes, enough further pops are queued to cover what is left, and the
+// engine runs them back to back. When the FIFO is found empty the receiver
+// goes back to polling: STATS_RX_FAST_US after the last byte, doubling up
+// to STATS_RX_IDLE_US while nothing arrives. A fresh STS in the register
+// cache that shows bytes waiting starts a burst at once.
+//
+// CHBOV in a pop's STS means bytes were lost before it; each one is counted
+// in st.overflows (the pop clears the flag).
+//
+// Plain C over stats_txn/stats_cache, no hardware access.
+//
+//------------------------------------------------------------------------------------
+#ifndef STATS_RX_H
+#define STATS_RX_H
+
+#include "stats_txn.h"
+#include "stats_cache.h"
+#include <stdint.h>
+
+#define STATS_RX_FAST_US   1000U    // poll interval right after traffic
+#define STATS_RX_IDLE_US   25000U   // slowest poll interval
+#define STATS_RX_DEPTH     3U       // pops in flight when NCHBF reads 3 (three or more)
+
+typedef void (*StatsRxChar)(uint8_t c, void *ctx);
+
+typedef struct {
+    uint32_t bytes;
+    uint32_t pops;
+    uint32_t empty;        // pops that found nothing
+    uint32_t polls;        // bursts started by the poll timer
+    uint32_t hinted;       // bursts started from a cached STS
+    uint32_t overflows;    // CHBOV seen
+    uint32_t maxBurst;     // most bytes in one run of pops
+} StatsRxStats;
+
+typedef struct {
+    StatsTxn     *txn;
+    StatsCache   *cache;        // may be NULL
+    StatsRxChar   rx;
+    void         *rxCtx;
+    uint64_t    (*nowUs)(void);
+    uint32_t      inFlight;
+    uint32_t      burst;        // bytes in the current run
+    uint32_t      intervalUs;
+    uint64_t      nextUs;
+    StatsRxStats  st;
+} StatsRx;
+
+void stats_rx_init(StatsRx *r, StatsTxn *t, StatsCache *c, uint64_t (*nowUs)(void),
+                   StatsRxChar rx, void *ctx);
+
+// Main loop: start a poll or burst when due; bytes arrive via the callback
+// from stats_txn_poll()
+void stats_rx_poll(StatsRx *r);
+
+#endif // STATS_RX_H
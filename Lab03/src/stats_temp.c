@@ -0,0 +1,184 @@
+//------------------------------------------------------------------------------------
+// stats_temp.c
+//------------------------------------------------------------------------------------
+//
+// See stats_temp.h.
+//
+//------------------------------------------------------------------------------------
+#include "stats_temp.h"
+#include "stats_regs.h"
+#include <stddef.h>
+
+enum { T_IDLE, T_CONVERT, T_READ };
+
+static void onLo(const StatsOp *op, void *ctx) {
+    StatsTemp *s = (StatsTemp *)ctx;
+    s->lo   = op->data;
+    s->loOk = op->status == STATS_TXN_OK && (op->sts & STS_TRDY);
+    if (op->status == STATS_TXN_OK && !(op->sts & STS_TRDY)) s->st.notReady++;
+}
+
+static void onHi(const StatsOp *op, void *ctx) {
+    StatsTemp *s = (StatsTemp *)ctx;
+
+    s->state = T_IDLE;
+    if (op->status != STATS_TXN_OK) {
+        s->st.errors++;
+        s->run = 0;
+        return;
+    }
+    if (!s->loOk) {
+        s->run = 0;
+        return;
+    }
+
+    uint16_t raw = (uint16_t)(((uint16_t)op->data << 8) | s->lo) & 0x0FFFU;
+    uint32_t slot = s->n & (STATS_TEMP_AVG_N - 1U);
+    if (s->n >= STATS_TEMP_AVG_N) s->sum -= s->hist[slot];
+    s->hist[slot] = raw;
+    s->sum += raw;
+    s->n++;
+    s->run++;
+    s->raw = raw;
+    s->st.samples++;
+}
+
+static void onAvg(const StatsOp *op, void *ctx) {
+    StatsTemp *s = (StatsTemp *)ctx;
+    if (op->status != STATS_TXN_OK) return;
+    s->devAvg = op->data;
+    // LO and HI ran first in this burst. The device averages every
+    // conversion, so a dropped one leaves the local window out of step
+    // with it until STATS_TEMP_AVG_N more have been recorded
+    if (s->run < STATS_TEMP_AVG_N) return;
+
+    s->st.avgChecks++;
+    if (op->data != (uint8_t)((s->sum / STATS_TEMP_AVG_N) >> 4)) s->st.avgMismatch++;
+}
+
+static void onSts(const StatsOp *op, void *ctx) {
+    (void)op; (void)ctx;     // the cache has it now
+}
+
+static void onTrigger(const StatsOp *op, void *ctx) {
+    StatsTemp *s = (StatsTemp *)ctx;
+    if (op->status == STATS_TXN_OK) return;
+    s->st.errors++;          // no conversion started: try again now
+    s->state = T_IDLE;
+    s->nextUs = s->nowUs();
+}
+
+static int queue(StatsTemp *s, int ok) {
+    if (ok) s->st.txns++;
+    return ok;
+}
+
+// LO, HI (and TMP_AVG now and then) in one burst
+static void collect(StatsTemp *s, uint64_t seenUs) {
+    s->convUs = (uint32_t)(seenUs - s->startUs);
+    s->state = T_READ;
+    s->loOk = 0;
+    int avg = s->n + 1U >= STATS_TEMP_AVG_N && (s->n + 1U) % STATS_TEMP_AVG_N == 0;
+    if (!queue(s, stats_txn_read(s->txn, REG_TMP_LO, onLo, s)) ||
+        !queue(s, stats_txn_read(s->txn, REG_TMP_HI, onHi, s))) {
+        s->st.errors++;          // queue full: HI never runs, try again next period
+        s->state = T_IDLE;
+        return;
+    }
+    if (avg) (void)queue(s, stats_txn_read(s->txn, REG_TMP_AVG, onAvg, s));
+}
+
+void stats_temp_init(StatsTemp *s, StatsTxn *t, StatsCache *c, uint64_t (*nowUs)(void)) {
+    StatsTempStats zero = {0};
+
+    s->txn         = t;
+    s->cache       = c;
+    s->nowUs       = nowUs;
+    s->periodUs    = STATS_TEMP_PERIOD_US;
+    s->on          = 0;
+    s->state       = T_IDLE;
+    s->lo          = 0;
+    s->loOk        = 0;
+    s->nextUs      = 0;
+    s->checkUs     = 0;
+    s->startUs     = 0;
+    s->lastCheckUs = 0;
+    s->convUs      = 0;
+    s->checked     = 0;
+    s->sum         = 0;
+    s->n           = 0;
+    s->run         = 0;
+    s->raw         = 0;
+    s->devAvg      = 0;
+    s->enabledUs   = 0;
+    s->st          = zero;
+    for (uint32_t i = 0; i < STATS_TEMP_AVG_N; i++) s->hist[i] = 0;
+}
+
+void stats_temp_enable(StatsTemp *s, int on, uint32_t periodUs) {
+    s->on = (uint8_t)(on != 0);
+    if (periodUs) s->periodUs = periodUs;
+    if (s->on) {
+        s->nextUs = s->nowUs();
+        s->enabledUs = s->nextUs;
+    }
+}
+
+void stats_temp_poll(StatsTemp *s) {
+    uint64_t now = s->nowUs();
+    uint8_t sts;
+
+    switch (s->state) {
+    case T_IDLE:
+        if (!s->on || now < s->nextUs) return;
+        if (!queue(s, stats_cache_write(s->cache, REG_CTL, CTL_RDTMP, onTrigger, s))) return;
+        s->st.triggers++;
+        s->state   = T_CONVERT;
+        s->startUs = now;
+        s->checked = 0;
+        s->checkUs = now + (s->convUs ? s->convUs : STATS_TEMP_CHECK_US);
+        s->lastCheckUs = now;
+        s->nextUs += s->periodUs;
+        if (s->nextUs < now) s->nextUs = now + s->periodUs;   // fell behind: skip, don't burst
+        break;
+
+    case T_CONVERT:
+        // Any fresh STS is from after the trigger (the CTL write dropped
+        // older ones), but may be up to its max age old: a "not ready"
+        // is re-read once a check is due
+        if (stats_cache_peek(s->cache, REG_STS, &sts) && (sts & STS_TRDY)) {
+            // Seen for free, or thanks to the check queued at lastCheckUs
+            collect(s, s->checked ? s->lastCheckUs : now);
+        } else if (now >= s->checkUs) {
+            if (queue(s, stats_cache_read(s->cache, REG_STS, onSts, s))) {
+                s->st.stsReads++;
+                s->lastCheckUs = now;
+                s->checked = 1;
+            }
+            s->checkUs = now + STATS_TEMP_CHECK_US;
+        }
+        if (s->state == T_CONVERT && now - s->startUs > STATS_TEMP_TIMEOUT_US) {
+            s->st.timeouts++;
+            s->run = 0;          // it may still convert, unseen
+            s->state = T_IDLE;
+        }
+        break;
+
+    default:
+        break;                   // T_READ ends in onHi
+    }
+}
+
+int stats_temp_ready(const StatsTemp *s) {
+    return s->n != 0;
+}
+
+int32_t stats_temp_last_mdeg(const StatsTemp *s) {
+    return stats_temp_mdeg(s->raw);
+}
+
+int32_t stats_temp_avg_mdeg(const StatsTemp *s) {
+    uint32_t n = s->n < STATS_TEMP_AVG_N ? s->n : STATS_TEMP_AVG_N;
+    if (!n) return 0;
+    return 357600 - (int32_t)((187U * s->sum + n / 2U) / n);
+}
@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------------
+// stats_temp.h
+//------------------------------------------------------------------------------------
+//
+// Background STaTS temperature sampler: starts a conversion every period,
+// collects the result when it is ready, and keeps a moving average.
+//
+// Per sample:
+//   - CTL_RDTMP (through the cache, so stale STS is dropped)
+//   - wait for TRDY, seen in the cached STS byte. Any transfer refreshes it
+//     (task4's 80 ms poll does), so TRDY is often seen for free; when it
+//     has not shown up by the next check, STS is read, and that read
+//     refreshes the cache like any other. The first check is when TRDY
+//     was seen last time, then every STATS_TEMP_CHECK_US.
+//   - TMP_LO and TMP_HI queued together, so they run as one back-to-back
+//     burst (STaTS has no multi-register frame); LO's STS confirms TRDY
+//   - every STATS_TEMP_AVG_N-th sample, TMP_AVG in the same burst, to
+//     compare with the formula below (skipped until STATS_TEMP_AVG_N
+//     samples in a row have been recorded, so the windows line up)
+// Nothing waits: stats_temp_poll() only looks at the clock and the cache,
+// the rest happens in transaction callbacks.
+//
+// Temperatures are integers in milli-degrees C: 357600 - 187 * raw12,
+// exactly the datasheet's 357.6 - 0.187 * raw. The average is over the
+// last STATS_TEMP_AVG_N raw samples. TMP_AVG is assumed to be the
+// device's mean of its last 8 results, raw >> 4; the datasheet does not
+// say, so avgMismatch counts disagreements with that guess, not errors.
+//
+// Plain C over stats_txn/stats_cache, no hardware access.
+//
+//------------------------------------------------------------------------------------
+#ifndef STATS_TEMP_H
+#define STATS_TEMP_H
+
+#include "stats_txn.h"
+#include "stats_cache.h"
+#include <stdint.h>
+
+#define STATS_TEMP_PERIOD_US   250000U    // default sample period
+#define STATS_TEMP_CHECK_US    20000U     // TRDY check interval without a fresh STS
+#define STATS_TEMP_TIMEOUT_US  1000000U   // give up on a conversion
+#define STATS_TEMP_AVG_N       8U         // samples in the average, power of two
+
+typedef struct {
+    uint32_t samples;
+    uint32_t triggers;
+    uint32_t txns;         // transactions queued by the sampler
+    uint32_t stsReads;     // TRDY checks that went to the bus
+    uint32_t avgChecks;    // TMP_AVG reads compared with the assumed formula
+    uint32_t avgMismatch;  // TMP_AVG != (local sum / 8) >> 4
+    uint32_t notReady;     // LO read without TRDY (result dropped)
+    uint32_t timeouts;
+    uint32_t errors;
+} StatsTempStats;
+
+typedef struct {
+    StatsTxn     *txn;
+    StatsCache   *cache;
+    uint64_t    (*nowUs)(void);
+    uint32_t      periodUs;
+    uint8_t       on, state;
+    uint8_t       lo, loOk, checked;
+    uint64_t      nextUs, checkUs, startUs, lastCheckUs;
+    uint32_t      convUs;       // trigger to TRDY last time, 0 = not seen yet
+    uint16_t      hist[STATS_TEMP_AVG_N];
+    uint32_t      sum, n;
+    uint32_t      run;          // samples since one was dropped
+    uint16_t      raw;          // last sample
+    uint8_t       devAvg;       // last TMP_AVG read
+    uint64_t      enabledUs;    // for the rate
+    StatsTempStats st;
+} StatsTemp;
+
+static inline int32_t stats_temp_mdeg(uint16_t raw12) {
+    return 357600 - 187 * (int32_t)(raw12 & 0x0FFFU);
+}
+
+void    stats_temp_init(StatsTemp *s, StatsTxn *t, StatsCache *c, uint64_t (*nowUs)(void));
+void    stats_temp_enable(StatsTemp *s, int on, uint32_t periodUs);
+void    stats_temp_poll(StatsTemp *s);     // main loop
+
+int     stats_temp_ready(const StatsTemp *s);          // at least one sample
+int32_t stats_temp_last_mdeg(const StatsTemp *s);
+int32_t stats_temp_avg_mdeg(const StatsTemp *s);
+
+#endif // STATS_TEMP_H
@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------------
+// stats_txn.c
+//------------------------------------------------------------------------------------
+//
+// See stats_txn.h. Plain C over spi_bus; the engine and the STM32 port are
+// the bus's.
+//
+// Queue indices are free-running and both belong to the main loop:
+// q[tail..head) have a frame on the bus. Frames of one device come back in
+// submission order, so the frame being called back is always q[tail]'s.
+//
+//------------------------------------------------------------------------------------
+#include "stats_txn.h"
+#include <stddef.h>
+
+#define Q_MASK  (STATS_TXN_QUEUE - 1U)
+
+//------------------------------------------------------------------------------------
+// Bus client
+//------------------------------------------------------------------------------------
+int stats_txn_init(StatsTxn *t, SpiBus *b, void *csPort, uint16_t csPin, uint32_t maxHz) {
+    StatsTxnStats zero = {0};
+    SpiDevCfg cfg = {0};
+
+    cfg.csPort   = csPort;
+    cfg.csPin    = csPin;
+    cfg.cpol     = 0;                  // mode 1
+    cfg.cpha     = 1;
+    cfg.lsbFirst = 1;                  // the header's WE bit goes first
+    cfg.maxHz    = maxHz;
+    cfg.setupUs  = STATS_CS_SETUP_US;
+    cfg.holdUs   = STATS_CS_HOLD_US;
+    cfg.gapUs    = STATS_CS_GAP_US;
+
+    t->bus        = b;
+    t->head       = 0;
+    t->tail       = 0;
+    t->monitor    = NULL;
+    t->monitorCtx = NULL;
+    t->st         = zero;
+
+    int dev = spi_bus_add(b, &cfg);
+    if (dev < 0) return 0;
+    t->dev = (uint8_t)dev;
+    return 1;
+}
+
+void stats_txn_monitor(StatsTxn *t, StatsDone fn, void *ctx) {
+    t->monitor = fn;
+    t->monitorCtx = ctx;
+}
+
+static void onFrame(const SpiFrame *f, void *ctx) {
+    StatsTxn *t = (StatsTxn *)ctx;
+
+    // Copy out and free the slot first, so the callback can submit
+    StatsOp op = t->q[t->tail & Q_MASK];
+    t->tail++;
+
+    op.sts  = f->rx[0];
+    op.data = f->rx[1];
+    if (f->status != SPI_BUS_OK) {
+        op.status = STATS_TXN_ERR;
+        t->st.errors++;
+    }
+    t->st.ops++;
+    if (t->monitor) t->monitor(&op, t->monitorCtx);
+    if (op.done) op.done(&op, op.ctx);
+}
+
+static int submit(StatsTxn *t, uint8_t we, uint8_t reg, uint8_t din, StatsDone done, void *ctx) {
+    uint32_t h = t->head;
+
+    if (h - t->tail >= STATS_TXN_QUEUE) {
+        t->st.full++;
+        return 0;
+    }
+
+    StatsOp *op = &t->q[h & Q_MASK];
+    op->we     = we;
+    op->reg    = reg;
+    op->din    = din;
+    op->sts    = 0;
+    op->data   = 0;
+    op->status = STATS_TXN_OK;
+    op->done   = done;
+    op->ctx    = ctx;
+
+    uint8_t tx[2];
+    tx[0] = (uint8_t)((we ? 1U : 0U) | ((reg & 0x0FU) << 1));
+    tx[1] = din;
+    if (!spi_bus_submit(t->bus, t->dev, tx, 2, onFrame, t)) {
+        t->st.full++;                  // someone else filled this device's bus queue
+        return 0;
+    }
+    t->head = h + 1;
+
+    if (t->head - t->tail > t->st.maxQueue) t->st.maxQueue = t->head - t->tail;
+    return 1;
+}
+
+int stats_txn_read(StatsTxn *t, uint8_t reg, StatsDone done, void *ctx) {
+    return submit(t, 0, reg, 0x00, done, ctx);
+}
+
+int stats_txn_write(StatsTxn *t, uint8_t reg, uint8_t val, StatsDone done, void *ctx) {
+    return submit(t, 1, reg, val, done, ctx);
+}
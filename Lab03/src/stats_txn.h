@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------------------
+// stats_txn.h
+//------------------------------------------------------------------------------------
+//
+// Queued, interrupt-driven STaTS register transactions.
+//
+// A transaction is the STaTS 2-byte exchange under one CS low:
+//   tx[0] header (write-enable bit 0, register << 1)   rx[0] STS
+//   tx[1] data (ignored on reads)                     rx[1] register value
+//                                                           (read) or its
+//                                                           previous value
+//                                                           (write)
+// The STaTS is one device on an SpiBus (spi_bus.h): stats_txn_init()
+// registers it with its CS pin, SPI mode 1, LSB first and the CS timings
+// below, and each op becomes one 2-byte frame. stats_txn_read()/
+// stats_txn_write() only queue it and return; the bus engine walks it through
+//
+//   CS low -> setup delay -> 2-byte DMA -> hold delay -> CS high -> gap
+//
+// entirely from interrupts, and a burst of submits goes out back to back
+// (between frames of other devices, if any) without a trip through the
+// main loop.
+//
+// Results and callbacks: stats_txn_poll() (main loop) polls this device's
+// frames on the bus and runs the callbacks of finished ops in submission
+// order, with op->sts / op->data / op->status filled in. Callbacks may
+// submit more ops. Nothing here waits. A monitor (stats_txn_monitor) sees
+// every finished op just before its callback, whoever submitted it; the
+// register cache uses it.
+//
+// Plain C over spi_bus, no hardware access: on the board the bus is
+// spi2_bus (the STM32 port in spi_bus.c); host/stats_txn_host.c runs it on
+// a bus with a simulated device, and host/stats_model.c provides a bus
+// port onto a bit-level STaTS model for driver tests.
+//
+//------------------------------------------------------------------------------------
+#ifndef STATS_TXN_H
+#define STATS_TXN_H
+
+#include "spi_bus.h"
+#include <stdint.h>
+
+#define STATS_TXN_QUEUE     SPI_BUS_QUEUE   // ops in flight or waiting
+#define STATS_CS_SETUP_US   4U      // CS low to first SCK edge
+#define STATS_CS_HOLD_US    4U      // last SCK edge to CS high
+#define STATS_CS_GAP_US     4U      // CS high between transactions
+
+enum { STATS_TXN_OK = 0, STATS_TXN_ERR = -1 };
+
+struct StatsOp;
+typedef void (*StatsDone)(const struct StatsOp *op, void *ctx);
+
+typedef struct StatsOp {
+    uint8_t    we, reg, din;       // request
+    uint8_t    sts, data;          // result: rx[0], rx[1]
+    int8_t     status;
+    StatsDone  done;               // may be NULL
+    void      *ctx;
+} StatsOp;
+
+typedef struct {
+    uint32_t ops;          // transactions completed
+    uint32_t errors;
+    uint32_t full;         // submits refused
+    uint32_t maxQueue;     // (bursts and chaining: the bus's SpiBusStats)
+} StatsTxnStats;
+
+typedef struct {
+    StatsOp        q[STATS_TXN_QUEUE];
+    uint32_t       head;      // submitted
+    uint32_t       tail;      // called back; q[tail..head) are on the bus
+    SpiBus        *bus;
+    uint8_t        dev;       // device number on the bus
+    StatsDone      monitor;
+    void          *monitorCtx;
+    StatsTxnStats  st;
+} StatsTxn;
+
+// Adds the STaTS to b (CS on csPort/csPin, SCK at most maxHz); returns 0
+// when the bus has no room for another device
+int  stats_txn_init(StatsTxn *t, SpiBus *b, void *csPort, uint16_t csPin, uint32_t maxHz);
+void stats_txn_monitor(StatsTxn *t, StatsDone fn, void *ctx);
+
+// Queue an op; returns 0 when the queue is full (nothing queued)
+int  stats_txn_read(StatsTxn *t, uint8_t reg, StatsDone done, void *ctx);
+int  stats_txn_write(StatsTxn *t, uint8_t reg, uint8_t val, StatsDone done, void *ctx);
+
+// Main loop: run callbacks of finished ops; returns how many ran
+static inline uint32_t stats_txn_poll(StatsTxn *t) {
+    return spi_bus_poll_dev(t->bus, t->dev);
+}
+
+// Submitted ops not yet called back
+static inline uint32_t stats_txn_pending(const StatsTxn *t) {
+    return t->head - t->tail;
+}
+static inline int stats_txn_idle(const StatsTxn *t) {
+    return t->head == t->tail;
+}
+
+#endif // STATS_TXN_H
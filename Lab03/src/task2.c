@@ -2,167 +2,230 @@
 // Lab 3 - Part 1: UART - Lab03_uart.c
 //------------------------------------
 //
+// USART1 and USART6 receive by interrupt into their own rings; everything
+// else runs in the main loop. Lines typed on either port go through the
+// command table (cmd.c): "#c"/"clear", "#e"/"exit", "#i"/"led", "help".
 
 #include "init.h"
-
-uint8_t UART1_rxBuffer[1] = {0};	// rx character buffer for UART1
-uint8_t UART6_rxBuffer[1] = {0};	// rx character buffer for UART6
-uint8_t UART1_rxLog[2] = {0};		// records last two character inputs from UART1
-uint8_t UART6_rxLog[2] = {0};		// records last two character inputs from UART6
-uint8_t halt_program = 0;			// 1: halt  	0: continue
+#include "cmd.h"
+#include <stdio.h>
+#include <string.h>
+
+#define RX_RING   64U	// per port, power of two
+#define CMD_LINE_LEN  64
+#define ESC       27
+
+// Single producer (ISR) / single consumer (main loop), free-running indices
+typedef struct {
+	volatile uint8_t  buf[RX_RING];
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	uint32_t dropped;
+} RxRing;
+
+typedef struct {
+	UART_HandleTypeDef *huart;
+	RxRing  *rx;
+	CmdLine  line;
+	char     buf[CMD_LINE_LEN];
+} Port;
+
+static RxRing rx1, rx6;
+static uint8_t halt_program = 0;	// 1: halt  	0: continue
 
 UART_HandleTypeDef huart6 = {};
 
-void initGPIO();
-void USART1_IRQHandler();
-void USART6_IRQHandler();
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
-void command(char c, UART_HandleTypeDef *huart);
+static void initGPIO(void);
+static void rx_enable(USART_TypeDef *u, IRQn_Type irq);
+static void poll_port(Port *p, Port *fwd);
+
+static void do_clear(const CmdArgs *a, void *ctx);
+static void do_exit(const CmdArgs *a, void *ctx);
+static void do_help(const CmdArgs *a, void *ctx);
+static void do_led(const CmdArgs *a, void *ctx);
+static int  parse_led(CmdArgs *a);
+
+// Sorted by name: the lookup is a binary search
+static const CmdEntry cmd_entries[] = {
+	{ "c",     cmd_parse_none, do_clear, "clear the terminal" },
+	{ "clear", cmd_parse_none, do_clear, "clear the terminal" },
+	{ "e",     cmd_parse_none, do_exit,  "end the program" },
+	{ "exit",  cmd_parse_none, do_exit,  "end the program" },
+	{ "help",  cmd_parse_none, do_help,  "list commands" },
+	{ "i",     parse_led,      do_led,   "toggle LD3 (from USART6)" },
+	{ "led",   parse_led,      do_led,   "led [on|off]: LD3 (from USART6)" },
+};
+static const CmdTable cmds = { cmd_entries, sizeof(cmd_entries) / sizeof(cmd_entries[0]) };
 
 // main Execution Loop
 int main(void) {
 
+	static Port usart1, usart6;
+
 	// initialize the system
 	Sys_Init();
 
 	// initialize GPIO
 	initGPIO();
 
-	// enable NVIC interrupts
-	HAL_NVIC_EnableIRQ(USART1_IRQn);
-	HAL_NVIC_EnableIRQ(USART6_IRQn);
-
 	// initialize USART1 with 115200 baud rate
 	initUart(&USB_UART, 115200, USART1);
 
 	// initialize USART6 with 38400 baud rate
 	initUart(&huart6, 38400, USART6);
 
-	// enable RX interrupt
-	HAL_UART_Receive_IT(&USB_UART, UART1_rxBuffer, 1);
-	HAL_UART_Receive_IT(&huart6, UART6_rxBuffer, 1);
+	usart1.huart = &USB_UART;
+	usart1.rx = &rx1;
+	cmd_line_init(&usart1.line, usart1.buf, CMD_LINE_LEN);
 
-	while (1) {
+	usart6.huart = &huart6;
+	usart6.rx = &rx6;
+	cmd_line_init(&usart6.line, usart6.buf, CMD_LINE_LEN);
 
-		if (halt_program) {	// halt program
-			HAL_NVIC_DisableIRQ(USART1_IRQn); // disable interrupts
-			HAL_NVIC_DisableIRQ(USART6_IRQn);
-			char exit_str[] = "\r\n\n\t- Exit. \r\n\n";
-			uart_print(&USB_UART, exit_str);
-			while (1) {};
-		}
+	if (cmd_check(&cmds) >= 0) {
+		printf("command table out of order at %d\r\n", cmd_check(&cmds));
+	}
+
+	// enable RX interrupts
+	rx_enable(USART1, USART1_IRQn);
+	rx_enable(USART6, USART6_IRQn);
 
+	while (!halt_program) {
+		poll_port(&usart1, &usart6);	// USART1 is also forwarded to USART6
+		poll_port(&usart6, NULL);
+		__WFI();						// the RX interrupts wake us
 	}
+
+	HAL_NVIC_DisableIRQ(USART1_IRQn); // disable interrupts
+	HAL_NVIC_DisableIRQ(USART6_IRQn);
+	char exit_str[] = "\r\n\n\t- Exit. \r\n\n";
+	uart_print(&USB_UART, exit_str);
+	while (1) {};
 }
 
 // initialize GPIO
-void initGPIO() {
+static void initGPIO(void) {
 
 	// initialize LED 3, PIN A12
 	GPIO_InitTypeDef GPIO_InitStruct = {0};
 	GPIO_InitStruct.Pin = GPIO_PIN_12;
 	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
-    GPIO_InitStruct.Pull = GPIO_NOPULL;
-    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
-
-}
-
-// handle USB/UART Interrupts with HAL
-void USART1_IRQHandler() {
-	HAL_UART_IRQHandler(&USB_UART);
-}
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
-void USART6_IRQHandler() {
-	HAL_UART_IRQHandler(&huart6);
 }
 
-// UART RX callback function
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
-
-	char nl[] = "\r\n";
+//------------------------------------
+// RX interrupts: byte into the ring, nothing else
+//------------------------------------
+static void rx_isr(USART_TypeDef *u, RxRing *r) {
+	uint32_t isr = u->ISR;
 
-	if (huart->Instance == USART1) {
+	// error flags stop reception until cleared
+	if (isr & (USART_ISR_ORE | USART_ISR_FE | USART_ISR_NE)) {
+		u->ICR = USART_ICR_ORECF | USART_ICR_FECF | USART_ICR_NCF;
+	}
 
-		if (UART1_rxBuffer[0] != '#' && UART1_rxLog[1] != '#') {
-			uart_print(&USB_UART, (char*) UART1_rxBuffer); 	// print out character over USART1
+	if (isr & USART_ISR_RXNE) {
+		uint8_t b = (uint8_t)u->RDR;	// reading clears RXNE
+		if (r->head - r->tail < RX_RING) {
+			r->buf[r->head & (RX_RING - 1U)] = b;
+			r->head++;
+		} else {
+			r->dropped++;
 		}
-		uart_print(&huart6, (char*) UART1_rxBuffer); 	// print out character over USART6
+	}
+}
 
-		if (UART1_rxBuffer[0] == 27) {	// halt program
-			halt_program = 1;
-			return;
-		}
+void USART1_IRQHandler(void) {
+	rx_isr(USART1, &rx1);
+}
 
-		// log character
-		UART1_rxLog[0] = UART1_rxLog[1];
-		UART1_rxLog[1] = UART1_rxBuffer[0];
+void USART6_IRQHandler(void) {
+	rx_isr(USART6, &rx6);
+}
 
-		if (UART1_rxBuffer[0] != '#') {
-			// print new lines
-			uart_print(&USB_UART, nl);
-		}
+static void rx_enable(USART_TypeDef *u, IRQn_Type irq) {
+	u->ICR = USART_ICR_ORECF | USART_ICR_FECF | USART_ICR_NCF;
+	(void)u->RDR;
+	u->CR1 |= USART_CR1_RXNEIE;
+	u->CR3 |= USART_CR3_EIE;
+	HAL_NVIC_EnableIRQ(irq);
+}
 
-		// start of command
-		if (UART1_rxLog[0] == '#') {
-			command(UART1_rxLog[1], huart);
-		}
+static int rx_get(RxRing *r) {
+	if (r->tail == r->head) return -1;
+	int c = r->buf[r->tail & (RX_RING - 1U)];
+	r->tail++;
+	return c;
+}
 
-		// re-enable RX interrupt
-		HAL_UART_Receive_IT(&USB_UART, UART1_rxBuffer, 1);
+//------------------------------------
+// Main loop side
+//------------------------------------
+static void poll_port(Port *p, Port *fwd) {
+	int c;
 
-	} else if (huart->Instance == USART6) {
+	while ((c = rx_get(p->rx)) >= 0) {
+		char ch[2] = { (char)c, '\0' };
 
-		if (UART6_rxBuffer[0] != '#' && UART6_rxLog[1] != '#') {
-			uart_print(&USB_UART, (char*) UART6_rxBuffer); 	// print out character over UART1
+		if (fwd) uart_print(fwd->huart, ch);	// raw copy to the other port
+		if (c != '\r' && c != '\n') {
+			if (c == 0x08 || c == 0x7F) uart_print(&USB_UART, "\b \b");
+			else                        uart_print(&USB_UART, ch);
 		}
 
-		if (UART6_rxBuffer[0] == 27) {	// halt program
+		if (c == ESC) {	// halt program
 			halt_program = 1;
 			return;
 		}
 
-		// log character
-		UART6_rxLog[0] = UART6_rxLog[1];
-		UART6_rxLog[1] = UART6_rxBuffer[0];
-
-		if (UART6_rxBuffer[0] != '#') {
-			// print new lines
-			uart_print(&USB_UART, nl);
+		if (cmd_line_feed(&p->line, (char)c)) {
+			uart_print(&USB_UART, "\r\n");
+			int st = cmd_exec(&cmds, &p->line, p);
+			if (st < 0) printf("? %s\r\n", cmd_error_str(st));
 		}
-
-		// command entered
-		if (UART6_rxLog[0] == '#') {
-			command(UART6_rxLog[1], huart);
-		}
-
-		// re-enable RX interrupt
-		HAL_UART_Receive_IT(&huart6, UART6_rxBuffer, 1);
-
 	}
 }
 
 // terminal control commands
-void command(char c, UART_HandleTypeDef *huart) {
-	HAL_NVIC_DisableIRQ(USART1_IRQn);	// disable interrupts
-	switch (c) {
-		case 'c':	// clear terminal
-			char clr_terminal_str[] = "\033[2J\033[H";
-			uart_print(&USB_UART, clr_terminal_str);
-			break;
-		case 'e':	// end program
-			halt_program = 1;
-			return;
-			break;
-		case 'i':	// toggle LED LD3
-			if (huart->Instance == USART6) {
-				HAL_GPIO_TogglePin(GPIOA, GPIO_PIN_12);
-			}
-			break;
-	}
-	HAL_NVIC_EnableIRQ(USART1_IRQn);	// enable interrupt
+static void do_clear(const CmdArgs *a, void *ctx) {
+	(void)a;
+	(void)ctx;
+	char clr_terminal_str[] = "\033[2J\033[H";
+	uart_print(&USB_UART, clr_terminal_str);
+}
+
+static void do_exit(const CmdArgs *a, void *ctx) {
+	(void)a;
+	(void)ctx;
+	halt_program = 1;
 }
 
+static void do_help(const CmdArgs *a, void *ctx) {
+	(void)a;
+	(void)ctx;
+	for (int i = 0; i < cmds.count; i++) {
+		printf("  %-6s %s\r\n", cmd_entries[i].name, cmd_entries[i].help);
+	}
+}
 
+// num[1]: 1 on, 0 off, -1 toggle
+static int parse_led(CmdArgs *a) {
+	a->num[1] = -1;
+	if (a->argc == 1) return CMD_OK;
+	if (a->argc != 2) return CMD_ERR_ARGS;
+	if (strcmp(a->argv[1], "on") == 0)  { a->num[1] = 1; return CMD_OK; }
+	if (strcmp(a->argv[1], "off") == 0) { a->num[1] = 0; return CMD_OK; }
+	return CMD_ERR_ARGS;
+}
 
+// LD3 only answers to the USART6 side, as before
+static void do_led(const CmdArgs *a, void *ctx) {
+	const Port *p = ctx;
+	if (p->huart->Instance != USART6) return;
 
+	if (a->num[1] < 0) HAL_GPIO_TogglePin(GPIOA, GPIO_PIN_12);
+	else HAL_GPIO_WritePin(GPIOA, GPIO_PIN_12, a->num[1] ? GPIO_PIN_SET : GPIO_PIN_RESET);
+}
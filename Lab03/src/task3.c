@@ -1,15 +1,21 @@
 /***************************************************************
  * Lab 3 - Part 3: SPI loopback with live single-line panes
  * Shows each full sentence as a JSON-style array of strings (words)
+ * Keystrokes queue in a TX ring and cross SPI2 in DMA batches
+ * (spi_batch.c); only new characters are drawn on the live rows
  * Target: STM32F769I-DISCO (F7 HAL)
  ***************************************************************/
 #include "init.h"
 #include "stm32f7xx_hal.h"
 #include "uart.h"
+#include "console_tx.h"
+#include "word_array.h"
+#include "spi_batch.h"
+#include "spi_bus.h"
+#include "timebase.h"
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
-#include <ctype.h>
 
 /* ---- extern from your uart.c ---- */
 extern UART_HandleTypeDef USB_UART;
@@ -17,17 +23,19 @@ extern UART_HandleTypeDef USB_UART;
 /* ---- SPI2 handle ---- */
 SPI_HandleTypeDef hspi2;
 
+/* ---- Loopback settings, described like any device on spi_bus (task4's
+ * STaTS is one): mode 0, MSB first, ~1 MHz, no CS. The loopback streams
+ * through spi_batch rather than the bus engine, so only MX_SPI2_Init()
+ * reads this. ---- */
+static const SpiDevCfg loop_cfg = {
+  .csPort = NULL, .csPin = 0, .cpol = 0, .cpha = 0, .lsbFirst = 0, .maxHz = 1000000u };
+
 /* ==== Prototypes ==== */
 static void SPI2_MspInit_Pins(void);
 static void MX_SPI2_Init(void);
 static void UI_Init(void);
 static void UI_DrawHeader(void);
-static void UI_UpdateTopLive(const char* s);
-static void UI_UpdateBotLive(const char* s);
-static void UI_PrintTopArray(const char* s);
-static void UI_PrintBotArray(const char* s);
 static int  uart_getchar_nb(uint8_t* ch);
-static void tokenize_to_array(const char* line, char* out, size_t outsz);
 void Error_Handler(void);
 
 /* ====== Simple split terminal layout (ANSI) ====== */
@@ -35,15 +43,94 @@ void Error_Handler(void);
 #define TOP_ROW    4           /* live typing row */
 #define SEP_ROW    6
 #define BOT_ROW    8           /* live RX row */
+#define STATS_ROW  11          /* console_tx report (Ctrl-R) */
+#define BENCH_ROW  14          /* SPI throughput table (Ctrl-B) */
+#define KEY_CTRL_B 0x02
+#define KEY_CTRL_R 0x12
 
 static inline void ansi_move(int r, int c){ printf("\033[%d;%dH", r, c); }
 static inline void ansi_clear(void){ printf("\033[2J\033[H"); }
 static inline void ansi_clear_line(void){ printf("\033[2K"); }
+static inline void ansi_clear_eol(void){ printf("\033[K"); }
+
+/* ====== Line panes ======
+ * An RX line can be any length: its word array is encoded as the bytes
+ * arrive (word_array.c) and the live row keeps only the tail. A TX line
+ * stops at LIVE_MAX-1 characters, as before, so backspace always has the
+ * whole line to re-encode. ARRAY_MAX bounds the array; past it the array
+ * stays valid and the cut words are counted.
+ * The row shows line[view..shown); new characters are appended after it,
+ * and only scrolling by half a row (or a reset) redraws it. */
+#define LIVE_MAX  256
+#define ARRAY_MAX 1024
+#define LIVE_COLS (TERM_COLS - 16)   /* line characters that fit on a live row */
+
+typedef struct {
+  char      live[LIVE_MAX];     /* tail of the line for the live row */
+  size_t    live_len;
+  size_t    line_len;           /* whole line, may exceed LIVE_MAX */
+  size_t    view, shown;        /* line offsets on screen */
+  int       redraw;
+  char      arr[ARRAY_MAX];
+  WordArray wa;
+} Pane;
+
+static Pane tx_pane, rx_pane;
+
+static void UI_SyncLive(Pane* p, int row, const char* label);
+
+static void pane_reset(Pane* p)
+{
+  p->live_len = 0; p->live[0] = 0;
+  p->line_len = 0;
+  p->view = 0; p->shown = 0; p->redraw = 1;
+  word_array_begin(&p->wa, p->arr, sizeof(p->arr), NULL, NULL);
+}
 
-/* ====== Line buffers ====== */
-#define LINE_MAX 256
-static char tx_live[LINE_MAX];  static size_t tx_len = 0;
-static char rx_live[LINE_MAX];  static size_t rx_len = 0;
+static void pane_feed(Pane* p, const char* s, size_t n)
+{
+  word_array_feed(&p->wa, s, n);
+  p->line_len += n;
+  while (n) {
+    if (p->live_len == LIVE_MAX-1) {            /* keep the newer half */
+      memmove(p->live, p->live + LIVE_MAX/2, LIVE_MAX/2);
+      p->live_len = LIVE_MAX/2 - 1;
+    }
+    size_t k = LIVE_MAX-1 - p->live_len;
+    if (k > n) k = n;
+    memcpy(p->live + p->live_len, s, k);
+    p->live_len += k; s += k; n -= k;
+  }
+  p->live[p->live_len] = 0;
+}
+
+static void pane_putc(Pane* p, char c)
+{
+  pane_feed(p, &c, 1);
+}
+
+/* Backspace re-encodes the line from the live buffer; a TX line always
+ * fits there */
+static int pane_backspace(Pane* p)
+{
+  if (p->live_len == 0 || p->line_len != p->live_len) return 0;
+  p->live[--p->live_len] = 0;
+  p->line_len--;
+  word_array_begin(&p->wa, p->arr, sizeof(p->arr), NULL, NULL);
+  word_array_feed(&p->wa, p->live, p->live_len);
+  return 1;
+}
+
+/* Close the array, print it on row r, start the next line */
+static void pane_print_array(Pane* p, int r, const char* label)
+{
+  word_array_end(&p->wa);
+  ansi_move(r,1); ansi_clear_line();
+  printf("%s array: %s", label, p->arr);
+  if (p->wa.cut) printf("  (%lu of %lu words cut)", (unsigned long)p->wa.cut, (unsigned long)p->wa.words);
+  fflush(stdout);
+  pane_reset(p);
+}
 
 /* ============================================================
  * MSP: map SPI2 to PB13/PB14/PB15 (AF5)
@@ -65,19 +152,21 @@ static void SPI2_MspInit_Pins(void)
 }
 
 /* ============================================================
- * SPI2 init: 8-bit, Mode 0, ~1 MHz, NSS=SOFT
+ * SPI2 init: 8-bit, NSS=SOFT, the rest from loop_cfg
  * ============================================================ */
 static void MX_SPI2_Init(void)
 {
+  uint32_t br = spi_bus_prescaler(HAL_RCC_GetPCLK1Freq(), loop_cfg.maxHz);   // /64 at 54 MHz
+
   hspi2.Instance               = SPI2;
   hspi2.Init.Mode              = SPI_MODE_MASTER;
   hspi2.Init.Direction         = SPI_DIRECTION_2LINES;
   hspi2.Init.DataSize          = SPI_DATASIZE_8BIT;
-  hspi2.Init.CLKPolarity       = SPI_POLARITY_LOW;      // Mode 0
-  hspi2.Init.CLKPhase          = SPI_PHASE_1EDGE;       // Mode 0
+  hspi2.Init.CLKPolarity       = loop_cfg.cpol ? SPI_POLARITY_HIGH : SPI_POLARITY_LOW;
+  hspi2.Init.CLKPhase          = loop_cfg.cpha ? SPI_PHASE_2EDGE : SPI_PHASE_1EDGE;
   hspi2.Init.NSS               = SPI_NSS_SOFT;          // no CS for loopback
-  hspi2.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_64; // ~1 MHz if kernel ~64 MHz
-  hspi2.Init.FirstBit          = SPI_FIRSTBIT_MSB;
+  hspi2.Init.BaudRatePrescaler = br << SPI_CR1_BR_Pos;
+  hspi2.Init.FirstBit          = loop_cfg.lsbFirst ? SPI_FIRSTBIT_LSB : SPI_FIRSTBIT_MSB;
   hspi2.Init.TIMode            = SPI_TIMODE_DISABLE;
   hspi2.Init.CRCCalculation    = SPI_CRCCALCULATION_DISABLE;
   hspi2.Init.NSSPMode          = SPI_NSS_PULSE_DISABLE;
@@ -94,7 +183,7 @@ static void UI_DrawHeader(void)
   ansi_move(1,1);
   printf("=== Lab 3 Part 3: SPI2 Loopback (~1 MHz) — Live Panes & Word Arrays ===\r\n");
   printf("Pins: D13=PB13(SCK), D12=PB14(MISO), D11=PB15(MOSI)  |  Short D11 <-> D12\r\n");
-  printf("Top live (TX) — type your sentence, hit ENTER to freeze as an array\r\n");
+  printf("Top live (TX) — type, ENTER freezes the array  |  Ctrl-B SPI bench, Ctrl-R stats\r\n");
   ansi_move(SEP_ROW,1);
   for (int i=0;i<TERM_COLS;i++) putchar('-');
   ansi_move(SEP_ROW+1,1);
@@ -104,72 +193,145 @@ static void UI_DrawHeader(void)
 
 static void UI_Init(void)
 {
-  tx_len = rx_len = 0;
-  tx_live[0] = rx_live[0] = 0;
+  pane_reset(&tx_pane);
+  pane_reset(&rx_pane);
   UI_DrawHeader();
-  UI_UpdateTopLive("");
-  UI_UpdateBotLive("");
+  UI_SyncLive(&tx_pane, TOP_ROW, "TX");
+  UI_SyncLive(&rx_pane, BOT_ROW, "RX");
 }
 
-static void UI_UpdateTopLive(const char* s)
+/* Terminal column of line offset pos on a live row */
+static int live_col(const Pane* p, size_t pos)
 {
-  ansi_move(TOP_ROW,1); ansi_clear_line();
-  printf("TX live: %s", s);
-  fflush(stdout);
+  return 10 + (p->view ? 3 : 0) + (int)(pos - p->view);
 }
-static void UI_UpdateBotLive(const char* s)
+
+/* Bring the live row up to date: append what is new, clear what was
+ * erased, redraw only when the line runs off the row */
+static void UI_SyncLive(Pane* p, int row, const char* label)
 {
-  ansi_move(BOT_ROW,1); ansi_clear_line();
-  printf("RX live: %s", s);
+  size_t first = p->line_len - p->live_len;     /* line offset of live[0] */
+
+  if (p->redraw || p->line_len < p->view || p->line_len - p->view > LIVE_COLS
+      || p->view < first) {
+    p->view = p->line_len > LIVE_COLS/2 ? p->line_len - LIVE_COLS/2 : 0;
+    ansi_move(row,1); ansi_clear_line();
+    printf("%s live: %s%.*s", label, p->view ? "..." : "",
+           (int)(p->line_len - p->view), p->live + (p->view - first));
+    p->redraw = 0;
+  } else if (p->shown > p->line_len) {
+    ansi_move(row, live_col(p, p->line_len)); ansi_clear_eol();
+  } else if (p->shown < p->line_len) {
+    ansi_move(row, live_col(p, p->shown));
+    printf("%.*s", (int)(p->line_len - p->shown), p->live + (p->shown - first));
+  } else {
+    return;
+  }
+  p->shown = p->line_len;
   fflush(stdout);
 }
 
-static void UI_PrintTopArray(const char* s)
+/* ============================================================
+ * SPI2 RX: bytes back from the loopback, a batch at a time
+ * ============================================================ */
+static void spi_rx(const uint8_t* p, uint32_t n, void* ctx)
+{
+  (void)ctx;
+  uint32_t i = 0;
+  while (i < n) {
+    uint32_t j = i;
+    while (j < n && p[j] >= 32 && p[j] <= 126) j++;
+    if (j > i) { pane_feed(&rx_pane, (const char*)p + i, j - i); i = j; continue; }
+    if (p[i] == '\n') pane_print_array(&rx_pane, BOT_ROW+1, "RX");
+    i++;
+  }
+  UI_SyncLive(&rx_pane, BOT_ROW, "RX");
+}
+
+/* Queue bytes for SPI2; only waits if the TX ring is full */
+static void spi_send(const uint8_t* p, uint32_t n)
 {
-  char arr[LINE_MAX*2]; tokenize_to_array(s, arr, sizeof(arr));
-  ansi_move(TOP_ROW-1,1); ansi_clear_line();
-  printf("TX array: %s", arr);
-  fflush(stdout);
+  while (n) {
+    uint32_t k = spi_batch_write(&spi2_batch, p, n);
+    p += k; n -= k;
+    if (n) spi_batch_poll(&spi2_batch);
+  }
 }
-static void UI_PrintBotArray(const char* s)
+
+/* ============================================================
+ * Ctrl-B: sustained loopback throughput at every SPI2 prescaler,
+ * DMA batches vs the old one HAL_SPI_TransmitReceive per key
+ * ============================================================ */
+#define BENCH_BYTES 8192
+#define BENCH_HAL   512         /* the per-key path is slow, fewer bytes */
+
+typedef struct { uint32_t got, bad; } BenchRx;
+
+static void bench_rx(const uint8_t* p, uint32_t n, void* ctx)
 {
-  char arr[LINE_MAX*2]; tokenize_to_array(s, arr, sizeof(arr));
-  ansi_move(BOT_ROW+1,1); ansi_clear_line();
-  printf("RX array: %s", arr);
-  fflush(stdout);
+  BenchRx* b = (BenchRx*)ctx;
+  for (uint32_t i=0;i<n;i++) if (p[i] != (uint8_t)(b->got + i)) b->bad++;
+  b->got += n;
 }
 
-/* Convert "hello world 123" -> ["hello","world","123"] */
-static void tokenize_to_array(const char* line, char* out, size_t outsz)
+static void spi_bench(void)
 {
-  out[0] = 0;
-  strncat(out, "[", outsz-1);
-  const char* p=line;
-  while (*p && isspace((unsigned char)*p)) p++;
+  static const uint32_t br[] = {
+    SPI_BAUDRATEPRESCALER_2,  SPI_BAUDRATEPRESCALER_4,  SPI_BAUDRATEPRESCALER_8,
+    SPI_BAUDRATEPRESCALER_16, SPI_BAUDRATEPRESCALER_32, SPI_BAUDRATEPRESCALER_64,
+    SPI_BAUDRATEPRESCALER_128, SPI_BAUDRATEPRESCALER_256 };
+  uint64_t hz = (uint64_t)tb_cycles_per_us() * 1000000u;
+  uint32_t pclk = HAL_RCC_GetPCLK1Freq();
+  uint8_t chunk[64];
 
-  int first=1;
-  while (*p)
-  {
-    /* extract token */
-    char tok[LINE_MAX]; size_t tlen=0;
-    while (*p && !isspace((unsigned char)*p) && tlen < LINE_MAX-1)
-      tok[tlen++] = *p++;
-    tok[tlen] = 0;
-
-    if (tlen>0) {
-      if (!first) strncat(out, ",", outsz-1);
-      strncat(out, "\"", outsz-1);
-      /* escape quotes/backslashes if needed */
-      for (size_t i=0;i<tlen;i++){
-        if (tok[i]=='\"' || tok[i]=='\\') strncat(out, "\\", outsz-1);
-        char tmp[2]={tok[i],0}; strncat(out, tmp, outsz-1);
+  ansi_move(BENCH_ROW,1); printf("\033[J");
+  printf("SPI2 loopback, %u chars per run (DMA) / %u (HAL), PCLK1 %lu kHz\r\n",
+         BENCH_BYTES, BENCH_HAL, (unsigned long)(pclk/1000));
+  printf("  SCK kHz   wire ch/s  batched ch/s  avg batch  per-key HAL ch/s  errors\r\n");
+  console_tx_flush();
+
+  for (unsigned k=0;k<sizeof(br)/sizeof(br[0]);k++) {
+    uint32_t sck = pclk >> (k+1);
+    BenchRx b = {0,0};
+    SpiBatchStats st0 = spi2_batch.st;
+
+    spi_batch_hw_prescaler(br[k]);
+    spi_batch_hook(&spi2_batch, bench_rx, &b);
+
+    /* Writer fills the ring as fast as it can; batches grow to match */
+    uint32_t sent = 0, t0 = tb_cycles();
+    while (sent < BENCH_BYTES || spi_batch_pending(&spi2_batch)) {
+      if (sent < BENCH_BYTES) {
+        uint32_t n = BENCH_BYTES - sent;
+        if (n > sizeof(chunk)) n = sizeof(chunk);
+        for (uint32_t i=0;i<n;i++) chunk[i] = (uint8_t)(sent + i);
+        sent += spi_batch_write(&spi2_batch, chunk, n);
       }
-      strncat(out, "\"", outsz-1);
-      first=0;
+      spi_batch_poll(&spi2_batch);
+    }
+    uint32_t dma = tb_cycles() - t0;
+    uint32_t batches = spi2_batch.st.batches - st0.batches;
+    b.bad += BENCH_BYTES - b.got;                       /* dropped batches */
+
+    spi_batch_hw_stop();
+    t0 = tb_cycles();
+    for (uint32_t i=0;i<BENCH_HAL;i++) {
+      uint8_t tx = (uint8_t)i, rx = 0;
+      if (HAL_SPI_TransmitReceive(&hspi2, &tx, &rx, 1, 5) != HAL_OK || rx != tx) b.bad++;
     }
-    while (*p && isspace((unsigned char)*p)) p++;
+    uint32_t hal = tb_cycles() - t0;
+    spi_batch_hw_start();
+
+    printf("  %7lu  %10lu  %12lu  %9lu  %16lu  %6lu\r\n",
+           (unsigned long)(sck/1000), (unsigned long)(sck/8),
+           (unsigned long)(BENCH_BYTES*hz/dma),
+           (unsigned long)(batches ? BENCH_BYTES/batches : 0),
+           (unsigned long)(BENCH_HAL*hz/hal), (unsigned long)b.bad);
+    fflush(stdout);
   }
-  strncat(out, "]", outsz-1);
+
+  spi_batch_hw_prescaler(hspi2.Init.BaudRatePrescaler);
+  spi_batch_hook(&spi2_batch, spi_rx, NULL);
 }
 
 /* ============================================================
@@ -186,63 +348,63 @@ static int uart_getchar_nb(uint8_t* ch)
 int main(void)
 {
   Sys_Init();              // clocks + USB_UART for printf
+  tb_init();               // DWT cycles for the benchmark
+  console_tx_init();       // printf queues, USART1 TX drains on DMA
   SPI2_MspInit_Pins();     // PB13/PB14/PB15 -> AF5
   MX_SPI2_Init();          // SPI ready
+  spi_batch_hw_init();     // SPI2 now runs on DMA1 S3/S4
+  spi_batch_hook(&spi2_batch, spi_rx, NULL);
   UI_Init();
 
   for (;;)
   {
-    /* 1) Read from keyboard (non-blocking) */
+    /* 1) Retire a finished SPI batch (RX pane gets it), start the next */
+    spi_batch_poll(&spi2_batch);
+
+    /* 2) Read from keyboard (non-blocking) */
     uint8_t c;
     if (uart_getchar_nb(&c))
     {
+      /* Ctrl-R: show console output cost / buffer stats */
+      if (c==KEY_CTRL_R) {
+        const SpiBatchStats* st = &spi2_batch.st;
+        ansi_move(STATS_ROW,1); ansi_clear_line();
+        console_tx_report();
+        ansi_move(STATS_ROW+1,1); ansi_clear_line();
+        printf("SPI2: %lu bytes in %lu batches (max %lu), ring peak %lu, %lu errors",
+               (unsigned long)st->txBytes, (unsigned long)st->batches,
+               (unsigned long)st->maxBatch, (unsigned long)st->maxFill,
+               (unsigned long)st->errors);
+        fflush(stdout);
+        continue;
+      }
+
+      if (c==KEY_CTRL_B) { spi_bench(); continue; }
+
       /* Handle backspace */
-      if ((c==0x08 || c==0x7F) && tx_len>0) {
-        tx_live[--tx_len]=0;
-        UI_UpdateTopLive(tx_live);
-        /* still send the raw byte over SPI to keep SPI busy, optional: skip */
+      if (c==0x08 || c==0x7F) {
+        if (pane_backspace(&tx_pane)) UI_SyncLive(&tx_pane, TOP_ROW, "TX");
         continue;
       }
 
       /* End-of-line? Treat CR or LF as "send line" */
       if (c=='\r' || c=='\n') {
         /* freeze & print TX word array */
-        UI_PrintTopArray(tx_live);
+        pane_print_array(&tx_pane, TOP_ROW-1, "TX");
+        UI_SyncLive(&tx_pane, TOP_ROW, "TX");
 
-        /* also terminate TX line for SPI peer */
+        /* terminate the line for the SPI peer; the RX array is printed
+         * when the '\n' comes back */
         uint8_t eol = '\n';
-        uint8_t dummy;
-        HAL_SPI_TransmitReceive(&hspi2, &eol, &dummy, 1, 5);
-
-        /* if we already have RX line pending, print its array too */
-        if (rx_len>0) { UI_PrintBotArray(rx_live); rx_len=0; rx_live[0]=0; UI_UpdateBotLive(rx_live); }
-
-        /* reset TX line for next sentence */
-        tx_len=0; tx_live[0]=0; UI_UpdateTopLive(tx_live);
+        spi_send(&eol, 1);
         continue;
       }
 
-      /* Append printable char to TX live line */
-      if (tx_len < LINE_MAX-1 && (c>=32 && c<=126)) {
-        tx_live[tx_len++] = (char)c; tx_live[tx_len]=0;
-        UI_UpdateTopLive(tx_live);
-      }
-
-      /* 2) Send on SPI and receive simultaneously (loopback returns same byte) */
-      uint8_t rx=0;
-      (void)HAL_SPI_TransmitReceive(&hspi2, &c, &rx, 1, 5);
-
-      /* Append received printable to RX live line; on EOL, print array */
-      if (rx=='\r') { /* ignore */ }
-      else if (rx=='\n') {
-        UI_PrintBotArray(rx_live);
-        rx_len=0; rx_live[0]=0;
-        UI_UpdateBotLive(rx_live);
-      } else if (rx>=32 && rx<=126) {
-        if (rx_len < LINE_MAX-1) {
-          rx_live[rx_len++] = (char)rx; rx_live[rx_len]=0;
-          UI_UpdateBotLive(rx_live);
-        }
+      /* Append printable char to TX live line and queue it for SPI */
+      if (tx_pane.line_len < LIVE_MAX-1 && (c>=32 && c<=126)) {
+        pane_putc(&tx_pane, (char)c);
+        UI_SyncLive(&tx_pane, TOP_ROW, "TX");
+        spi_send(&c, 1);
       }
     }
 
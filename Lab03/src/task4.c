@@ -8,6 +8,11 @@
  *
  * Protocol:
  *  - 2 bytes per transaction, CS low across both bytes
+ *  - transactions are queued (stats_txn.c) as frames of the STaTS
+ *    device on the SPI2 bus (spi_bus.c) and run from DMA/TIM7
+ *    interrupts; results come back in callbacks, the loop never waits
+ *  - STS/DIG/VERSION/DEVID are shadowed (stats_cache.c); STS comes
+ *    free with every transfer, so most reads of it never go out
  *  - LSB-first on SPI (physical), Mode per init (kept as you had it)
  *  - TX[0] header (fields as per your enum remap),
  *    TX[1] data (ignored on reads)
@@ -16,22 +21,27 @@
 #include "init.h"
 #include "stm32f7xx_hal.h"
 #include "uart.h"
+#include "timebase.h"
+#include "spi_bus.h"
+#include "stats_txn.h"
+#include "stats_cache.h"
+#include "stats_rx.h"
+#include "stats_temp.h"
+#include "stats_regs.h"
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
 
 /* ============ Tuning ============ */
-#define RX_POLL_MS   25u   /* how often we poll CH_BUF (RX) when idle */
 #define STS_POLL_MS  80u   /* how often we poll STS/DIG + mirror LD3 */
+#define BENCH_OPS    1000u /* 'b': back-to-back VERSION reads */
+/* CH_BUF (RX) polling adapts between STATS_RX_FAST_US and STATS_RX_IDLE_US (stats_rx.h) */
 
 /* Which DPx bit to mirror to LD3 (read from DIG_REG). Default: DP2 */
 #ifndef STATS_DPX_MASK
 #define STATS_DPX_MASK (1u<<2)
 #endif
 
-/* Temp conversion: °C = 357.6 − 0.187 * raw12 (TMP_HI:TMP_LO, right-justified 12-bit) */
-static inline float stats_raw_to_degC(uint16_t v){ return 357.6f - 0.187f * (float)v; }
-
 /* extern from your uart.c */
 extern UART_HandleTypeDef USB_UART;
 
@@ -39,47 +49,8 @@ extern UART_HandleTypeDef USB_UART;
 static SPI_HandleTypeDef hspi2;
 #define CS_GPIO_Port   GPIOA          /* D10 -> STaTS A2 */
 #define CS_Pin         GPIO_PIN_11
-#define CS_LOW()       HAL_GPIO_WritePin(CS_GPIO_Port, CS_Pin, GPIO_PIN_RESET)
 #define CS_HIGH()      HAL_GPIO_WritePin(CS_GPIO_Port, CS_Pin, GPIO_PIN_SET)
 
-/* tiny CS setup/hold delays */
-static inline void delay_cycles(volatile uint32_t n){ while(n--) __NOP(); }
-#define CS_SETUP_DELAY()  delay_cycles(150)
-#define CS_HOLD_DELAY()   delay_cycles(150)
-
-/* ===== STaTS register numbers (bit-reversed nibble mapping you provided) ===== */
-enum {
-  REG_CTL     = 0,
-  REG_STS     = 8,
-  REG_DIG     = 4,
-  REG_TMP_AVG = 12,
-  REG_TMP_LO  = 2,
-  REG_TMP_HI  = 10,
-  REG_CH_BUF  = 6,
-  REG_TXT_ATTR= 14,
-  REG_VERSION = 1,
-  REG_DEVID   = 9
-};
-
-/* CTL_REG bits */
-#define CTL_RST      (1u<<0)
-#define CTL_RDTMP    (1u<<1)
-#define CTL_TRMCLR   (1u<<2)
-#define CTL_TRMRST   (1u<<3)
-#define CTL_CHBCLR   (1u<<4)
-#define CTL_LGT_TGL  (1u<<5)
-#define CTL_ULKDID   (1u<<7)
-
-/* STS_REG bits */
-#define STS_RDY      (1u<<0)
-#define STS_DIG      (1u<<1)
-#define STS_LGT_ON   (1u<<2)
-#define STS_TBUSY    (1u<<3)
-#define STS_TRDY     (1u<<4)
-#define STS_NCHBF0   (1u<<5)
-#define STS_NCHBF1   (1u<<6)
-#define STS_CHBOV    (1u<<7)
-
 /* ===== UART non-blocking getchar ===== */
 static int uart_getchar_nb(uint8_t* ch)
 {
@@ -140,167 +111,313 @@ static void MX_SPI2_Init(void)
   if (HAL_SPI_Init(&hspi2) != HAL_OK) { __disable_irq(); while(1){} }
 }
 
-/* ===== 2-byte STaTS transfer =====
-   tx[0] = header (built from we + reg)
-   tx[1] = data (dummy for read)
-   rx[0] = STS during header
-   rx[1] = REG value (read) / previous (write)
-*/
-static HAL_StatusTypeDef stats_xfer(uint8_t we, uint8_t reg, uint8_t din,
-                                    uint8_t* out_sts, uint8_t* out_data)
+/* ===== High-level ops =====
+   Each queues one or more transactions and returns at once; the
+   callbacks run from stats_txn_poll() in the main loop, in order.
+   op->sts = STS during the header, op->data = REG value (read) /
+   previous value (write). Writes go through the cache so it can
+   drop what they make stale. The STaTS is one device on spi2_bus;
+   its mode, bit order and /256 are set in stats_txn_init(). */
+static StatsTxn stats_txn;
+#define TXN (&stats_txn)
+
+static StatsCache cache;
+
+static int stats_tx_char(uint8_t ch) { return stats_cache_write(&cache, REG_CH_BUF, ch, NULL, NULL); }
+
+/* CH_BUF pops: bursts sized from NCHBF, run back to back (stats_rx.c) */
+static StatsRx rx;
+static uint32_t rx_ovf_shown;
+
+static void on_rx_char(uint8_t r, void* ctx)
+{
+  (void)ctx;
+  if (r=='\r' || r=='\n') printf("[RX] \\n\r\n");
+  else if (r>=32 && r<=126) printf("[RX] 0x%02X '%c'\r\n", r, r);
+  else printf("[RX] 0x%02X\r\n", r);
+}
+
+static void stats_poll_rx(void)
 {
-  uint8_t tx[2], rx[2];
-  tx[0] = (uint8_t)((we ? 1u : 0u) | ((reg & 0x0Fu) << 1));
-  tx[1] = din;
+  stats_rx_poll(&rx);
+  if (rx.st.overflows != rx_ovf_shown) {
+    rx_ovf_shown = rx.st.overflows;
+    printf("[RX] CH_BUF overflow, bytes lost (%lu so far)\r\n", (unsigned long)rx_ovf_shown);
+  }
+}
 
-  CS_LOW(); CS_SETUP_DELAY();
-  HAL_StatusTypeDef s = HAL_SPI_TransmitReceive(&hspi2, tx, rx, 2, 30); /* <-- size = 2 bytes */
-  CS_HOLD_DELAY(); CS_HIGH();
+/* Poll cycle: one DIG read. Its header byte is STS, which is all the
+   NCHBF report and the LD3 mirror need, so the STS + DIG + STS reads
+   this used to take are one transaction (none while both are still
+   fresh in the cache). The toggle, when needed, is a second. */
+static uint32_t poll_cycles, poll_txns;
 
-  if (out_sts)  *out_sts  = rx[0];
-  if (out_data) *out_data = rx[1];
-  return s;
+static void stats_poll_report(uint8_t sts_val)
+{
+  static uint8_t last_nchbf = 0xFF;
+  uint8_t nchbf = (uint8_t)((sts_val >> 5) & 0x03);
+  if (nchbf != last_nchbf) {
+    printf("[STS] NCHBF=%u%s%s%s\r\n",
+           (unsigned)nchbf,
+           (sts_val & STS_DIG)? " DIG": "",
+           (sts_val & STS_TRDY)? " TRDY": "",
+           (sts_val & STS_CHBOV)? " CHBOV": "");
+    last_nchbf = nchbf;
+  }
 }
 
-static uint8_t stats_read_reg(uint8_t reg, uint8_t* val, uint8_t* sts)
+/* DPx -> LD3: queue the toggle if the light disagrees */
+static void stats_mirror_ld3(uint8_t dig, uint8_t sts_val)
 {
-  uint8_t s=0, d=0;
-  if (stats_xfer(0, reg, 0x00, &s, &d) != HAL_OK) return 0;
-  if (val) *val = d;
-  if (sts) *sts = s;
-  return 1;
+  uint8_t want_on = (dig & STATS_DPX_MASK) ? 1u : 0u;
+  uint8_t is_on   = (sts_val & STS_LGT_ON) ? 1u : 0u;
+  if (want_on != is_on && stats_cache_write(&cache, REG_CTL, CTL_LGT_TGL, NULL, NULL))
+    poll_txns++;
 }
-static uint8_t stats_write_reg(uint8_t reg, uint8_t val, uint8_t* prev, uint8_t* sts)
+
+static void on_poll_dig(const StatsOp* op, void* ctx)
 {
-  uint8_t s=0, d=0;
-  if (stats_xfer(1, reg, val, &s, &d) != HAL_OK) return 0;
-  if (prev) *prev = d;
-  if (sts)  *sts  = s;
-  return 1;
+  (void)ctx;
+  if (op->status != STATS_TXN_OK) return;
+  stats_poll_report(op->sts);
+  stats_mirror_ld3(op->data, op->sts);
 }
 
-/* ===== High-level ops ===== */
-static void   stats_tx_char(uint8_t ch) { (void)stats_write_reg(REG_CH_BUF, ch, NULL, NULL); }
+static void stats_poll_cycle(void)
+{
+  uint8_t dig, sts_val;
+  poll_cycles++;
+  if (stats_cache_get(&cache, REG_DIG, &dig) && stats_cache_get(&cache, REG_STS, &sts_val)) {
+    stats_poll_report(sts_val);
+    stats_mirror_ld3(dig, sts_val);
+  } else if (stats_cache_read(&cache, REG_DIG, on_poll_dig, NULL)) {
+    poll_txns++;
+  }
+}
 
-static int    stats_try_rx_char(uint8_t* out)
+static void print_version(uint8_t v, const char* tail)
 {
-  uint8_t v=0;
-  if (!stats_read_reg(REG_CH_BUF,&v,NULL) || v==0x00) return 0;
-  *out = v; return 1;
+  printf("FW version %u.%u%s", (unsigned)((v>>4)&0x0F), (unsigned)(v & 0x0F), tail);
 }
 
-static void   stats_mirror_ld3(void)
+static void on_version(const StatsOp* op, void* ctx)
 {
-  uint8_t dpx_val=0, sts_dummy=0;
-  if (!stats_read_reg(REG_DIG, &dpx_val, &sts_dummy)) return;
-  uint8_t want_on = (dpx_val & STATS_DPX_MASK) ? 1u : 0u;
+  const char* tail = (const char*)ctx;
+  if (op->status == STATS_TXN_OK) print_version(op->data, tail);
+  else                            printf("FW read failed%s", tail);
+}
 
-  uint8_t sts_val=0;
-  (void)stats_read_reg(REG_STS, &sts_val, NULL);  /* read value byte only */
-  uint8_t is_on = (sts_val & STS_LGT_ON) ? 1u : 0u;
+/* VERSION never changes: only the first one goes out */
+static int stats_read_version(const char* tail)
+{
+  uint8_t v;
+  if (stats_cache_get(&cache, REG_VERSION, &v)) { print_version(v, tail); return 1; }
+  return stats_cache_read(&cache, REG_VERSION, on_version, (void*)tail);
+}
+
+/* Temperature: sampled in the background (stats_temp.c), every
+   STATS_TEMP_PERIOD_US; 't' turns it on/off, 'r' shows the latest.
+   °C = 357.6 − 0.187 * raw12, kept in milli-degrees */
+static StatsTemp temp;
 
-  if (want_on != is_on) (void)stats_write_reg(REG_CTL, CTL_LGT_TGL, NULL, NULL);
+static void print_mdeg(int32_t m)
+{
+  int32_t t10 = (m + (m >= 0 ? 50 : -50)) / 100;     /* round to 0.1°C */
+  int32_t a10 = t10 < 0 ? -t10 : t10;
+  printf("%s%ld.%ld C", t10 < 0 ? "-" : "", (long)(a10 / 10), (long)(a10 % 10));
 }
 
-static uint8_t stats_read_version(uint8_t* major, uint8_t* minor)
+static void stats_show_temp(void)
 {
-  uint8_t v=0; if(!stats_read_reg(REG_VERSION,&v,NULL)) return 0;
-  if (major) *major = (uint8_t)((v>>4)&0x0F);
-  if (minor) *minor = (uint8_t)(v & 0x0F);
-  return 1;
+  if (!stats_temp_ready(&temp)) { printf("%60s Temp: no sample yet\r\n> ", ""); return; }
+  printf("%60s Temp = ", "");
+  print_mdeg(stats_temp_last_mdeg(&temp));
+  printf(", avg ");
+  print_mdeg(stats_temp_avg_mdeg(&temp));
+  printf("\r\n> ");
 }
 
-static void   stats_trigger_temp(void) { (void)stats_write_reg(REG_CTL, CTL_RDTMP, NULL, NULL); }
+static int stats_clear_terminal(uint8_t reset_attrs)
+{ return stats_cache_write(&cache, REG_CTL, reset_attrs ? CTL_TRMRST : CTL_TRMCLR, NULL, NULL); }
 
-/* Robust temp read: check TRDY from value byte, then read LO/HI and convert */
-static int    stats_try_read_temp(float* outC)
+static void on_devid(const StatsOp* op, void* ctx)
 {
-  uint8_t sts_val = 0;
-  if (!stats_read_reg(REG_STS, &sts_val, NULL) || !(sts_val & STS_TRDY))
-    return 0;
+  (void)ctx;
+  if (op->status == STATS_TXN_OK) printf("Device ID now 0x%02X\r\n> ", op->data);
+  else                            printf("ID read failed\r\n> ");
+}
 
-  uint8_t lo=0, hi=0;
-  if (!stats_read_reg(REG_TMP_LO, &lo, NULL)) return 0;
-  if (!stats_read_reg(REG_TMP_HI, &hi, NULL)) return 0;  /* reading HI clears TRDY */
+/* Unlock, write, read back: three transactions in one burst */
+static int stats_set_devid(uint8_t id)
+{
+  return stats_cache_write(&cache, REG_CTL, CTL_ULKDID, NULL, NULL)
+      && stats_cache_write(&cache, REG_DEVID, id, NULL, NULL)
+      && stats_cache_read(&cache, REG_DEVID, on_devid, NULL);
+}
 
-  uint16_t raw = (uint16_t)((((uint16_t)hi) << 8) | lo) & 0x0FFFu;
-  if (outC) *outC = stats_raw_to_degC(raw);
-  return 1;
+/* ===== 's': transaction counts ===== */
+static void show_txn_stats(void)
+{
+  static const char* const names[16] = {
+    [REG_CTL] = "CTL", [REG_STS] = "STS", [REG_DIG] = "DIG", [REG_TMP_AVG] = "TMP_AVG",
+    [REG_TMP_LO] = "TMP_LO", [REG_TMP_HI] = "TMP_HI", [REG_CH_BUF] = "CH_BUF",
+    [REG_TXT_ATTR] = "TXT_ATTR", [REG_VERSION] = "VERSION", [REG_DEVID] = "DEVID" };
+  const StatsCacheStats* cs = &cache.st;
+  uint32_t per100 = poll_cycles ? poll_txns * 100u / poll_cycles : 0;
+
+  printf("%lu transactions, %lu errors:", (unsigned long)stats_txn.st.ops, (unsigned long)stats_txn.st.errors);
+  for (int r = 0; r < 16; r++)
+    if (cs->busOps[r]) printf(" %s %lu", names[r] ? names[r] : "?", (unsigned long)cs->busOps[r]);
+  printf("\r\npoll: %lu cycles, %lu.%02lu txn/cycle (was 3 + toggles)\r\n",
+         (unsigned long)poll_cycles, (unsigned long)(per100 / 100u), (unsigned long)(per100 % 100u));
+  printf("cache: %lu hits, %lu misses, STS free from %lu transfers, %lu CTL invalidations\r\n",
+         (unsigned long)cs->hits, (unsigned long)cs->misses,
+         (unsigned long)cs->stsFree, (unsigned long)cs->invalidations);
+  printf("rx: %lu bytes in %lu pops (%lu empty), longest burst %lu, %lu overflows, polling every %lu us\r\n",
+         (unsigned long)rx.st.bytes, (unsigned long)rx.st.pops, (unsigned long)rx.st.empty,
+         (unsigned long)rx.st.maxBurst, (unsigned long)rx.st.overflows, (unsigned long)rx.intervalUs);
+
+  /* Sampler rate and its share of the bus: each transaction holds SPI2
+     for CS setup + 16 SCK + hold + gap */
+  const StatsTempStats* ts = &temp.st;
+  uint64_t el = tb_now_us() - temp.enabledUs;
+  uint32_t txn_us = STATS_CS_SETUP_US + STATS_CS_HOLD_US + STATS_CS_GAP_US
+                  + 16u * 1000000u / (HAL_RCC_GetPCLK1Freq() / 256u);
+  uint32_t sps100  = el ? (uint32_t)((uint64_t)ts->samples * 100000000u / el) : 0;
+  uint32_t bus1000 = el ? (uint32_t)((uint64_t)ts->txns * txn_us * 100000u / el) : 0;
+  printf("temp: %lu samples, %lu.%02lu/s, %lu txn (%lu STS checks), bus %lu.%03lu%%, "
+         "TMP_AVG %lu/%lu match sum/8>>4 (assumed), %lu not ready, %lu timeouts\r\n> ",
+         (unsigned long)ts->samples, (unsigned long)(sps100 / 100u), (unsigned long)(sps100 % 100u),
+         (unsigned long)ts->txns, (unsigned long)ts->stsReads,
+         (unsigned long)(bus1000 / 1000u), (unsigned long)(bus1000 % 1000u),
+         (unsigned long)(ts->avgChecks - ts->avgMismatch), (unsigned long)ts->avgChecks,
+         (unsigned long)ts->notReady, (unsigned long)ts->timeouts);
 }
 
-static void   stats_clear_terminal(uint8_t reset_attrs)
-{ (void)stats_write_reg(REG_CTL, reset_attrs ? CTL_TRMRST : CTL_TRMCLR, NULL, NULL); }
+/* ===== 'b': transaction throughput =====
+   Keeps the queue topped up with VERSION reads until BENCH_OPS are done;
+   the main loop keeps running (and counting passes) meanwhile. */
+static uint8_t  bench_on;
+static uint32_t bench_left, bench_done, bench_loops;
+static uint64_t bench_t0;
+static uint32_t bench_cyc0;
+static StatsTxnStats bench_st0;
+static SpiBusStats   bench_bus0;
+
+static void on_bench(const StatsOp* op, void* ctx)
+{
+  (void)op; (void)ctx;
+  if (++bench_done < BENCH_OPS) return;
+  bench_on = 0;
+
+  uint32_t us   = (uint32_t)(tb_now_us() - bench_t0);
+  uint32_t isr  = spi_bus_hw_isr_cycles() - bench_cyc0;
+  uint32_t sck  = HAL_RCC_GetPCLK1Freq() / 256u;
+  const StatsTxnStats* st = &stats_txn.st;
+  const SpiBusStats* bs = &spi2_bus.st;
+
+  printf("%u transactions in %lu us: %lu txn/s, %lu.%02lu us each (wire %lu us)\r\n",
+         BENCH_OPS, (unsigned long)us,
+         (unsigned long)((uint64_t)BENCH_OPS * 1000000u / us),
+         (unsigned long)(us / BENCH_OPS), (unsigned long)(us % BENCH_OPS * 100u / BENCH_OPS),
+         (unsigned long)(16u * 1000000u / sck));
+  printf("CPU in engine IRQs %lu cycles/txn, %lu main-loop passes, %lu bursts, %lu chained, %lu errors\r\n> ",
+         (unsigned long)(isr / BENCH_OPS), (unsigned long)bench_loops,
+         (unsigned long)(bs->bursts - bench_bus0.bursts),
+         (unsigned long)(bs->chained - bench_bus0.chained),
+         (unsigned long)(st->errors - bench_st0.errors));
+}
 
-static void   stats_set_devid(uint8_t id)
-{ (void)stats_write_reg(REG_CTL, CTL_ULKDID, NULL, NULL); (void)stats_write_reg(REG_DEVID, id, NULL, NULL); }
+static void bench_start(void)
+{
+  if (bench_on) return;
+  bench_on = 1;
+  bench_left = BENCH_OPS; bench_done = 0; bench_loops = 0;
+  bench_st0 = stats_txn.st;
+  bench_bus0 = spi2_bus.st;
+  bench_cyc0 = spi_bus_hw_isr_cycles();
+  bench_t0 = tb_now_us();
+}
 
-static uint8_t stats_get_devid(void)
-{ uint8_t v=0; (void)stats_read_reg(REG_DEVID,&v,NULL); return v; }
+static void bench_feed(void)
+{
+  if (!bench_on) return;
+  bench_loops++;
+  while (bench_left && stats_txn_read(TXN, REG_VERSION, on_bench, NULL)) bench_left--;
+}
 
 /* ===== Menu ===== */
 static void show_menu(void)
 {
   printf("\r\n--- STaTS Menu ---\r\n");
   printf(" v: read version\r\n");
-  printf(" t: trigger temperature\r\n");
-  printf(" r: read temperature (prints on right)\r\n");
+  printf(" t: temperature sampling on/off\r\n");
+  printf(" r: show temperature (prints on right)\r\n");
   printf(" x: clear terminal (keep attrs)\r\n");
   printf(" X: reset terminal (clear attrs)\r\n");
   printf(" i: set ID=0x42 then read back\r\n");
+  printf(" b: transaction throughput (%u reads)\r\n", BENCH_OPS);
+  printf(" s: transaction / cache / rx counts\r\n");
   printf(" q: quit menu\r\n> ");
 }
 
 static void handle_menu(uint8_t k)
 {
+  int ok = 1;
   if (k=='v'){
-    uint8_t maj=0, min=0;
-    if (stats_read_version(&maj,&min)) printf("FW version %u.%u\r\n> ", maj, min);
-    else                                printf("FW read failed\r\n> ");
+    ok = stats_read_version("\r\n> ");
   } else if (k=='t'){
-    stats_trigger_temp(); printf("Temp conversion started\r\n> ");
+    stats_temp_enable(&temp, !temp.on, 0);
+    printf("Temp sampling %s\r\n> ", temp.on ? "on" : "off");
   } else if (k=='r'){
-	  float c;
-	  if (stats_try_read_temp(&c)) {
-	    int32_t t10 = (int32_t)(c * 10.0f + (c >= 0 ? 0.5f : -0.5f)); // round to 0.1°C
-	    int32_t whole = t10 / 10;
-	    int32_t frac  = (t10 < 0 ? -t10 : t10) % 10;
-	    printf("%60s Temp = %ld.%ld C\r\n> ", "", (long)whole, (long)frac);
-	  } else {
-	    printf("%60s Temp not ready\r\n> ", "");}
-	  } else if (k=='x'){
-    stats_clear_terminal(0); printf("Cleared\r\n> ");
+    stats_show_temp();
+  } else if (k=='x'){
+    if ((ok = stats_clear_terminal(0))) printf("Cleared\r\n> ");
   } else if (k=='X'){
-    stats_clear_terminal(1); printf("Reset\r\n> ");
+    if ((ok = stats_clear_terminal(1))) printf("Reset\r\n> ");
   } else if (k=='i'){
-    stats_set_devid(0x42);
-    printf("Device ID now 0x%02X\r\n> ", stats_get_devid());
+    ok = stats_set_devid(0x42);
+  } else if (k=='b'){
+    bench_start();
+  } else if (k=='s'){
+    show_txn_stats();
   } else {
     printf("(unknown)\r\n> ");
   }
+  if (!ok) printf("(busy, try again)\r\n> ");
 }
 
 /* ===== MAIN ===== */
 int main(void)
 {
   Sys_Init();
+  tb_init();
   GPIO_SPI2_Msp();
   MX_SPI2_Init();
+  spi_bus_hw_init();                         /* SPI2 on DMA1, CS timing on TIM7 */
+  stats_txn_init(TXN, &spi2_bus, CS_GPIO_Port, CS_Pin, HAL_RCC_GetPCLK1Freq() / 256u);
+  stats_cache_init(&cache, TXN, tb_now_us);
+  stats_rx_init(&rx, TXN, &cache, tb_now_us, on_rx_char, NULL);
+  stats_temp_init(&temp, TXN, &cache, tb_now_us);
+  stats_temp_enable(&temp, 1, STATS_TEMP_PERIOD_US);
 
   printf("\r\n=== Task 4: STaTS controller (SPI2) ===\r\n");
   printf("Wiring: PA12->A3(SCK) PB15->A5(SDI/MOSI) PB14->A4(SDO/MISO) PA11->A2(CS) 3V3/GND\r\n");
   printf("Type to send; ESC shows menu. DPx->LD3 mirroring is automatic.\r\n");
 
-  /* read FW on startup */
-  uint8_t maj=0, min=0;
-  if (stats_read_version(&maj,&min)) printf("FW version: %u.%u\r\n", maj, min);
-  else                                printf("FW read failed\r\n");
+  /* read FW on startup (printed by the callback) */
+  (void)stats_read_version("\r\n");
 
-  uint32_t last_poll_ms = 0, last_rx_ms = 0;
+  uint64_t next_poll_us = 0;   /* deadline on the us time base */
   int in_menu = 0;
-  static uint8_t last_nchbf = 0xFF;
 
   for (;;)
   {
+    /* finished transactions -> their callbacks */
+    stats_txn_poll(TXN);
+    bench_feed();
+    stats_temp_poll(&temp);
+
     /* keyboard -> STaTS (TX) */
     uint8_t c;
     if (uart_getchar_nb(&c))
@@ -311,42 +428,24 @@ int main(void)
         if (c=='q' || c=='Q'){ in_menu=0; printf("\r\n(resume)\r\n"); }
         else handle_menu(c);
       } else {
-        if (c=='\r' || c=='\n'){ stats_tx_char('\n'); printf("[TX] \\n\r\n"); }
-        else if (c>=32 && c<=126){ stats_tx_char(c); printf("[TX] 0x%02X '%c'\r\n", c, c); }
+        if (c=='\r' || c=='\n') c = '\n';
+        if (c=='\n' || (c>=32 && c<=126)) {
+          if (!stats_tx_char(c))  printf("[TX] queue full, dropped\r\n");
+          else if (c=='\n')       printf("[TX] \\n\r\n");
+          else                    printf("[TX] 0x%02X '%c'\r\n", c, c);
+        }
       }
     }
 
-    uint32_t now = HAL_GetTick();
-
-    /* poll STS occasionally to see CH_BUF level (NCHBF1:0) + mirror LD3 */
-    if (now - last_poll_ms > STS_POLL_MS){
-      uint8_t sts_val = 0;
-      (void)stats_read_reg(REG_STS, &sts_val, NULL);   /* read value byte only */
-      uint8_t nchbf = (uint8_t)((sts_val >> 5) & 0x03);
-      if (nchbf != last_nchbf) {
-        printf("[STS] NCHBF=%u%s%s%s\r\n",
-               (unsigned)nchbf,
-               (sts_val & STS_DIG)? " DIG": "",
-               (sts_val & STS_TRDY)? " TRDY": "",
-               (sts_val & STS_CHBOV)? " CHBOV": "");
-        last_nchbf = nchbf;
-      }
-      /* 3) DPx -> LD3 mirror */
-      stats_mirror_ld3();
-      last_poll_ms = now;
+    uint64_t now = tb_now_us();
+
+    /* poll occasionally to see CH_BUF level (NCHBF1:0) + mirror LD3 */
+    if (now >= next_poll_us){
+      stats_poll_cycle();
+      next_poll_us = now + STS_POLL_MS * 1000u;
     }
 
     /* read any available chars from CH_BUF (RX) */
-    if (!in_menu && (now - last_rx_ms > RX_POLL_MS)){
-      uint8_t r;
-      while (stats_try_rx_char(&r)) {
-        if (r=='\r' || r=='\n') printf("[RX] \\n\r\n");
-        else if (r>=32 && r<=126) printf("[RX] 0x%02X '%c'\r\n", r, r);
-        else printf("[RX] 0x%02X\r\n", r);
-        /* keep popping until empty so we don’t miss bursts */
-        HAL_Delay(1);
-      }
-      last_rx_ms = now;
-    }
+    if (!in_menu) stats_poll_rx();
   }
 }
@@ -0,0 +1,446 @@
+//------------------------------------------------------------------------------------
+// uart_bridge.c
+//------------------------------------------------------------------------------------
+//
+// See uart_bridge.h. The core comes first and is plain C; the STM32 port
+// (USART1/USART6, DMA2) follows and is left out of host builds.
+//
+//------------------------------------------------------------------------------------
+#include "uart_bridge.h"
+#include <stddef.h>
+
+#define RING_MASK (BRIDGE_RING - 1U)
+
+//------------------------------------------------------------------------------------
+// Core
+//------------------------------------------------------------------------------------
+void bridge_init(Bridge *b, const BridgeOps *ops, uint8_t *rings[BRIDGE_PORTS]) {
+    b->ops = *ops;
+    b->hook = NULL;
+    b->hookCtx = NULL;
+
+    for (int p = 0; p < BRIDGE_PORTS; p++) {
+        BridgePort *s = &b->port[p];
+        BridgeStats zero = {0};
+
+        s->ring    = rings[p];
+        s->head    = 0;
+        s->lastPos = b->ops.rxPos(p) & RING_MASK;
+        for (int d = 0; d < BRIDGE_PORTS; d++) s->tail[d] = 0;
+        s->routes  = 0;
+        s->flow    = BRIDGE_FLOW_NONE;
+        s->stopped = 0;
+        s->ctrl    = 0;
+        s->txLen   = 0;
+        s->txSrc   = 0;
+        s->txNext  = 0;
+        s->st      = zero;
+    }
+}
+
+void bridge_route(Bridge *b, int src, int dst, int on) {
+    BridgePort *s = &b->port[src];
+
+    if (on) {
+        s->tail[dst] = s->head;   // forward from now on, not the old ring contents
+        s->routes |= (uint8_t)(1U << dst);
+    } else {
+        s->routes &= (uint8_t)~(1U << dst);
+    }
+}
+
+void bridge_flow(Bridge *b, int port, int mode) {
+    b->port[port].flow = (uint8_t)mode;
+}
+
+void bridge_hook(Bridge *b, BridgeRxHook hook, void *ctx) {
+    b->hook = hook;
+    b->hookCtx = ctx;
+}
+
+// Largest unsent backlog of a ring over all its destinations
+static uint32_t fill(const BridgePort *s) {
+    uint32_t worst = 0;
+
+    for (int d = 0; d < BRIDGE_PORTS; d++) {
+        if (!(s->routes & (1U << d))) continue;
+        uint32_t n = s->head - s->tail[d];
+        if (n > worst) worst = n;
+    }
+    return worst;
+}
+
+// Start the next run on port d: a pending XON/XOFF first, then the routed
+// rings in turn, each from its tail up to the ring end (or BRIDGE_TX_MAX)
+static void kick(Bridge *b, int d) {
+    BridgePort *t = &b->port[d];
+
+    if (t->txLen) return;
+
+    if (t->ctrl) {
+        t->ctrlByte = t->ctrl;
+        t->ctrl  = 0;
+        t->txSrc = -1;
+        t->txLen = 1;
+        b->ops.txStart(d, &t->ctrlByte, 1);
+        return;
+    }
+
+    for (int i = 0; i < BRIDGE_PORTS; i++) {
+        int src = (t->txNext + i) % BRIDGE_PORTS;
+        BridgePort *s = &b->port[src];
+        if (!(s->routes & (1U << d))) continue;
+
+        uint32_t pend = s->head - s->tail[d];
+        if (pend == 0) continue;
+
+        uint32_t off = s->tail[d] & RING_MASK;
+        uint32_t len = BRIDGE_RING - off;
+        if (len > pend) len = pend;
+        if (len > BRIDGE_TX_MAX) len = BRIDGE_TX_MAX;
+
+        t->txSrc  = (int8_t)src;
+        t->txLen  = len;
+        t->txNext = (uint8_t)((src + 1) % BRIDGE_PORTS);
+        t->st.txRuns++;
+        b->ops.txStart(d, &s->ring[off], len);
+        return;
+    }
+}
+
+static void flowCheck(Bridge *b, int p) {
+    BridgePort *s = &b->port[p];
+    uint32_t f = fill(s);
+
+    if (f > s->st.maxFill) s->st.maxFill = f;
+    if (s->flow == BRIDGE_FLOW_NONE) return;
+
+    if (!s->stopped && f >= BRIDGE_HIGH_WATER) {
+        s->stopped = 1;
+        s->st.flowStops++;
+        if (s->flow == BRIDGE_FLOW_XONXOFF) { s->ctrl = BRIDGE_XOFF; kick(b, p); }
+        else if (b->ops.rxGate)             b->ops.rxGate(p, 0);
+    } else if (s->stopped && f <= BRIDGE_LOW_WATER) {
+        s->stopped = 0;
+        if (s->flow == BRIDGE_FLOW_XONXOFF) { s->ctrl = BRIDGE_XON; kick(b, p); }
+        else if (b->ops.rxGate)             b->ops.rxGate(p, 1);
+    }
+}
+
+// Take in what the RX DMA has written since the last look
+static void publish(Bridge *b, int p) {
+    BridgePort *s = &b->port[p];
+    uint32_t pos = b->ops.rxPos(p) & RING_MASK;
+    uint32_t n   = (pos - s->lastPos) & RING_MASK;
+
+    if (n) {
+        if (b->hook) {
+            uint32_t first = BRIDGE_RING - s->lastPos;
+            if (first > n) first = n;
+            if (b->ops.rxSync) b->ops.rxSync(p, s->lastPos, first);
+            b->hook(p, &s->ring[s->lastPos], first, b->hookCtx);
+            if (n > first) {
+                if (b->ops.rxSync) b->ops.rxSync(p, 0, n - first);
+                b->hook(p, s->ring, n - first, b->hookCtx);
+            }
+        }
+
+        s->lastPos = pos;
+        s->head += n;
+        s->st.rxBytes += n;
+
+        // A destination more than a ring behind has lost the oldest bytes
+        for (int d = 0; d < BRIDGE_PORTS; d++) {
+            if (!(s->routes & (1U << d))) continue;
+            uint32_t behind = s->head - s->tail[d];
+            if (behind > BRIDGE_RING) {
+                s->st.overrun += behind - BRIDGE_RING;
+                s->tail[d] = s->head - BRIDGE_RING;
+            }
+        }
+    }
+    flowCheck(b, p);
+}
+
+void bridge_rx_event(Bridge *b, int p) {
+    b->port[p].st.rxEvents++;
+    publish(b, p);
+    for (int d = 0; d < BRIDGE_PORTS; d++) {
+        if (b->port[p].routes & (1U << d)) kick(b, d);
+    }
+}
+
+void bridge_tx_done(Bridge *b, int d) {
+    BridgePort *t = &b->port[d];
+    uint32_t len = t->txLen;
+
+    t->txLen = 0;
+    if (len && t->txSrc >= 0) {
+        BridgePort *s = &b->port[t->txSrc];
+        s->tail[d] += len;
+        // An overrun may have moved the tail on while the run was out
+        if ((int32_t)(s->head - s->tail[d]) < 0) s->tail[d] = s->head;
+        t->st.txBytes += len;
+    }
+
+    // Completions come every BRIDGE_TX_MAX bytes: poll the RX side too, so a
+    // continuous stream (no IDLE) moves on in runs rather than half rings
+    for (int p = 0; p < BRIDGE_PORTS; p++) publish(b, p);
+    for (int p = 0; p < BRIDGE_PORTS; p++) kick(b, p);
+}
+
+#ifndef HOST_BUILD
+//------------------------------------------------------------------------------------
+// STM32 port: USART1 RX DMA2 S2 / TX S7 (ch 4), USART6 RX S1 / TX S6 (ch 5)
+//------------------------------------------------------------------------------------
+//
+// RX runs in double-buffer mode over the ring, one BRIDGE_RX_SEG segment per
+// buffer: each completion points the finished buffer register one segment
+// past the live one. The ring stays contiguous for TX, and the completion
+// is the segment event (half/full transfer over the whole ring would only
+// come every 4 KB).
+#include "stm32f769xx.h"
+#include "stm32f7xx_hal.h"
+
+#define BRIDGE_IRQ_PRIO  1      // every bridge IRQ at one level: the core is not reentrant
+#define DMA_FLAGS        0x3DU  // FE, DME, TE, HT, TC of one stream, before the shift
+#define DMA_TE           0x08U
+#define DMA_TC           0x20U
+
+typedef struct {
+    USART_TypeDef      *uart;
+    DMA_Stream_TypeDef *rx, *tx;
+    uint32_t            ch;
+    volatile uint32_t  *rxIsr, *rxIfcr;
+    volatile uint32_t  *txIsr, *txIfcr;
+    uint8_t             rxShift, txShift;
+    IRQn_Type           uartIrq, rxIrq, txIrq;
+} HwPort;
+
+static const HwPort hw[BRIDGE_PORTS] = {
+    { USART1, DMA2_Stream2, DMA2_Stream7, 4U,
+      &DMA2->LISR, &DMA2->LIFCR, &DMA2->HISR, &DMA2->HIFCR, 16, 22,
+      USART1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream7_IRQn },
+    { USART6, DMA2_Stream1, DMA2_Stream6, 5U,
+      &DMA2->LISR, &DMA2->LIFCR, &DMA2->HISR, &DMA2->HIFCR, 6, 16,
+      USART6_IRQn, DMA2_Stream1_IRQn, DMA2_Stream6_IRQn },
+};
+
+static uint8_t rings[BRIDGE_PORTS][BRIDGE_RING] __attribute__((aligned(32)));
+static volatile uint32_t isrCycles;
+
+Bridge uart_bridge;
+
+static uint32_t hwRxPos(int p) {
+    DMA_Stream_TypeDef *rx = hw[p].rx;
+    uint32_t ct, n;
+
+    // NDTR and CT have to come from the same segment
+    do {
+        ct = rx->CR & DMA_SxCR_CT;
+        n  = rx->NDTR;
+    } while ((rx->CR & DMA_SxCR_CT) != ct);
+
+    uint32_t seg = (ct ? rx->M1AR : rx->M0AR) - (uint32_t)rings[p];
+    return seg + BRIDGE_RX_SEG - n;
+}
+
+static void hwTxStart(int p, const uint8_t *src, uint32_t len) {
+    const HwPort *h = &hw[p];
+
+    // Ring bytes come from DMA and are never dirty; only the XON/XOFF byte
+    // was written by the CPU
+    if ((src < rings[0] || src >= rings[0] + sizeof(rings)) && (SCB->CCR & SCB_CCR_DC_Msk)) {
+        uint32_t a = (uint32_t)src & ~31U;
+        SCB_CleanDCache_by_Addr((uint32_t *)a, (int32_t)(((uint32_t)src + len) - a));
+    }
+
+    *h->txIfcr   = DMA_FLAGS << h->txShift;
+    h->tx->M0AR  = (uint32_t)src;
+    h->tx->NDTR  = len;
+    h->tx->CR   |= DMA_SxCR_EN;
+}
+
+// RTS follows RDR: with DMAR off the first byte stays unread and RTS drops
+static void hwRxGate(int p, int open) {
+    if (open) hw[p].uart->CR3 |= USART_CR3_DMAR;
+    else      hw[p].uart->CR3 &= ~USART_CR3_DMAR;
+}
+
+// The CPU only reads the rings for the hook: drop stale lines first. The
+// DMA never sees dirty lines there, so invalidating is safe.
+static void hwRxSync(int p, uint32_t off, uint32_t len) {
+    if (SCB->CCR & SCB_CCR_DC_Msk) {
+        uint32_t a = off & ~31U;
+        SCB_InvalidateDCache_by_Addr((uint32_t *)&rings[p][a], (int32_t)(off + len - a));
+    }
+}
+
+static const BridgeOps hwOps = { hwRxPos, hwTxStart, hwRxGate, hwRxSync };
+
+static void uartIrq(int p) {
+    uint32_t t0 = DWT->CYCCNT;
+    USART_TypeDef *u = hw[p].uart;
+    uint32_t isr = u->ISR;
+
+    if (isr & (USART_ISR_FE | USART_ISR_NE | USART_ISR_ORE)) {
+        u->ICR = USART_ICR_FECF | USART_ICR_NCF | USART_ICR_ORECF;
+    }
+    if (isr & USART_ISR_IDLE) {
+        u->ICR = USART_ICR_IDLECF;
+        bridge_rx_event(&uart_bridge, p);
+    }
+    isrCycles += DWT->CYCCNT - t0;
+}
+
+static void rxDmaIrq(int p) {
+    uint32_t t0 = DWT->CYCCNT;
+    const HwPort *h = &hw[p];
+    uint32_t isr = (*h->rxIsr >> h->rxShift) & DMA_FLAGS;
+
+    *h->rxIfcr = isr << h->rxShift;
+    if (isr & DMA_TC) {
+        // The finished buffer follows the live one; done before that fills
+        uint32_t base = (uint32_t)rings[p];
+        if (h->rx->CR & DMA_SxCR_CT) h->rx->M0AR = base + ((h->rx->M1AR - base + BRIDGE_RX_SEG) & (BRIDGE_RING - 1U));
+        else                         h->rx->M1AR = base + ((h->rx->M0AR - base + BRIDGE_RX_SEG) & (BRIDGE_RING - 1U));
+        bridge_rx_event(&uart_bridge, p);
+    }
+    isrCycles += DWT->CYCCNT - t0;
+}
+
+static void txDmaIrq(int p) {
+    uint32_t t0 = DWT->CYCCNT;
+    const HwPort *h = &hw[p];
+    uint32_t isr = (*h->txIsr >> h->txShift) & DMA_FLAGS;
+
+    *h->txIfcr = isr << h->txShift;
+    // On a transfer error the run is dropped, not retried
+    if (isr & (DMA_TC | DMA_TE)) bridge_tx_done(&uart_bridge, p);
+    isrCycles += DWT->CYCCNT - t0;
+}
+
+void USART1_IRQHandler(void)       { uartIrq(BRIDGE_USART1); }
+void USART6_IRQHandler(void)       { uartIrq(BRIDGE_USART6); }
+void DMA2_Stream2_IRQHandler(void) { rxDmaIrq(BRIDGE_USART1); }
+void DMA2_Stream1_IRQHandler(void) { rxDmaIrq(BRIDGE_USART6); }
+void DMA2_Stream7_IRQHandler(void) { txDmaIrq(BRIDGE_USART1); }
+void DMA2_Stream6_IRQHandler(void) { txDmaIrq(BRIDGE_USART6); }
+
+static void streamOff(DMA_Stream_TypeDef *s) {
+    s->CR &= ~DMA_SxCR_EN;
+    while (s->CR & DMA_SxCR_EN) {}
+}
+
+void bridge_hw_init(void) {
+    uint8_t *r[BRIDGE_PORTS];
+
+    // The DWT stays locked without a debugger attached
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    for (int p = 0; p < BRIDGE_PORTS; p++) {
+        const HwPort *h = &hw[p];
+
+        streamOff(h->rx);
+        streamOff(h->tx);
+        *h->rxIfcr = DMA_FLAGS << h->rxShift;
+        *h->txIfcr = DMA_FLAGS << h->txShift;
+
+        h->rx->PAR  = (uint32_t)&h->uart->RDR;
+        h->rx->M0AR = (uint32_t)rings[p];
+        h->rx->M1AR = (uint32_t)rings[p] + BRIDGE_RX_SEG;
+        h->rx->NDTR = BRIDGE_RX_SEG;
+        h->rx->CR   = (h->ch << DMA_SxCR_CHSEL_Pos)     // peripheral to memory
+                    | DMA_SxCR_DBM | DMA_SxCR_MINC      // DBM implies circular
+                    | DMA_SxCR_PL_1                     // RX ahead of TX
+                    | DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+        h->rx->FCR  = 0;                                // direct mode
+
+        h->tx->PAR  = (uint32_t)&h->uart->TDR;
+        h->tx->CR   = (h->ch << DMA_SxCR_CHSEL_Pos)
+                    | DMA_SxCR_DIR_0                    // memory to peripheral
+                    | DMA_SxCR_MINC
+                    | DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+        h->tx->FCR  = 0;
+
+        r[p] = rings[p];
+    }
+
+    isrCycles = 0;
+    bridge_init(&uart_bridge, &hwOps, r);
+}
+
+void bridge_hw_start(void) {
+    for (int p = 0; p < BRIDGE_PORTS; p++) {
+        const HwPort *h = &hw[p];
+        USART_TypeDef *u = h->uart;
+
+        // Let anything already printed leave before the DMA takes over TDR
+        while (!(u->ISR & USART_ISR_TC)) {}
+
+        // OVRDIS: a late DMA read loses a byte instead of freezing RX
+        u->CR1 &= ~USART_CR1_UE;
+        u->CR3 |= USART_CR3_OVRDIS | USART_CR3_EIE | USART_CR3_DMAT | USART_CR3_DMAR;
+        u->CR1 |= USART_CR1_UE;
+        u->ICR  = USART_ICR_IDLECF | USART_ICR_FECF | USART_ICR_NCF | USART_ICR_ORECF;
+        u->CR1 |= USART_CR1_IDLEIE;
+
+        h->rx->CR |= DMA_SxCR_EN;
+
+        HAL_NVIC_SetPriority(h->uartIrq, BRIDGE_IRQ_PRIO, 0);
+        HAL_NVIC_SetPriority(h->rxIrq, BRIDGE_IRQ_PRIO, 0);
+        HAL_NVIC_SetPriority(h->txIrq, BRIDGE_IRQ_PRIO, 0);
+        HAL_NVIC_EnableIRQ(h->uartIrq);
+        HAL_NVIC_EnableIRQ(h->rxIrq);
+        HAL_NVIC_EnableIRQ(h->txIrq);
+    }
+}
+
+static int hwIdle(int p) {
+    const BridgePort *t = &uart_bridge.port[p];
+
+    if (t->txLen || t->ctrl) return 0;
+    for (int s = 0; s < BRIDGE_PORTS; s++) {
+        if ((uart_bridge.port[s].routes & (1U << p)) && bridge_backlog(&uart_bridge, s, p)) return 0;
+    }
+    return !(hw[p].tx->CR & DMA_SxCR_EN) && (hw[p].uart->ISR & USART_ISR_TC);
+}
+
+int bridge_hw_drain(uint32_t timeoutMs) {
+    uint32_t t0 = HAL_GetTick();
+
+    for (;;) {
+        int idle = 1;
+        for (int p = 0; p < BRIDGE_PORTS; p++) idle &= hwIdle(p);
+        if (idle) return 1;
+        if (HAL_GetTick() - t0 >= timeoutMs) return 0;
+    }
+}
+
+void bridge_hw_stop(void) {
+    for (int p = 0; p < BRIDGE_PORTS; p++) {
+        const HwPort *h = &hw[p];
+
+        NVIC_DisableIRQ(h->uartIrq);
+        NVIC_DisableIRQ(h->rxIrq);
+        NVIC_DisableIRQ(h->txIrq);
+
+        // The current TX run finishes on its own; RX stops where it is
+        while (h->tx->CR & DMA_SxCR_EN) {}
+        streamOff(h->rx);
+        *h->rxIfcr = DMA_FLAGS << h->rxShift;
+        *h->txIfcr = DMA_FLAGS << h->txShift;
+
+        h->uart->CR1 &= ~USART_CR1_IDLEIE;
+        h->uart->CR3 &= ~(USART_CR3_EIE | USART_CR3_DMAT | USART_CR3_DMAR);
+        while (!(h->uart->ISR & USART_ISR_TC)) {}
+    }
+}
+
+uint32_t bridge_hw_isr_cycles(void) {
+    return isrCycles;
+}
+#endif
@@ -0,0 +1,135 @@
+//------------------------------------------------------------------------------------
+// uart_bridge.h
+//------------------------------------------------------------------------------------
+//
+// Zero-copy DMA bridge between UART ports (USART1 <-> USART6 on the board).
+//
+// Every port receives with circular DMA into its own ring. IDLE and an
+// interrupt every BRIDGE_RX_SEG bytes publish what has arrived; the
+// destination port's TX DMA then sends straight out of the source ring, one
+// contiguous run at a time. No byte is copied by the CPU, and a route table
+// decides which rings each TX drains (a port may also echo to itself).
+//
+// Flow control, per receiving port:
+//   BRIDGE_FLOW_NONE     the ring simply laps; overwritten bytes are counted
+//   BRIDGE_FLOW_XONXOFF  XOFF is queued on that port's TX when its ring is
+//                        BRIDGE_HIGH_WATER full, XON below BRIDGE_LOW_WATER
+//   BRIDGE_FLOW_RTSCTS   RX DMA requests are gated off at the high-water
+//                        mark, so the USART's RTS drops once RDR fills;
+//                        CTS stalls our TX in hardware (pins are the
+//                        caller's job)
+// Incoming XON/XOFF bytes are forwarded like data, not obeyed.
+//
+// A continuous stream never goes IDLE, so the segment interrupt bounds both
+// the forwarding latency and how late a water mark is seen. TX completions
+// poll the RX positions as well. Above the high mark the sender has a
+// quarter ring less one segment and one TX run (the XOFF waits behind it)
+// to react.
+//
+// The core is hardware-free: the port layer supplies BridgeOps and calls
+// bridge_rx_event() / bridge_tx_done() from its interrupts (all bridge IRQs
+// at one priority). The STM32 port is at the bottom of uart_bridge.c; the
+// host model in host/bridge_host.c runs the same core over pipes.
+//
+//------------------------------------------------------------------------------------
+#ifndef UART_BRIDGE_H
+#define UART_BRIDGE_H
+
+#include <stdint.h>
+
+#define BRIDGE_PORTS       2
+#define BRIDGE_RING        8192U                   // per port, power of two
+#define BRIDGE_RX_SEG      256U                    // RX event at least this often
+#define BRIDGE_TX_MAX      256U                    // longest single TX run
+#define BRIDGE_HIGH_WATER  (BRIDGE_RING * 3U / 4U)
+#define BRIDGE_LOW_WATER   (BRIDGE_RING / 4U)
+
+#define BRIDGE_XON         0x11
+#define BRIDGE_XOFF        0x13
+
+enum { BRIDGE_FLOW_NONE, BRIDGE_FLOW_XONXOFF, BRIDGE_FLOW_RTSCTS };
+
+typedef struct {
+    uint32_t (*rxPos)(int port);                              // RX DMA write index
+    void     (*txStart)(int port, const uint8_t *p, uint32_t len);
+    void     (*rxGate)(int port, int open);                   // RTSCTS only
+    void     (*rxSync)(int port, uint32_t off, uint32_t len); // before the hook reads, may be NULL
+} BridgeOps;
+
+// Look at (do not keep) newly received bytes, e.g. to catch an ESC
+typedef void (*BridgeRxHook)(int port, const uint8_t *p, uint32_t len, void *ctx);
+
+typedef struct {
+    uint32_t rxBytes;
+    uint32_t txBytes;
+    uint32_t txRuns;       // TX DMA transfers started
+    uint32_t rxEvents;     // IDLE / HT / TC services
+    uint32_t overrun;      // bytes lost to a lapped ring
+    uint32_t maxFill;      // worst unsent backlog in this port's ring
+    uint32_t flowStops;    // XOFF sent / RX gated
+} BridgeStats;
+
+typedef struct {
+    uint8_t    *ring;                    // BRIDGE_RING bytes, DMA target
+    uint32_t    head;                    // bytes received (free-running)
+    uint32_t    lastPos;
+    uint32_t    tail[BRIDGE_PORTS];      // per destination: bytes handed to TX
+    uint8_t     routes;                  // bit d: forward to port d
+    uint8_t     flow;
+    uint8_t     stopped;                 // flow control currently holding the sender
+    uint8_t     ctrl;                    // XON/XOFF waiting to go out of this port
+
+    // TX side of this port
+    uint32_t    txLen;                   // run in flight, 0 = idle
+    int8_t      txSrc;                   // ring it came from, -1 = ctrl byte
+    uint8_t     txNext;                  // round-robin start
+    uint8_t     ctrlByte;                // DMA source for ctrl
+
+    BridgeStats st;
+} BridgePort;
+
+typedef struct {
+    BridgePort   port[BRIDGE_PORTS];
+    BridgeOps    ops;
+    BridgeRxHook hook;
+    void        *hookCtx;
+} Bridge;
+
+void bridge_init(Bridge *b, const BridgeOps *ops, uint8_t *rings[BRIDGE_PORTS]);
+void bridge_route(Bridge *b, int src, int dst, int on);
+void bridge_flow(Bridge *b, int port, int mode);
+void bridge_hook(Bridge *b, BridgeRxHook hook, void *ctx);
+
+// From the port layer's interrupts
+void bridge_rx_event(Bridge *b, int port);
+void bridge_tx_done(Bridge *b, int port);
+
+// Bytes received on src not yet sent to dst
+static inline uint32_t bridge_backlog(const Bridge *b, int src, int dst) {
+    return b->port[src].head - b->port[src].tail[dst];
+}
+
+#ifndef HOST_BUILD
+// STM32 port: USART1 (port 0) and USART6 (port 1), already initialized
+// (baud, pins) by initUart(). Defines the USART1/6 and DMA2 stream 1/2/6/7
+// handlers, so it cannot be linked with console_tx.c or console_rx.c.
+//
+//   bridge_hw_init();                 // DMA set up, core reset, nothing running
+//   bridge_route(&uart_bridge, ...);  // routes, flow, hook
+//   bridge_hw_start();
+//   ...
+//   bridge_hw_drain(ms);              // let the backlogs out
+//   bridge_hw_stop();                 // drops whatever is still queued
+#define BRIDGE_USART1 0
+#define BRIDGE_USART6 1
+
+extern Bridge uart_bridge;
+
+void     bridge_hw_init(void);
+void     bridge_hw_start(void);
+void     bridge_hw_stop(void);
+int      bridge_hw_drain(uint32_t timeoutMs);   // 1 once every TX is idle with TC set
+uint32_t bridge_hw_isr_cycles(void);   // DWT cycles spent in bridge IRQs
+#endif
+
+#endif // UART_BRIDGE_H
@@ -0,0 +1,150 @@
+//------------------------------------------------------------------------------------
+// word_array.c
+//------------------------------------------------------------------------------------
+//
+// See word_array.h. The closing quote of a word is only written when the
+// next word starts (as ",") or at the end, so separators never need undoing.
+//
+//------------------------------------------------------------------------------------
+#include "word_array.h"
+#include <string.h>
+
+#define RESERVE 3   // closing quote, ']' and NUL, kept free in a fixed buffer
+
+static int isSpace(uint8_t c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Copied through as is
+static int isPlain(uint8_t c) {
+    return c > ' ' && c != '"' && c != '\\' && c != 0x7F;
+}
+
+static void flush(WordArray *w) {
+    if (w->len) w->sink(w->out, w->len, w->ctx);
+    w->len = 0;
+}
+
+static size_t room(const WordArray *w) {
+    size_t keep = w->sink ? 0 : RESERVE;
+    return w->cap > w->len + keep ? w->cap - w->len - keep : 0;
+}
+
+// Write n bytes; a fixed buffer takes as many as fit. Returns bytes written.
+static size_t put(WordArray *w, const char *s, size_t n) {
+    size_t done = 0;
+
+    while (done < n) {
+        size_t r = room(w);
+        if (r == 0) {
+            if (!w->sink) break;
+            flush(w);
+            continue;
+        }
+        if (r > n - done) r = n - done;
+        memcpy(w->out + w->len, s + done, r);
+        w->len += r;
+        done += r;
+    }
+    w->total += done;
+    return done;
+}
+
+// All or nothing, for separators and escapes
+static int putAll(WordArray *w, const char *s, size_t n) {
+    if (!w->sink && room(w) < n) return 0;
+    put(w, s, n);
+    return 1;
+}
+
+// Out of room in a fixed buffer: the current word counts as cut
+static void fill(WordArray *w) {
+    if (w->full) return;
+    w->full = 1;
+    if (w->inWord) w->cut++;
+}
+
+void word_array_begin(WordArray *w, char *buf, size_t cap, WordSink sink, void *ctx) {
+    w->out = buf;
+    w->cap = cap;
+    w->len = 0;
+    w->total = 0;
+    w->sink = sink;
+    w->ctx = ctx;
+    w->words = 0;
+    w->cut = 0;
+    w->inWord = 0;
+    w->open = 0;
+    w->full = 0;
+    if (!putAll(w, "[", 1)) w->full = 1;
+}
+
+void word_array_feed(WordArray *w, const char *p, size_t n) {
+    static const char hex[] = "0123456789abcdef";
+    size_t i = 0;
+
+    while (i < n) {
+        uint8_t c = (uint8_t)p[i];
+
+        if (isSpace(c)) {
+            w->inWord = 0;
+            i++;
+            continue;
+        }
+
+        if (!w->inWord) {
+            w->inWord = 1;
+            w->words++;
+            if (w->full) {
+                w->cut++;
+            } else if (putAll(w, w->open ? "\",\"" : "\"", w->open ? 3 : 1)) {
+                w->open = 1;
+            } else {
+                fill(w);
+            }
+        }
+
+        // A run of plain bytes goes out in one copy
+        size_t j = i;
+        while (j < n && isPlain((uint8_t)p[j])) j++;
+        if (j > i) {
+            if (!w->full && put(w, p + i, j - i) < j - i) fill(w);
+            i = j;
+            continue;
+        }
+
+        if (!w->full) {
+            char esc[6] = { '\\', (char)c, 0, 0, 0, 0 };
+            size_t len = 2;
+            if (c != '"' && c != '\\') {
+                memcpy(esc, "\\u00", 4);
+                esc[4] = hex[c >> 4];
+                esc[5] = hex[c & 15];
+                len = 6;
+            }
+            if (!putAll(w, esc, len)) fill(w);
+        }
+        i++;
+    }
+}
+
+void word_array_putc(WordArray *w, char c) {
+    word_array_feed(w, &c, 1);
+}
+
+size_t word_array_end(WordArray *w) {
+    if (w->sink) {
+        if (w->open) put(w, "\"", 1);
+        put(w, "]", 1);
+        flush(w);
+    } else {
+        // The reserve always has room for these, even in a full buffer
+        if (w->open) w->out[w->len++] = '"';
+        w->out[w->len++] = ']';
+        w->out[w->len] = '\0';
+        w->total = w->len;
+    }
+    w->open = 0;
+    w->inWord = 0;
+    return w->total;
+}
@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------------
+// word_array.h
+//------------------------------------------------------------------------------------
+//
+// Streaming "words to JSON array" encoder:  hello "big" world  ->
+// ["hello","\"big\"","world"]
+//
+// Bytes go in as they arrive (word_array_putc / word_array_feed, any chunk
+// size, no line buffer); each is looked at once and written through an
+// output cursor. Whitespace (space, \t \n \v \f \r) separates words; quote
+// and backslash are escaped with a backslash, other control bytes become
+// \u00XX.
+//
+// Two output modes:
+//   sink == NULL  fixed buffer of at least 4 bytes. Three bytes stay
+//                 reserved, so a full buffer still ends in a valid,
+//                 NUL-terminated array: the word being written is cut
+//                 short, later words are dropped, and both are counted
+//                 in cut.
+//   sink != NULL  the buffer is a staging area handed to sink whenever it
+//                 fills (and by word_array_end), so output is unbounded.
+//
+//------------------------------------------------------------------------------------
+#ifndef WORD_ARRAY_H
+#define WORD_ARRAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef void (*WordSink)(const char *p, size_t n, void *ctx);
+
+typedef struct {
+    char     *out;
+    size_t    cap;
+    size_t    len;         // bytes in out
+    size_t    total;       // bytes produced, including those already sunk
+    WordSink  sink;
+    void     *ctx;
+    uint32_t  words;       // words seen
+    uint32_t  cut;         // words truncated or dropped (fixed buffer only)
+    uint8_t   inWord;      // last byte was part of a word
+    uint8_t   open;        // a word's closing quote is still owed
+    uint8_t   full;
+} WordArray;
+
+void   word_array_begin(WordArray *w, char *buf, size_t cap, WordSink sink, void *ctx);
+void   word_array_feed(WordArray *w, const char *p, size_t n);
+void   word_array_putc(WordArray *w, char c);
+
+// Closes the array; returns its total length. A fixed buffer is NUL-terminated.
+size_t word_array_end(WordArray *w);
+
+#endif // WORD_ARRAY_H
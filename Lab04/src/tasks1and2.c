@@ -3,6 +3,8 @@
 //--------------------------------
 
 #include "init.h"
+#include "console_tx.h"
+#include "fmt.h"
 #include "stm32f7xx_hal.h"
 #include <stdio.h>
 #include <stdint.h>
@@ -27,6 +29,7 @@
 #define SAMPLE_PERIOD_MS            1U
 #define WINDOW_MS                   1000000U
 #define RING_LEN                    (WINDOW_MS / SAMPLE_PERIOD_MS)
+#define TX_REPORT_SAMPLES           10000U  // console_tx stats line every N samples
 
 /* ====== Globals ====== */
 static ADC_HandleTypeDef hadc1;
@@ -51,12 +54,13 @@ static inline uint32_t adc_to_mV(uint32_t raw)
 int main(void)
 {
     Sys_Init();
+    console_tx_init();   // printf queues, USART1 TX drains on DMA
 
 #if RUN_TASK1_VOLT_METER
     configureADC_single();
 
     static uint16_t ring[RING_LEN] = {0};
-    uint32_t sum_mV = 0, count = 0, idx = 0;
+    uint32_t sum_mV = 0, count = 0, idx = 0, samples = 0;
     uint16_t cur_min = 0xFFFF, cur_max = 0;
 
     printf("\r\n[Task 1] Simple Voltmeter on PA6 (A0). Sampling every %lu ms.\r\n",
@@ -90,10 +94,19 @@ int main(void)
         if (mV > cur_max) cur_max = mV;
 
         uint32_t avg_mV = (count == 0) ? 0 : (sum_mV / count);
-        printf("ADC=0x%03lX  V=%.3f  avg(10s)=%.3f  min=%.3f  max=%.3f\r\n",
-               (unsigned long)raw,
-               (float)mV/1000.0f, (float)avg_mV/1000.0f,
-               (float)cur_min/1000.0f, (float)cur_max/1000.0f);
+
+        /* Same line as "ADC=0x%03lX  V=%.3f ..." but volts come straight
+           from the mV integers, so float printf is not linked in */
+        char line[96], *p = line;
+        p = fmt_str(p, "ADC=0x");      p = fmt_hex(p, raw, 3, 1);
+        p = fmt_str(p, "  V=");        p = fmt_fixed(p, (int32_t)mV, 3);
+        p = fmt_str(p, "  avg(10s)="); p = fmt_fixed(p, (int32_t)avg_mV, 3);
+        p = fmt_str(p, "  min=");      p = fmt_fixed(p, (int32_t)cur_min, 3);
+        p = fmt_str(p, "  max=");      p = fmt_fixed(p, (int32_t)cur_max, 3);
+        p = fmt_str(p, "\r\n");
+        fwrite(line, 1, (size_t)(p - line), stdout);
+
+        if ((++samples % TX_REPORT_SAMPLES) == 0) console_tx_report();
 
         HAL_Delay(SAMPLE_PERIOD_MS);
         idx = (idx + 1) % RING_LEN;
@@ -1,6 +1,7 @@
 #include "init.h" // Always need init.h, otherwise nothing will work.
 #include<stdint.h>
 #include<stdlib.h>
+#include "timebase.h" // Shared DWT/TIM5 time base, never reset
 
 
 DMA_HandleTypeDef hdma_memtomem_dma2_stream0;
@@ -16,10 +17,8 @@ int main(void)
 {
 	Sys_Init();
 
-	// Enable the DWT_CYCCNT register
-	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
-	DWT->LAR = 0xC5ACCE55;
-	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	// Enable the DWT_CYCCNT register (measurements take deltas, nothing resets it)
+	tb_init();
 
 	MX_DMA_Init(); // initialize DMA
 	hdma_memtomem_dma2_stream0.XferCpltCallback = &DmaXferCompleteCallback;
@@ -39,66 +38,66 @@ void MemToMem(int buflen) {
 	uint8_t *src8 = (uint8_t *)malloc(buflen * sizeof(uint8_t));
 	uint8_t *dest8 = (uint8_t *)malloc(buflen * sizeof(uint8_t));
 
-	DWT->CYCCNT = 0; // Clear the cycle counter
+	uint32_t start = tb_cycles(); // Start of the measured interval
 
 	for (int i = 0; i < buflen; i++) { dest8[i] = src8[i]; }
 
-	uint32_t cycles = DWT->CYCCNT; // Store the cycle counter
+	uint32_t cycles = tb_cycles() - start; // Cycles since start
 	printf("copying uint8_t buffer without DMA took %lu CPU cycles\r\n", cycles);
 
     hdma_memtomem_dma2_stream0.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_memtomem_dma2_stream0.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
     HAL_DMA_Init(&hdma_memtomem_dma2_stream0);
 	dma_done = 0;
-	DWT->CYCCNT = 0; // Clear the cycle counter
+	start = tb_cycles(); // Start of the measured interval
 	HAL_DMA_Start_IT(&hdma_memtomem_dma2_stream0,(uint32_t)src8,(uint32_t)dest8,buflen);
 	while (!dma_done);  // wait until callback fires
 
-	cycles = DWT->CYCCNT; // Store the cycle counter
+	cycles = tb_cycles() - start; // Cycles since start
 	printf("copying uint8_t buffer with DMA took %lu CPU cycles\r\n", cycles);
 
 	/********** uint16_t **********/
 	uint16_t *src16 = (uint16_t *)malloc(buflen * sizeof(uint16_t));
 	uint16_t *dest16 = (uint16_t *)malloc(buflen * sizeof(uint16_t));
 
-	DWT->CYCCNT = 0; // Clear the cycle counter
+	start = tb_cycles(); // Start of the measured interval
 
 	for (int i = 0; i < buflen; i++) { dest16[i] = src16[i]; }
 
-	cycles = DWT->CYCCNT; // Store the cycle counter
+	cycles = tb_cycles() - start; // Cycles since start
 	printf("copying uint16_t buffer without DMA took %lu CPU cycles\r\n", cycles);
 
     hdma_memtomem_dma2_stream0.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
     hdma_memtomem_dma2_stream0.Init.MemDataAlignment    = DMA_MDATAALIGN_HALFWORD;
     HAL_DMA_Init(&hdma_memtomem_dma2_stream0);
     dma_done = 0;
-	DWT->CYCCNT = 0; // Clear the cycle counter
+	start = tb_cycles(); // Start of the measured interval
 	HAL_DMA_Start_IT(&hdma_memtomem_dma2_stream0,(uint32_t)src16,(uint32_t)dest16,buflen);
 	while (!dma_done);  // wait until callback fires
 
-	cycles = DWT->CYCCNT; // Store the cycle counter
+	cycles = tb_cycles() - start; // Cycles since start
 	printf("copying uint16_t buffer with DMA took %lu CPU cycles\r\n", cycles);
 
 	/********** uint32_t **********/
 	uint32_t *src32 = (uint32_t *)malloc(buflen * sizeof(uint32_t));
 	uint32_t *dest32 = (uint32_t *)malloc(buflen * sizeof(uint32_t));
 
-	DWT->CYCCNT = 0; // Clear the cycle counter
+	start = tb_cycles(); // Start of the measured interval
 
 	for (int i = 0; i < buflen; i++) { dest32[i] = src32[i]; }
 
-	cycles = DWT->CYCCNT; // Store the cycle counter
+	cycles = tb_cycles() - start; // Cycles since start
 	printf("copying uint32_t buffer without DMA took %lu CPU cycles\r\n", cycles);
 
     hdma_memtomem_dma2_stream0.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
     hdma_memtomem_dma2_stream0.Init.MemDataAlignment    = DMA_MDATAALIGN_WORD;
     HAL_DMA_Init(&hdma_memtomem_dma2_stream0);
 	dma_done = 0;
-	DWT->CYCCNT = 0; // Clear the cycle counter
+	start = tb_cycles(); // Start of the measured interval
 	HAL_DMA_Start_IT(&hdma_memtomem_dma2_stream0,(uint32_t)src32,(uint32_t)dest32,buflen);
 	while (!dma_done);  // wait until callback fires
 
-	cycles = DWT->CYCCNT; // Store the cycle counter
+	cycles = tb_cycles() - start; // Cycles since start
 	printf("copying uint32_t buffer with DMA took %lu CPU cycles\r\n", cycles);
 
 }
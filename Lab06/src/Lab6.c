@@ -16,6 +16,7 @@
 
 #include "init.h"
 #include "helper_functions.h"
+#include "console_tx.h"
 
 /* Defines */
 #define LCD_FRAME_BUFFER        0xC0000000
@@ -54,6 +55,7 @@ void DMA2D_CopyBuffer(uint32_t *pSrc, uint32_t *pDst, uint16_t x, uint16_t y, JP
 int main(void)
 {
 	Sys_Init();
+	console_tx_init();   // printf/printPutty queue into the DMA ring
 	input = 0;   // make sure we actually draw in PuTTY
 
     printf("\033[2J\033[;H"); // Erase screen & move cursor to home position
@@ -236,6 +238,7 @@ int main(void)
     if (input != 0x1B)
     	printPutty(raw_output, &jpeg_info);
 
+    console_tx_report();
     printf("\r\nTask 2 completed! Press any key to continue \r\n");
     getchar();
     printf("\033[2J\033[;H"); // Erase screen & move cursor to home position
@@ -0,0 +1,152 @@
+// console_rx.c  (shared by the lab programs)
+//
+// See console_rx.h.
+
+#include "console_rx.h"
+#include "stm32f7xx_hal.h"
+#include <stdio.h>
+
+#define RX_MASK (CONSOLE_RX_SIZE - 1U)
+
+// Single producer (ISR) / single consumer (main loop), free-running indices
+static volatile uint8_t  rx_ring[CONSOLE_RX_SIZE];
+static volatile uint32_t rx_head;
+static volatile uint32_t rx_tail;
+
+static ConsoleRxStats rx_stats;
+
+//---------------------------------------------------------------------------
+// ISR
+//---------------------------------------------------------------------------
+void USART1_IRQHandler(void)
+{
+  uint32_t isr = USART1->ISR;
+
+  // Error flags stop reception until cleared; count and clear them
+  if (isr & (USART_ISR_ORE | USART_ISR_FE | USART_ISR_NE)) {
+    if (isr & USART_ISR_ORE) rx_stats.ore++;
+    if (isr & USART_ISR_FE)  rx_stats.fe++;
+    if (isr & USART_ISR_NE)  rx_stats.ne++;
+    USART1->ICR = USART_ICR_ORECF | USART_ICR_FECF | USART_ICR_NCF;
+  }
+
+  if (isr & USART_ISR_RXNE) {
+    uint8_t  b    = (uint8_t)USART1->RDR;   // reading clears RXNE
+    uint32_t used = rx_head - rx_tail;
+
+    if (used < CONSOLE_RX_SIZE) {
+      rx_ring[rx_head & RX_MASK] = b;
+      rx_head++;
+      if (used + 1 > rx_stats.high_water) rx_stats.high_water = used + 1;
+    } else {
+      rx_stats.dropped++;
+    }
+    rx_stats.bytes++;
+  }
+}
+
+//---------------------------------------------------------------------------
+// Public API
+//---------------------------------------------------------------------------
+void console_rx_init(void)
+{
+  rx_head = rx_tail = 0;
+
+  // Anything that arrived before now is stale
+  USART1->ICR = USART_ICR_ORECF | USART_ICR_FECF | USART_ICR_NCF;
+  (void)USART1->RDR;
+
+  USART1->CR1 |= USART_CR1_RXNEIE;
+  USART1->CR3 |= USART_CR3_EIE;
+
+  HAL_NVIC_SetPriority(USART1_IRQn, 0x0D, 0);
+  HAL_NVIC_EnableIRQ(USART1_IRQn);
+}
+
+int console_getc(void)
+{
+  if (rx_tail == rx_head) return -1;
+
+  int c = rx_ring[rx_tail & RX_MASK];
+  rx_tail++;
+  return c;
+}
+
+uint32_t console_rx_available(void)
+{
+  return rx_head - rx_tail;
+}
+
+const ConsoleRxStats *console_rx_stats(void)
+{
+  return &rx_stats;
+}
+
+// getchar()/scanf() path: wait for one byte, then take whatever else is there
+int _read(int file, char *ptr, int len)
+{
+  (void)file;
+  if (len <= 0) return 0;
+
+  int c;
+  while ((c = console_getc()) < 0) __WFI();   // the RX interrupt wakes us
+
+  int n = 0;
+  do {
+    ptr[n++] = (char)c;
+  } while (n < len && (c = console_getc()) >= 0);
+  return n;
+}
+
+//---------------------------------------------------------------------------
+// Line editing
+//---------------------------------------------------------------------------
+#define KEY_BS      0x08
+#define KEY_DEL     0x7F
+#define KEY_CTRL_U  0x15
+
+void console_line_init(ConsoleLine *l, char *buf, uint16_t cap, uint8_t echo)
+{
+  l->buf  = buf;
+  l->cap  = cap;
+  l->len  = 0;
+  l->echo = echo;
+  l->last_cr = 0;
+  buf[0]  = '\0';
+}
+
+int console_line_poll(ConsoleLine *l)
+{
+  int c;
+
+  while ((c = console_getc()) >= 0) {
+    uint8_t after_cr = l->last_cr;
+    l->last_cr = (c == '\r');
+
+    if (c == '\r' || c == '\n') {
+      if (c == '\n' && after_cr) continue;   // CR LF is one line end
+      l->buf[l->len] = '\0';
+      l->len = 0;
+      if (l->echo) { fputs("\r\n", stdout); fflush(stdout); }
+      return 1;
+    }
+
+    if (l->len == 0) l->buf[0] = '\0';  // previous line has been consumed
+
+    if (c == KEY_BS || c == KEY_DEL) {
+      if (l->len > 0) {
+        l->len--;
+        if (l->echo) fputs("\b \b", stdout);
+      }
+    } else if (c == KEY_CTRL_U) {
+      if (l->echo) while (l->len) { fputs("\b \b", stdout); l->len--; }
+      l->len = 0;
+    } else if (c >= 32 && c < 127 && l->len < l->cap - 1) {
+      l->buf[l->len++] = (char)c;
+      if (l->echo) putchar(c);
+    }
+  }
+
+  if (l->echo) fflush(stdout);
+  return 0;
+}
@@ -0,0 +1,59 @@
+// console_rx.h  (shared by the lab programs)
+//
+// Interrupt-driven keyboard input from the USB virtual COM port (USART1).
+//
+// console_rx_init() enables the USART1 RXNE interrupt; the ISR moves each byte
+// into a CONSOLE_RX_SIZE ring and clears ORE/FE/NE so the receiver never
+// locks up. The main loop polls:
+//
+//   int c = console_getc();     // -1 when nothing is waiting, never blocks
+//
+// so GPIO mirroring and rendering keep running while nobody types.
+//
+// ConsoleLine adds non-blocking line editing on top: feed it with
+// console_line_poll() every loop; backspace/DEL erase, Ctrl-U clears the
+// line, CR or LF completes it (optionally echoed).
+//
+// This file also provides _read (blocking until at least one byte) so
+// getchar()/scanf() still work once the ISR owns RDR. uart.c's own _read must
+// be left out of the link (or marked __weak), and no other USART1_IRQHandler
+// may be linked, in projects that use this file.
+
+#ifndef CONSOLE_RX_H
+#define CONSOLE_RX_H
+
+#include <stdint.h>
+
+#define CONSOLE_RX_SIZE  256U   // ring size, power of two
+
+typedef struct {
+  uint32_t bytes;      // bytes received
+  uint32_t dropped;    // bytes lost because the ring was full
+  uint32_t ore;        // hardware overruns (ISR too late)
+  uint32_t fe;         // framing errors
+  uint32_t ne;         // noise errors
+  uint32_t high_water; // most bytes ever waiting
+} ConsoleRxStats;
+
+void     console_rx_init(void);
+int      console_getc(void);
+uint32_t console_rx_available(void);
+
+const ConsoleRxStats *console_rx_stats(void);
+
+typedef struct {
+  char    *buf;
+  uint16_t cap;    // including the NUL
+  uint16_t len;
+  uint8_t  echo;   // echo edits back to the terminal
+  uint8_t  last_cr;
+} ConsoleLine;
+
+void console_line_init(ConsoleLine *l, char *buf, uint16_t cap, uint8_t echo);
+
+// Drains pending input into the line. Returns 1 when CR/LF completed it: buf
+// holds the NUL-terminated text (no CR/LF) until the next poll starts a new
+// line. Returns 0 otherwise.
+int  console_line_poll(ConsoleLine *l);
+
+#endif // CONSOLE_RX_H
@@ -0,0 +1,230 @@
+// console_tx.c  (shared by the lab programs)
+//
+// See console_tx.h. Register-level DMA so the ISR path stays short; the HAL
+// UART handle in uart.c keeps owning RX.
+
+#include "console_tx.h"
+#include "stm32f7xx_hal.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TX_MASK (CONSOLE_TX_SIZE - 1U)
+
+#define TX_STREAM      DMA2_Stream7
+#define TX_FLAGS_7     (DMA_HISR_TCIF7 | DMA_HISR_HTIF7 | DMA_HISR_TEIF7 | DMA_HISR_DMEIF7 | DMA_HISR_FEIF7)
+
+// Ring: head is written by _write, tail (and the in-flight chunk) by the
+// DMA service. Both are free-running; pending = head - tail.
+static uint8_t  tx_ring[CONSOLE_TX_SIZE] __attribute__((aligned(32)));
+static volatile uint32_t tx_head;
+static volatile uint32_t tx_tail;
+static volatile uint32_t tx_busy;     // length of the chunk on the wire, 0 = idle
+static uint8_t  tx_ready;
+static char     tx_line[CONSOLE_TX_LINE];
+
+static ConsoleTxStats tx_stats;
+
+//---------------------------------------------------------------------------
+// DMA side
+//---------------------------------------------------------------------------
+
+// Start the next contiguous chunk if the stream is idle. Called with the
+// stream IRQ masked or from the IRQ itself.
+static void tx_kick(void)
+{
+  if (tx_busy) return;
+
+  uint32_t pending = tx_head - tx_tail;
+  if (pending == 0) return;
+
+  uint32_t off = tx_tail & TX_MASK;
+  uint32_t len = CONSOLE_TX_SIZE - off;      // up to the end of the ring
+  if (len > pending) len = pending;
+
+  // DMA reads SRAM directly; push the bytes out of the D-cache first
+  if (SCB->CCR & SCB_CCR_DC_Msk) {
+    uint32_t a = (uint32_t)&tx_ring[off] & ~31U;
+    SCB_CleanDCache_by_Addr((uint32_t *)a, (int32_t)(((uint32_t)&tx_ring[off] + len) - a));
+  }
+
+  DMA2->HIFCR     = TX_FLAGS_7;
+  TX_STREAM->M0AR = (uint32_t)&tx_ring[off];
+  TX_STREAM->NDTR = len;
+  tx_busy = len;
+  tx_stats.chunks++;
+  TX_STREAM->CR  |= DMA_SxCR_EN;
+}
+
+// Retire a finished chunk and start the next one
+static void tx_service(void)
+{
+  uint32_t isr = DMA2->HISR;
+
+  if (tx_busy && (isr & (DMA_HISR_TCIF7 | DMA_HISR_TEIF7))) {
+    DMA2->HIFCR = TX_FLAGS_7;
+    tx_tail += tx_busy;   // on a transfer error the chunk is dropped, not retried
+    tx_busy = 0;
+  }
+  tx_kick();
+}
+
+void DMA2_Stream7_IRQHandler(void)
+{
+  tx_service();
+}
+
+// Run the service from thread context. With interrupts globally off (fault
+// handlers, Error_Handler) the IRQ never fires, so poll the flags instead.
+static void tx_service_locked(void)
+{
+  NVIC_DisableIRQ(DMA2_Stream7_IRQn);
+  tx_service();
+  NVIC_EnableIRQ(DMA2_Stream7_IRQn);
+}
+
+//---------------------------------------------------------------------------
+// Syscall
+//---------------------------------------------------------------------------
+
+// Blocking fallback until console_tx_init() has run
+static void tx_poll_bytes(const char *p, int len)
+{
+  for (int i = 0; i < len; i++) {
+    while (!(USART1->ISR & USART_ISR_TXE)) { }
+    USART1->TDR = (uint8_t)p[i];
+  }
+}
+
+int _write(int file, char *ptr, int len)
+{
+  (void)file;
+
+  if (!tx_ready) {
+    tx_poll_bytes(ptr, len);
+    return len;
+  }
+
+  uint32_t t0 = DWT->CYCCNT;
+  uint32_t left = (uint32_t)len;
+  uint8_t  stalled = 0;
+
+  while (left) {
+    uint32_t space = CONSOLE_TX_SIZE - (tx_head - tx_tail);
+    if (space == 0) {
+      // Ring full: this is the only place printf can wait
+      stalled = 1;
+      tx_service_locked();
+      continue;
+    }
+
+    uint32_t off = tx_head & TX_MASK;
+    uint32_t n = CONSOLE_TX_SIZE - off;
+    if (n > space) n = space;
+    if (n > left)  n = left;
+
+    memcpy(&tx_ring[off], ptr, n);
+    __DMB();
+    tx_head += n;
+    ptr  += n;
+    left -= n;
+
+    uint32_t pending = tx_head - tx_tail;
+    if (pending > tx_stats.high_water) tx_stats.high_water = pending;
+  }
+
+  tx_service_locked();
+
+  tx_stats.bytes  += (uint32_t)len;
+  tx_stats.writes++;
+  tx_stats.stalls += stalled;
+  tx_stats.cycles += DWT->CYCCNT - t0;
+  return len;
+}
+
+//---------------------------------------------------------------------------
+// Public API
+//---------------------------------------------------------------------------
+void console_tx_init(void)
+{
+  // Let anything already printed leave before the DMA takes over TDR
+  while (!(USART1->ISR & USART_ISR_TC)) { }
+
+  // Cycle counter for the stats (left running, never reset here)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  __HAL_RCC_DMA2_CLK_ENABLE();
+
+  TX_STREAM->CR &= ~DMA_SxCR_EN;
+  while (TX_STREAM->CR & DMA_SxCR_EN) { }
+
+  TX_STREAM->PAR = (uint32_t)&USART1->TDR;
+  TX_STREAM->CR  = (4U << DMA_SxCR_CHSEL_Pos)   // channel 4 = USART1_TX
+                 | DMA_SxCR_DIR_0                 // memory to peripheral
+                 | DMA_SxCR_MINC
+                 | DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+  TX_STREAM->FCR = 0;                             // direct mode
+  DMA2->HIFCR    = TX_FLAGS_7;
+
+  USART1->CR3 |= USART_CR3_DMAT;
+
+  HAL_NVIC_SetPriority(DMA2_Stream7_IRQn, 0x0E, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream7_IRQn);
+
+  tx_head = tx_tail = 0;
+  tx_busy = 0;
+  memset(&tx_stats, 0, sizeof(tx_stats));
+  tx_ready = 1;
+
+  setvbuf(stdout, tx_line, _IOLBF, sizeof(tx_line));
+}
+
+void console_tx_flush(void)
+{
+  fflush(stdout);
+  if (!tx_ready) return;
+
+  while (tx_head != tx_tail) {
+    tx_service_locked();
+  }
+  while (!(USART1->ISR & USART_ISR_TC)) { }  // last byte out of the shifter
+}
+
+uint32_t console_tx_pending(void)
+{
+  return tx_head - tx_tail;
+}
+
+const ConsoleTxStats *console_tx_stats(void)
+{
+  return &tx_stats;
+}
+
+uint32_t console_tx_cycles_per_kb(void)
+{
+  if (tx_stats.bytes == 0) return 0;
+  return (uint32_t)(((uint64_t)tx_stats.cycles * 1024U) / tx_stats.bytes);
+}
+
+uint32_t console_tx_blocking_cycles_per_kb(void)
+{
+  // USART1 runs from PCLK2 with 16x oversampling: baud = PCLK2 / BRR
+  uint32_t brr = USART1->BRR;
+  if (brr == 0) return 0;
+  uint32_t baud = HAL_RCC_GetPCLK2Freq() / brr;
+  return (uint32_t)(((uint64_t)SystemCoreClock * 10U * 1024U) / baud);
+}
+
+void console_tx_report(void)
+{
+  uint32_t now  = console_tx_cycles_per_kb();
+  uint32_t blk  = console_tx_blocking_cycles_per_kb();
+  uint32_t save = (blk > now && blk) ? (uint32_t)(((uint64_t)(blk - now) * 100U) / blk) : 0;
+
+  printf("console: %lu B in %lu writes, %lu cyc/KB (blocking %lu cyc/KB, %lu%% saved), "
+         "high water %lu/%u, stalls %lu\r\n",
+         (unsigned long)tx_stats.bytes, (unsigned long)tx_stats.writes,
+         (unsigned long)now, (unsigned long)blk, (unsigned long)save,
+         (unsigned long)tx_stats.high_water, (unsigned)CONSOLE_TX_SIZE,
+         (unsigned long)tx_stats.stalls);
+}
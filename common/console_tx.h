@@ -0,0 +1,55 @@
+// console_tx.h  (shared by the lab programs)
+//
+// Buffered, DMA-driven stdout for the USB virtual COM port (USART1).
+//
+// console_tx_init() takes over the _write syscall: printf/fwrite/fflush copy
+// into a CONSOLE_TX_SIZE byte ring and return. USART1 drains the ring on
+// DMA2 Stream 7 / Channel 4, one contiguous chunk at a time; while a chunk is
+// on the wire the CPU keeps filling the other part of the ring (that is the
+// double buffering). Writes only block when the ring is full.
+//
+// stdout is switched to line buffering on a CONSOLE_TX_LINE byte stdio buffer,
+// so existing code that relies on "\r\n" or fflush() to show text still works.
+// Frame semantics:
+//   fflush(stdout)      end of frame: hand everything to DMA, do not wait
+//   console_tx_flush()  sync point: fflush + wait until the last byte left
+//                       (before resets, long HAL_Delay()s, or blocking HAL_UART_*
+//                       calls on USART1)
+//
+// Before console_tx_init() (and if it is never called) _write falls back to
+// polling TDR, so early prints are not lost. uart.c's own _write must be
+// left out of the link (or marked __weak) in projects that use this file.
+// _write is not reentrant: do not printf from an ISR that can preempt printf.
+
+#ifndef CONSOLE_TX_H
+#define CONSOLE_TX_H
+
+#include <stdint.h>
+
+#define CONSOLE_TX_SIZE  4096U   // ring size, power of two
+#define CONSOLE_TX_LINE  256U    // stdio buffer in front of the ring
+
+typedef struct {
+  uint32_t bytes;        // bytes queued through _write
+  uint32_t writes;       // _write calls
+  uint32_t chunks;       // DMA transfers started
+  uint32_t high_water;   // most bytes ever pending in the ring
+  uint32_t stalls;       // writes that had to wait for ring space
+  uint32_t cycles;       // DWT cycles spent inside _write
+} ConsoleTxStats;
+
+void     console_tx_init(void);
+void     console_tx_flush(void);
+uint32_t console_tx_pending(void);
+
+const ConsoleTxStats *console_tx_stats(void);
+
+// Cycles per KB the printf path costs now vs. what a blocking write costs at
+// the current baud rate (10 bit times per byte).
+uint32_t console_tx_cycles_per_kb(void);
+uint32_t console_tx_blocking_cycles_per_kb(void);
+
+// One-line summary of the above, printed through the console itself
+void     console_tx_report(void);
+
+#endif // CONSOLE_TX_H
@@ -0,0 +1,123 @@
+// dlog.c  (shared by the lab programs)
+//
+// See dlog.h. No HAL dependencies so the same file links on the host.
+
+#include "dlog.h"
+#include "fmt.h"
+#include <stdio.h>
+
+#define DLOG_MASK (DLOG_SIZE - 1U)
+
+typedef struct {
+  uint32_t  seq;     // == position: free for that producer; == position + 1: full
+  DlogEntry e;
+} DlogSlot;
+
+static DlogSlot  dlog_ring[DLOG_SIZE];
+static uint32_t  dlog_enq;
+static uint32_t  dlog_deq;
+static DlogStats dlog_st;
+static uint32_t  dlog_dropped_shown;
+
+void dlog_init(void)
+{
+  for (uint32_t i = 0; i < DLOG_SIZE; i++) {
+    __atomic_store_n(&dlog_ring[i].seq, i, __ATOMIC_RELAXED);
+  }
+  __atomic_store_n(&dlog_enq, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&dlog_deq, 0, __ATOMIC_RELAXED);
+  dlog_st = (DlogStats){0};
+  dlog_dropped_shown = 0;
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+int dlog_push(const char *fmt, uint8_t nargs,
+              uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+  uint32_t pos = __atomic_load_n(&dlog_enq, __ATOMIC_RELAXED);
+  DlogSlot *s;
+
+  // Claim a slot: its sequence must equal our position
+  for (;;) {
+    s = &dlog_ring[pos & DLOG_MASK];
+    uint32_t seq  = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+    int32_t  diff = (int32_t)(seq - pos);
+
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&dlog_enq, &pos, pos + 1, 1,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+    } else if (diff < 0) {
+      __atomic_fetch_add(&dlog_st.dropped, 1, __ATOMIC_RELAXED);   // full
+      return 0;
+    } else {
+      pos = __atomic_load_n(&dlog_enq, __ATOMIC_RELAXED);
+    }
+  }
+
+  s->e.fmt     = fmt;
+  s->e.nargs   = nargs;
+  s->e.args[0] = a0;
+  s->e.args[1] = a1;
+  s->e.args[2] = a2;
+  s->e.args[3] = a3;
+  __atomic_store_n(&s->seq, pos + 1, __ATOMIC_RELEASE);   // publish
+
+  __atomic_fetch_add(&dlog_st.pushed, 1, __ATOMIC_RELAXED);
+  uint32_t used = pos + 1 - __atomic_load_n(&dlog_deq, __ATOMIC_RELAXED);
+  if (used > dlog_st.high_water) dlog_st.high_water = used;   // approximate, stats only
+  return 1;
+}
+
+int dlog_pop(DlogEntry *out)
+{
+  uint32_t pos = __atomic_load_n(&dlog_deq, __ATOMIC_RELAXED);
+  DlogSlot *s;
+
+  for (;;) {
+    s = &dlog_ring[pos & DLOG_MASK];
+    uint32_t seq  = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+    int32_t  diff = (int32_t)(seq - (pos + 1));
+
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&dlog_deq, &pos, pos + 1, 1,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+    } else if (diff < 0) {
+      return 0;   // empty (or the next producer has not published yet)
+    } else {
+      pos = __atomic_load_n(&dlog_deq, __ATOMIC_RELAXED);
+    }
+  }
+
+  *out = s->e;
+  __atomic_store_n(&s->seq, pos + DLOG_SIZE, __ATOMIC_RELEASE);   // free for the next lap
+  return 1;
+}
+
+uint32_t dlog_drain(uint32_t max)
+{
+  DlogEntry e;
+  char line[160];
+  uint32_t n = 0;
+
+  while ((max == 0 || n < max) && dlog_pop(&e)) {
+    int len = fmt_snprintf(line, sizeof(line), e.fmt,
+                           e.args[0], e.args[1], e.args[2], e.args[3]);
+    if (len > (int)sizeof(line) - 1) len = (int)sizeof(line) - 1;
+    fwrite(line, 1, (size_t)len, stdout);
+    n++;
+  }
+
+  uint32_t dropped = __atomic_load_n(&dlog_st.dropped, __ATOMIC_RELAXED);
+  if (dropped != dlog_dropped_shown) {
+    printf("[dlog: %lu entries dropped]\r\n", (unsigned long)(dropped - dlog_dropped_shown));
+    dlog_dropped_shown = dropped;
+  }
+
+  if (n) fflush(stdout);
+  return n;
+}
+
+const DlogStats *dlog_stats(void)
+{
+  return &dlog_st;
+}
@@ -0,0 +1,61 @@
+// dlog.h  (shared by the lab programs)
+//
+// Deferred logging: get printf out of interrupt handlers.
+//
+//   DLOG("Elapsed time: %lu tenths of a second\r\n", tenths);   // in an ISR
+//   dlog_drain(0);                                             // main loop
+//
+// DLOG() stores the format pointer (the format "ID": a string literal in
+// flash) and up to DLOG_MAX_ARGS 32-bit arguments in a lock-free ring and
+// returns; no formatting, no UART. dlog_drain() formats the entries with
+// fmt_snprintf() and writes them to stdout from thread context (with
+// console_tx linked that is a DMA hand-off as well).
+//
+// The ring is a bounded multi-producer/multi-consumer queue with per-slot
+// sequence numbers (Vyukov style) on __atomic builtins, so ISRs of any
+// priority can log concurrently with each other and with the drain.
+// When it is full the entry is dropped and counted, never waited for.
+//
+// Arguments are 32-bit words: integers, chars and (on the board) pointers to
+// strings that stay valid until drained. No floating point.
+
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdint.h>
+
+#define DLOG_SIZE      256U   // entries, power of two
+#define DLOG_MAX_ARGS  4
+
+typedef struct {
+  const char *fmt;
+  uint8_t     nargs;
+  uint32_t    args[DLOG_MAX_ARGS];
+} DlogEntry;
+
+typedef struct {
+  uint32_t pushed;
+  uint32_t dropped;     // ring full
+  uint32_t high_water;  // most entries ever waiting
+} DlogStats;
+
+void dlog_init(void);
+int  dlog_push(const char *fmt, uint8_t nargs,
+               uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+int  dlog_pop(DlogEntry *out);           // 1 = got an entry, 0 = empty
+
+// Format and print up to max entries (0 = all waiting). Returns the count.
+uint32_t dlog_drain(uint32_t max);
+
+const DlogStats *dlog_stats(void);
+
+// DLOG(fmt, ...) with 0..4 arguments
+#define DLOG(...) DLOG_SEL_(__VA_ARGS__, DLOG4_, DLOG3_, DLOG2_, DLOG1_, DLOG0_, _)(__VA_ARGS__)
+#define DLOG_SEL_(_f, _1, _2, _3, _4, M, ...) M
+#define DLOG0_(f)             dlog_push((f), 0, 0, 0, 0, 0)
+#define DLOG1_(f, a)          dlog_push((f), 1, (uint32_t)(a), 0, 0, 0)
+#define DLOG2_(f, a, b)       dlog_push((f), 2, (uint32_t)(a), (uint32_t)(b), 0, 0)
+#define DLOG3_(f, a, b, c)    dlog_push((f), 3, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), 0)
+#define DLOG4_(f, a, b, c, d) dlog_push((f), 4, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d))
+
+#endif // DLOG_H
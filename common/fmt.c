@@ -0,0 +1,236 @@
+// fmt.c  (shared by the lab programs)
+//
+// See fmt.h. No HAL dependencies so the same file links on the host.
+
+#include "fmt.h"
+
+static const char fmt_digits2[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static unsigned fmt_count_digits(uint32_t v)
+{
+  unsigned n = 1;
+  while (v >= 10) { v /= 10; n++; }
+  return n;
+}
+
+// Write exactly 'n' digits of v ending at p + n
+static char *fmt_u32_n(char *p, uint32_t v, unsigned n)
+{
+  char *end = p + n;
+  char *q = end;
+
+  while (v >= 100) {
+    unsigned i = (v % 100) * 2;
+    v /= 100;
+    *--q = fmt_digits2[i + 1];
+    *--q = fmt_digits2[i];
+  }
+  if (v >= 10) {
+    *--q = fmt_digits2[v * 2 + 1];
+    *--q = fmt_digits2[v * 2];
+  } else {
+    *--q = (char)('0' + v);
+  }
+  while (q > p) *--q = '0';   // leading zeros when n is wider than v
+  return end;
+}
+
+//---------------------------------------------------------------------------
+// Encoders
+//---------------------------------------------------------------------------
+char *fmt_u32(char *p, uint32_t v)
+{
+  return fmt_u32_n(p, v, fmt_count_digits(v));
+}
+
+char *fmt_i32(char *p, int32_t v)
+{
+  if (v < 0) {
+    *p++ = '-';
+    return fmt_u32(p, 0U - (uint32_t)v);
+  }
+  return fmt_u32(p, (uint32_t)v);
+}
+
+char *fmt_u32_pad(char *p, uint32_t v, unsigned width, char pad)
+{
+  unsigned n = fmt_count_digits(v);
+  while (width > n) { *p++ = pad; width--; }
+  return fmt_u32_n(p, v, n);
+}
+
+char *fmt_hex(char *p, uint32_t v, unsigned min_digits, int upper)
+{
+  const char *hx = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  unsigned n = 1;
+  while (n < 8 && (v >> (4 * n))) n++;
+  if (n < min_digits) n = min_digits;
+
+  for (unsigned i = n; i-- > 0; ) {
+    *p++ = (i < 8) ? hx[(v >> (4 * i)) & 0xF] : '0';
+  }
+  return p;
+}
+
+char *fmt_fixed(char *p, int32_t v, unsigned frac_digits)
+{
+  uint32_t mag = (v < 0) ? 0U - (uint32_t)v : (uint32_t)v;
+  uint32_t scale = 1;
+  for (unsigned i = 0; i < frac_digits; i++) scale *= 10;
+
+  if (v < 0) *p++ = '-';
+  p = fmt_u32(p, mag / scale);
+  if (frac_digits) {
+    *p++ = '.';
+    p = fmt_u32_n(p, mag % scale, frac_digits);
+  }
+  return p;
+}
+
+char *fmt_str(char *p, const char *s)
+{
+  while (*s) *p++ = *s++;
+  return p;
+}
+
+char *fmt_cup(char *p, unsigned row, unsigned col)
+{
+  *p++ = '\033';
+  *p++ = '[';
+  p = (row < 100) ? fmt_u32_n(p, row, row < 10 ? 1 : 2) : fmt_u32(p, row);
+  *p++ = ';';
+  p = (col < 100) ? fmt_u32_n(p, col, col < 10 ? 1 : 2) : fmt_u32(p, col);
+  *p++ = 'H';
+  return p;
+}
+
+//---------------------------------------------------------------------------
+// printf subset
+//---------------------------------------------------------------------------
+
+// Bounded output: counts everything like snprintf, stores what fits
+typedef struct {
+  char  *buf;
+  size_t cap;   // usable chars (n - 1)
+  size_t len;
+} FmtOut;
+
+static void fmt_put(FmtOut *o, char c)
+{
+  if (o->len < o->cap) o->buf[o->len] = c;
+  o->len++;
+}
+
+static void fmt_put_n(FmtOut *o, const char *s, size_t n)
+{
+  for (size_t i = 0; i < n; i++) fmt_put(o, s[i]);
+}
+
+static void fmt_pad(FmtOut *o, char c, int n)
+{
+  while (n-- > 0) fmt_put(o, c);
+}
+
+int fmt_vsnprintf(char *buf, size_t n, const char *fmt, va_list ap)
+{
+  FmtOut o = { buf, n ? n - 1 : 0, 0 };
+
+  while (*fmt) {
+    if (*fmt != '%') {
+      const char *run = fmt;
+      while (*fmt && *fmt != '%') fmt++;
+      fmt_put_n(&o, run, (size_t)(fmt - run));
+      continue;
+    }
+    fmt++;
+
+    int left = 0, zero = 0, width = 0, prec = -1;
+    for (;; fmt++) {
+      if (*fmt == '-') left = 1;
+      else if (*fmt == '0') zero = 1;
+      else break;
+    }
+    if (*fmt == '*') {
+      width = va_arg(ap, int);
+      fmt++;
+      if (width < 0) { left = 1; width = -width; }   // as C: a negative '*' width is '-'
+    }
+    else while (*fmt >= '0' && *fmt <= '9') width = width * 10 + (*fmt++ - '0');
+    if (*fmt == '.') {
+      fmt++;
+      prec = 0;
+      if (*fmt == '*') { prec = va_arg(ap, int); fmt++; }
+      else while (*fmt >= '0' && *fmt <= '9') prec = prec * 10 + (*fmt++ - '0');
+    }
+    int is_long = 0;
+    while (*fmt == 'l' || *fmt == 'h') is_long |= (*fmt++ == 'l');
+
+    char tmp[FMT_U32_MAX + 2];
+    char *end = tmp;
+    const char *s = tmp;
+    size_t len;
+    int neg = 0;
+
+    switch (*fmt) {
+      case 'd': case 'i': {
+        int32_t v = is_long ? (int32_t)va_arg(ap, long) : va_arg(ap, int);
+        neg = v < 0;
+        end = fmt_u32(tmp, neg ? 0U - (uint32_t)v : (uint32_t)v);
+        if (prec == 0 && v == 0) end = tmp;   // "%.0d" prints no digits for 0
+        break;
+      }
+      case 'u': case 'x': case 'X': {
+        // long is 32-bit on the board, 64-bit on the host; values are truncated to 32
+        uint32_t v = is_long ? (uint32_t)va_arg(ap, unsigned long) : va_arg(ap, unsigned);
+        end = (*fmt == 'u') ? fmt_u32(tmp, v) : fmt_hex(tmp, v, 1, *fmt == 'X');
+        if (prec == 0 && v == 0) end = tmp;
+        break;
+      }
+      case 'c': tmp[0] = (char)va_arg(ap, int); end = tmp + 1; prec = -1; break;
+      case 's':
+        s = va_arg(ap, const char *);
+        if (!s) s = "(null)";
+        for (end = (char *)s; *end && (prec < 0 || end - s < prec); end++) { }
+        prec = -1;
+        break;
+      case '%': tmp[0] = '%'; end = tmp + 1; break;
+      case '\0': continue;
+      default:  tmp[0] = '%'; tmp[1] = *fmt; end = tmp + 2; break;   // pass unknown through
+    }
+    fmt++;
+
+    len = (size_t)(end - s);
+    int zeros = (prec > (int)len) ? prec - (int)len : 0;
+    int body  = (int)len + zeros + neg;
+    int fill  = (width > body) ? width - body : 0;
+
+    if (!left && !(zero && prec < 0)) fmt_pad(&o, ' ', fill);
+    if (neg) fmt_put(&o, '-');
+    if (!left && zero && prec < 0) fmt_pad(&o, '0', fill);
+    fmt_pad(&o, '0', zeros);
+    fmt_put_n(&o, s, len);
+    if (left) fmt_pad(&o, ' ', fill);
+  }
+
+  if (n) buf[(o.len < o.cap) ? o.len : o.cap] = '\0';
+  return (int)o.len;
+}
+
+int fmt_snprintf(char *buf, size_t n, const char *fmt, ...)
+{
+  va_list ap;
+  va_start(ap, fmt);
+  int r = fmt_vsnprintf(buf, n, fmt, ap);
+  va_end(ap);
+  return r;
+}
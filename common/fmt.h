@@ -0,0 +1,49 @@
+// fmt.h  (shared by the lab programs)
+//
+// Small, heap-free formatting for hot console paths.
+//
+// The fmt_* encoders write into a caller buffer and return the new end
+// pointer; they do not NUL-terminate, so calls chain:
+//
+//   char line[32], *p = line;
+//   p = fmt_cup(p, row, col);
+//   p = fmt_u32(p, count);
+//   fwrite(line, 1, p - line, stdout);
+//
+// Decimal conversion goes two digits at a time through a 200-byte "00".."99"
+// table, so ANSI cursor moves (fmt_cup) cost a handful of stores.
+//
+// fmt_snprintf() is a printf-compatible subset for when a format string reads
+// better: %d %i %u %x %X %c %s %% with '-', '0', width, precision (strings:
+// max chars, integers: min digits) and the 'l' / 'h' length modifiers.
+// There is no floating point on purpose; use fmt_fixed() on a scaled integer.
+
+#ifndef FMT_H
+#define FMT_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FMT_U32_MAX  10   // chars for the largest uint32_t
+#define FMT_CUP_MAX  12   // "\033[" + 5 + ";" + 5 + "H" worst case for 16-bit coords
+
+char *fmt_u32(char *p, uint32_t v);
+char *fmt_i32(char *p, int32_t v);
+char *fmt_u32_pad(char *p, uint32_t v, unsigned width, char pad);
+char *fmt_hex(char *p, uint32_t v, unsigned min_digits, int upper);
+
+// v is scaled by 10^frac_digits: fmt_fixed(p, 1234, 3) -> "1.234",
+// fmt_fixed(p, -5, 2) -> "-0.05".
+char *fmt_fixed(char *p, int32_t v, unsigned frac_digits);
+
+char *fmt_str(char *p, const char *s);
+
+// ANSI cursor position "\033[row;colH" (1-based)
+char *fmt_cup(char *p, unsigned row, unsigned col);
+
+int fmt_vsnprintf(char *buf, size_t n, const char *fmt, va_list ap);
+int fmt_snprintf(char *buf, size_t n, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#endif // FMT_H
@@ -0,0 +1,137 @@
+// gesture.c  (shared by the lab programs and the shooter)
+//
+// See gesture.h. No HAL dependencies so the same file links on the host.
+
+#include "gesture.h"
+#include <stddef.h>
+
+static void emit(Gesture *g, GestureType type, uint32_t t, uint32_t duration)
+{
+  GestureEvent e;
+  e.type     = type;
+  e.button   = g->id;
+  e.level    = (type == GESTURE_RELEASE) ? g->level : 0;
+  e.count    = (type == GESTURE_REPEAT) ? g->repeats : 0;
+  e.t        = t;
+  e.duration = duration;
+  if (g->emit) g->emit(&e, g->ctx);
+}
+
+// a < b in wrapping ms
+static inline int before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+static void flush_tap(Gesture *g)
+{
+  if (!g->tap_pending) return;
+  g->tap_pending = 0;
+  emit(g, GESTURE_TAP, g->t_tap, g->t_tap_len);
+}
+
+void gesture_init(Gesture *g, uint8_t id, const GestureConfig *cfg,
+                  GestureFn fn, void *ctx)
+{
+  g->cfg  = *cfg;
+  g->emit = fn;
+  g->ctx  = ctx;
+  g->id   = id;
+  g->down = 0;
+  g->level = 0;
+  g->tap_pending = 0;
+  g->second = 0;
+  g->seen = 0;
+  g->repeats = 0;
+  g->t_edge = g->t_down = g->t_tap = g->t_tap_len = 0;
+}
+
+int gesture_deadline(const Gesture *g, uint32_t *t)
+{
+  int any = 0;
+  uint32_t best = 0;
+  uint32_t c;
+
+#define CANDIDATE(x) do { c = (x); if (!any || before(c, best)) best = c; any = 1; } while (0)
+  if (g->down) {
+    if (g->cfg.hold_ms && g->level == 0)
+      CANDIDATE(g->t_down + g->cfg.hold_ms);
+    if (g->cfg.long_ms && g->level != GESTURE_LONG_HOLD)
+      CANDIDATE(g->t_down + g->cfg.long_ms);
+    if (g->cfg.repeat_ms)
+      CANDIDATE(g->t_down + g->cfg.repeat_delay_ms + (uint32_t)g->repeats * g->cfg.repeat_ms);
+  } else if (g->tap_pending) {
+    CANDIDATE(g->t_tap + g->cfg.double_ms + 1U);
+  }
+#undef CANDIDATE
+
+  if (any) *t = best;
+  return any;
+}
+
+void gesture_poll(Gesture *g, uint32_t now)
+{
+  uint32_t t;
+
+  // Handle thresholds in time order; each pass retires one
+  while (gesture_deadline(g, &t) && !before(now, t)) {
+    if (!g->down) {
+      flush_tap(g);   // double-tap window closed
+      continue;
+    }
+
+    uint32_t held = t - g->t_down;
+    if (g->cfg.hold_ms && g->level == 0 && held == g->cfg.hold_ms) {
+      flush_tap(g);   // the second press became a hold: first one was a tap
+      g->level = GESTURE_HOLD;
+      emit(g, GESTURE_HOLD, t, held);
+    } else if (g->cfg.long_ms && g->level != GESTURE_LONG_HOLD && held == g->cfg.long_ms) {
+      flush_tap(g);
+      g->level = GESTURE_LONG_HOLD;
+      emit(g, GESTURE_LONG_HOLD, t, held);
+    } else {
+      g->repeats++;
+      emit(g, GESTURE_REPEAT, t, held);
+    }
+  }
+}
+
+void gesture_edge(Gesture *g, int down, uint32_t t)
+{
+  down = down ? 1 : 0;
+  if (down == g->down) return;
+  if (g->seen && g->cfg.debounce_ms && before(t, g->t_edge + g->cfg.debounce_ms)) return;
+
+  // Time-based events that happened before this edge come first
+  gesture_poll(g, t);
+
+  g->seen   = 1;
+  g->t_edge = t;
+  g->down   = (uint8_t)down;
+
+  if (down) {
+    g->t_down  = t;
+    g->level   = 0;
+    g->repeats = 0;
+    g->second  = g->tap_pending;   // still inside the double-tap window
+    emit(g, GESTURE_PRESS, t, 0);
+    return;
+  }
+
+  uint32_t len = t - g->t_down;
+
+  if (g->level) {
+    emit(g, GESTURE_RELEASE, t, len);
+  } else if (g->cfg.tap_ms && len <= g->cfg.tap_ms) {
+    if (g->second) {
+      g->tap_pending = 0;
+      emit(g, GESTURE_DOUBLE_TAP, t, len);
+    } else if (g->cfg.double_ms) {
+      g->tap_pending = 1;
+      g->t_tap       = t;
+      g->t_tap_len   = len;
+    } else {
+      emit(g, GESTURE_TAP, t, len);
+    }
+  } else {
+    flush_tap(g);   // too long for a tap, too short for a hold
+  }
+  g->second = 0;
+}
@@ -0,0 +1,94 @@
+// gesture.h  (shared by the lab programs and the shooter)
+//
+// Button gestures from edge timestamps.
+//
+// Feed each accepted level change with its time (EXTI handler or a polling
+// loop) and the recognizer reports:
+//   PRESS        on the down edge (immediate, for fire buttons)
+//   TAP          released within tap_ms (held back by double_ms when
+//                double taps are enabled, to see if a second tap follows)
+//   DOUBLE_TAP   second tap starting within double_ms of the first release
+//   HOLD         held for hold_ms        (at that moment, not on release)
+//   LONG_HOLD    held for long_ms
+//   REPEAT       every repeat_ms while held, starting at repeat_delay_ms
+//   RELEASE      release after a HOLD/LONG_HOLD; 'level' says which was
+//                reached, 'duration' how long the press was
+//
+// Nothing needs a hardware timer per button: time-based events are derived
+// from the timestamps whenever the next edge or gesture_poll() arrives, and
+// gesture_deadline() says when polling next matters (one software timer
+// or the main loop can serve every button).
+//
+// Any threshold set to 0 disables that gesture. Edges closer than
+// debounce_ms to the last accepted edge are ignored as bounce.
+// No HAL dependencies: the core runs on the host against synthetic edges.
+
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <stdint.h>
+
+typedef enum {
+  GESTURE_NONE = 0,
+  GESTURE_PRESS,
+  GESTURE_TAP,
+  GESTURE_DOUBLE_TAP,
+  GESTURE_HOLD,
+  GESTURE_LONG_HOLD,
+  GESTURE_REPEAT,
+  GESTURE_RELEASE
+} GestureType;
+
+typedef struct {
+  GestureType type;
+  uint8_t     button;     // Gesture.id
+  uint8_t     level;      // RELEASE: GESTURE_HOLD or GESTURE_LONG_HOLD
+  uint16_t    count;      // REPEAT: 1, 2, ...
+  uint32_t    t;          // when it happened (ms)
+  uint32_t    duration;   // RELEASE/TAP: press length (ms)
+} GestureEvent;
+
+typedef struct {
+  uint16_t debounce_ms;
+  uint16_t tap_ms;
+  uint16_t double_ms;
+  uint16_t hold_ms;
+  uint16_t long_ms;
+  uint16_t repeat_delay_ms;
+  uint16_t repeat_ms;
+} GestureConfig;
+
+typedef void (*GestureFn)(const GestureEvent *e, void *ctx);
+
+typedef struct {
+  GestureConfig cfg;
+  GestureFn     emit;
+  void         *ctx;
+  uint8_t       id;
+
+  uint8_t       down;        // current debounced level
+  uint8_t       level;       // 0, GESTURE_HOLD or GESTURE_LONG_HOLD this press
+  uint8_t       tap_pending; // first tap waiting for a possible second
+  uint8_t       second;      // this press started inside the double-tap window
+  uint8_t       seen;        // any edge accepted yet
+  uint16_t      repeats;
+  uint32_t      t_edge;      // last accepted edge
+  uint32_t      t_down;
+  uint32_t      t_tap;       // release time of the pending tap
+  uint32_t      t_tap_len;
+} Gesture;
+
+void gesture_init(Gesture *g, uint8_t id, const GestureConfig *cfg,
+                  GestureFn emit, void *ctx);
+
+// Button level changed at time t (ms). Same-level calls are ignored, so a
+// polling loop may pass every sample.
+void gesture_edge(Gesture *g, int down, uint32_t t);
+
+// Emit the time-based events due at or before now.
+void gesture_poll(Gesture *g, uint32_t now);
+
+// 1 and *t = next time gesture_poll() has something to do, 0 if idle.
+int  gesture_deadline(const Gesture *g, uint32_t *t);
+
+#endif // GESTURE_H
@@ -0,0 +1,193 @@
+// swtimer.c  (shared by the lab programs)
+//
+// See swtimer.h. No HAL dependencies so the same file links on the host.
+
+#include "swtimer.h"
+#include <stddef.h>
+
+#define SWT_BITS   6
+#define SWT_MASK   (SWT_SLOTS - 1U)
+#define SWT_DUE    0xFF    // level tag: on w->due, being expired
+
+static inline uint32_t lvl_shift(int l) { return (uint32_t)l * SWT_BITS; }
+
+static void link(SwWheel *w, SwTimer *t, int l, uint32_t s)
+{
+  SwTimer **head = &w->slot[l][s];
+  t->level = (uint8_t)l;
+  t->slot  = (uint8_t)s;
+  t->prev  = NULL;
+  t->next  = *head;
+  if (*head) (*head)->prev = t;
+  *head = t;
+  w->busy[l] |= (uint64_t)1 << s;
+}
+
+static void unlink(SwWheel *w, SwTimer *t)
+{
+  SwTimer **head = (t->level == SWT_DUE) ? &w->due : &w->slot[t->level][t->slot];
+
+  if (t->prev) t->prev->next = t->next;
+  else         *head = t->next;
+  if (t->next) t->next->prev = t->prev;
+  if (t->level != SWT_DUE && !*head) w->busy[t->level] &= ~((uint64_t)1 << t->slot);
+}
+
+// File t by its expiry relative to w->now: the lowest level whose slot
+// number is less than a full turn away. expires must be after w->now.
+static void file(SwWheel *w, SwTimer *t)
+{
+  for (int l = 0; l < SWT_LEVELS; l++) {
+    uint32_t sh = lvl_shift(l);
+    uint32_t d  = ((t->expires >> sh) - (w->now >> sh)) & (0xFFFFFFFFU >> sh);   // wraps with the clock
+    if (d < SWT_SLOTS) {
+      link(w, t, l, (t->expires >> sh) & SWT_MASK);
+      return;
+    }
+  }
+  // Too far out: park in the top-level slot just behind the current one,
+  // re-filed when that slot cascades a full top-level turn from now
+  int l = SWT_LEVELS - 1;
+  link(w, t, l, ((w->now >> lvl_shift(l)) - 1U) & SWT_MASK);
+}
+
+void swt_init(SwWheel *w, const SwTimerPort *port)
+{
+  for (int l = 0; l < SWT_LEVELS; l++) {
+    for (int s = 0; s < SWT_SLOTS; s++) w->slot[l][s] = NULL;
+    w->busy[l] = 0;
+  }
+  w->due    = NULL;
+  w->active = 0;
+  w->fired  = 0;
+  if (port) w->port = *port;
+  else      w->port = (SwTimerPort){0};
+  w->now = w->port.now ? w->port.now() : 0;
+}
+
+void swt_setup(SwTimer *t, SwTimerFn fn, void *arg)
+{
+  t->next = t->prev = NULL;
+  t->fn     = fn;
+  t->arg    = arg;
+  t->active = 0;
+  t->period = 0;
+}
+
+// Earliest tick after w->now at which a slot needs attention. Level 0 slots
+// are expiries, higher-level slots are cascade points (the slot's start).
+static int next_event(const SwWheel *w, uint32_t *next)
+{
+  int found = 0;
+  uint32_t best = 0;
+
+  for (int l = 0; l < SWT_LEVELS; l++) {
+    if (!w->busy[l]) continue;
+    uint32_t sh  = lvl_shift(l);
+    uint32_t cur = (w->now >> sh) & SWT_MASK;
+    // rotate so bit 0 is the slot after the current one
+    uint32_t r   = (cur + 1U) & SWT_MASK;
+    uint64_t rot = (w->busy[l] >> r) | (r ? w->busy[l] << (SWT_SLOTS - r) : 0);
+    uint32_t d   = (uint32_t)__builtin_ctzll(rot) + 1U;
+    uint32_t at  = ((w->now >> sh) + d) << sh;
+
+    if (!found || (int32_t)(at - best) < 0) best = at;
+    found = 1;
+  }
+  if (found) *next = best;
+  return found;
+}
+
+void swt_start(SwWheel *w, SwTimer *t, uint32_t delay, uint32_t period)
+{
+  uint32_t now = w->port.now ? w->port.now() : w->now;
+
+  if (t->active) unlink(w, t);
+  else           w->active++;
+
+  if (delay == 0) delay = 1;
+  t->expires = now + delay;
+  t->period  = period;
+  t->active  = 1;
+  file(w, t);
+
+  // The compare may be set for something later: bring it forward
+  if (w->port.arm) {
+    uint32_t next;
+    if (next_event(w, &next)) w->port.arm(next);
+  }
+}
+
+void swt_cancel(SwWheel *w, SwTimer *t)
+{
+  if (!t->active) return;
+  unlink(w, t);
+  t->active = 0;
+  w->active--;
+  // A stale compare only costs one empty swt_service()
+}
+
+static void cascade(SwWheel *w, int l)
+{
+  uint32_t s = (w->now >> lvl_shift(l)) & SWT_MASK;
+  SwTimer *t = w->slot[l][s];
+
+  w->slot[l][s] = NULL;
+  w->busy[l] &= ~((uint64_t)1 << s);
+  while (t) {
+    SwTimer *n = t->next;
+    file(w, t);
+    t = n;
+  }
+}
+
+// The slot moves to w->due before any callback runs, so callbacks can
+// start or cancel anything (including timers still waiting on w->due).
+static void expire(SwWheel *w)
+{
+  uint32_t s = w->now & SWT_MASK;
+  SwTimer *t;
+
+  w->due = w->slot[0][s];
+  w->slot[0][s] = NULL;
+  w->busy[0] &= ~((uint64_t)1 << s);
+  for (t = w->due; t; t = t->next) t->level = SWT_DUE;
+
+  while ((t = w->due) != NULL) {
+    unlink(w, t);
+    t->active = 0;
+    w->active--;
+    w->fired++;
+    if (t->period) {
+      t->expires += t->period;
+      t->active = 1;
+      w->active++;
+      file(w, t);
+    }
+    t->fn(t, t->arg);
+  }
+}
+
+int swt_advance(SwWheel *w, uint32_t now, uint32_t *next)
+{
+  uint32_t at;
+
+  while (next_event(w, &at) && (int32_t)(at - now) <= 0) {
+    w->now = at;
+    for (int l = SWT_LEVELS - 1; l > 0; l--) {
+      uint32_t mask = ((uint32_t)1 << lvl_shift(l)) - 1U;
+      if ((at & mask) == 0 && (w->busy[l] & ((uint64_t)1 << ((at >> lvl_shift(l)) & SWT_MASK)))) {
+        cascade(w, l);
+      }
+    }
+    expire(w);
+  }
+  w->now = now;
+  return next_event(w, next);
+}
+
+void swt_service(SwWheel *w)
+{
+  uint32_t next;
+  if (swt_advance(w, w->port.now(), &next) && w->port.arm) w->port.arm(next);
+}
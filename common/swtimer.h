@@ -0,0 +1,80 @@
+// swtimer.h  (shared by the lab programs)
+//
+// Software timers multiplexed on one compare-match hardware timer.
+//
+// A hierarchical timing wheel: SWT_LEVELS levels of 64 slots, level L
+// holding timers that are 64^L..64^(L+1) ticks out. Each slot is an
+// intrusive doubly linked list, so start and cancel are O(1) with no
+// allocation; a 64-bit occupancy bitmap per level finds the next busy slot
+// with one count-trailing-zeros. Timers further out than 64^SWT_LEVELS
+// ticks park in the top level and are re-filed when it comes round.
+//
+// Tickless: nothing runs per tick. swt_service() processes everything due
+// up to the current time and asks the port to arm the compare for the next
+// event (an expiry or the point where a higher-level slot cascades down).
+//
+// Port (per board, see Lab02 for TIM2):
+//   now()  free-running tick counter (any rate, 32 bits, wraps)
+//   arm(t) interrupt at tick t; if t has already passed, interrupt at once
+//   ISR    clear the flag and call swt_service()
+//
+// Not reentrant: start, cancel and service must not preempt each other
+// (call them from handlers of one priority, or mask around them).
+// Callbacks run inside swt_service() and may start or cancel any timer,
+// including their own.
+
+#ifndef SWTIMER_H
+#define SWTIMER_H
+
+#include <stdint.h>
+
+#define SWT_LEVELS  4     // 6 bits each: 2^24 ticks before parking
+#define SWT_SLOTS   64
+
+typedef struct SwTimer SwTimer;
+typedef void (*SwTimerFn)(SwTimer *t, void *arg);
+
+struct SwTimer {
+  SwTimer   *next, *prev;   // slot list, owned by the wheel
+  uint32_t   expires;       // absolute tick
+  uint32_t   period;        // 0 = one-shot
+  SwTimerFn  fn;
+  void      *arg;
+  uint8_t    level, slot;
+  uint8_t    active;
+};
+
+typedef struct {
+  uint32_t (*now)(void);
+  void     (*arm)(uint32_t tick);
+} SwTimerPort;
+
+typedef struct {
+  SwTimer    *slot[SWT_LEVELS][SWT_SLOTS];
+  uint64_t    busy[SWT_LEVELS];
+  SwTimer    *due;          // timers being expired right now
+  uint32_t    now;          // last tick processed
+  uint32_t    active;       // timers pending
+  uint32_t    fired;
+  SwTimerPort port;
+} SwWheel;
+
+void swt_init(SwWheel *w, const SwTimerPort *port);
+void swt_setup(SwTimer *t, SwTimerFn fn, void *arg);
+
+// Fire delay ticks from now (0 counts as 1), then every period ticks if
+// period != 0. Restarting an active timer moves it.
+void swt_start(SwWheel *w, SwTimer *t, uint32_t delay, uint32_t period);
+void swt_cancel(SwWheel *w, SwTimer *t);
+
+static inline int swt_active(const SwTimer *t) { return t->active; }
+
+// Run everything due at or before port.now(), then re-arm the port.
+void swt_service(SwWheel *w);
+
+// Same without the port: process up to tick 'now'. Returns 1 and sets
+// *next if anything is still pending. swt_service() is built on this;
+// host tests drive it with a simulated clock.
+int  swt_advance(SwWheel *w, uint32_t now, uint32_t *next);
+
+#endif // SWTIMER_H
@@ -0,0 +1,130 @@
+// timebase.c  (shared by the lab programs)
+//
+// See timebase.h. The host half keeps host tools and simulations on the
+// same API.
+
+#include "timebase.h"
+
+#ifdef HOST_BUILD
+
+#include <time.h>
+
+static uint64_t tb_epoch_ns;
+
+static uint64_t host_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void tb_init(void)
+{
+  if (!tb_epoch_ns) tb_epoch_ns = host_ns();
+}
+
+uint64_t tb_now_us(void)
+{
+  return (host_ns() - tb_epoch_ns) / 1000U;
+}
+
+uint32_t tb_cycles(void)        { return (uint32_t)host_ns(); }
+uint32_t tb_cycles_per_us(void) { return 1000U; }
+
+void tb_sleep_until(uint64_t deadline)
+{
+  uint64_t ns = tb_epoch_ns + deadline * 1000U;
+  struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {}
+}
+
+#else // board
+
+#include "stm32f7xx_hal.h"
+
+static volatile uint32_t tb_hi;     // TIM5 wraps (every ~71.6 minutes)
+static uint32_t tb_cpu_per_us;
+static uint8_t  tb_ready;
+
+void tb_init(void)
+{
+  if (tb_ready) return;
+
+  // Cycle counter: enable only, other modules may already be timing with it
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = 0xC5ACCE55;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  tb_cpu_per_us = SystemCoreClock / 1000000U;
+
+  // APB1 timers run at 2x PCLK1 whenever the APB1 prescaler is not 1
+  uint32_t timclk = HAL_RCC_GetPCLK1Freq();
+  if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) timclk *= 2U;
+
+  __HAL_RCC_TIM5_CLK_ENABLE();
+  TIM5->CR1  = 0;
+  TIM5->PSC  = timclk / 1000000U - 1U;   // 1 MHz
+  TIM5->ARR  = 0xFFFFFFFF;
+  TIM5->CNT  = 0;
+  TIM5->EGR  = TIM_EGR_UG;               // load PSC
+  TIM5->SR   = 0;
+  TIM5->DIER = TIM_DIER_UIE;
+  TIM5->CR1  = TIM_CR1_CEN;
+
+  HAL_NVIC_SetPriority(TIM5_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(TIM5_IRQn);
+  tb_ready = 1;
+}
+
+void TIM5_IRQHandler(void)
+{
+  uint32_t sr = TIM5->SR;
+
+  if (sr & TIM_SR_UIF) {
+    TIM5->SR = ~TIM_SR_UIF;
+    tb_hi++;
+  }
+  if (sr & TIM_SR_CC1IF) {
+    TIM5->SR = ~TIM_SR_CC1IF;       // tb_sleep_until() wake-up only
+    TIM5->DIER &= ~TIM_DIER_CC1IE;
+  }
+}
+
+uint64_t tb_now_us(void)
+{
+  uint32_t hi, lo, sr;
+
+  do {
+    hi = tb_hi;
+    lo = TIM5->CNT;
+    sr = TIM5->SR;
+  } while (hi != tb_hi);
+
+  // Wrapped, but the update interrupt has not run yet (we are masking it)
+  if ((sr & TIM_SR_UIF) && lo < 0x80000000U) hi++;
+
+  return ((uint64_t)hi << 32) | lo;
+}
+
+uint32_t tb_cycles(void)        { return DWT->CYCCNT; }
+uint32_t tb_cycles_per_us(void) { return tb_cpu_per_us; }
+
+void tb_sleep_until(uint64_t deadline)
+{
+  for (;;) {
+    uint64_t now = tb_now_us();
+    if (now >= deadline) break;
+
+    // Compare on the low word when it is less than half a wrap away;
+    // otherwise the update interrupt wakes us to try again
+    if (deadline - now < 0x80000000ULL) {
+      TIM5->CCR1 = (uint32_t)deadline;
+      TIM5->SR = ~TIM_SR_CC1IF;
+      TIM5->DIER |= TIM_DIER_CC1IE;
+      if (tb_now_us() >= deadline) break;
+    }
+    __WFI();   // any other interrupt also lands here; the loop re-checks
+  }
+  TIM5->DIER &= ~TIM_DIER_CC1IE;
+}
+
+#endif // HOST_BUILD
@@ -0,0 +1,46 @@
+// timebase.h  (shared by the lab programs)
+//
+// Monotonic time for measurements, timeouts and pacing.
+//
+//   tb_now_us()     64-bit microseconds since tb_init(); never wraps, never
+//                   resets, keeps counting through WFI sleep
+//   tb_cycles()     raw 32-bit DWT cycle counter for short intervals
+//                   (end - start, valid up to 2^32 cycles, ~19 s at 216 MHz)
+//   tb_sleep_us()   sleep in WFI until a deadline; no busy waiting
+//
+// On the board the microsecond clock is TIM5 (32-bit) at 1 MHz, extended to
+// 64 bits by its update interrupt. DWT CYCCNT is not used for it because
+// the core clock, and with it CYCCNT, stops in WFI. Nothing here writes
+// CYCCNT or TIM5->CNT, so any number of modules can take deltas at once.
+//
+// TIM5_IRQHandler lives in timebase.c and runs at priority 0 (it is a few
+// instructions) so the 64-bit read stays consistent from any context. The
+// sleeps use the TIM5 CC1 compare: call them from thread context only.
+//
+// Host builds (HOST_BUILD) use clock_gettime(CLOCK_MONOTONIC); "cycles"
+// are then nanoseconds.
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+
+void     tb_init(void);
+
+uint64_t tb_now_us(void);
+uint32_t tb_cycles(void);
+uint32_t tb_cycles_per_us(void);
+
+static inline uint32_t tb_cycles_to_us(uint32_t cycles)
+{
+  return cycles / tb_cycles_per_us();
+}
+
+// Deadlines are absolute tb_now_us() values
+static inline uint64_t tb_deadline_us(uint64_t us) { return tb_now_us() + us; }
+static inline int      tb_expired(uint64_t deadline) { return tb_now_us() >= deadline; }
+
+void     tb_sleep_until(uint64_t deadline);
+static inline void tb_sleep_us(uint64_t us) { tb_sleep_until(tb_deadline_us(us)); }
+
+#endif // TIMEBASE_H
@@ -0,0 +1,368 @@
+// bridge_host.c  (host model of Lab03/src/uart_bridge.c)
+//
+//   gcc -O2 -DHOST_BUILD -ILab03/src -o bridge_host
+//       host/bridge_host.c Lab03/src/uart_bridge.c -lpthread
+//
+// Runs the bridge core against two simulated ports. Each side of the link is
+// a real pipe: a producer thread writes the sender's byte stream into one end,
+// and a consumer thread reads what the bridge transmitted and checks it.
+//
+// Time is virtual, in byte times at the line rate, so the results hold for
+// any baud rate. Every tick each RX "DMA" takes one byte off its pipe into
+// the ring (an event every BRIDGE_RX_SEG bytes, IDLE one byte time after a
+// burst) and each TX "DMA" puts one byte on the wire. Latency is measured
+// per byte from ring arrival to the tick it leaves on TX.
+//
+// The remote sender obeys flow control: XON/XOFF bytes the bridge sends back
+// stop and restart it (and are not passed to the consumer), a closed RX gate
+// is RTS deasserted.
+
+#define _POSIX_C_SOURCE 199309L
+#include "uart_bridge.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RING_MASK  (BRIDGE_RING - 1U)
+#define STAGE      4096
+
+typedef struct {
+  // Sender on the far side of this port's RX
+  int       inFd;
+  uint8_t   stage[STAGE];
+  uint32_t  stageLen, stagePos;
+  uint64_t  toSend;
+  uint64_t  busyTicks;      // ticks the sender had a byte on the line
+  uint32_t  burst, gap;     // bytes left in the burst, idle ticks left
+  uint8_t   paused;         // XOFF seen
+  uint8_t   gate;           // RX gate open (RTS)
+  uint8_t   idleArmed;
+
+  // RX DMA
+  uint32_t  pos;
+  uint64_t  arrive[BRIDGE_RING];
+
+  // TX DMA and the receiver on the far side of TX
+  const uint8_t *txPtr;
+  uint32_t  txLeft;
+  uint32_t  txDiv, txWait;  // TX sends one byte every txDiv ticks
+  int       outFd;
+  uint8_t   out[STAGE];
+  uint32_t  outLen;
+
+  uint64_t  latSum, latN, latMax;
+} SimPort;
+
+typedef struct {
+  int       fd;
+  int       src;            // stream this port carries, for the pattern
+  uint64_t  bytes;
+  uint64_t  bad;
+} Consumer;
+
+static uint8_t  rings[BRIDGE_PORTS][BRIDGE_RING];
+static SimPort  sim[BRIDGE_PORTS];
+static Bridge   br;
+static uint64_t now;
+static uint64_t coreCalls, coreNs;
+static uint32_t rng = 2463534242u;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static uint64_t mono_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Byte i of stream s; never XON or XOFF
+static uint8_t pattern(int s, uint64_t i)
+{
+  uint8_t v = (uint8_t)(i * 131u + (i >> 8) + (uint64_t)s * 77u);
+  if (v == BRIDGE_XON || v == BRIDGE_XOFF) v ^= 0x40;
+  return v;
+}
+
+//---------------------------------------------------------------------------
+// Pipe ends
+//---------------------------------------------------------------------------
+typedef struct { int fd; int s; uint64_t n; } Producer;
+
+static void *producer(void *arg)
+{
+  Producer *p = arg;
+  uint8_t buf[STAGE];
+
+  for (uint64_t i = 0; i < p->n; ) {
+    uint32_t k = 0;
+    while (k < sizeof(buf) && i < p->n) buf[k++] = pattern(p->s, i++);
+    for (uint32_t off = 0; off < k; ) {
+      ssize_t w = write(p->fd, buf + off, k - off);
+      if (w <= 0) return NULL;
+      off += (uint32_t)w;
+    }
+  }
+  close(p->fd);
+  return NULL;
+}
+
+static void *consumer(void *arg)
+{
+  Consumer *c = arg;
+  uint8_t buf[STAGE];
+  ssize_t r;
+
+  while ((r = read(c->fd, buf, sizeof(buf))) > 0) {
+    for (ssize_t i = 0; i < r; i++) {
+      if (c->src >= 0 && buf[i] != pattern(c->src, c->bytes)) c->bad++;
+      c->bytes++;
+    }
+  }
+  return NULL;
+}
+
+//---------------------------------------------------------------------------
+// Port ops
+//---------------------------------------------------------------------------
+static uint32_t simRxPos(int p)
+{
+  return sim[p].pos;
+}
+
+static void simTxStart(int p, const uint8_t *src, uint32_t len)
+{
+  sim[p].txPtr  = src;
+  sim[p].txLeft = len;
+  sim[p].txWait = sim[p].txDiv;
+}
+
+static void simRxGate(int p, int open)
+{
+  sim[p].gate = (uint8_t)open;
+}
+
+static const BridgeOps simOps = { simRxPos, simTxStart, simRxGate, NULL };
+
+static void rxEvent(int p)
+{
+  uint64_t t0 = mono_ns();
+  bridge_rx_event(&br, p);
+  coreNs += mono_ns() - t0;
+  coreCalls++;
+}
+
+static void txDone(int p)
+{
+  uint64_t t0 = mono_ns();
+  bridge_tx_done(&br, p);
+  coreNs += mono_ns() - t0;
+  coreCalls++;
+}
+
+//---------------------------------------------------------------------------
+// One byte time
+//---------------------------------------------------------------------------
+static int nextIn(SimPort *s, uint8_t *v)
+{
+  if (s->stagePos == s->stageLen) {
+    ssize_t r = read(s->inFd, s->stage, sizeof(s->stage));
+    if (r <= 0) return 0;
+    s->stageLen = (uint32_t)r;
+    s->stagePos = 0;
+  }
+  *v = s->stage[s->stagePos++];
+  return 1;
+}
+
+static void flushOut(SimPort *s)
+{
+  for (uint32_t off = 0; off < s->outLen; ) {
+    ssize_t w = write(s->outFd, s->out + off, s->outLen - off);
+    if (w <= 0) break;
+    off += (uint32_t)w;
+  }
+  s->outLen = 0;
+}
+
+static void tickRx(int p, uint32_t maxBurst, uint32_t maxGap)
+{
+  SimPort *s = &sim[p];
+  int sent = 0;
+
+  if (s->gap) {
+    s->gap--;
+  } else if (s->toSend && !s->paused && s->gate) {
+    uint8_t v;
+    if (nextIn(s, &v)) {
+      rings[p][s->pos] = v;
+      s->arrive[s->pos] = now;
+      s->pos = (s->pos + 1) & RING_MASK;
+      s->toSend--;
+      s->busyTicks++;
+      sent = 1;
+      if ((s->pos & (BRIDGE_RX_SEG - 1U)) == 0) rxEvent(p);       // segment
+      if (maxGap && --s->burst == 0) {
+        s->burst = 1 + xorshift() % maxBurst;
+        s->gap   = 1 + xorshift() % maxGap;
+      }
+    }
+  }
+
+  if (sent) {
+    s->idleArmed = 1;
+  } else if (s->idleArmed) {
+    s->idleArmed = 0;
+    rxEvent(p);                                                    // IDLE
+  }
+}
+
+static void tickTx(int p)
+{
+  SimPort *s = &sim[p];
+
+  if (!s->txLeft || --s->txWait) return;
+  s->txWait = s->txDiv;
+
+  uint8_t v = *s->txPtr;
+  if (s->txPtr == &br.port[p].ctrlByte) {
+    s->paused = (v == BRIDGE_XOFF);   // the remote on this port reacts
+  } else {
+    int src = (s->txPtr >= rings[1]) ? 1 : 0;
+    uint32_t idx = (uint32_t)(s->txPtr - rings[src]);
+    uint64_t lat = now - sim[src].arrive[idx];
+    sim[src].latSum += lat;
+    sim[src].latN++;
+    if (lat > sim[src].latMax) sim[src].latMax = lat;
+
+    s->out[s->outLen++] = v;
+    if (s->outLen == sizeof(s->out)) flushOut(s);
+  }
+  s->txPtr++;
+  if (--s->txLeft == 0) txDone(p);
+}
+
+//---------------------------------------------------------------------------
+// Scenarios
+//---------------------------------------------------------------------------
+typedef struct {
+  const char *name;
+  uint64_t    bytes;          // per direction
+  uint32_t    maxBurst, maxGap;  // 0 gap: continuous
+  uint32_t    txDiv1;         // port 1 TX at 1/txDiv1 of the line rate
+  int         flow;
+} Scenario;
+
+static void run(const Scenario *sc)
+{
+  int inPipe[BRIDGE_PORTS][2], outPipe[BRIDGE_PORTS][2];
+  pthread_t prodT[BRIDGE_PORTS], consT[BRIDGE_PORTS];
+  Producer prod[BRIDGE_PORTS];
+  Consumer cons[BRIDGE_PORTS];
+  uint8_t *r[BRIDGE_PORTS] = { rings[0], rings[1] };
+
+  memset(sim, 0, sizeof(sim));
+  memset(rings, 0, sizeof(rings));
+  now = 0;
+  coreCalls = coreNs = 0;
+
+  for (int p = 0; p < BRIDGE_PORTS; p++) {
+    if (pipe(inPipe[p]) || pipe(outPipe[p])) { perror("pipe"); exit(1); }
+    sim[p].inFd   = inPipe[p][0];
+    sim[p].outFd  = outPipe[p][1];
+    sim[p].toSend = sc->bytes;
+    sim[p].gate   = 1;
+    sim[p].burst  = sc->maxGap ? 1 + xorshift() % sc->maxBurst : 0;
+    sim[p].txDiv  = (p == 1) ? sc->txDiv1 : 1;
+
+    prod[p] = (Producer){ inPipe[p][1], p, sc->bytes };
+    cons[p] = (Consumer){ outPipe[p][0], 1 - p, 0, 0 };
+    pthread_create(&prodT[p], NULL, producer, &prod[p]);
+    pthread_create(&consT[p], NULL, consumer, &cons[p]);
+  }
+
+  bridge_init(&br, &simOps, r);
+  bridge_route(&br, 0, 1, 1);
+  bridge_route(&br, 1, 0, 1);
+  bridge_flow(&br, 0, sc->flow);
+  bridge_flow(&br, 1, sc->flow);
+
+  uint64_t t0 = mono_ns();
+  for (;;) {
+    int busy = 0;
+    for (int p = 0; p < BRIDGE_PORTS; p++) {
+      tickRx(p, sc->maxBurst, sc->maxGap);
+      tickTx(p);
+      busy |= sim[p].toSend || sim[p].txLeft || sim[p].idleArmed ||
+              bridge_backlog(&br, p, 1 - p) ||
+              ((sim[p].pos - br.port[p].lastPos) & RING_MASK);
+    }
+    now++;
+    if (!busy) break;
+  }
+  uint64_t wall = mono_ns() - t0;
+
+  for (int p = 0; p < BRIDGE_PORTS; p++) {
+    flushOut(&sim[p]);
+    close(sim[p].outFd);
+    close(sim[p].inFd);
+    pthread_join(prodT[p], NULL);
+    pthread_join(consT[p], NULL);
+  }
+
+  printf("%s\n", sc->name);
+  for (int p = 0; p < BRIDGE_PORTS; p++) {
+    const BridgeStats *st = &br.port[p].st;
+    const SimPort *s = &sim[p];
+    int d = 1 - p;
+    printf("  %d->%d: %llu B in %llu byte times (line %.1f%% busy), delivered %llu B, "
+           "latency avg %.1f max %llu byte times\n"
+           "        overrun %lu, max fill %lu, flow stops %lu, ",
+           p, d, (unsigned long long)sc->bytes, (unsigned long long)now,
+           100.0 * (double)s->busyTicks / (double)now, (unsigned long long)cons[d].bytes,
+           s->latN ? (double)s->latSum / (double)s->latN : 0.0, (unsigned long long)s->latMax,
+           (unsigned long)st->overrun, (unsigned long)st->maxFill,
+           (unsigned long)st->flowStops);
+    if (st->overrun) printf("data not checked\n");
+    else             printf("%llu bad bytes\n", (unsigned long long)cons[d].bad);
+  }
+
+  // What it costs at real rates: core calls per second of line time
+  uint32_t bauds[] = { 921600, 4000000, 12500000 };
+  double callsPerTick = (double)coreCalls / (double)now;
+  printf("  core: %llu calls, %.0f ns each on this host;", (unsigned long long)coreCalls,
+         coreCalls ? (double)coreNs / (double)coreCalls : 0.0);
+  for (unsigned i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++) {
+    double bytesPerSec = bauds[i] / 10.0;
+    printf(" %.1f Mbaud %.0f IRQ/s, lat avg %.0f us%s", bauds[i] / 1e6,
+           callsPerTick * bytesPerSec,
+           (sim[0].latN ? (double)sim[0].latSum / (double)sim[0].latN : 0.0) * 1e6 / bytesPerSec,
+           i + 1 < sizeof(bauds) / sizeof(bauds[0]) ? ";" : "");
+  }
+  printf("\n  sim %.2f s wall\n", wall / 1e9);
+}
+
+int main(void)
+{
+  static const Scenario scenarios[] = {
+    { "full duplex, continuous",            8u << 20, 0,   0,  1, BRIDGE_FLOW_NONE    },
+    { "full duplex, bursts up to 512 B",    8u << 20, 512, 64, 1, BRIDGE_FLOW_NONE    },
+    { "port 1 TX at half rate, no flow",    1u << 20, 0,   0,  2, BRIDGE_FLOW_NONE    },
+    { "port 1 TX at half rate, XON/XOFF",   1u << 20, 0,   0,  2, BRIDGE_FLOW_XONXOFF },
+    { "port 1 TX at half rate, RTS/CTS",    1u << 20, 0,   0,  2, BRIDGE_FLOW_RTSCTS  },
+  };
+
+  for (unsigned i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+    run(&scenarios[i]);
+  }
+  return 0;
+}
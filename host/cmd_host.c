@@ -0,0 +1,205 @@
+// cmd_host.c  (host harness for Lab03/src/cmd.c)
+//
+//   gcc -O2 -ILab03/src -o cmd_host host/cmd_host.c Lab03/src/cmd.c
+//
+// Feeds scripted keystrokes through cmd_line_feed()/cmd_exec() against a
+// small table and checks the status, the handler that ran and the arguments
+// it saw. Then times lookups in a 64-entry table. Exits non-zero on failure.
+
+#define _POSIX_C_SOURCE 199309L
+#include "cmd.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static char ran[32];
+static int  ranArgc;
+static int32_t ranNum[CMD_MAX_ARGS];
+static char ranArg1[32];
+
+static void record(const char *name, const CmdArgs *a)
+{
+  snprintf(ran, sizeof(ran), "%s", name);
+  ranArgc = a->argc;
+  memcpy(ranNum, a->num, sizeof(ranNum));
+  snprintf(ranArg1, sizeof(ranArg1), "%s", a->argc > 1 ? a->argv[1] : "");
+}
+
+static void do_clear(const CmdArgs *a, void *ctx) { (void)ctx; record("clear", a); }
+static void do_exit(const CmdArgs *a, void *ctx)  { (void)ctx; record("exit", a); }
+static void do_led(const CmdArgs *a, void *ctx)   { (void)ctx; record("led", a); }
+static void do_set(const CmdArgs *a, void *ctx)   { (void)ctx; record("set", a); }
+static void do_echo(const CmdArgs *a, void *ctx)  { (void)ctx; record("echo", a); }
+
+static int parse_led(CmdArgs *a)
+{
+  a->num[1] = -1;
+  if (a->argc == 1) return CMD_OK;
+  if (a->argc != 2) return CMD_ERR_ARGS;
+  if (strcmp(a->argv[1], "on") == 0)  { a->num[1] = 1; return CMD_OK; }
+  if (strcmp(a->argv[1], "off") == 0) { a->num[1] = 0; return CMD_OK; }
+  return CMD_ERR_ARGS;
+}
+
+static int parse_set(CmdArgs *a)
+{
+  if (a->argc != 3) return CMD_ERR_ARGS;
+  return cmd_parse_ints(a);
+}
+
+static const CmdEntry entries[] = {
+  { "c",     cmd_parse_none, do_clear, "" },
+  { "clear", cmd_parse_none, do_clear, "" },
+  { "e",     cmd_parse_none, do_exit,  "" },
+  { "echo",  NULL,           do_echo,  "" },
+  { "exit",  cmd_parse_none, do_exit,  "" },
+  { "i",     parse_led,      do_led,   "" },
+  { "led",   parse_led,      do_led,   "" },
+  { "set",   parse_set,      do_set,   "" },
+};
+static const CmdTable table = { entries, sizeof(entries) / sizeof(entries[0]) };
+
+typedef struct {
+  const char *keys;      // bytes as typed, ending in a line end
+  int         status;
+  const char *handler;   // "" when nothing should run
+  int         argc;
+  int32_t     num1, num2;
+  const char *arg1;      // NULL: not checked
+} Case;
+
+static const Case cases[] = {
+  { "#c\r",                 CMD_OK,          "clear", 1, 0, 0, NULL },
+  { "#e\n",                 CMD_OK,          "exit",  1, 0, 0, NULL },
+  { "#i\r\n",               CMD_OK,          "led",   1, -1, 0, NULL },
+  { "  clear  \r",          CMD_OK,          "clear", 1, 0, 0, NULL },
+  { "led on\r",             CMD_OK,          "led",   2, 1, 0, "on" },
+  { "led\toff\r",           CMD_OK,          "led",   2, 0, 0, "off" },
+  { "led blink\r",          CMD_ERR_ARGS,    "",      0, 0, 0, NULL },
+  { "clear now\r",          CMD_ERR_ARGS,    "",      0, 0, 0, NULL },
+  { "set 12 -7\r",          CMD_OK,          "set",   3, 12, -7, NULL },
+  { "set 0x1F +3\r",        CMD_OK,          "set",   3, 31, 3, NULL },
+  { "set 2147483647 -2147483648\r", CMD_OK,  "set",   3, 2147483647, (int32_t)0x80000000, NULL },
+  { "set 2147483648 0\r",   CMD_ERR_ARGS,    "",      0, 0, 0, NULL },
+  { "set 0xFFFFFFFF 0\r",   CMD_OK,          "set",   3, -1, 0, NULL },
+  { "set 0x100000000 0\r",  CMD_ERR_ARGS,    "",      0, 0, 0, NULL },
+  { "set -0x10 0\r",        CMD_ERR_ARGS,    "",      0, 0, 0, NULL },
+  { "set +0x10 0\r",        CMD_ERR_ARGS,    "",      0, 0, 0, NULL },
+  { "set 12x 1\r",          CMD_ERR_ARGS,    "",      0, 0, 0, NULL },
+  { "set - 1\r",            CMD_ERR_ARGS,    "",      0, 0, 0, NULL },
+  { "set 1\r",              CMD_ERR_ARGS,    "",      0, 0, 0, NULL },
+  { "echo \"a b\" c\r",     CMD_OK,          "echo",  3, 0, 0, "a b" },
+  { "echo \"\"\r",          CMD_OK,          "echo",  2, 0, 0, "" },
+  { "echo \"open\r",        CMD_ERR_QUOTE,   "",      0, 0, 0, NULL },
+  { "echo 1 2 3 4 5 6 7\r", CMD_OK,          "echo",  8, 0, 0, "1" },
+  { "echo 1 2 3 4 5 6 7 8\r", CMD_ERR_MANY,  "",      0, 0, 0, NULL },
+  { "leds\r",               CMD_ERR_UNKNOWN, "",      0, 0, 0, NULL },
+  { "#\r",                  CMD_ERR_UNKNOWN, "",      0, 0, 0, NULL },
+  { "\r",                   CMD_EMPTY,       "",      0, 0, 0, NULL },
+  { "   \r",                CMD_EMPTY,       "",      0, 0, 0, NULL },
+  { "clx\bear\r",           CMD_OK,          "clear", 1, 0, 0, NULL },
+  { "\x7f\x7f" "c\r",       CMD_OK,          "clear", 1, 0, 0, NULL },
+  { "led \x01on\r",         CMD_OK,          "led",   2, 1, 0, "on" },
+  { "echo 0123456789012345678901234567890123456789\r", CMD_ERR_LONG, "", 0, 0, 0, NULL },
+  { "c\r",                  CMD_OK,          "clear", 1, 0, 0, NULL },   // recovers after overflow
+};
+
+static uint64_t mono_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int runCases(void)
+{
+  char buf[40];
+  CmdLine line;
+  int fail = 0;
+
+  cmd_line_init(&line, buf, sizeof(buf));
+
+  for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    const Case *c = &cases[i];
+    int st = CMD_EMPTY, lines = 0;
+
+    ran[0] = '\0';
+    for (const char *k = c->keys; *k; k++) {
+      if (cmd_line_feed(&line, *k)) {
+        st = cmd_exec(&table, &line, NULL);
+        lines++;
+      }
+    }
+
+    int ok = (lines == 1) && (st == c->status) && strcmp(ran, c->handler) == 0;
+    if (ok && c->handler[0]) {
+      ok = (ranArgc == c->argc);
+      if (ok && strcmp(c->handler, "set") == 0)
+        ok = ranNum[1] == c->num1 && ranNum[2] == c->num2;
+      if (ok && strcmp(c->handler, "led") == 0) ok = ranNum[1] == c->num1;
+      if (ok && c->arg1) ok = strcmp(ranArg1, c->arg1) == 0;
+    }
+    if (!ok) {
+      printf("FAIL case %u: status %d (%s) ran '%s' argc %d lines %d\n",
+             i, st, cmd_error_str(st), ran, ranArgc, lines);
+      fail++;
+    }
+  }
+  printf("%u cases, %d failed\n", (unsigned)(sizeof(cases) / sizeof(cases[0])), fail);
+  return fail;
+}
+
+// 64 sorted names: lookups by binary search vs the linear scan it replaces
+static int benchLookup(void)
+{
+  static char names[64][8];
+  static CmdEntry big[64];
+  CmdTable t = { big, 64 };
+  volatile uintptr_t sink = 0;
+  const int rounds = 200000;
+
+  for (int i = 0; i < 64; i++) {
+    snprintf(names[i], sizeof(names[i]), "cmd%02d", i);
+    big[i] = (CmdEntry){ names[i], NULL, do_echo, "" };
+  }
+  if (cmd_check(&t) >= 0) { printf("bench table unsorted\n"); return 1; }
+
+  uint64_t t0 = mono_ns();
+  for (int r = 0; r < rounds; r++) sink += (uintptr_t)cmd_find(&t, names[r & 63]);
+  uint64_t bin = mono_ns() - t0;
+
+  t0 = mono_ns();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < 64; i++) {
+      if (strcmp(names[r & 63], big[i].name) == 0) { sink += (uintptr_t)&big[i]; break; }
+    }
+  }
+  uint64_t lin = mono_ns() - t0;
+
+  printf("64 commands: binary search %.1f ns/lookup, linear scan %.1f ns/lookup\n",
+         (double)bin / rounds, (double)lin / rounds);
+
+  // Whole line: tokenize + lookup + parse
+  char line[32];
+  t0 = mono_ns();
+  for (int r = 0; r < rounds; r++) {
+    strcpy(line, "set 0x1F -7");
+    sink += (uintptr_t)cmd_exec_str(&table, line, NULL);
+  }
+  printf("\"set 0x1F -7\": %.1f ns/line\n", (double)(mono_ns() - t0) / rounds);
+  (void)sink;
+  return 0;
+}
+
+int main(void)
+{
+  int fail = 0;
+
+  if (cmd_check(&table) >= 0) {
+    printf("table out of order at %d\n", cmd_check(&table));
+    fail++;
+  }
+  fail += runCases();
+  fail += benchLookup();
+  return fail ? 1 : 0;
+}
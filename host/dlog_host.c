@@ -0,0 +1,231 @@
+// dlog_host.c  (host checks and timing for common/dlog.c)
+//
+//   gcc -O2 -pthread -Icommon -o dlog_host host/dlog_host.c common/dlog.c
+//       common/fmt.c
+//
+// Threads stand in for handlers at different priorities; they are preempted
+// at any point, so consumers meet claimed but unpublished slots.
+//
+// 1. 4 producers x 200k entries, retrying when the ring is full, into one
+//    consumer: every entry arrives once, in order per producer, with its
+//    format pointer, argument count and all four arguments intact; every
+//    failed push is counted as dropped.
+// 2. The same with producers that give up when the ring is full (as the
+//    ISRs do) and two consumers: what arrives is exactly what was pushed,
+//    each entry once, and dropped = failed pushes.
+// 3. dlog_drain() output: the formatted lines, then one "[dlog: N entries
+//    dropped]" notice after an overflow.
+// 4. Push + pop cost against one unbuffered fprintf of the same line.
+// Exits non-zero on a failed check.
+
+#define _GNU_SOURCE
+#include "dlog.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PRODUCERS 4
+#define PER       200000u
+
+static const char *fmts[PRODUCERS] = { "a %u %u %u %u\r\n", "b %u %u %u %u\r\n",
+                                       "c %u %u %u %u\r\n", "d %u %u %u %u\r\n" };
+static int       giveUp;
+static uint32_t  pushedOk[PRODUCERS], pushFailed[PRODUCERS];
+static uint8_t   seen[PRODUCERS][PER];
+static uint32_t  corrupt, outOfOrder, twice;
+static uint32_t  received;
+static int       producersDone;
+static int       bad;
+
+static void check(int ok, const char *what)
+{
+  if (!ok) { printf("FAIL: %s\n", what); bad++; }
+}
+
+static uint64_t mono_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void *producer(void *arg)
+{
+  uint32_t id = (uint32_t)(uintptr_t)arg;
+
+  for (uint32_t i = 0; i < PER; ) {
+    if (DLOG(fmts[id], id, i, ~i, i * 2654435761u ^ id)) {
+      pushedOk[id]++;
+      i++;
+    } else {
+      pushFailed[id]++;
+      if (giveUp) i++;
+      else sched_yield();                              // let a consumer in, even on one core
+    }
+    if (giveUp && i % 128 == 0) sched_yield();         // bursts of 128
+  }
+  __atomic_add_fetch(&producersDone, 1, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+// Per-consumer last sequence per producer: with two consumers the order
+// holds within each consumer's share
+static void *consumer(void *arg)
+{
+  uint32_t last[PRODUCERS];
+  DlogEntry e;
+  (void)arg;
+
+  memset(last, 0xff, sizeof(last));
+  for (;;) {
+    if (!dlog_pop(&e)) {
+      // all published once the producers are done: empty then is empty for good
+      if (__atomic_load_n(&producersDone, __ATOMIC_ACQUIRE) < PRODUCERS) { sched_yield(); continue; }
+      if (!dlog_pop(&e)) break;
+    }
+    uint32_t id = e.args[0], i = e.args[1];
+    if (id >= PRODUCERS || i >= PER || e.fmt != fmts[id] || e.nargs != 4 ||
+        e.args[2] != ~i || e.args[3] != (i * 2654435761u ^ id)) {
+      __atomic_add_fetch(&corrupt, 1, __ATOMIC_RELAXED);
+      continue;
+    }
+    if (last[id] != 0xffffffffu && i <= last[id]) __atomic_add_fetch(&outOfOrder, 1, __ATOMIC_RELAXED);
+    last[id] = i;
+    if (__atomic_fetch_add(&seen[id][i], 1, __ATOMIC_RELAXED)) __atomic_add_fetch(&twice, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&received, 1, __ATOMIC_RELAXED);
+  }
+  return NULL;
+}
+
+static void run(int consumers, int producersGiveUp)
+{
+  pthread_t p[PRODUCERS], c[2];
+
+  dlog_init();
+  giveUp = producersGiveUp;
+  memset(pushedOk, 0, sizeof(pushedOk));
+  memset(pushFailed, 0, sizeof(pushFailed));
+  memset(seen, 0, sizeof(seen));
+  corrupt = outOfOrder = twice = received = 0;
+  producersDone = 0;
+
+  for (int i = 0; i < consumers; i++) pthread_create(&c[i], NULL, consumer, NULL);
+  for (uint32_t i = 0; i < PRODUCERS; i++) pthread_create(&p[i], NULL, producer, (void *)(uintptr_t)i);
+  for (int i = 0; i < PRODUCERS; i++) pthread_join(p[i], NULL);
+  for (int i = 0; i < consumers; i++) pthread_join(c[i], NULL);
+}
+
+static uint32_t sum(const uint32_t *v)
+{
+  uint32_t s = 0;
+  for (int i = 0; i < PRODUCERS; i++) s += v[i];
+  return s;
+}
+
+static uint32_t missing(void)
+{
+  uint32_t n = 0;
+  for (int id = 0; id < PRODUCERS; id++)
+    for (uint32_t i = 0; i < PER; i++) n += !seen[id][i];
+  return n;
+}
+
+//------------------------------------------------------------------------------
+// 3. Drain output, captured from stdout
+//------------------------------------------------------------------------------
+static void checkDrain(void)
+{
+  char out[4096];
+  FILE *cap = tmpfile();
+  if (!cap) { check(0, "tmpfile"); return; }
+
+  fflush(stdout);
+  int saved = dup(1);
+  dup2(fileno(cap), 1);
+
+  dlog_init();
+  DLOG("Elapsed time: %lu tenths of a second\r\n", 1234);
+  DLOG("x=%d y=%u c=%c s=%x\r\n", -5, 7, 'q', 0xbeef);
+  DLOG("no args\r\n");
+  uint32_t first = dlog_drain(0);
+  for (uint32_t i = 0; i < DLOG_SIZE + 10; i++) DLOG("n %u\r\n", i);
+  uint32_t second = dlog_drain(3);
+  uint32_t rest = dlog_drain(0);
+
+  fflush(stdout);
+  dup2(saved, 1);
+  close(saved);
+  size_t n = fread(out, 1, sizeof(out) - 1, (rewind(cap), cap));
+  out[n] = '\0';
+  fclose(cap);
+
+  char want[4096], *w = want;
+  w += sprintf(w, "Elapsed time: 1234 tenths of a second\r\nx=-5 y=7 c=q s=beef\r\nno args\r\n");
+  w += sprintf(w, "n 0\r\nn 1\r\nn 2\r\n[dlog: 10 entries dropped]\r\n");
+  for (uint32_t i = 3; i < DLOG_SIZE; i++) w += sprintf(w, "n %u\r\n", (unsigned)i);
+
+  check(first == 3 && second == 3 && rest == DLOG_SIZE - 3, "drain counts");
+  check(strcmp(out, want) == 0, "drained text");
+  printf("drain: %u + %u + %u lines, text %s\n", first, second, rest,
+         strcmp(out, want) ? "DIFFERS" : "as expected, one drop notice");
+}
+
+//------------------------------------------------------------------------------
+// 4. Timing
+//------------------------------------------------------------------------------
+static void timing(void)
+{
+  const uint32_t N = 10000000, M = 1000000;
+  DlogEntry e;
+
+  dlog_init();
+  uint64_t t0 = mono_ns();
+  for (uint32_t i = 0; i < N; i++) {
+    DLOG("Current Number: %lu\r\n", i);
+    dlog_pop(&e);
+  }
+  double push = (double)(mono_ns() - t0) / N;
+
+  FILE *f = fopen("/dev/null", "w");
+  if (!f) return;
+  setvbuf(f, NULL, _IONBF, 0);
+  t0 = mono_ns();
+  for (uint32_t i = 0; i < M; i++) fprintf(f, "Current Number: %lu\r\n", (unsigned long)i);
+  double pr = (double)(mono_ns() - t0) / M;
+  fclose(f);
+  printf("push + pop %.1f ns, unbuffered fprintf to /dev/null %.1f ns\n", push, pr);
+}
+
+int main(void)
+{
+  // 1. Retry when full, one consumer
+  run(1, 0);
+  printf("retrying producers, 1 consumer: %u received, %u missing, %u corrupt, %u out of order, "
+         "%u twice; %u full-ring retries, dropped %u, high water %u\n",
+         received, missing(), corrupt, outOfOrder, twice, sum(pushFailed),
+         dlog_stats()->dropped, dlog_stats()->high_water);
+  check(received == PRODUCERS * PER && missing() == 0, "entries lost");
+  check(corrupt == 0 && outOfOrder == 0 && twice == 0, "entries corrupt, reordered or repeated");
+  check(dlog_stats()->pushed == PRODUCERS * PER, "pushed count");
+  check(dlog_stats()->dropped == sum(pushFailed), "dropped != failed pushes");
+  check(dlog_stats()->high_water <= DLOG_SIZE, "high water above the ring size");
+
+  // 2. Give up when full, two consumers
+  run(2, 1);
+  printf("dropping producers, 2 consumers: %u pushed, %u dropped, %u received, %u corrupt, "
+         "%u out of order, %u twice\n", sum(pushedOk), sum(pushFailed), received, corrupt,
+         outOfOrder, twice);
+  check(received == sum(pushedOk) && received + missing() == PRODUCERS * PER, "received != pushed");
+  check(corrupt == 0 && outOfOrder == 0 && twice == 0, "entries corrupt, reordered or repeated");
+  check(dlog_stats()->dropped == sum(pushFailed), "dropped != failed pushes");
+
+  checkDrain();
+  timing();
+
+  printf("%s\n", bad ? "FAILED" : "all checks passed");
+  return bad ? 1 : 0;
+}
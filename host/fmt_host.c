@@ -0,0 +1,274 @@
+// fmt_host.c  (host checks and timing for common/fmt.c)
+//
+//   gcc -O2 -Icommon -o fmt_host host/fmt_host.c common/fmt.c
+//
+// 1. fmt_snprintf against the C library's snprintf, byte for byte and
+//    return value for return value: every supported conversion (%d %i %u
+//    %x %X %c %s %%) crossed with the flags ('-', '0', both), widths
+//    (none, 1, 5, 12, '*') and precisions (none, .0, .1, .3, .12, '*'), the
+//    'l' and 'h' modifiers, edge values and random ones.
+// 2. Truncation: each case again into buffers of 0 .. len + 1 bytes.
+// 3. The encoders (fmt_u32, fmt_i32, fmt_u32_pad, fmt_hex, fmt_fixed,
+//    fmt_cup) against the equivalent snprintf.
+// 4. Timing against snprintf for the console's hot calls: cursor moves,
+//    an unsigned count, a 3-decimal reading.
+// Exits non-zero on a mismatch.
+
+#define _POSIX_C_SOURCE 199309L
+#include "fmt.h"
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static uint32_t cases, errs;
+
+static uint32_t rng = 2463534242u;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static uint64_t mono_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void mismatch(const char *what, const char *want, int wantRet, const char *got, int gotRet)
+{
+  if (errs++ < 10) printf("%s: \"%s\" (%d) vs \"%s\" (%d)\n", what, want, wantRet, got, gotRet);
+}
+
+// Both formatters on the same arguments, whole and truncated
+static void compare(const char *f, ...)
+{
+  char want[256], got[256];
+  va_list ap, aq;
+
+  va_start(ap, f);
+  va_copy(aq, ap);
+  int r1 = vsnprintf(want, sizeof(want), f, ap);
+  int r2 = fmt_vsnprintf(got, sizeof(got), f, aq);
+  va_end(aq);
+  va_end(ap);
+  cases++;
+  if (r1 != r2 || strcmp(want, got)) { mismatch(f, want, r1, got, r2); return; }
+
+  for (size_t n = 0; n <= (size_t)r1 + 1; n++) {
+    memset(want, 'x', sizeof(want));
+    memset(got, 'x', sizeof(got));
+    va_start(ap, f);
+    va_copy(aq, ap);
+    r1 = vsnprintf(want, n, f, ap);
+    r2 = fmt_vsnprintf(got, n, f, aq);
+    va_end(aq);
+    va_end(ap);
+    if (r1 != r2 || memcmp(want, got, n + 1)) {
+      char what[64];
+      snprintf(what, sizeof(what), "%s into %zu bytes", f, n);
+      mismatch(what, want, r1, got, r2);
+      return;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// 1, 2. fmt_snprintf
+//------------------------------------------------------------------------------
+static const char *flags[] = { "", "-", "0", "-0" };
+static const char *widths[] = { "", "1", "5", "12", "*" };
+static const char *precs[] = { "", ".0", ".1", ".3", ".12", ".*" };
+
+static void spec(char *f, int fl, int w, int p, const char *len, char conv)
+{
+  sprintf(f, "[%%%s%s%s%s%c]", flags[fl], widths[w], precs[p], len, conv);
+}
+
+// Calls compare with the '*' arguments in front of the value as needed
+#define COMPARE(f, w, p, ...)                                                    \
+  do {                                                                           \
+    int ws = (int)(xorshift() % 25) - 12, ps = (int)(xorshift() % 16) - 3;       \
+    if (w == 4 && p == 5) compare(f, ws, ps, __VA_ARGS__); \
+    else if (w == 4) compare(f, ws, __VA_ARGS__);                   \
+    else if (p == 5) compare(f, ps, __VA_ARGS__);                    \
+    else compare(f, __VA_ARGS__);                                                \
+  } while (0)
+
+static int32_t signedValue(int i)
+{
+  static const int32_t edge[] = { 0, 1, -1, 9, -10, 99, 100, -12345, INT32_MAX, INT32_MIN };
+  if (i < (int)(sizeof(edge) / sizeof(edge[0]))) return edge[i];
+  uint32_t r = xorshift();
+  return (int32_t)(r >> (xorshift() % 32));
+}
+
+static void checkSnprintf(void)
+{
+  static const char *strs[] = { "", "a", "hi", "hello", "a longer string!" };
+  static const char *lens[] = { "", "l", "h" };
+  char f[32];
+
+  for (int fl = 0; fl < 4; fl++) {
+    for (int w = 0; w < 5; w++) {
+      for (int p = 0; p < 6; p++) {
+        for (int i = 0; i < 40; i++) {
+          int32_t v = signedValue(i);
+          for (int l = 0; l < 3; l++) {
+            int32_t hv = l == 2 ? (int16_t)v : v;   // 'h' values as the board passes them
+            spec(f, fl, w, p, lens[l], 'd');
+            if (l == 1) COMPARE(f, w, p, (long)hv); else COMPARE(f, w, p, (int)hv);
+            spec(f, fl, w, p, lens[l], 'i');
+            if (l == 1) COMPARE(f, w, p, (long)hv); else COMPARE(f, w, p, (int)hv);
+            uint32_t u = l == 2 ? (uint16_t)v : (uint32_t)v;
+            for (const char *c = "uxX"; *c; c++) {
+              spec(f, fl, w, p, lens[l], *c);
+              if (l == 1) COMPARE(f, w, p, (unsigned long)u); else COMPARE(f, w, p, (unsigned)u);
+            }
+          }
+        }
+        for (size_t s = 0; s < sizeof(strs) / sizeof(strs[0]); s++) {
+          if (fl < 2) {                                  // '0' with %s is undefined
+            spec(f, fl, w, p, "", 's');
+            COMPARE(f, w, p, strs[s]);
+          }
+        }
+        if (p == 0 && fl < 2) {                          // precision with %c is undefined
+          spec(f, fl, w, p, "", 'c');
+          COMPARE(f, w, p, ' ' + (int)(xorshift() % 95));
+        }
+      }
+    }
+  }
+
+  compare("%%");
+  compare("100%% of %d%%", 42);
+  compare("");
+  compare("no conversions");
+  compare("\033[%d;%dH%s", 12, 34, "text");
+  compare("%s=%d, %s=0x%04x", "count", -7, "mask", 0xbeefu);
+  compare("%d %u %x %c %s %ld %lu", -1, 1u, 255u, 'z', "end", -5L, 5UL);
+  for (int i = 0; i < 20000; i++) {
+    int32_t v = signedValue(10 + i);
+    compare("v=%d u=%u x=%x X=%08X c=%c s=%.*s|", (int)v, (unsigned)v, (unsigned)v,
+            (unsigned)v, 'A' + i % 26, (int)(xorshift() % 8), "abcdefgh");
+  }
+}
+
+//------------------------------------------------------------------------------
+// 3. Encoders
+//------------------------------------------------------------------------------
+static void expect(const char *what, const char *want, char *buf, const char *end)
+{
+  size_t n = (size_t)(end - buf);
+  cases++;
+  if (n != strlen(want) || memcmp(buf, want, n)) {
+    buf[n] = '\0';
+    mismatch(what, want, (int)strlen(want), buf, (int)n);
+  }
+}
+
+static void checkEncoders(void)
+{
+  char want[64], got[64];
+
+  for (int i = 0; i < 200000; i++) {
+    int32_t v = signedValue(i);
+    uint32_t u = (uint32_t)v;
+
+    snprintf(want, sizeof(want), "%u", (unsigned)u);
+    expect("fmt_u32", want, got, fmt_u32(got, u));
+    snprintf(want, sizeof(want), "%d", (int)v);
+    expect("fmt_i32", want, got, fmt_i32(got, v));
+
+    unsigned w = xorshift() % 13;
+    snprintf(want, sizeof(want), "%*u", (int)w, (unsigned)u);
+    expect("fmt_u32_pad ' '", want, got, fmt_u32_pad(got, u, w, ' '));
+    snprintf(want, sizeof(want), "%0*u", (int)w, (unsigned)u);
+    expect("fmt_u32_pad '0'", want, got, fmt_u32_pad(got, u, w, '0'));
+
+    unsigned d = 1 + xorshift() % 8;
+    int upper = (int)(xorshift() & 1);
+    snprintf(want, sizeof(want), upper ? "%0*X" : "%0*x", (int)d, (unsigned)u);
+    expect("fmt_hex", want, got, fmt_hex(got, u, d, upper));
+
+    unsigned frac = xorshift() % 6;
+    int32_t m = v % 100000000;
+    uint32_t mag = m < 0 ? 0U - (uint32_t)m : (uint32_t)m, scale = 1;
+    for (unsigned k = 0; k < frac; k++) scale *= 10;
+    if (frac) snprintf(want, sizeof(want), "%s%u.%0*u", m < 0 ? "-" : "", (unsigned)(mag / scale),
+                       (int)frac, (unsigned)(mag % scale));
+    else snprintf(want, sizeof(want), "%d", (int)m);
+    expect("fmt_fixed", want, got, fmt_fixed(got, m, frac));
+
+    unsigned row = xorshift() % 65536, col = xorshift() % 65536;
+    if (i & 1) { row %= 100; col %= 100; }
+    snprintf(want, sizeof(want), "\033[%u;%uH", row, col);
+    expect("fmt_cup", want, got, fmt_cup(got, row, col));
+  }
+}
+
+//------------------------------------------------------------------------------
+// 4. Timing
+//------------------------------------------------------------------------------
+#define N 2000000
+
+static volatile int sink;
+
+static double perCall(uint64_t t0)
+{
+  return (double)(mono_ns() - t0) / N;
+}
+
+static void timing(void)
+{
+  char buf[64];
+  uint64_t t0;
+  double a, b, c;
+
+  t0 = mono_ns();
+  for (int i = 0; i < N; i++) sink += snprintf(buf, sizeof(buf), "\033[%d;%dH", i % 24 + 1, i % 80 + 1);
+  a = perCall(t0);
+  t0 = mono_ns();
+  for (int i = 0; i < N; i++) sink += fmt_snprintf(buf, sizeof(buf), "\033[%d;%dH", i % 24 + 1, i % 80 + 1);
+  b = perCall(t0);
+  t0 = mono_ns();
+  for (int i = 0; i < N; i++) sink += (int)(fmt_cup(buf, (unsigned)(i % 24 + 1), (unsigned)(i % 80 + 1)) - buf);
+  c = perCall(t0);
+  printf("cursor move: snprintf %.1f ns, fmt_snprintf %.1f ns, fmt_cup %.1f ns\n", a, b, c);
+
+  t0 = mono_ns();
+  for (int i = 0; i < N; i++) sink += snprintf(buf, sizeof(buf), "%lu", (unsigned long)i * 4099u);
+  a = perCall(t0);
+  t0 = mono_ns();
+  for (int i = 0; i < N; i++) sink += (int)(fmt_u32(buf, (uint32_t)i * 4099u) - buf);
+  b = perCall(t0);
+  printf("count: snprintf %%lu %.1f ns, fmt_u32 %.1f ns\n", a, b);
+
+  t0 = mono_ns();
+  for (int i = 0; i < N; i++) sink += snprintf(buf, sizeof(buf), "%.3f", (double)(i % 3300) / 1000.0);
+  a = perCall(t0);
+  t0 = mono_ns();
+  for (int i = 0; i < N; i++) sink += (int)(fmt_fixed(buf, i % 3300, 3) - buf);
+  b = perCall(t0);
+  printf("reading: snprintf %%.3f %.1f ns, fmt_fixed %.1f ns\n", a, b);
+}
+
+int main(void)
+{
+  checkSnprintf();
+  uint32_t s = cases;
+  printf("fmt_snprintf: %u cases (each also truncated to every length): %u mismatches\n", s, errs);
+  uint32_t e = errs;
+  checkEncoders();
+  printf("encoders: %u cases: %u mismatches\n", cases - s, errs - e);
+  timing();
+
+  printf("%s\n", errs ? "FAILED" : "all checks passed");
+  return errs ? 1 : 0;
+}
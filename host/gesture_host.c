@@ -0,0 +1,239 @@
+// gesture_host.c  (host checks for common/gesture.c on synthetic edges)
+//
+//   gcc -O2 -Icommon -o gesture_host host/gesture_host.c common/gesture.c
+//
+// 1. Scripted edge streams with the events they must give: tap, double
+//    tap, two separate taps, hold, long hold, tap then hold, bounce, a
+//    press between tap and hold, repeat, and the Lab02 depth-task
+//    thresholds across the 32-bit ms wrap.
+// 2. 2000 random configs x 60 s of random edges (short and long presses,
+//    some a few ms apart), three ways: edges only with one poll at the
+//    end, sampled and polled every 1 ms, and edges plus polls only at
+//    gesture_deadline(). All three give the same events.
+// 3. Bounce: the random streams again with up to 2 pairs of extra
+//    transitions inside debounce_ms after each edge give the same events
+//    as the clean ones.
+// Exits non-zero on a mismatch.
+
+#include "gesture.h"
+#include <stdio.h>
+#include <string.h>
+
+static int fails;
+
+static uint32_t rng = 2463534242u;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+//------------------------------------------------------------------------------
+// 1. Scripted
+//------------------------------------------------------------------------------
+static char text[512];
+
+// P100 = PRESS at 100; U...h / U...l = RELEASE after HOLD / LONG_HOLD
+static void toText(const GestureEvent *e, void *ctx)
+{
+  static const char *names[] = { "-", "P", "T", "D", "H", "L", "R", "U" };
+  char b[32];
+  (void)ctx;
+  snprintf(b, sizeof(b), "%s%u%s ", names[e->type], (unsigned)e->t,
+           e->type == GESTURE_RELEASE ? (e->level == GESTURE_HOLD ? "h" : "l") : "");
+  strncat(text, b, sizeof(text) - strlen(text) - 1);
+}
+
+// edges: level, time pairs
+static void script(const char *name, const GestureConfig *cfg, const int *edges, int n,
+                   uint32_t end, const char *want)
+{
+  Gesture g;
+
+  text[0] = '\0';
+  gesture_init(&g, 0, cfg, toText, NULL);
+  for (int i = 0; i < n; i += 2) gesture_edge(&g, edges[i], (uint32_t)edges[i + 1]);
+  gesture_poll(&g, end);
+  int ok = strcmp(text, want) == 0;
+  fails += !ok;
+  printf("  %-12s %s  %s\n", name, ok ? "ok  " : "FAIL", text);
+  if (!ok) printf("  %-12s       want %s\n", "", want);
+}
+
+#define SCRIPT(name, cfg, end, want, ...)                                 \
+  do {                                                                    \
+    static const int e_[] = { __VA_ARGS__ };                              \
+    script(name, cfg, e_, (int)(sizeof(e_) / sizeof(e_[0])), end, want); \
+  } while (0)
+
+static void scripted(void)
+{
+  GestureConfig c = { .debounce_ms = 20, .tap_ms = 300, .double_ms = 250, .hold_ms = 1000,
+                      .long_ms = 3000 };
+  GestureConfig r = c;
+  r.repeat_delay_ms = 500;
+  r.repeat_ms = 200;
+  r.long_ms = 0;
+  GestureConfig depth = { .tap_ms = 1000, .hold_ms = 1000, .long_ms = 3000 };
+
+  printf("scripted:\n");
+  SCRIPT("tap", &c, 1000, "P100 T200 ", 1, 100, 0, 200);
+  SCRIPT("double", &c, 1000, "P100 P300 D400 ", 1, 100, 0, 200, 1, 300, 0, 400);
+  SCRIPT("2 taps", &c, 2000, "P100 T200 P600 T700 ", 1, 100, 0, 200, 1, 600, 0, 700);
+  SCRIPT("hold", &c, 2000, "P100 H1100 U1500h ", 1, 100, 0, 1500);
+  SCRIPT("long", &c, 6000, "P100 H1100 L3100 U5000l ", 1, 100, 0, 5000);
+  SCRIPT("tap+hold", &c, 3000, "P100 P300 T200 H1300 U2000h ", 1, 100, 0, 200, 1, 300, 0, 2000);
+  SCRIPT("bounce", &c, 1000, "P100 T200 ", 1, 100, 0, 105, 1, 108, 0, 200);
+  SCRIPT("mid press", &c, 2000, "P100 ", 1, 100, 0, 700);
+  SCRIPT("repeat", &r, 2000, "P0 R500 R700 R900 H1000 U1050h ", 1, 0, 0, 1050);
+  SCRIPT("depth+wrap", &depth, 9000,
+         "P4294966296 T4294966796 P0 H1000 U1000h P2000 H3000 U3000h P4000 H5000 L7000 U7001l ",
+         1, -1000, 0, -500, 1, 0, 0, 1000, 1, 2000, 0, 3000, 1, 4000, 0, 7001);
+}
+
+//------------------------------------------------------------------------------
+// 2, 3. Random streams
+//------------------------------------------------------------------------------
+#define MAX_EVENTS 4096
+#define RUN_MS     60000u
+
+typedef struct {
+  int          n;
+  GestureEvent e[MAX_EVENTS];
+} Log;
+
+static void toLog(const GestureEvent *e, void *ctx)
+{
+  Log *l = ctx;
+  if (l->n < MAX_EVENTS) l->e[l->n++] = *e;
+}
+
+static int sameLog(const Log *a, const Log *b)
+{
+  if (a->n != b->n) return 0;
+  for (int i = 0; i < a->n; i++) {
+    const GestureEvent *x = &a->e[i], *y = &b->e[i];
+    if (x->type != y->type || x->level != y->level || x->count != y->count ||
+        x->t != y->t || x->duration != y->duration) return 0;
+  }
+  return 1;
+}
+
+static void showFirstDifference(const char *what, int trial, const Log *a, const Log *b)
+{
+  printf("  %s, trial %d: %d vs %d events\n", what, trial, a->n, b->n);
+  for (int i = 0; i < a->n || i < b->n; i++) {
+    if (i < a->n && i < b->n && a->e[i].type == b->e[i].type && a->e[i].t == b->e[i].t) continue;
+    printf("  first at %d: type %d t %u vs type %d t %u\n", i, i < a->n ? (int)a->e[i].type : -1,
+           i < a->n ? (unsigned)a->e[i].t : 0u, i < b->n ? (int)b->e[i].type : -1,
+           i < b->n ? (unsigned)b->e[i].t : 0u);
+    break;
+  }
+}
+
+static uint32_t edgeT[MAX_EVENTS];
+static int      edgeN;
+
+// Alternating levels from down: short and long presses and gaps, some
+// closer together than any threshold
+static void randomEdges(uint32_t t0, uint16_t debounce)
+{
+  uint32_t t = t0 + xorshift() % 500;
+  edgeN = 0;
+  for (int down = 1; t - t0 < RUN_MS && edgeN < MAX_EVENTS; down ^= 1) {
+    edgeT[edgeN++] = t;
+    uint32_t gap = xorshift() % 8 == 0 ? xorshift() % 10 : xorshift() % (down ? 4000 : 600);
+    t += debounce + 1 + gap;                           // clean edges stay outside the window
+  }
+}
+
+static void streams(void)
+{
+  static Log byEdge, byPoll, byDeadline, bounced;
+  uint32_t events = 0, polls = 0;
+  int badPoll = 0, badDeadline = 0, badBounce = 0;
+
+  for (int trial = 0; trial < 2000; trial++) {
+    GestureConfig c = {
+      .debounce_ms     = (uint16_t)(trial & 1 ? 5 + xorshift() % 30 : 0),
+      .tap_ms          = (uint16_t)(200 + xorshift() % 200),
+      .double_ms       = (uint16_t)(xorshift() % 2 ? 150 + xorshift() % 200 : 0),
+      .hold_ms         = (uint16_t)(800 + xorshift() % 400),
+      .long_ms         = (uint16_t)(xorshift() % 2 ? 2500 : 0),
+      .repeat_delay_ms = 600,
+      .repeat_ms       = (uint16_t)(xorshift() % 2 ? 100 : 0),
+    };
+    uint32_t t0 = xorshift();                          // anywhere, wrap included
+    randomEdges(t0, c.debounce_ms);
+    uint32_t end = t0 + RUN_MS;
+    Gesture ge, gp, gd, gb;
+
+    byEdge.n = byPoll.n = byDeadline.n = bounced.n = 0;
+    gesture_init(&ge, 0, &c, toLog, &byEdge);
+    gesture_init(&gp, 0, &c, toLog, &byPoll);
+    gesture_init(&gd, 0, &c, toLog, &byDeadline);
+    gesture_init(&gb, 0, &c, toLog, &bounced);
+
+    // Edges only
+    for (int i = 0; i < edgeN; i++) gesture_edge(&ge, !(i & 1), edgeT[i]);
+    gesture_poll(&ge, end);
+
+    // Sampled and polled every ms
+    int k = 0, level = 0;
+    for (uint32_t t = t0; t != end + 1; t++) {
+      if (k < edgeN && edgeT[k] == t) { level = !(k & 1); k++; }
+      gesture_edge(&gp, level, t);
+      gesture_poll(&gp, t);
+    }
+
+    // Edges plus polls only when the deadline says so
+    k = 0;
+    for (;;) {
+      uint32_t dl, at;
+      int has = gesture_deadline(&gd, &dl);
+      int edgeNext = k < edgeN && (!has || (int32_t)(edgeT[k] - dl) <= 0);
+      at = edgeNext ? edgeT[k] : dl;
+      if (!edgeNext && (!has || (int32_t)(at - end) > 0)) break;
+      if (edgeNext) { gesture_edge(&gd, !(k & 1), edgeT[k]); k++; }
+      else { gesture_poll(&gd, at); polls++; }
+    }
+    gesture_poll(&gd, end);
+
+    // Bounce inside the window after each edge (only with debouncing on):
+    // pairs of transitions that settle on the edge's level
+    for (int i = 0; i < edgeN; i++) {
+      int lv = !(i & 1);
+      uint32_t bt = edgeT[i];
+      gesture_edge(&gb, lv, bt);
+      for (uint32_t pairs = c.debounce_ms ? xorshift() % 3 : 0; pairs; pairs--) {
+        uint32_t up = 1 + xorshift() % 3, back = 1 + xorshift() % 3;
+        if (bt + up + back - edgeT[i] >= c.debounce_ms) break;
+        gesture_edge(&gb, !lv, bt += up);
+        gesture_edge(&gb, lv, bt += back);
+      }
+    }
+    gesture_poll(&gb, end);
+
+    events += (uint32_t)byEdge.n;
+    if (!sameLog(&byEdge, &byPoll) && badPoll++ == 0) showFirstDifference("1 ms polling", trial, &byEdge, &byPoll);
+    if (!sameLog(&byEdge, &byDeadline) && badDeadline++ == 0)
+      showFirstDifference("deadline polling", trial, &byEdge, &byDeadline);
+    if (!sameLog(&byEdge, &bounced) && badBounce++ == 0) showFirstDifference("bounce", trial, &byEdge, &bounced);
+  }
+  printf("random streams: 2000 x 60 s, %u events edge-driven; 1 ms polling differs in %d trials, "
+         "deadline polling (%u polls) in %d, bounced edges in %d\n",
+         events, badPoll, polls, badDeadline, badBounce);
+  fails += badPoll + badDeadline + badBounce;
+}
+
+int main(void)
+{
+  scripted();
+  streams();
+
+  printf("%s\n", fails ? "FAILED" : "all checks passed");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,103 @@
+// kinematics_host.c  (host checks for kinematics.c)
+//
+//   gcc -O2 -I. -o kinematics_host host/kinematics_host.c kinematics.c
+//
+// 1. The same motion stepped at 25, 50 and 100 Hz (40, 20, 10 ms) lands
+//    on the same Q16.16 position, remainder included, every 40 ms, for the
+//    ship and bullet speeds and a spread of odd ones, both signs (up to
+//    3200 px/s, so 10 s stays inside Q16.16's +-32767 px).
+// 2. Random frame times (1..100 ms, as main.c's clamped HAL_GetTick
+//    deltas) reach the same place as fixed steps over the same total.
+// 3. The position stays exact: pos * 1000 + rem = start * 65536000 +
+//    v * 65536 * t_ms throughout.
+// Exits non-zero on a mismatch.
+
+#include "kinematics.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define RUN_MS   10000u
+#define CHECK_MS 40u
+
+static const int rates[] = { 25, 50, 100 };
+static const int32_t speeds[] = { 200, -200, 500, -500, 137, -1, 1, 999, -3000, 3200 };
+
+static uint32_t rng = 2463534242u;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static int exact(const KinAxis *a, int start, int32_t v, uint32_t ms)
+{
+  int64_t want = (int64_t)start * Q16_ONE * 1000 + (int64_t)v * Q16_ONE * ms;
+  return (int64_t)a->pos * 1000 + a->rem == want;
+}
+
+static int same(const KinBody *a, const KinBody *b)
+{
+  return a->x.pos == b->x.pos && a->x.rem == b->x.rem &&
+         a->y.pos == b->y.pos && a->y.rem == b->y.rem;
+}
+
+int main(void)
+{
+  enum { N = RUN_MS / CHECK_MS + 1 };
+  static KinBody ref[N];
+  int fail = 0;
+  uint32_t checked = 0;
+
+  // 1. 25 / 50 / 100 Hz
+  for (size_t s = 0; s < sizeof(speeds) / sizeof(speeds[0]); s++) {
+    int32_t vx = speeds[s], vy = -speeds[s] / 3;
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+      uint32_t dt = 1000u / (uint32_t)rates[r];
+      KinBody b;
+      kin_body_set(&b, 100, 50, vx, vy);
+      for (uint32_t t = 0; t <= RUN_MS; t += dt) {
+        if (t % CHECK_MS == 0) {
+          KinBody *e = &ref[t / CHECK_MS];
+          if (r == 0) *e = b;
+          else if (!same(e, &b)) {
+            if (fail++ < 5) printf("v %d at %d Hz: t=%u ms px (%d,%d) vs (%d,%d) at 25 Hz\n",
+                                   vx, rates[r], t, kin_px(&b.x), kin_px(&b.y),
+                                   kin_px(&e->x), kin_px(&e->y));
+          }
+          if (!exact(&b.x, 100, vx, t) || !exact(&b.y, 50, vy, t)) {
+            if (fail++ < 5) printf("v %d at %d Hz: t=%u ms not exact\n", vx, rates[r], t);
+          }
+          checked++;
+        }
+        kin_body_step(&b, dt);
+      }
+    }
+  }
+  printf("25/50/100 Hz: %u positions compared, %s\n", checked, fail ? "MISMATCH" : "identical");
+
+  // 2. Jittery frames
+  int jfail = 0;
+  for (int trial = 0; trial < 1000; trial++) {
+    int32_t vx = (int32_t)(xorshift() % 2001) - 1000, vy = (int32_t)(xorshift() % 2001) - 1000;
+    KinBody a, b;
+    kin_body_set(&a, 10, 20, vx, vy);
+    kin_body_set(&b, 10, 20, vx, vy);
+    uint32_t t = 0;
+    while (t < RUN_MS) {
+      uint32_t dt = 1 + xorshift() % 100;
+      if (dt > RUN_MS - t) dt = RUN_MS - t;
+      kin_body_step(&a, dt);
+      t += dt;
+    }
+    for (t = 0; t < RUN_MS; t += 20) kin_body_step(&b, 20);
+    if (!same(&a, &b) || !exact(&a.x, 10, vx, RUN_MS)) jfail++;
+  }
+  printf("random 1..100 ms frames vs 20 ms steps: 1000 runs, %d differ\n", jfail);
+  fail += jfail;
+
+  printf("%s\n", fail ? "FAILED" : "all checks passed");
+  return fail ? 1 : 0;
+}
@@ -0,0 +1,221 @@
+// link_health_host.c  (host checks for link_health.c with byte loss)
+//
+//   gcc -O2 -I. -o link_health_host host/link_health_host.c link_health.c
+//
+// Two boards (left = authority) joined by a lossy byte link, 1 ms per
+// step. Each board fires bullets (Y bytes) and now and then dies (DIED:
+// the loser's score_them++ and round++, the winner's score_me++ and
+// round++ on receipt), as in main.c.
+//
+// 1. 10 min at 2% byte loss, nobody dying: the boards always agree, so
+//    every digest mismatch is a damaged frame read as good, and any
+//    resync is a wrong one. Counts frames rejected by the check byte and
+//    cut by a control byte, and bullets lost with broken frames.
+// 2. 10 min at 2% loss with deaths: lost DIED bytes really desync the
+//    scores. Every RESYNC_SET the right board applies must carry the left
+//    board's state as sent, and after a few clean seconds the boards must
+//    agree again.
+// 3. As 2, with both boards starting past 250 on scores and round: the
+//    values a RESYNC_SET carries mod 250 must come back whole.
+// Exits non-zero on a failed check.
+
+#include "link_health.h"
+#include <stdio.h>
+#include <string.h>
+
+#define DIED     254
+#define QCAP     4096
+#define RUN_MS   600000u
+
+typedef struct {
+  LinkHealth l;
+  int        me, them;
+  uint32_t   round;
+  uint8_t    q[QCAP];          // bytes on the wire to the other board
+  uint8_t    bullet[QCAP];     // q[i] is a bullet Y (payload bytes look the same)
+  uint32_t   n;
+  uint32_t   bulletsTx, bulletsRx;
+} Board;
+
+static Board    left, right;
+static uint32_t lossPer1000;
+static uint32_t wireLost, bulletsLostWire;
+static uint32_t setsApplied, wrongSets;
+static int      sentMe, sentThem;      // left's state in its last RESYNC_SET
+static uint32_t sentRound;
+static int      bad;
+
+static uint32_t rng = 88172645u;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static void check(int ok, const char *what)
+{
+  if (!ok) { printf("FAIL: %s\n", what); bad++; }
+}
+
+static void put(Board *b, uint8_t c, int bullet)
+{
+  if (b->n < QCAP) {
+    b->bullet[b->n] = (uint8_t)bullet;
+    b->q[b->n++] = c;
+  }
+}
+
+static void sendLeft(uint8_t c)
+{
+  if (c == LINK_CTRL_RESYNC_SET) {
+    sentMe = left.me;
+    sentThem = left.them;
+    sentRound = left.round;
+  }
+  put(&left, c, 0);
+}
+
+static void sendRight(uint8_t c) { put(&right, c, 0); }
+
+static void onResyncLeft(void) {}
+
+static void onResyncRight(void)
+{
+  setsApplied++;
+  if (right.me != sentThem || right.them != sentMe || right.round != sentRound) wrongSets++;
+}
+
+// Both boards start at me - them, round (left's view)
+static void setup(int me, int them, uint32_t round)
+{
+  memset(&left, 0, sizeof(left));
+  memset(&right, 0, sizeof(right));
+  left.me = right.them = me;
+  left.them = right.me = them;
+  left.round = right.round = round;
+  link_init(&left.l, 1, sendLeft, onResyncLeft, &left.me, &left.them, &left.round, 0);
+  link_init(&right.l, 0, sendRight, onResyncRight, &right.me, &right.them, &right.round, 0);
+  wireLost = bulletsLostWire = setsApplied = wrongSets = 0;
+}
+
+// Game bytes the link layer hands back
+static void gameRx(Board *b, uint8_t c)
+{
+  if (c == DIED) {
+    b->me++;
+    b->round++;
+  } else if (c <= LINK_Y_MAX) {
+    b->bulletsRx++;
+  }
+}
+
+// Move what from sent to to, dropping bytes at the loss rate
+static void deliver(Board *from, Board *to)
+{
+  for (uint32_t i = 0; i < from->n; i++) {
+    uint8_t c = from->q[i];
+    if (xorshift() % 1000 < lossPer1000) {
+      wireLost++;
+      bulletsLostWire += from->bullet[i];
+      continue;
+    }
+    if (!link_rx_byte(&to->l, c)) gameRx(to, c);
+  }
+  from->n = 0;
+}
+
+static void play(Board *b, int deaths)
+{
+  uint32_t r = xorshift() % 1000;
+  if (r < 20) {                                       // 20 bullets/s
+    put(b, (uint8_t)(xorshift() % (LINK_Y_MAX + 1)), 1);
+    link_note_tx(&b->l);
+    b->bulletsTx++;
+  } else if (deaths && r == 20 && xorshift() % 50 == 0) {   // a death every ~50 s
+    put(b, DIED, 0);
+    link_note_tx(&b->l);
+    b->them++;
+    b->round++;
+  }
+}
+
+// Returns the digest mismatches on both boards
+static uint32_t run(int deaths)
+{
+  for (uint32_t t = 1; t <= RUN_MS; t++) {
+    play(&left, deaths);
+    play(&right, deaths);
+    link_poll(&left.l, t);
+    link_poll(&right.l, t);
+    deliver(&left, &right);
+    deliver(&right, &left);
+  }
+  // a few seconds on a clean wire, to settle
+  lossPer1000 = 0;
+  for (uint32_t t = RUN_MS + 1; t <= RUN_MS + 4 * LINK_DIGEST_MS; t++) {
+    link_poll(&left.l, t);
+    link_poll(&right.l, t);
+    deliver(&left, &right);
+    deliver(&right, &left);
+  }
+  return left.l.stats.mismatches + right.l.stats.mismatches;
+}
+
+static void report(const char *name)
+{
+  const LinkStats *a = &left.l.stats, *b = &right.l.stats;
+  uint32_t tx = left.bulletsTx + right.bulletsTx, rx = left.bulletsRx + right.bulletsRx;
+
+  printf("%s: %u bytes lost on the wire; frames cut %u, failed check %u; "
+         "digests compared %u, mismatched %u; resyncs %u (%u applied, %u wrong); "
+         "bullets %u sent, %u lost on the wire, %u taken by broken frames\n",
+         name, wireLost, a->frames_dropped + b->frames_dropped, a->frames_bad + b->frames_bad,
+         a->digests_rx + b->digests_rx, a->mismatches + b->mismatches,
+         a->resyncs, setsApplied, wrongSets, tx, bulletsLostWire, tx - bulletsLostWire - rx);
+}
+
+static int agree(void)
+{
+  return left.me == right.them && left.them == right.me && left.round == right.round;
+}
+
+int main(void)
+{
+  // 1. Loss, state never changes
+  setup(0, 0, 0);
+  lossPer1000 = 20;
+  uint32_t mm = run(0);
+  report("2% loss, no deaths");
+  check(left.l.stats.frames_bad + right.l.stats.frames_bad > 0, "loss never hit a frame");
+  check(left.l.stats.resyncs == 0 && setsApplied == 0, "resync with the boards in agreement");
+  check(mm <= (left.l.stats.frames_bad + right.l.stats.frames_bad) / 50,
+        "damaged digests taken as good more than 1 in 50");
+  check(agree(), "boards disagree");
+
+  // 2. Loss with deaths
+  setup(0, 0, 0);
+  lossPer1000 = 20;
+  run(1);
+  report("2% loss, deaths");
+  check(wrongSets == 0, "RESYNC_SET applied with the wrong state");
+  check(agree(), "boards still disagree on a clean wire");
+  printf("final: left %d-%d right %d-%d, round %u/%u\n",
+         left.me, left.them, right.me, right.them, left.round, right.round);
+
+  // 3. Loss with deaths, past the wire's 250
+  setup(740, 735, 1475);
+  lossPer1000 = 20;
+  run(1);
+  report("2% loss, deaths, from round 1475");
+  check(setsApplied > 0, "no RESYNC_SET applied");
+  check(wrongSets == 0, "RESYNC_SET past 250 applied with the wrong state");
+  check(agree(), "boards past 250 still disagree on a clean wire");
+  printf("final: left %d-%d right %d-%d, round %u/%u\n",
+         left.me, left.them, right.me, right.them, left.round, right.round);
+
+  printf("%s\n", bad ? "FAILED" : "all checks passed");
+  return bad ? 1 : 0;
+}
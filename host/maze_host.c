@@ -0,0 +1,343 @@
+// maze_host.c  (host checks and benchmarks for Lab01/Src/maze.c)
+//
+//   gcc -O2 -ILab01/Src -Icommon -o maze_host host/maze_host.c
+//       Lab01/Src/maze.c common/fmt.c
+//
+// Sizes 65, 257 and 1025 (the odd grid for "up to 1024 x 1024").
+//
+// 1. Generator: every generated maze (several seeds per size) is a
+//    spanning tree of its open cells: all reachable from the entry, open
+//    cells - 1 open adjacencies, borders closed but for the exit.
+// 2. Solver: the step count matches a plain int-array BFS, and the path
+//    bits are the start, the goal and one cell per distance in between,
+//    each next to the one before. On random walled grids (with loops) the
+//    counts and "unreachable" match too; a too-small queue returns -2.
+// 3. Collision: maze_wall against a byte-per-cell copy after random
+//    maze_set calls, coordinates outside the grid included.
+// 4. Viewport: a random walk through a 257 x 257 maze with the solution
+//    shown, rendered through a small terminal (CUP and 38;5 SGR): the
+//    terminal window matches the maze around the player after every step,
+//    and an idle render sends nothing.
+// 5. Timing: generate, solve, collision query per size.
+// Exits non-zero on a failed check.
+
+#define _POSIX_C_SOURCE 199309L
+#include "maze.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define QCAP 4096
+
+static const int sizes[] = { 65, 257, 1025 };
+static int bad;
+
+static uint32_t rng = 2463534242u;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static double mono_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec * 1e-6;
+}
+
+static void check(int ok, const char *what)
+{
+  if (!ok && bad++ < 10) printf("FAIL: %s\n", what);
+}
+
+static int bit(const uint32_t *bits, uint32_t i)
+{
+  return (int)((bits[i >> 5] >> (i & 31)) & 1U);
+}
+
+//------------------------------------------------------------------------------
+// Reference BFS on an int array: distance from (sx, sy), -1 if unreachable.
+// Returns the number of cells reached.
+//------------------------------------------------------------------------------
+static int32_t *dist;
+static uint32_t *fifo;
+
+static uint32_t refBfs(const Maze *m, int sx, int sy)
+{
+  static const int dx[4] = { 1, -1, 0, 0 }, dy[4] = { 0, 0, 1, -1 };
+  uint32_t n = (uint32_t)m->w * m->h, head = 0, tail = 0;
+
+  for (uint32_t i = 0; i < n; i++) dist[i] = -1;
+  if (maze_wall(m, sx, sy)) return 0;
+  dist[(uint32_t)sy * m->w + (uint32_t)sx] = 0;
+  fifo[tail++] = (uint32_t)sy * m->w + (uint32_t)sx;
+  while (head < tail) {
+    uint32_t i = fifo[head++];
+    int x = (int)(i % m->w), y = (int)(i / m->w);
+    for (int d = 0; d < 4; d++) {
+      int nx = x + dx[d], ny = y + dy[d];
+      if (maze_wall(m, nx, ny)) continue;
+      uint32_t j = (uint32_t)ny * m->w + (uint32_t)nx;
+      if (dist[j] >= 0) continue;
+      dist[j] = dist[i] + 1;
+      fifo[tail++] = j;
+    }
+  }
+  return tail;
+}
+
+// Path bits against the reference distances from the start
+static int pathOk(const Maze *m, const uint32_t *path, int32_t len, int gx, int gy)
+{
+  static uint8_t seen[1025 * 1025];
+  uint32_t n = (uint32_t)m->w * m->h, count = 0;
+
+  memset(seen, 0, (size_t)len + 1);
+  for (uint32_t i = 0; i < n; i++) {
+    if (!bit(path, i)) continue;
+    int32_t d = dist[i];
+    if (d < 0 || d > len || seen[d]++) return 0;
+    count++;
+    if (d == 0) continue;
+    int x = (int)(i % m->w), y = (int)(i / m->w), prev = 0;
+    if (x > 0 && bit(path, i - 1) && dist[i - 1] == d - 1) prev = 1;
+    if (x < m->w - 1 && bit(path, i + 1) && dist[i + 1] == d - 1) prev = 1;
+    if (y > 0 && bit(path, i - m->w) && dist[i - m->w] == d - 1) prev = 1;
+    if (y < m->h - 1 && bit(path, i + m->w) && dist[i + m->w] == d - 1) prev = 1;
+    if (!prev) return 0;
+  }
+  return count == (uint32_t)len + 1 && dist[(uint32_t)gy * m->w + (uint32_t)gx] == len;
+}
+
+//------------------------------------------------------------------------------
+// 1, 2, 5. Generator and solver, timed
+//------------------------------------------------------------------------------
+static void checkGenerated(int size, uint32_t *bits, uint32_t *gs, uint32_t *ss,
+                           uint32_t *q, uint32_t *path)
+{
+  int W = size, H = size;
+  int seeds = size > 300 ? 3 : 20;
+  double genMs = 0, solveMs = 0;
+  int32_t len = 0;
+  Maze m;
+
+  maze_init(&m, (uint16_t)W, (uint16_t)H, bits);
+  for (int s = 0; s < seeds; s++) {
+    double t0 = mono_ms();
+    maze_generate(&m, 12345u + (uint32_t)s * 7919u, gs);
+    genMs += mono_ms() - t0;
+
+    uint32_t open = 0, edges = 0;
+    for (int y = 0; y < H; y++) {
+      for (int x = 0; x < W; x++) {
+        if (maze_wall(&m, x, y)) continue;
+        open++;
+        edges += !maze_wall(&m, x + 1, y);
+        edges += !maze_wall(&m, x, y + 1);
+        check((x & 1) || (y & 1), "open cell at even (x, y)");
+      }
+    }
+    for (int x = 0; x < W; x++) {
+      check(maze_wall(&m, x, 0), "top border open");
+      if (x != W - 2) check(maze_wall(&m, x, H - 1), "bottom border open");
+    }
+    for (int y = 0; y < H; y++) check(maze_wall(&m, 0, y) && maze_wall(&m, W - 1, y), "side border open");
+    check(!maze_wall(&m, W - 2, H - 1), "exit closed");
+    check(edges == open - 1, "not a tree");
+    check(refBfs(&m, 1, 1) == open, "open cells not all reachable");
+
+    t0 = mono_ms();
+    len = maze_solve(&m, 1, 1, W - 2, H - 2, ss, q, QCAP, path);
+    solveMs += mono_ms() - t0;
+    check(len == dist[(uint32_t)(H - 2) * W + (uint32_t)(W - 2)], "solve length differs from reference");
+    check(len > 0 && pathOk(&m, path, len, W - 2, H - 2), "path bits not a shortest path");
+  }
+
+  // 5. Collision query cost on the last maze
+  const long N = 20000000;
+  uint32_t hits = 0;
+  double t0 = mono_ms();
+  for (long i = 0; i < N; i++) {
+    uint32_t r = xorshift();
+    hits += (uint32_t)maze_wall(&m, (int)((r >> 4) % (uint32_t)W), (int)((r >> 18) % (uint32_t)H));
+  }
+  double ns = (mono_ms() - t0) * 1e6 / (double)N;
+
+  printf("%4dx%-4d  %u B  gen %.2f ms  solve %.2f ms (%d steps)  collide %.1f ns/query (%u walls)"
+         "  %d mazes are trees\n", W, H, (unsigned)(MAZE_WORDS(W, H) * 4), genMs / seeds,
+         solveMs / seeds, (int)len, ns, hits, seeds);
+}
+
+// Random walls with loops, random ends
+static void checkRandomGrids(uint32_t *bits, uint32_t *ss, uint32_t *q, uint32_t *path)
+{
+  uint32_t solved = 0, unreachable = 0;
+  Maze m;
+
+  for (int t = 0; t < 400; t++) {
+    int W = 3 + (int)(xorshift() % 120), H = 3 + (int)(xorshift() % 120);
+    maze_init(&m, (uint16_t)W, (uint16_t)H, bits);
+    maze_fill(&m, 0);
+    uint32_t pct = 20 + xorshift() % 25;
+    for (int y = 0; y < H; y++)
+      for (int x = 0; x < W; x++)
+        if (xorshift() % 100 < pct) maze_set(&m, x, y, 1);
+    int sx = (int)(xorshift() % (uint32_t)W), sy = (int)(xorshift() % (uint32_t)H);
+    int gx = (int)(xorshift() % (uint32_t)W), gy = (int)(xorshift() % (uint32_t)H);
+    maze_set(&m, sx, sy, 0);
+    maze_set(&m, gx, gy, 0);
+
+    refBfs(&m, sx, sy);
+    int32_t want = dist[(uint32_t)gy * W + (uint32_t)gx];
+    int32_t len = maze_solve(&m, sx, sy, gx, gy, ss, q, QCAP, path);
+    check(len == want, "random grid: solve length differs from reference");
+    if (len >= 0) {
+      check(pathOk(&m, path, len, gx, gy), "random grid: path bits not a shortest path");
+      solved++;
+    } else {
+      unreachable++;
+    }
+  }
+
+  maze_init(&m, 101, 101, bits);
+  maze_fill(&m, 0);
+  check(maze_solve(&m, 0, 0, 100, 100, ss, q, 8, path) == -2, "open field with an 8-entry queue not -2");
+  printf("random walled grids: 400 (%u solved, %u unreachable) agree with the reference\n",
+         solved, unreachable);
+}
+
+//------------------------------------------------------------------------------
+// 3. Collision
+//------------------------------------------------------------------------------
+static void checkCollision(uint32_t *bits)
+{
+  static uint8_t ref[1025 * 1025];
+  const int W = 1025, H = 1023;
+  uint32_t wrong = 0;
+  Maze m;
+
+  maze_init(&m, W, H, bits);
+  maze_fill(&m, 1);
+  memset(ref, 1, sizeof(ref));
+  for (int i = 0; i < 2000000; i++) {
+    int x = (int)(xorshift() % W), y = (int)(xorshift() % H);
+    uint8_t w = (uint8_t)(xorshift() & 1);
+    maze_set(&m, x, y, w);
+    ref[y * W + x] = w;
+  }
+  for (int y = -2; y < H + 2; y++) {
+    for (int x = -2; x < W + 2; x++) {
+      int want = (x < 0 || y < 0 || x >= W || y >= H) ? 1 : ref[y * W + x];
+      wrong += maze_wall(&m, x, y) != want;
+    }
+  }
+  check(wrong == 0, "maze_wall differs from the byte copy");
+  printf("collision: 2M random sets on 1025x1023, every cell and the ring outside: %u wrong\n", wrong);
+}
+
+//------------------------------------------------------------------------------
+// 4. Viewport through a terminal
+//------------------------------------------------------------------------------
+#define T_ROWS 30
+#define T_COLS 90
+
+static char    scr[T_ROWS][T_COLS];
+static uint8_t scrFg[T_ROWS][T_COLS];
+static int     tRow, tCol, tFg;
+static uint32_t termErrors;
+
+static void sink(const char *b, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++) {
+    if (b[i] != '\033') {
+      if (tRow < T_ROWS && tCol < T_COLS) { scr[tRow][tCol] = b[i]; scrFg[tRow][tCol] = (uint8_t)tFg; }
+      else termErrors++;
+      tCol++;
+      continue;
+    }
+    int p[4] = { 0 }, np = 0;
+    if (++i >= n || b[i] != '[') { termErrors++; continue; }
+    for (i++; i < n && ((b[i] >= '0' && b[i] <= '9') || b[i] == ';'); i++) {
+      if (b[i] == ';') { if (np < 3) np++; }
+      else p[np] = p[np] * 10 + (b[i] - '0');
+    }
+    if (i >= n) { termErrors++; break; }               // the view never splits a sequence
+    if (b[i] == 'H') { tRow = p[0]; tCol = p[1]; }
+    else if (b[i] == 'm' && p[0] == 38 && p[1] == 5) tFg = p[2];
+    else termErrors++;
+  }
+}
+
+static void checkView(uint32_t *bits, uint32_t *gs, uint32_t *ss, uint32_t *q, uint32_t *path)
+{
+  const int W = 257, H = 257, ROW = 4, COL = 19;
+  static MazeView v;
+  Maze m;
+  uint32_t steps = 0, quiet = 0, cells = 0, wrong = 0, idleSent = 0;
+
+  maze_init(&m, W, H, bits);
+  maze_generate(&m, 4242u, gs);
+  check(maze_solve(&m, 1, 1, W - 2, H - 2, ss, q, QCAP, path) > 0, "view maze unsolved");
+  maze_view_init(&v, &m, 60, 18, ROW, COL, sink);
+
+  int px = 1, py = 1;
+  for (int k = 0; k < 20000; k++) {
+    const uint32_t *shown = (k / 4000) & 1 ? NULL : path;   // path on and off every 4000 steps
+    int ox = v.ox, oy = v.oy;
+    uint32_t sent = maze_view_render(&v, px, py, shown);
+    steps++;
+    if (k && (k % 4000) && ox == v.ox && oy == v.oy) { quiet++; cells += sent; }
+
+    check(px - v.ox >= 0 && px - v.ox < v.vw && py - v.oy >= 0 && py - v.oy < v.vh, "player out of view");
+    for (int r = 0; r < v.vh; r++) {
+      for (int c = 0; c < v.vw; c++) {
+        int x = v.ox + c, y = v.oy + r;
+        uint32_t i = (uint32_t)y * W + (uint32_t)x;
+        char want = (x == px && y == py) ? 'O'
+                  : maze_wall(&m, x, y) ? ((y == 0 || y == H - 1) ? '-' : '|')
+                  : (shown && bit(shown, i)) ? '.' : ' ';
+        uint8_t fg = want == 'O' ? 220 : want == '.' ? 46 : 21;
+        if (scr[ROW + r][COL + c] != want || (want != ' ' && scrFg[ROW + r][COL + c] != fg)) wrong++;
+      }
+    }
+    idleSent += maze_view_render(&v, px, py, shown);
+
+    // a random open neighbour
+    static const int dx[4] = { 1, -1, 0, 0 }, dy[4] = { 0, 0, 1, -1 };
+    for (int tries = 0; tries < 8; tries++) {
+      int d = (int)(xorshift() % 4);
+      if (!maze_wall(&m, px + dx[d], py + dy[d]) && py + dy[d] < H - 1) { px += dx[d]; py += dy[d]; break; }
+    }
+  }
+  check(wrong == 0 && termErrors == 0, "terminal differs from the maze window");
+  check(idleSent == 0, "idle render sent cells");
+  printf("viewport: %u renders, %u cells wrong, %u bad sequences; idle renders sent %u cells; "
+         "%.2f cells per step without scrolling\n", steps, wrong, termErrors, idleSent,
+         quiet ? (double)cells / quiet : 0.0);
+}
+
+int main(void)
+{
+  const uint32_t n = 1025u * 1025u;
+  uint32_t *bits = malloc(MAZE_WORDS(1025, 1025) * 4);
+  uint32_t *gs   = malloc(MAZE_GEN_WORDS(1025, 1025) * 4);
+  uint32_t *ss   = malloc(MAZE_SOLVE_WORDS(1025, 1025) * 4);
+  uint32_t *path = malloc(MAZE_WORDS(1025, 1025) * 4);
+  uint32_t *q    = malloc(QCAP * 4);
+  dist = malloc(n * sizeof(*dist));
+  fifo = malloc(n * sizeof(*fifo));
+  if (!bits || !gs || !ss || !path || !q || !dist || !fifo) return 2;
+
+  for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) checkGenerated(sizes[k], bits, gs, ss, q, path);
+  checkRandomGrids(bits, ss, q, path);
+  checkCollision(bits);
+  checkView(bits, gs, ss, q, path);
+
+  printf("%s\n", bad ? "FAILED" : "all checks passed");
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,292 @@
+// pulse_seq_host.c  (host checks for the Lab02/src/pulse_seq.c compiler,
+//                    verifier and burst layout)
+//
+//   gcc -O2 -DHOST_BUILD -ILab02/src -o pulse_seq_host host/pulse_seq_host.c
+//       Lab02/src/pulse_seq.c
+//
+// 1. Part 3's ramp (50 high/low steps, 1..100 ms) at 216, 200, 108 and
+//    16 MHz kernel clocks: exact, one pass 5050 ms, no drift.
+// 2. A mixed table with odd lengths and repeats up to 255.
+// 3. Long periods: 1 s up to the ~19.88 s limit at 216 MHz (past the 4.29 s
+//    where ns stop fitting 32 bits) compile with at most half a tick of
+//    error, checked here against long double arithmetic; longer ones are
+//    PULSE_ERR_RANGE.
+// 4. Error codes, single-step padding, and corrupted image words (ARR, PSC,
+//    a stray CCR) caught at the right step.
+// 5. Chaining: a TIM1 + DMA model (preload/shadow registers loaded on each
+//    update, RCR repeats, one burst per update, the driver's priming and
+//    transfer-complete hand-over) plays a 1 kHz program, then a chained one
+//    of multi-second steps compiled with another prescaler. Every period of
+//    both must come out as requested. The same model with PSC written by
+//    the CPU at the hand-over instead shows the step that gets mistimed.
+// Exits non-zero on a failed check.
+
+#include "pulse_seq.h"
+#include <stdio.h>
+#include <string.h>
+
+#define W_PSC 0
+#define W_ARR 1
+#define W_RCR 2
+#define W_CCR (2 + PULSE_SEQ_CH)
+
+static int bad;
+
+static void check(int ok, const char *what)
+{
+  if (!ok) { printf("FAIL: %s\n", what); bad++; }
+}
+
+// Period length in ns for ticks at psc, independently of pulse_seq.c
+static long double nsOf(uint32_t ticks, uint32_t psc, uint32_t hz)
+{
+  return (long double)ticks * (psc + 1) * 1e9L / hz;
+}
+
+//------------------------------------------------------------------------------
+// 1. 2. 4. Tables
+//------------------------------------------------------------------------------
+static PulseStep ramp[50];
+static uint32_t  img[64 * PULSE_SEQ_WORDS];
+
+static void tables(void)
+{
+  static const uint32_t hz[] = { 216000000, 200000000, 108000000, 16000000 };
+  PulseProgram p;
+  PulseVerify v;
+
+  for (int i = 0; i < 50; i++) {
+    uint32_t k = 2 * (uint32_t)i + 1;
+    ramp[i] = (PulseStep){ (2 * k + 1) * 1000, k * 1000, 0 };
+  }
+  for (size_t h = 0; h < sizeof(hz) / sizeof(hz[0]); h++) {
+    int rc = pulse_seq_compile(ramp, 50, hz[h], img, sizeof(img) / 4, &p);
+    int vr = pulse_seq_verify(&p, ramp, 50, 1000, &v);
+    printf("ramp at %3u MHz: psc %u, max error %u ns, %u periods, pass %llu ms, drift %lld ns\n",
+           (unsigned)(hz[h] / 1000000), p.psc, p.maxErrNs, v.checked,
+           (unsigned long long)(v.totalNs / 1000000), (long long)v.driftNs);
+    check(rc == PULSE_OK && vr == 0 && p.maxErrNs == 0 && v.driftNs == 0 &&
+          v.totalNs == 5050000000ULL, "ramp not exact");
+  }
+
+  PulseStep mixed[] = { { 7, 3, 0 }, { 13, 13, 4 }, { 1000, 1, 255 }, { 333, 0, 2 } };
+  int rc = pulse_seq_compile(mixed, 4, 216000000, img, sizeof(img) / 4, &p);
+  int vr = pulse_seq_verify(&p, mixed, 4, 10, &v);
+  printf("mixed: psc %u, max error %u ns, %u periods, drift %lld ns\n", p.psc, p.maxErrNs,
+         v.checked, (long long)v.driftNs);
+  check(rc == PULSE_OK && vr == 0 && v.checked == 1 + 5 + 256 + 3, "mixed table");
+
+  PulseStep longPulse[] = { { 10, 11, 0 } }, tooLong[] = { { 400000000, 1, 0 } };
+  PulseStep bigRepeat[] = { { 10, 1, 300 } }, one[] = { { 50, 25, 0 } };
+  check(pulse_seq_compile(longPulse, 1, 216000000, img, 99, &p) == PULSE_ERR_PULSE, "PULSE_ERR_PULSE");
+  check(pulse_seq_compile(tooLong, 1, 216000000, img, 99, &p) == PULSE_ERR_RANGE, "PULSE_ERR_RANGE");
+  check(pulse_seq_compile(bigRepeat, 1, 216000000, img, 99, &p) == PULSE_ERR_REPEAT, "PULSE_ERR_REPEAT");
+  check(pulse_seq_compile(ramp, 50, 216000000, img, 10, &p) == PULSE_ERR_SPACE, "PULSE_ERR_SPACE");
+  check(pulse_seq_compile(ramp, 0, 216000000, img, 99, &p) == PULSE_ERR_EMPTY, "PULSE_ERR_EMPTY");
+  rc = pulse_seq_compile(one, 1, 216000000, img, 99, &p);
+  check(rc == PULSE_OK && p.steps == 2 && pulse_seq_verify(&p, one, 1, 0, &v) == 0, "single step padded to 2");
+
+  // Corrupted words, each caught at step 7
+  static const struct { int word; uint32_t add; const char *name; } hits[] = {
+    { W_ARR, 3, "ARR" }, { W_PSC, 1, "PSC" }, { W_RCR + 1, 5, "CCR1" }, { W_RCR, 1, "RCR" },
+  };
+  for (size_t k = 0; k < sizeof(hits) / sizeof(hits[0]); k++) {
+    pulse_seq_compile(ramp, 50, 216000000, img, sizeof(img) / 4, &p);
+    img[7 * PULSE_SEQ_WORDS + hits[k].word] += hits[k].add;
+    int r = pulse_seq_verify(&p, ramp, 50, 1000, &v);
+    printf("corrupted %s at step 7: verify %d\n", hits[k].name, r);
+    check(r == -8, "corruption not caught at its step");
+  }
+}
+
+//------------------------------------------------------------------------------
+// 3. Long periods
+//------------------------------------------------------------------------------
+static void longPeriods(void)
+{
+  static const uint32_t us[] = { 1000000, 4294967, 4294968, 5000000, 10000000, 19000000, 19884107 };
+  const uint32_t hz = 216000000;
+  PulseProgram p;
+  PulseVerify v;
+
+  for (size_t k = 0; k < sizeof(us) / sizeof(us[0]); k++) {
+    PulseStep s[2] = { { us[k], us[k] / 3, 0 }, { us[k] / 2 + 7, 1, 1 } };
+    int rc = pulse_seq_compile(s, 2, hz, img, sizeof(img) / 4, &p);
+    if (rc != PULSE_OK) { printf("%u us: rejected %d\n", (unsigned)us[k], rc); check(0, "long period rejected"); continue; }
+    int vr = pulse_seq_verify(&p, s, 2, 0xFFFFFFFFu, &v);
+
+    // Independent error of every word against the request
+    long double worst = 0, halfTick = nsOf(1, p.psc, hz) / 2;
+    for (int i = 0; i < 2; i++) {
+      const uint32_t *w = &img[i * PULSE_SEQ_WORDS];
+      long double e1 = nsOf(w[W_ARR] + 1, w[W_PSC], hz) - s[i].periodUs * 1000.0L;
+      long double e2 = nsOf(w[W_CCR], w[W_PSC], hz) - s[i].pulseUs * 1000.0L;
+      if (e1 < 0) e1 = -e1;
+      if (e2 < 0) e2 = -e2;
+      if (e1 > worst) worst = e1;
+      if (e2 > worst) worst = e2;
+    }
+    printf("%8u us: psc %5u, max error %u ns (independent %.0Lf, half a tick %.0Lf), "
+           "pass %.6f s, drift %lld ns\n", (unsigned)us[k], p.psc, p.maxErrNs, worst, halfTick,
+           (double)v.totalNs / 1e9, (long long)v.driftNs);
+    check(vr == 0 && worst <= halfTick + 1 && (long double)p.maxErrNs >= worst - 1 &&
+          (long double)p.maxErrNs <= worst + 1, "long period error wrong");
+  }
+
+  PulseStep over[] = { { 19884108, 1, 0 } }, way[] = { { 60000000, 1, 0 } };
+  check(pulse_seq_compile(over, 1, hz, img, 99, &p) == PULSE_ERR_RANGE, "just past the limit not PULSE_ERR_RANGE");
+  check(pulse_seq_compile(way, 1, hz, img, 99, &p) == PULSE_ERR_RANGE, "60 s not PULSE_ERR_RANGE");
+}
+
+//------------------------------------------------------------------------------
+// 5. TIM1 + DMA model of the driver
+//------------------------------------------------------------------------------
+typedef struct { uint32_t psc, arr, rcr, ccr; } Regs;
+
+typedef struct {
+  Regs     pre, act;              // preload and active (shadow) registers
+  int      ude, ending;
+  const uint32_t *dma;            // stream
+  uint32_t ndtr;
+  const PulseProgram *cur, *next;
+  int      cpuPscAtHandOver;      // the alternative: write PSC in the TC handler
+  uint32_t hz;
+  // played periods
+  long double ns[4096];
+  long double high[4096];
+  int      n;
+} Model;
+
+static void loadWords(Regs *r, const uint32_t *w)
+{
+  r->psc = w[W_PSC];
+  r->arr = w[W_ARR];
+  r->rcr = w[W_RCR];
+  r->ccr = w[W_CCR];
+}
+
+static void tcHandler(Model *m)
+{
+  if (m->next) {
+    m->cur = m->next;
+    m->next = NULL;
+    m->dma = m->cur->image;
+    m->ndtr = (uint32_t)m->cur->steps * PULSE_SEQ_WORDS;
+    if (m->cpuPscAtHandOver) m->pre.psc = m->cur->psc;
+  } else {
+    m->ude = 0;                                       // beginTail
+    m->ending = 2;
+  }
+}
+
+// One update event: shadows load, then the DMA burst or the tail handler
+static void update(Model *m)
+{
+  m->act = m->pre;
+  if (m->ude && m->ndtr) {
+    loadWords(&m->pre, m->dma);
+    m->dma += PULSE_SEQ_WORDS;
+    m->ndtr -= PULSE_SEQ_WORDS;
+    if (!m->ndtr) tcHandler(m);
+  } else if (m->ending == 2) {
+    m->pre.ccr = 0;
+    m->ending = 1;
+  } else if (m->ending == 1) {
+    m->ending = 0;
+  }
+}
+
+static void play(Model *m, const PulseProgram *a, const PulseProgram *b)
+{
+  const uint32_t *w = a->image;
+
+  memset(m, 0, sizeof(*m));
+  m->hz = a->timerHz;
+  m->cur = a;
+  m->next = b;
+  // pulse_seq_start: step 0 active (UG), step 1 preloaded, DMA from step 2
+  loadWords(&m->pre, w);
+  m->act = m->pre;
+  loadWords(&m->pre, w + PULSE_SEQ_WORDS);
+  m->dma = w + 2 * PULSE_SEQ_WORDS;
+  m->ndtr = (uint32_t)(a->steps - 2) * PULSE_SEQ_WORDS;
+  m->ude = 1;
+  if (!m->ndtr) tcHandler(m);
+}
+
+static void runModel(Model *m, const PulseProgram *a, const PulseProgram *b, int cpuPsc)
+{
+  play(m, a, b);
+  m->cpuPscAtHandOver = cpuPsc;
+  for (;;) {
+    for (uint32_t r = 0; r <= m->act.rcr && m->n < 4096; r++) {
+      m->ns[m->n] = nsOf(m->act.arr + 1, m->act.psc, m->hz);
+      m->high[m->n++] = nsOf(m->act.ccr, m->act.psc, m->hz);
+    }
+    if (!m->ude && m->ending == 0 && m->act.ccr == 0) break;      // idle level reached
+    update(m);
+  }
+}
+
+// Periods that differ from a's then b's steps by more than maxErr
+static int mistimed(const Model *m, const PulseStep *sa, int na, const PulseStep *sb, int nb,
+                    long double maxErr, int *firstBad)
+{
+  int k = 0, wrong = 0;
+  *firstBad = -1;
+  for (int part = 0; part < 2; part++) {
+    const PulseStep *s = part ? sb : sa;
+    int n = part ? nb : na;
+    for (int i = 0; i < n; i++) {
+      for (uint32_t r = 0; r <= s[i].repeat; r++, k++) {
+        long double e1 = m->ns[k] - s[i].periodUs * 1000.0L, e2 = m->high[k] - s[i].pulseUs * 1000.0L;
+        if (e1 < 0) e1 = -e1;
+        if (e2 < 0) e2 = -e2;
+        if (e1 > maxErr || e2 > maxErr) { if (*firstBad < 0) *firstBad = k; wrong++; }
+      }
+    }
+  }
+  return wrong;
+}
+
+static void chaining(void)
+{
+  static uint32_t imgA[8 * PULSE_SEQ_WORDS], imgB[8 * PULSE_SEQ_WORDS];
+  static Model m;
+  PulseStep a[] = { { 1000, 500, 3 }, { 1000, 250, 0 }, { 500, 100, 2 }, { 2000, 1000, 0 }, { 1000, 1, 0 } };
+  PulseStep b[] = { { 5000000, 2500000, 0 }, { 3000000, 1000000, 1 }, { 7000000, 7, 0 } };
+  PulseProgram pa, pb;
+  int first;
+
+  check(pulse_seq_compile(a, 5, 216000000, imgA, sizeof(imgA) / 4, &pa) == PULSE_OK, "chain A");
+  check(pulse_seq_compile(b, 3, 216000000, imgB, sizeof(imgB) / 4, &pb) == PULSE_OK, "chain B");
+  long double tol = (pa.maxErrNs > pb.maxErrNs ? pa.maxErrNs : pb.maxErrNs) + 1;
+  int periodsA = 0, periods;
+  for (int i = 0; i < 5; i++) periodsA += a[i].repeat + 1;
+  periods = periodsA;
+  for (int i = 0; i < 3; i++) periods += b[i].repeat + 1;
+
+  runModel(&m, &pa, &pb, 0);                          // the last period recorded is the idle level
+  int wrong = mistimed(&m, a, 5, b, 3, tol, &first);
+  printf("chain A (psc %u) -> B (psc %u), PSC in the burst: %d periods played (%d requested), "
+         "%d mistimed\n", pa.psc, pb.psc, m.n - 1, periods, wrong);
+  check(pa.psc != pb.psc, "test programs share a prescaler");
+  check(m.n - 1 == periods && wrong == 0, "chained program played at the wrong speed");
+
+  runModel(&m, &pa, &pb, 1);
+  wrong = mistimed(&m, a, 5, b, 3, tol, &first);
+  printf("  same with PSC written by the CPU at the hand-over: %d mistimed, first at period %d "
+         "(A's last step plays %.0Lf ns instead of %u us)\n", wrong, first, first >= 0 ? m.ns[first] : 0.0L,
+         (unsigned)a[4].periodUs);
+  check(wrong > 0 && first == periodsA - 1, "CPU write at the hand-over should mistime A's last step");
+}
+
+int main(void)
+{
+  tables();
+  longPeriods();
+  chaining();
+
+  printf("%s\n", bad ? "FAILED" : "all checks passed");
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+// scrollback_host.c  (host checks and timing for Lab01/Src/scrollback.c)
+//
+//   gcc -O2 -ILab01/Src -o scrollback_host host/scrollback_host.c
+//       Lab01/Src/scrollback.c
+//
+// Streams 8 MB of pseudo-random printable text into the log, task2's way
+// (10 visible rows of 72). The reference is the flat text: line L holds
+// chars L*72 .. L*72+71, blank past the last one typed.
+//
+// 1. Every 4096 chars (and at random points) all 10 visible rows match the
+//    reference.
+// 2. There, a random walk of Ctrl-U / Ctrl-D half pages: every window
+//    matches, the view stops at the oldest line the ring still holds
+//    (SB_LINES - 1 back from the current one) and at live, and the next
+//    char snaps back to live.
+// 3. Append cost per MB stays flat.
+// Exits non-zero on a mismatch.
+
+#define _POSIX_C_SOURCE 199309L
+#include "scrollback.h"
+#include <stdio.h>
+#include <time.h>
+
+#define ROWS   10
+#define TOTAL  (8u << 20)
+#define MB     (1u << 20)
+
+static Scrollback sb;
+static char       ref[TOTAL];
+static uint32_t   typed;
+static uint32_t   errs;
+
+static uint32_t rng = 2463534242u;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static uint64_t mono_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static char refAt(uint32_t line, uint32_t col)
+{
+  uint32_t i = line * SB_COLS + col;
+  return i < typed ? ref[i] : '.';
+}
+
+// The window as it should be with the view v lines back
+static void checkWindow(uint32_t v)
+{
+  uint32_t head = typed / SB_COLS;
+  uint32_t top  = head + 1 > ROWS ? head + 1 - ROWS : 0;
+
+  for (int r = 0; r < ROWS; r++) {
+    const char *row = sb_row(&sb, r, ROWS);
+    for (uint32_t c = 0; c < SB_COLS; c++) {
+      if (row[c] != refAt(top - v + (uint32_t)r, c)) {
+        if (errs++ < 5) printf("typed %u view %u row %d col %u: '%c' not '%c'\n",
+                               typed, v, r, c, row[c], refAt(top - v + (uint32_t)r, c));
+        return;
+      }
+    }
+  }
+}
+
+static void scrollWalk(void)
+{
+  uint32_t head   = typed / SB_COLS;
+  uint32_t top    = head + 1 > ROWS ? head + 1 - ROWS : 0;
+  uint32_t oldest = head >= SB_LINES ? head - (SB_LINES - 1) : 0;
+  uint32_t max    = top > oldest ? top - oldest : 0;
+  int32_t  v      = 0;
+
+  for (int k = 0; k < 12; k++) {
+    int32_t d = xorshift() % 3 ? ROWS / 2 : -ROWS / 2;
+    sb_scroll(&sb, d, ROWS);
+    v += d;
+    if (v < 0) v = 0;
+    if (v > (int32_t)max) v = (int32_t)max;
+    if (sb.view != (uint32_t)v) {
+      if (errs++ < 5) printf("typed %u: view %u, expected %d (max %u)\n", typed, sb.view, v, max);
+      return;
+    }
+    checkWindow((uint32_t)v);
+  }
+  sb_scroll(&sb, 1 << 14, ROWS);                       // all the way back
+  if (sb.view != max) errs++;
+  checkWindow(max);
+}
+
+int main(void)
+{
+  for (uint32_t i = 0; i < TOTAL; i++) ref[i] = (char)('!' + xorshift() % 90);
+
+  // 1, 2. Correctness
+  sb_init(&sb, '.');
+  typed = 0;
+  checkWindow(0);
+  uint32_t walks = 0;
+  for (uint32_t i = 0; i < TOTAL; i++) {
+    sb_putc(&sb, ref[i]);
+    typed++;
+    if (sb.view != 0) errs++;
+    if ((typed & 4095) == 0 || xorshift() % 8192 == 0) {
+      checkWindow(0);
+      scrollWalk();
+      walks++;
+    }
+  }
+  printf("8 MB streamed, %u windows checked with a scroll walk each: %u mismatches\n", walks, errs);
+
+  // 3. Timing, no checks in the loop
+  sb_init(&sb, '.');
+  double worst = 0, best = 1e9;
+  for (uint32_t base = 0; base < TOTAL; base += MB) {
+    uint64_t t0 = mono_ns();
+    for (uint32_t i = base; i < base + MB; i++) sb_putc(&sb, ref[i]);
+    double ns = (double)(mono_ns() - t0) / MB;
+    if (ns > worst) worst = ns;
+    if (ns < best) best = ns;
+  }
+  volatile char sink = sb_row(&sb, 0, ROWS)[0];
+  (void)sink;
+  printf("append: %.2f .. %.2f ns/char over the 8 MB\n", best, worst);
+
+  printf("%s\n", errs ? "FAILED" : "all checks passed");
+  return errs ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+// spi_batch_host.c  (host model of Lab03/src/spi_batch.c)
+//
+//   gcc -O2 -DHOST_BUILD -ILab03/src -o spi_batch_host
+//       host/spi_batch_host.c Lab03/src/spi_batch.c
+//
+// Runs the batch core against a simulated full-duplex bus in virtual time
+// (picoseconds). The bus is a loopback: a batch of n bytes takes n * 8 SCK
+// periods and returns what it sent. The main loop is modelled as one
+// iteration every loopPs: write what fits, then spi_batch_poll(), so a
+// finished batch is noticed at the next iteration.
+//
+// 1. Correctness: random write sizes (typing to 600-byte bursts), a ring
+//    that fills, one batch in 37 failing. Every batch must be contiguous in
+//    the ring, at most SPI_BATCH_MAX, untouched while on the wire and in
+//    stream order; the callback must see exactly the good batches.
+// 2. Throughput: a writer that never runs dry, at each SPI2 prescaler of
+//    a 54 MHz PCLK1, for a few main-loop periods. The gap between batches
+//    is what the pipeline costs; on the board Ctrl-B in task3 measures it.
+// Exits non-zero on a failed check.
+
+#include "spi_batch.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PCLK1_HZ  54000000ull
+
+static uint8_t  ring[SPI_BATCH_RING];
+static uint8_t  rxBufs[2 * SPI_BATCH_MAX];
+static SpiBatch sb;
+
+static uint64_t now, psPerByte;
+static uint32_t failEvery;
+static uint32_t rng = 88172645u;
+
+static struct {
+  const uint8_t *tx;
+  uint8_t  *rx;
+  uint32_t  len;
+  uint8_t   copy[SPI_BATCH_MAX];
+  uint64_t  end;
+  int       on, fail;
+} bus;
+
+// The core starts the next batch before its callback runs, so the callback
+// is checked against the batch that finished last, not the one on the bus
+static uint8_t  last[SPI_BATCH_MAX];
+static uint32_t lastLen;
+
+static uint64_t streamPos;     // stream offset of the next batch
+static uint64_t delivered;     // bytes the callback has seen
+static uint64_t dropped;
+static uint32_t bad;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static uint8_t pattern(uint64_t k)
+{
+  return (uint8_t)(k * 7u + (k >> 8));
+}
+
+static void simStart(const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+  if (bus.on) { printf("batch started while busy\n"); bad++; }
+  if (len == 0 || len > SPI_BATCH_MAX) { printf("batch length %u\n", len); bad++; }
+  if (tx < ring || tx + len > ring + SPI_BATCH_RING) { printf("batch wraps the ring\n"); bad++; }
+  if (rx != rxBufs && rx != rxBufs + SPI_BATCH_MAX) { printf("bad RX buffer\n"); bad++; }
+
+  for (uint32_t i = 0; i < len; i++) {
+    if (tx[i] != pattern(streamPos + i)) { printf("out of order at %llu\n", (unsigned long long)(streamPos + i)); bad++; break; }
+  }
+  streamPos += len;
+
+  memcpy(bus.copy, tx, len);
+  bus.tx = tx;
+  bus.rx = rx;
+  bus.len = len;
+  bus.end = now + len * psPerByte;
+  bus.fail = failEvery && xorshift() % failEvery == 0;
+  bus.on = 1;
+}
+
+static int simDone(void)
+{
+  if (!bus.on || now < bus.end) return 0;
+  bus.on = 0;
+  if (memcmp(bus.tx, bus.copy, bus.len)) { printf("ring overwritten under the DMA\n"); bad++; }
+  if (bus.fail) {
+    dropped += bus.len;
+    return -1;
+  }
+  memcpy(bus.rx, bus.copy, bus.len);   // loopback
+  memcpy(last, bus.copy, bus.len);
+  lastLen = bus.len;
+  return 1;
+}
+
+static void onRx(const uint8_t *p, uint32_t len, void *ctx)
+{
+  (void)ctx;
+  if (len != lastLen || memcmp(p, last, len)) { if (!bad) printf("callback got the wrong bytes\n"); bad++; }
+  delivered += len;
+}
+
+static const SpiBatchOps simOps = { simStart, simDone };
+
+static void reset(uint32_t sckDiv, uint32_t failOneIn)
+{
+  memset(&bus, 0, sizeof(bus));
+  now = 0;
+  psPerByte = 8ull * 1000000000000ull * sckDiv / PCLK1_HZ;
+  failEvery = failOneIn;
+  streamPos = delivered = dropped = 0;
+  spi_batch_init(&sb, &simOps, ring, rxBufs);
+  spi_batch_hook(&sb, onRx, NULL);
+}
+
+// Push total bytes; each loop iteration writes up to chunk() bytes then polls
+static uint64_t run(uint64_t total, uint64_t loopPs, int typing)
+{
+  uint8_t buf[600];
+  uint64_t sent = 0;
+
+  while (sent < total || spi_batch_pending(&sb)) {
+    if (sent < total) {
+      uint32_t n = typing ? (xorshift() % 8 == 0) : 64;
+      if (typing && xorshift() % 50 == 0) n = 1 + xorshift() % sizeof(buf);
+      if (n > total - sent) n = (uint32_t)(total - sent);
+      for (uint32_t i = 0; i < n; i++) buf[i] = pattern(sent + i);
+      sent += spi_batch_write(&sb, buf, n);
+    }
+    spi_batch_poll(&sb);
+    now += loopPs;
+  }
+  return now;
+}
+
+int main(void)
+{
+  int fail = 0;
+
+  // 1. Correctness
+  static const uint32_t divs[] = { 2, 16, 256 };
+  for (unsigned d = 0; d < 3; d++) {
+    reset(divs[d], 37);
+    run(2000000, 1000000, 1);
+    if (delivered + dropped != streamPos || streamPos != 2000000 || bad) {
+      printf("div %u: streamed %llu delivered %llu dropped %llu, %u bad\n", divs[d],
+             (unsigned long long)streamPos, (unsigned long long)delivered,
+             (unsigned long long)dropped, bad);
+      fail++;
+    }
+    if (sb.st.errors == 0 || sb.st.full == 0 || sb.st.txBytes != delivered) {
+      printf("div %u: stats errors %u full %u txBytes %u\n", divs[d], sb.st.errors, sb.st.full, sb.st.txBytes);
+      fail++;
+    }
+    printf("div %3u: %u batches (max %u), %u dropped, ring peak %u, %u full writes\n",
+           divs[d], sb.st.batches, sb.st.maxBatch, sb.st.errors, sb.st.maxFill, sb.st.full);
+  }
+
+  // 2. Throughput
+  static const uint64_t loops[] = { 500000, 1000000, 2000000 };   // ps per main-loop pass
+  printf("\nsustained chars/s, writer never dry, 64-byte writes\n");
+  printf("  SCK kHz   wire ch/s   loop 0.5 us       loop 1 us         loop 2 us\n");
+  for (uint32_t k = 0; k < 8; k++) {
+    uint32_t div = 2u << k;
+    printf("  %7llu  %10llu", (unsigned long long)(PCLK1_HZ / div / 1000), (unsigned long long)(PCLK1_HZ / div / 8));
+    for (unsigned l = 0; l < 3; l++) {
+      reset(div, 0);
+      uint64_t ps = run(1 << 20, loops[l], 0);
+      double rate = (double)(1 << 20) * 1e12 / (double)ps;
+      printf("  %9.0f (%3.0f%%)", rate, 100.0 * rate / (double)(PCLK1_HZ / div / 8));
+      if (bad) fail++;
+    }
+    printf("  batch %u\n", (1u << 20) / sb.st.batches);
+  }
+
+  printf("%s\n", fail ? "FAILED" : "all checks passed");
+  return fail ? 1 : 0;
+}
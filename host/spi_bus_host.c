@@ -0,0 +1,441 @@
+// spi_bus_host.c  (host checks and benchmark for Lab03/src/spi_bus.c)
+//
+//   gcc -O2 -DHOST_BUILD -ILab03/src -Ihost -o spi_bus_host
+//       host/spi_bus_host.c host/stats_model.c Lab03/src/spi_bus.c
+//       Lab03/src/stats_txn.c
+//
+// Four STaTS models on one virtual SPI2 (PCLK1 54 MHz), each wired for its
+// own SPI settings:
+//
+//   0  mode 1, LSB first, <= 250 kHz, CS 4/4/4 us (task4's board) -> /256  211 kHz
+//   1  the same as 0                                              -> /256  211 kHz
+//   2  mode 0, MSB first, <= 1 MHz, CS 2/2/2 us                   -> /64   844 kHz
+//   3  mode 3, LSB first, <= 4 MHz, CS 2/2/2 us                   -> /16   3.4 MHz
+//
+// Every CS delay is one the STM32 port times on TIM7 (at least
+// SPI_BUS_MIN_TIMER_US); a shorter one asked for fails the run, so the
+// rates below hold for the board.
+//
+// The bus model shifts every bit: a device clocked in the wrong mode, or
+// faster than it takes, samples one bit late, and a bit order mismatch
+// reverses its bytes, so a frame sent with the wrong settings reads back
+// wrong. SPI2 reprogramming is charged RECONF_NS (assumed: SPE off, CR1,
+// SPE on, from the ISR).
+//
+// 1. Random traffic on all four for 2 s: every read is right (VERSION,
+//    DEVID, TXT_ATTR written earlier, STS RDY), terminals hold what was
+//    written, no CS overlap, no reconfiguration with a CS low, and
+//    reconfigurations = setting changes between consecutive frames. With
+//    reconfiguration switched off in the model, frames do go wrong.
+// 2. Saturated throughput: one device, then all four with reconfiguration
+//    on change only, and on every frame.
+// 3. Arbitration: round robin shares, a saturated high-priority device
+//    starving the rest, latency of a periodic high-priority device.
+// Exits non-zero on a failed check.
+
+#include "spi_bus.h"
+#include "stats_model.h"
+#include "stats_regs.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PCLK_HZ    54000000u
+#define LOOP_NS    2000u
+#define RECONF_NS  1000u
+#define NDEV       4
+#define EXPECT     64u
+#define NEVER      (~0ull)
+
+typedef struct {
+  StatsModel m;
+  uint8_t    cpol, cpha, lsbFirst;   // how the device is wired
+  uint32_t   maxHz;                  // what it really takes
+  uint32_t   skewed;                 // frames clocked with the wrong settings
+
+  // driver side: what each queued frame should read back
+  struct { uint8_t reg, val; uint64_t at; } exp[EXPECT];
+  uint32_t   eHead, eTail;
+  uint8_t    attr;
+  char       sent[STATS_MODEL_TERM];
+  uint32_t   sentLen;
+  uint32_t   done, wrong;
+  uint64_t   maxLatNs;
+} Dev;
+
+static Dev      devs[NDEV];
+static SpiBus   bus;
+static uint64_t now, timerAt, xferAt;
+static uint8_t  xferBuf[SPI_BUS_FRAME], *xferRx;
+static uint32_t xferLen;
+static int      bad;
+
+// SPI2 as the model sees it
+static uint8_t  busCpol, busCpha, busLsb;
+static uint32_t busHz = PCLK_HZ / 256u;
+static int      selected = -1, nLow;
+static int      reconfEvery, ignoreConfigure, configuredNow;
+static uint32_t csOverlap, reconfWithCs, reconfCharged, keyChanges;
+static int      lastKey = -1;
+
+static uint32_t rng = 88172645u;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static void check(int ok, const char *what)
+{
+  if (!ok) { printf("FAIL: %s\n", what); bad++; }
+}
+
+//------------------------------------------------------------------------------
+// SpiBusOps in virtual time
+//------------------------------------------------------------------------------
+static void advanceAll(void)
+{
+  for (int i = 0; i < NDEV; i++) stats_model_advance(&devs[i].m, now);
+}
+
+static void busConfigure(const SpiDevCfg *cfg, uint32_t br)
+{
+  if (nLow) reconfWithCs++;
+  if (ignoreConfigure) return;
+  busCpol = cfg->cpol;
+  busCpha = cfg->cpha;
+  busLsb  = cfg->lsbFirst;
+  busHz   = PCLK_HZ / (2u << br);
+  now += RECONF_NS;
+  reconfCharged++;
+  configuredNow = 1;
+}
+
+static void busCs(const SpiDevCfg *cfg, int level)
+{
+  int i = cfg->csPin;
+
+  advanceAll();
+  if (level == 0) {
+    if (reconfEvery && !configuredNow) {         // baseline: CR1 rewritten per frame
+      now += RECONF_NS;
+      reconfCharged++;
+    }
+    if (nLow) csOverlap++;
+    nLow++;
+    selected = i;
+
+    const Dev *d = &devs[i];
+    int key = d->cpol | d->cpha << 1 | d->lsbFirst << 2 | (int)(bus.dev[i].br << 3);
+    if (lastKey >= 0 && key != lastKey) keyChanges++;
+    lastKey = key;
+  } else if (devs[i].m.cs == 0) {
+    nLow--;
+    selected = -1;
+    configuredNow = 0;
+  }
+  stats_model_cs(&devs[i].m, level);
+}
+
+static uint32_t shortDelays;
+
+static void busDelay(uint32_t us)
+{
+  if (us < SPI_BUS_MIN_TIMER_US) shortDelays++;
+  timerAt = now + us * 1000ull;
+}
+
+static void busXfer(const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+  uint8_t mosi[8 * SPI_BUS_FRAME], seen[8 * SPI_BUS_FRAME], miso[8 * SPI_BUS_FRAME];
+  uint32_t nb = 8u * len;
+  uint64_t bitNs = 1000000000ull / busHz;
+
+  xferRx = rx;
+  xferLen = len;
+  xferAt = now + nb * bitNs;
+  memset(xferBuf, 0, sizeof(xferBuf));
+  if (selected < 0 || nLow != 1) return;
+
+  Dev *d = &devs[selected];
+  int late = d->cpol != busCpol || d->cpha != busCpha || busHz > d->maxHz;
+  if (late || d->lsbFirst != busLsb) d->skewed++;
+
+  for (uint32_t j = 0; j < nb; j++) {
+    uint32_t k = j & 7u;
+    mosi[j] = (tx[j >> 3] >> (busLsb ? k : 7u - k)) & 1u;
+  }
+  for (uint32_t j = 0; j < nb; j++) seen[j] = late ? (j ? mosi[j - 1] : 0) : mosi[j];
+
+  // The device puts its bytes together in its own bit order; the model
+  // itself takes them LSB first
+  uint64_t t = now;
+  for (uint32_t i = 0; i < len; i++) {
+    uint8_t in = 0, out = 0;
+    for (uint32_t k = 0; k < 8; k++) in |= (uint8_t)(seen[8 * i + k] << (d->lsbFirst ? k : 7u - k));
+    for (uint32_t k = 0; k < 8; k++) {
+      out |= (uint8_t)(stats_model_sck(&d->m, (in >> k) & 1u) << k);
+      t += bitNs;
+      stats_model_advance(&d->m, t);
+    }
+    for (uint32_t k = 0; k < 8; k++) miso[8 * i + k] = (out >> (d->lsbFirst ? k : 7u - k)) & 1u;
+  }
+
+  for (uint32_t j = 0; j < nb; j++) {
+    uint32_t k = j & 7u;
+    uint8_t b = late ? (j + 1 < nb ? miso[j + 1] : 1) : miso[j];
+    xferBuf[j >> 3] |= (uint8_t)(b << (busLsb ? k : 7u - k));
+  }
+}
+
+static void busKick(void) { spi_bus_kick(&bus); }
+
+static const SpiBusOps busOps = { busConfigure, busCs, busDelay, busXfer, busKick };
+
+static void runUntil(uint64_t t)
+{
+  for (;;) {
+    uint64_t next = timerAt < xferAt ? timerAt : xferAt;
+    if (next > t) break;
+    now = next;
+    if (next == xferAt) {
+      xferAt = NEVER;
+      memcpy(xferRx, xferBuf, xferLen);
+      spi_bus_xfer_done(&bus, 1);
+    } else {
+      timerAt = NEVER;
+      spi_bus_timer(&bus);
+    }
+  }
+  if (t > now) now = t;
+  advanceAll();
+}
+
+//------------------------------------------------------------------------------
+// Four STaTS drivers
+//------------------------------------------------------------------------------
+static const SpiDevCfg cfgs[NDEV] = {
+  { NULL, 0, 0, 1, 1,  250000u, 0, 4, 4, 4 },
+  { NULL, 1, 0, 1, 1,  250000u, 0, 4, 4, 4 },
+  { NULL, 2, 0, 0, 0, 1000000u, 0, 2, 2, 2 },
+  { NULL, 3, 1, 1, 1, 4000000u, 0, 2, 2, 2 },
+};
+
+static void setup(const uint8_t prio[NDEV])
+{
+  now = 1000000000ull;
+  timerAt = xferAt = NEVER;
+  selected = -1;
+  nLow = 0;
+  reconfEvery = ignoreConfigure = configuredNow = 0;
+  csOverlap = reconfWithCs = reconfCharged = keyChanges = 0;
+  lastKey = -1;
+  busCpol = busCpha = busLsb = 0;
+  busHz = PCLK_HZ / 256u;
+
+  spi_bus_init(&bus, &busOps, PCLK_HZ);
+  for (int i = 0; i < NDEV; i++) {
+    Dev *d = &devs[i];
+    memset(d, 0, sizeof(*d));
+    stats_model_init(&d->m);
+    stats_model_advance(&d->m, now);
+    d->m.version  = (uint8_t)(0x21 + i);
+    d->m.devid    = (uint8_t)(0x51 + i);
+    d->cpol       = cfgs[i].cpol;
+    d->cpha       = cfgs[i].cpha;
+    d->lsbFirst   = cfgs[i].lsbFirst;
+    d->maxHz      = cfgs[i].maxHz;
+
+    SpiDevCfg c = cfgs[i];
+    c.prio = prio[i];
+    check(spi_bus_add(&bus, &c) == i, "add");
+  }
+}
+
+static void onFrame(const SpiFrame *f, void *ctx)
+{
+  Dev *d = ctx;
+  uint32_t e = d->eTail++ % EXPECT;
+  uint64_t lat = now - d->exp[e].at;
+
+  d->done++;
+  if (lat > d->maxLatNs) d->maxLatNs = lat;
+  if (f->status != SPI_BUS_OK || !(f->rx[0] & STS_RDY) ||
+      (d->exp[e].reg != REG_CTL && f->rx[1] != d->exp[e].val))
+    d->wrong++;
+}
+
+// One random STaTS op; REG_CTL marks a write (nothing to check in rx[1])
+static int submitOne(int i)
+{
+  Dev *d = &devs[i];
+  uint8_t tx[2], reg, val = 0, expReg = REG_CTL, we = 0;
+
+  if (d->eHead - d->eTail >= EXPECT) return 0;
+  switch (xorshift() % 5) {
+  case 0:  reg = REG_VERSION;  expReg = reg; val = d->m.version; break;
+  case 1:  reg = REG_DEVID;    expReg = reg; val = d->m.devid; break;
+  case 2:  reg = REG_TXT_ATTR; expReg = reg; val = d->attr; break;
+  case 3:  reg = REG_TXT_ATTR; we = 1; val = (uint8_t)xorshift(); break;
+  default: reg = REG_CH_BUF;   we = 1; val = (uint8_t)('a' + xorshift() % 26); break;
+  }
+  tx[0] = (uint8_t)(reg << 1 | we);
+  tx[1] = we ? val : 0;
+  if (!spi_bus_submit(&bus, (uint32_t)i, tx, 2, onFrame, d)) return 0;
+
+  uint32_t e = d->eHead++ % EXPECT;
+  d->exp[e].reg = expReg;
+  d->exp[e].val = val;
+  d->exp[e].at  = now;
+  if (we && reg == REG_TXT_ATTR) d->attr = val;
+  if (we && reg == REG_CH_BUF && d->sentLen < STATS_MODEL_TERM) d->sent[d->sentLen++] = (char)val;
+  return 1;
+}
+
+static void step(void)
+{
+  spi_bus_poll(&bus);
+  runUntil(now + LOOP_NS);
+}
+
+static void drain(void)
+{
+  while (!spi_bus_idle(&bus)) step();
+}
+
+// Keep the chosen devices' queues full for ns (then drain() to finish)
+static void saturate(const int on[NDEV], uint64_t ns)
+{
+  uint64_t end = now + ns;
+  while (now < end) {
+    for (int i = 0; i < NDEV; i++) {
+      while (on[i] && spi_bus_pending(&bus, (uint32_t)i) < SPI_BUS_QUEUE && submitOne(i)) {}
+    }
+    step();
+  }
+}
+
+static uint32_t wrongTotal(void)
+{
+  uint32_t w = 0;
+  for (int i = 0; i < NDEV; i++) w += devs[i].wrong;
+  return w;
+}
+
+static void checkDevices(const char *what)
+{
+  char msg[96];
+  for (int i = 0; i < NDEV; i++) {
+    Dev *d = &devs[i];
+    snprintf(msg, sizeof(msg), "%s: device %d reads", what, i);
+    check(d->wrong == 0 && d->eHead == d->eTail, msg);
+    snprintf(msg, sizeof(msg), "%s: device %d terminal", what, i);
+    check(d->m.termLen == d->sentLen && memcmp(d->m.term, d->sent, d->sentLen) == 0, msg);
+    snprintf(msg, sizeof(msg), "%s: device %d wire", what, i);
+    check(d->skewed == 0 && d->m.st.badFrames == 0, msg);
+  }
+  check(csOverlap == 0, "two chip selects low");
+  check(reconfWithCs == 0, "SPI2 reconfigured with a CS low");
+}
+
+//------------------------------------------------------------------------------
+int main(void)
+{
+  static const uint8_t flat[NDEV] = { 0, 0, 0, 0 };
+  static const uint8_t top3[NDEV] = { 0, 0, 0, 1 };
+
+  // 1. Random traffic
+  setup(flat);
+  uint64_t end = now + 2000000000ull;
+  while (now < end) {
+    for (int i = 0; i < NDEV; i++) {
+      if (xorshift() % 2048 == 0) {               // a burst of 1..12 ops
+        for (uint32_t n = 1 + xorshift() % 12; n; n--) submitOne(i);
+      }
+    }
+    step();
+  }
+  drain();
+  checkDevices("random traffic");
+  check(bus.st.reconfigs == keyChanges + 1, "reconfigure only on a settings change");
+  printf("random traffic: %u frames (%u/%u/%u/%u), %u device switches, %u SPI2 reconfigs, "
+         "0 wrong reads\n",
+         bus.st.frames, devs[0].done, devs[1].done, devs[2].done, devs[3].done,
+         bus.st.switches, bus.st.reconfigs);
+
+  setup(flat);
+  ignoreConfigure = 1;
+  saturate((const int[NDEV]){ 1, 1, 1, 1 }, 20000000ull);
+  drain();
+  check(wrongTotal() > 0, "wrong settings go unnoticed by the model");
+  printf("SPI2 left in its reset settings: %u of %u frames read back wrong\n",
+         wrongTotal(), bus.st.frames);
+
+  // 2. Saturated throughput
+  setup(flat);
+  saturate((const int[NDEV]){ 1, 0, 0, 0 }, 1000000000ull);
+  drain();
+  checkDevices("one device");
+  printf("\nsaturated, 1 s:\n  device 0 alone:          %6u frames/s\n", bus.st.frames);
+
+  for (int every = 0; every < 2; every++) {
+    setup(flat);
+    reconfEvery = every;
+    saturate((const int[NDEV]){ 1, 1, 1, 1 }, 1000000000ull);
+    drain();
+    checkDevices(every ? "reconfigure always" : "reconfigure on change");
+    printf("  4 devices, %s %6u frames/s (%u/%u/%u/%u), %u reconfigs/s, %.2f%% of the "
+           "time reprogramming SPI2\n",
+           every ? "every frame:" : "on change:  ", bus.st.frames,
+           devs[0].done, devs[1].done, devs[2].done, devs[3].done, reconfCharged,
+           100.0 * reconfCharged * RECONF_NS / 1e9);
+  }
+
+  // 3. Arbitration
+  setup(flat);
+  saturate((const int[NDEV]){ 1, 1, 1, 1 }, 200000000ull);
+  drain();
+  uint32_t lo = devs[0].done, hi = devs[0].done;
+  for (int i = 1; i < NDEV; i++) {
+    if (devs[i].done < lo) lo = devs[i].done;
+    if (devs[i].done > hi) hi = devs[i].done;
+  }
+  check(hi - lo <= 1, "round robin shares");
+  printf("\nround robin, all saturated: frames %u/%u/%u/%u\n",
+         devs[0].done, devs[1].done, devs[2].done, devs[3].done);
+
+  setup(top3);
+  saturate((const int[NDEV]){ 1, 1, 1, 1 }, 200000000ull);
+  uint32_t f[NDEV];
+  for (int i = 0; i < NDEV; i++) f[i] = bus.dev[i].frames;
+  drain();
+  checkDevices("priority");
+  check(f[0] + f[1] + f[2] <= 1, "priority device served first");
+  printf("device 3 at priority 1, all saturated: frames %u/%u/%u/%u (the rest starve)\n",
+         f[0], f[1], f[2], f[3]);
+
+  for (int p = 0; p < 2; p++) {
+    setup(p ? top3 : flat);
+    uint64_t stop = now + 1000000000ull, next = now;
+    while (now < stop) {
+      for (int i = 0; i < 3; i++) {
+        while (spi_bus_pending(&bus, (uint32_t)i) < SPI_BUS_QUEUE && submitOne(i)) {}
+      }
+      if (now >= next) {                         // device 3: one op per ms
+        submitOne(3);
+        next += 1000000ull;
+      }
+      step();
+    }
+    drain();
+    checkDevices("periodic");
+    printf("device 3 one op/ms at priority %d, rest saturated: %u ops, worst latency %.0f us\n",
+           p, devs[3].done, devs[3].maxLatNs / 1e3);
+  }
+
+  check(shortDelays == 0, "CS delay shorter than TIM7 can time");
+  printf("%s\n", bad ? "FAILED" : "all checks passed");
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,466 @@
+// stats_cache_host.c  (host checks for Lab03/src/stats_cache.c)
+//
+//   gcc -O2 -DHOST_BUILD -ILab03/src -o stats_cache_host
+//       host/stats_cache_host.c Lab03/src/stats_cache.c Lab03/src/stats_txn.c
+//       Lab03/src/spi_bus.c
+//
+// The cache on the real transaction engine (stats_txn on spi_bus), against a simulated STaTS in
+// virtual time (same port model as stats_txn_host.c). The device keeps the
+// parts of the register map the cache cares about: VERSION fixed, DEVID
+// writable after CTL_ULKDID, DIG and CH_BUF fed from outside, LGT_ON
+// toggled and TRDY set/cleared by CTL and TMP_HI as on the board.
+//
+// 1. Coherency rules, one at a time: VERSION survives CTL writes, DEVID
+//    drops as soon as a CTL write is queued, ops queued before a CTL write
+//    are not recorded, STS expires, CH_BUF / TMP_HI / register writes drop
+//    what they make stale.
+// 2. Soak: random traffic with failing transfers while the device changes
+//    on its own. Every cache hit is checked against the device: a stale
+//    value is only allowed when the device changed that register by itself
+//    within its max age (plus the time an op can wait to be polled).
+// 3. Transactions per task4 poll cycle, old (STS, DIG, STS reads) vs
+//    cached (one DIG read), with CH_BUF popped every 25 ms meanwhile.
+// Exits non-zero on a failed check.
+
+#include "stats_cache.h"
+#include "stats_regs.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SCK_HZ    (54000000u / 256u)
+#define LOOP_NS   2000u
+#define NEVER     (~0ull)
+#define SLACK_US  5000u          // op on the wire -> seen by stats_txn_poll, worst case
+
+static SpiBus     bus;
+static StatsTxn   tx;
+static StatsCache cache;
+static uint64_t now, timerAt = NEVER, xferAt = NEVER;
+static uint32_t failEvery;
+static uint32_t rng = 88172645u;
+static int      bad;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static void fault(const char *what)
+{
+  if (bad++ < 8) printf("t=%llu us: %s\n", (unsigned long long)(now / 1000u), what);
+}
+
+static uint64_t nowUs(void) { return now / 1000u; }
+
+//------------------------------------------------------------------------------
+// Simulated STaTS
+//------------------------------------------------------------------------------
+static struct {
+  uint8_t  ver, devid, dig, unlocked;
+  uint8_t  lgt, tbusy, trdy, chbov;
+  uint8_t  fifo[16];
+  uint32_t fifoHead, fifoTail;
+  uint64_t tempDoneAt;
+  uint64_t extAt[16];       // last change made by the outside world, us
+} dev;
+
+static uint8_t devSts(void)
+{
+  uint32_t n = dev.fifoHead - dev.fifoTail;
+  uint8_t nchbf = (uint8_t)(n > 3 ? 3 : n);
+  return (uint8_t)(STS_RDY | (dev.dig ? STS_DIG : 0) | (dev.lgt ? STS_LGT_ON : 0) |
+                   (dev.tbusy ? STS_TBUSY : 0) | (dev.trdy ? STS_TRDY : 0) |
+                   (nchbf << 5) | (dev.chbov ? STS_CHBOV : 0));
+}
+
+// Things that happen to the device without the driver asking
+static void devSetDig(uint8_t v)
+{
+  if (v == dev.dig) return;
+  dev.dig = v;
+  dev.extAt[REG_DIG] = dev.extAt[REG_STS] = nowUs();
+}
+
+static void devRxChar(uint8_t c)
+{
+  if (dev.fifoHead - dev.fifoTail == 16) dev.chbov = 1;
+  else dev.fifo[dev.fifoHead++ & 15u] = c;
+  dev.extAt[REG_STS] = nowUs();
+}
+
+static void devTick(void)
+{
+  if (dev.tbusy && now >= dev.tempDoneAt) {
+    dev.tbusy = 0;
+    dev.trdy = 1;
+    dev.extAt[REG_STS] = nowUs();
+  }
+}
+
+static uint8_t devAccess(uint8_t we, uint8_t reg, uint8_t din)
+{
+  uint8_t out = 0;
+  devTick();
+  switch (reg) {
+  case REG_VERSION: out = dev.ver; break;
+  case REG_DEVID:
+    out = dev.devid;
+    if (we && dev.unlocked) { dev.devid = din; dev.unlocked = 0; }
+    break;
+  case REG_DIG:
+    out = dev.dig;
+    if (we) dev.dig = din;
+    break;
+  case REG_STS: out = devSts(); break;
+  case REG_TMP_LO: out = 0x34; break;
+  case REG_TMP_HI: out = 0x07; dev.trdy = 0; break;
+  case REG_CH_BUF:
+    if (!we) {
+      out = dev.fifoHead != dev.fifoTail ? dev.fifo[dev.fifoTail++ & 15u] : 0;
+      dev.chbov = 0;
+    }
+    break;
+  case REG_CTL:
+    if (!we) break;
+    if (din & CTL_RST)     { dev.lgt = 0; dev.trdy = 0; dev.tbusy = 0; dev.fifoTail = dev.fifoHead; dev.chbov = 0; }
+    if (din & CTL_RDTMP)   { dev.tbusy = 1; dev.trdy = 0; dev.tempDoneAt = now + 3000000ull; }
+    if (din & CTL_CHBCLR)  { dev.fifoTail = dev.fifoHead; dev.chbov = 0; }
+    if (din & CTL_LGT_TGL) dev.lgt ^= 1u;
+    if (din & CTL_ULKDID)  dev.unlocked = 1;
+    break;
+  default: break;
+  }
+  return out;
+}
+
+static uint8_t devTruth(uint8_t reg)
+{
+  devTick();
+  switch (reg) {
+  case REG_VERSION: return dev.ver;
+  case REG_DEVID:   return dev.devid;
+  case REG_DIG:     return dev.dig;
+  case REG_STS:     return devSts();
+  default:          return 0;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Port model: CS and timing are checked in stats_txn_host.c; here the
+// transfer just happens on time
+//------------------------------------------------------------------------------
+static const uint8_t *xTx;
+static uint8_t *xRx;
+static int xFail;
+
+static void simConfigure(const SpiDevCfg *cfg, uint32_t br) { (void)cfg; (void)br; }
+
+static void simCs(const SpiDevCfg *cfg, int level) { (void)cfg; (void)level; }
+
+static void simDelay(uint32_t us) { timerAt = now + us * 1000ull; }
+
+static void simXfer(const uint8_t *t, uint8_t *r, uint32_t len)
+{
+  (void)len;
+  xTx = t;
+  xRx = r;
+  xFail = failEvery && xorshift() % failEvery == 0;
+  xferAt = now + 16ull * 1000000000ull / SCK_HZ;
+}
+
+static void simKick(void) { spi_bus_kick(&bus); }
+
+static const SpiBusOps simOps = { simConfigure, simCs, simDelay, simXfer, simKick };
+
+static uint32_t wireOps[16];
+
+static void xferEvent(void)
+{
+  xferAt = NEVER;
+  if (xFail) { spi_bus_xfer_done(&bus, 0); return; }
+  uint8_t we = xTx[0] & 1u, reg = (uint8_t)(xTx[0] >> 1);
+  xRx[0] = devSts();
+  xRx[1] = devAccess(we, reg, xTx[1]);
+  wireOps[reg]++;
+  spi_bus_xfer_done(&bus, 1);
+}
+
+static void runUntil(uint64_t t)
+{
+  for (;;) {
+    uint64_t next = timerAt < xferAt ? timerAt : xferAt;
+    if (next > t) break;
+    now = next;
+    if (next == xferAt) xferEvent();
+    else { timerAt = NEVER; spi_bus_timer(&bus); }
+  }
+  now = t;
+}
+
+static void step(void)
+{
+  stats_txn_poll(&tx);
+  runUntil(now + LOOP_NS);
+}
+
+static void drain(void)
+{
+  while (!stats_txn_idle(&tx)) step();
+}
+
+static void reset(uint32_t failOneIn)
+{
+  memset(&dev, 0, sizeof(dev));
+  memset(wireOps, 0, sizeof(wireOps));
+  dev.ver = 0x23;
+  dev.devid = 0x11;
+  now = 1000000000ull;
+  timerAt = xferAt = NEVER;
+  failEvery = failOneIn;
+  spi_bus_init(&bus, &simOps, 54000000u);
+  stats_txn_init(&tx, &bus, NULL, 0, SCK_HZ);
+  stats_cache_init(&cache, &tx, nowUs);
+}
+
+static int hit(uint8_t reg, uint8_t *v)
+{
+  uint8_t dummy;
+  return stats_cache_get(&cache, reg, v ? v : &dummy);
+}
+
+//------------------------------------------------------------------------------
+// 1. Rules
+//------------------------------------------------------------------------------
+static int firstDigSeenCached;
+
+static void onFirstDig(const StatsOp *op, void *ctx)
+{
+  (void)op; (void)ctx;
+  firstDigSeenCached = hit(REG_DIG, NULL);
+}
+
+static void checkRules(void)
+{
+  uint8_t v;
+  reset(0);
+
+  // VERSION: one bus read, then static through CTL writes
+  stats_cache_read(&cache, REG_VERSION, NULL, NULL);
+  drain();
+  stats_cache_write(&cache, REG_CTL, CTL_LGT_TGL, NULL, NULL);
+  drain();
+  if (!hit(REG_VERSION, &v) || v != 0x23) fault("VERSION not cached across CTL");
+  if (wireOps[REG_VERSION] != 1) fault("VERSION read twice");
+
+  // DEVID: static, but gone the moment a CTL write is queued
+  stats_cache_read(&cache, REG_DEVID, NULL, NULL);
+  drain();
+  if (!hit(REG_DEVID, &v) || v != 0x11) fault("DEVID not cached");
+  stats_cache_write(&cache, REG_CTL, CTL_ULKDID, NULL, NULL);
+  if (hit(REG_DEVID, NULL)) fault("DEVID still cached with a CTL write queued");
+  stats_cache_write(&cache, REG_DEVID, 0x42, NULL, NULL);
+  stats_cache_read(&cache, REG_DEVID, NULL, NULL);
+  drain();
+  if (!hit(REG_DEVID, &v) || v != 0x42) fault("DEVID not 0x42 after set + read back");
+
+  // A plain DEVID write drops DEVID
+  stats_cache_write(&cache, REG_DEVID, 0x55, NULL, NULL);
+  if (hit(REG_DEVID, NULL)) fault("DEVID cached after a DEVID write");
+  drain();
+
+  // Ops queued ahead of a CTL write are not recorded; the ones after are
+  stats_cache_read(&cache, REG_DIG, onFirstDig, NULL);
+  stats_cache_write(&cache, REG_CTL, CTL_LGT_TGL, NULL, NULL);
+  stats_cache_read(&cache, REG_DIG, NULL, NULL);
+  drain();
+  if (firstDigSeenCached) fault("DIG recorded while a CTL write was pending");
+  if (!hit(REG_STS, &v) || v != devTruth(REG_STS)) fault("STS after CTL not recorded");
+
+  // STS comes free with any transfer and ages out
+  stats_cache_invalidate(&cache);
+  stats_cache_read(&cache, REG_VERSION, NULL, NULL);
+  drain();
+  if (!hit(REG_STS, &v) || v != devTruth(REG_STS)) fault("STS not taken from a VERSION read");
+  runUntil(now + (STATS_STS_MAX_AGE_US - 1000u) * 1000ull);
+  if (!hit(REG_STS, NULL)) fault("STS expired early");
+  runUntil(now + 2000000ull);
+  if (hit(REG_STS, NULL)) fault("STS older than its max age");
+
+  // CH_BUF pops and TMP_HI reads change STS: they drop it
+  devRxChar('a');
+  stats_cache_read(&cache, REG_VERSION, NULL, NULL);
+  stats_cache_read(&cache, REG_CH_BUF, NULL, NULL);
+  drain();
+  if (hit(REG_STS, NULL)) fault("STS cached after a CH_BUF pop");
+  stats_cache_read(&cache, REG_VERSION, NULL, NULL);
+  stats_cache_read(&cache, REG_TMP_HI, NULL, NULL);
+  drain();
+  if (hit(REG_STS, NULL)) fault("STS cached after a TMP_HI read");
+
+  // Failed transfers record nothing
+  stats_cache_invalidate(&cache);
+  failEvery = 1;
+  stats_cache_read(&cache, REG_VERSION, NULL, NULL);
+  drain();
+  failEvery = 0;
+  if (hit(REG_VERSION, NULL) || hit(REG_STS, NULL)) fault("failed transfer recorded");
+}
+
+//------------------------------------------------------------------------------
+// 2. Soak
+//------------------------------------------------------------------------------
+static void checkHit(uint8_t reg)
+{
+  uint8_t v;
+  if (!stats_cache_get(&cache, reg, &v) || v == devTruth(reg)) return;
+
+  uint32_t age = cache.maxAge[reg];
+  if (age == STATS_AGE_STATIC || nowUs() - dev.extAt[reg] > age + SLACK_US) {
+    char msg[64];
+    snprintf(msg, sizeof(msg), "stale hit on reg %u: 0x%02X, device 0x%02X", reg, v, devTruth(reg));
+    fault(msg);
+  }
+}
+
+static void soak(void)
+{
+  static const uint8_t regs[] = { REG_STS, REG_DIG, REG_VERSION, REG_DEVID, REG_CH_BUF,
+                                  REG_TMP_LO, REG_TMP_HI, REG_TXT_ATTR };
+  static const uint8_t ctl[] = { CTL_LGT_TGL, CTL_RDTMP, CTL_TRMCLR, CTL_CHBCLR, CTL_ULKDID, CTL_RST };
+  uint32_t hits = 0;
+
+  reset(29);
+  for (uint32_t pass = 0; pass < 3000000u; pass++) {
+    uint32_t r = xorshift();
+    if (r % 5000u == 0) devSetDig((uint8_t)xorshift());
+    if (r % 3000u == 1) devRxChar((uint8_t)('a' + xorshift() % 26u));
+
+    if (r % 300u == 2) {
+      uint32_t n = 1 + xorshift() % 6u;
+      while (n--) {
+        uint32_t k = xorshift();
+        int ok;
+        if (k % 8u == 0)      ok = stats_cache_write(&cache, REG_CTL, ctl[(k >> 8) % 6u], NULL, NULL);
+        else if (k % 8u == 1) ok = stats_cache_write(&cache, (k >> 8) & 1u ? REG_DEVID : REG_CH_BUF, (uint8_t)(k >> 16), NULL, NULL);
+        else                  ok = stats_cache_read(&cache, regs[(k >> 8) % 8u], NULL, NULL);
+        if (!ok) break;
+      }
+    }
+
+    for (uint32_t i = 0; i < 4; i++) {
+      uint8_t reg = regs[i];
+      uint32_t h0 = cache.st.hits;
+      checkHit(reg);
+      hits += cache.st.hits - h0;
+    }
+    step();
+  }
+  drain();
+  printf("soak: %u transactions (%u failed), %u hits checked, %u misses, STS free from %u, %u CTL invalidations\n",
+         tx.st.ops, tx.st.errors, hits, cache.st.misses, cache.st.stsFree, cache.st.invalidations);
+  if (hits == 0 || tx.st.errors == 0) fault("soak exercised nothing");
+}
+
+//------------------------------------------------------------------------------
+// 3. task4 poll cycle, old vs cached
+//------------------------------------------------------------------------------
+#define POLL_US   80000u
+#define RX_US     25000u
+#define DPX_MASK  (1u << 2)
+
+static uint32_t cycles, cycleTxns, toggles;
+static int16_t  oldDig = -1;
+
+static void toggleIf(uint8_t dig, uint8_t sts)
+{
+  if (!!(dig & DPX_MASK) != !!(sts & STS_LGT_ON) &&
+      stats_cache_write(&cache, REG_CTL, CTL_LGT_TGL, NULL, NULL)) {
+    cycleTxns++;
+    toggles++;
+  }
+}
+
+// Before: STS poll, then DIG + STS for the mirror
+static void onOldDig(const StatsOp *op, void *ctx) { (void)ctx; oldDig = op->status ? -1 : op->data; }
+
+static void onOldSts(const StatsOp *op, void *ctx)
+{
+  (void)ctx;
+  if (oldDig >= 0 && op->status == STATS_TXN_OK) toggleIf((uint8_t)oldDig, op->data);
+}
+
+static void oldCycle(void)
+{
+  cycleTxns += (uint32_t)stats_txn_read(&tx, REG_STS, NULL, NULL);
+  if (stats_txn_read(&tx, REG_DIG, onOldDig, NULL)) {
+    cycleTxns++;
+    cycleTxns += (uint32_t)stats_txn_read(&tx, REG_STS, onOldSts, NULL);
+  }
+}
+
+// After: task4's stats_poll_cycle()
+static void onNewDig(const StatsOp *op, void *ctx)
+{
+  (void)ctx;
+  if (op->status == STATS_TXN_OK) toggleIf(op->data, op->sts);
+}
+
+static void newCycle(void)
+{
+  uint8_t dig, sts;
+  if (stats_cache_get(&cache, REG_DIG, &dig) && stats_cache_get(&cache, REG_STS, &sts)) toggleIf(dig, sts);
+  else cycleTxns += (uint32_t)stats_cache_read(&cache, REG_DIG, onNewDig, NULL);
+}
+
+static uint8_t rxBusy;
+static uint64_t nextRx;
+
+static void onRx(const StatsOp *op, void *ctx)
+{
+  (void)ctx;
+  rxBusy = 0;
+  nextRx = nowUs() + (op->status == STATS_TXN_OK && op->data ? 1000u : RX_US);
+}
+
+static void cycleRun(int cached, const char *name)
+{
+  reset(0);
+  cycles = cycleTxns = toggles = 0;
+  rxBusy = 0;
+  nextRx = 0;
+  uint64_t nextPoll = 0, end = now + 60000000000ull;
+  while (now < end) {
+    uint32_t r = xorshift();
+    if (r % 250000u == 0) devSetDig((uint8_t)xorshift());
+    if (r % 20000u == 1) devRxChar('x');
+
+    stats_txn_poll(&tx);
+    if (nowUs() >= nextPoll) {
+      cycles++;
+      if (cached) newCycle(); else oldCycle();
+      nextPoll = nowUs() + POLL_US;
+    }
+    if (!rxBusy && nowUs() >= nextRx) rxBusy = (uint8_t)stats_txn_read(&tx, REG_CH_BUF, onRx, NULL);
+    runUntil(now + LOOP_NS);
+  }
+  drain();
+  uint8_t dig = devTruth(REG_DIG);
+  if (!!(dig & DPX_MASK) != dev.lgt) fault("LD3 mirror out of step at the end");
+  printf("%-7s 60 s: %u poll cycles, %.2f txn/cycle (%u toggles), %u txn total (STS %u, DIG %u, CH_BUF %u)\n",
+         name, cycles, (double)cycleTxns / cycles, toggles, tx.st.ops,
+         wireOps[REG_STS], wireOps[REG_DIG], wireOps[REG_CH_BUF]);
+}
+
+int main(void)
+{
+  checkRules();
+  soak();
+  cycleRun(0, "old:");
+  cycleRun(1, "cached:");
+
+  printf("%s\n", bad ? "FAILED" : "all checks passed");
+  return bad ? 1 : 0;
+}
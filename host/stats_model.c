@@ -0,0 +1,329 @@
+// stats_model.c  (host model of the STaTS board, for Lab03 driver tests)
+//
+// See stats_model.h.
+
+#include "stats_model.h"
+#include "stats_regs.h"
+#include <string.h>
+
+// Datasheet register addresses (task4's REG_* are these, bit-reversed)
+enum { A_CTL, A_STS, A_DIG, A_TMP_AVG, A_TMP_LO, A_TMP_HI, A_CH_BUF, A_TXT_ATTR, A_VERSION, A_DEVID };
+
+static StatsSim *sim;      // the one SpiBusOps instance
+
+//------------------------------------------------------------------------------
+// Device
+//------------------------------------------------------------------------------
+void stats_model_init(StatsModel *m)
+{
+  memset(m, 0, sizeof(*m));
+  m->version = 0x23;
+  m->devid   = 0x11;
+  m->tempRaw = 0x734;
+  m->tconvUs = STATS_MODEL_TCONV_US;
+  m->cs      = 1;
+}
+
+static uint32_t fifoLevel(const StatsModel *m) { return m->fHead - m->fTail; }
+
+void stats_model_advance(StatsModel *m, uint64_t nowNs)
+{
+  if (nowNs <= m->now) return;
+  m->now = nowNs;
+  if (m->tbusy && m->now >= m->tDone) {
+    m->tbusy = 0;
+    m->trdy  = 1;
+    m->tmp   = m->tempRaw & 0x0FFFu;
+    m->hist[m->nHist++ & 7u] = m->tmp;
+    m->st.conversions++;
+  }
+}
+
+uint8_t stats_model_sts(const StatsModel *m)
+{
+  uint32_t n = fifoLevel(m);
+  return (uint8_t)((m->now >= m->rdyAt ? STS_RDY : 0) |
+                   (m->dig   ? STS_DIG    : 0) |
+                   (m->lgt   ? STS_LGT_ON : 0) |
+                   (m->tbusy ? STS_TBUSY  : 0) |
+                   (m->trdy  ? STS_TRDY   : 0) |
+                   ((n > 3 ? 3u : n) << 5) |
+                   (m->chbov ? STS_CHBOV  : 0));
+}
+
+static uint8_t tmpAvg(const StatsModel *m)
+{
+  uint32_t n = m->nHist < 8 ? m->nHist : 8, sum = 0;
+  for (uint32_t i = 0; i < n; i++) sum += m->hist[i];
+  return n ? (uint8_t)((sum / n) >> 4) : 0;
+}
+
+static uint8_t regValue(const StatsModel *m, uint8_t a)
+{
+  switch (a) {
+  case A_CTL:      return 0;
+  case A_STS:      return stats_model_sts(m);
+  case A_DIG:      return m->dig;
+  case A_TMP_AVG:  return tmpAvg(m);
+  case A_TMP_LO:   return (uint8_t)m->tmp;
+  case A_TMP_HI:   return (uint8_t)(m->tmp >> 8);
+  case A_CH_BUF:   return fifoLevel(m) ? m->fifo[m->fTail % STATS_MODEL_FIFO] : 0;
+  case A_TXT_ATTR: return m->attr;
+  case A_VERSION:  return m->version;
+  case A_DEVID:    return m->devid;
+  default:         return 0;
+  }
+}
+
+static void termPut(StatsModel *m, uint8_t c)
+{
+  if (m->termLen < STATS_MODEL_TERM) m->term[m->termLen++] = (char)c;
+}
+
+static void control(StatsModel *m, uint8_t v)
+{
+  if (v & CTL_RST) {
+    m->lgt = m->tbusy = m->trdy = m->chbov = 0;
+    m->attr = 0;
+    m->fTail = m->fHead;
+    m->termLen = 0;
+    m->rdyAt = m->now + STATS_MODEL_RST_US * 1000ull;
+    return;
+  }
+  if (v & CTL_RDTMP) {
+    m->tbusy = 1;
+    m->trdy  = 0;
+    m->tDone = m->now + m->tconvUs * 1000ull;
+  }
+  if (v & (CTL_TRMCLR | CTL_TRMRST)) m->termLen = 0;
+  if (v & CTL_TRMRST)                m->attr = 0;
+  if (v & CTL_CHBCLR)  { m->fTail = m->fHead; m->chbov = 0; }
+  if (v & CTL_LGT_TGL) m->lgt ^= 1u;
+  if (v & CTL_ULKDID)  m->unlocked = 2;     // survives this frame's end
+}
+
+// A complete frame: writes and read side effects land here
+static void commit(StatsModel *m)
+{
+  uint8_t a = m->addr, v = m->in[1];
+
+  m->st.frames++;
+  if (m->we) m->st.writes[a]++;
+  else       m->st.reads[a]++;
+
+  if (m->we) {
+    switch (a) {
+    case A_CTL:      control(m, v); break;
+    case A_CH_BUF:   termPut(m, v); break;
+    case A_TXT_ATTR: m->attr = v; break;
+    case A_DEVID:    if (m->unlocked) m->devid = v; break;
+    default:         break;                 // read-only
+    }
+  } else if (a == A_CH_BUF && m->popping) {
+    m->fTail++;
+    m->chbov = 0;
+    m->st.pops++;
+  } else if (a == A_TMP_HI) {
+    m->trdy = 0;
+  }
+  if (m->unlocked) m->unlocked--;
+}
+
+void stats_model_cs(StatsModel *m, int level)
+{
+  if (level == m->cs) return;
+  m->cs = level;
+  if (level == 0) {
+    m->bits = 0;
+    m->in[0] = m->in[1] = 0;
+    m->out[0] = stats_model_sts(m);         // STS goes out during the header
+    m->out[1] = 0;
+  } else if (m->bits == 16) {
+    commit(m);
+  } else {
+    m->st.badFrames++;
+  }
+}
+
+int stats_model_sck(StatsModel *m, int mosi)
+{
+  if (m->cs || m->bits >= 16) return 1;     // MISO idles high
+
+  uint32_t byte = m->bits >> 3, bit = m->bits & 7u;
+  int miso = (m->out[byte] >> bit) & 1;
+  if (mosi) m->in[byte] |= (uint8_t)(1u << bit);
+
+  if (++m->bits == 8) {
+    uint8_t h = m->in[0];
+    m->we   = h & 1u;
+    m->addr = (uint8_t)(((h >> 1) & 1u) << 3 | ((h >> 2) & 1u) << 2 |
+                        ((h >> 3) & 1u) << 1 | ((h >> 4) & 1u));
+    m->out[1] = regValue(m, m->addr);       // read value / previous value
+    m->popping = !m->we && m->addr == A_CH_BUF && fifoLevel(m);
+  }
+  return miso;
+}
+
+void stats_model_key(StatsModel *m, uint8_t c)
+{
+  m->st.keys++;
+  if (fifoLevel(m) == STATS_MODEL_FIFO) {
+    m->chbov = 1;
+    m->st.overflows++;
+    return;
+  }
+  m->fifo[m->fHead++ % STATS_MODEL_FIFO] = c;
+}
+
+void stats_model_set_dig(StatsModel *m, uint8_t dp)      { m->dig = dp; }
+void stats_model_set_temp(StatsModel *m, uint16_t raw12) { m->tempRaw = raw12 & 0x0FFFu; }
+
+//------------------------------------------------------------------------------
+// Wire: a master shifting bytes through the model
+//------------------------------------------------------------------------------
+static void wireAt(void *ctx, uint64_t nowNs)
+{
+  StatsWire *w = ctx;
+  if (nowNs > w->now) w->now = nowNs;
+  stats_model_advance(w->dev, w->now);
+}
+
+static void wireCs(void *ctx, int level)
+{
+  StatsWire *w = ctx;
+  stats_model_cs(w->dev, level);
+}
+
+static void wireXfer(void *ctx, const uint8_t *tx, uint8_t *rx, uint32_t n)
+{
+  StatsWire *w = ctx;
+  uint64_t bitNs = 1000000000ull / w->sckHz;
+
+  for (uint32_t i = 0; i < n; i++) {
+    uint8_t in = 0;
+    for (uint32_t k = 0; k < 8; k++) {
+      uint32_t b = w->lsbFirst ? k : 7u - k;
+      in |= (uint8_t)(stats_model_sck(w->dev, (tx[i] >> b) & 1u) << b);
+      w->now += bitNs;
+      w->busyNs += bitNs;
+      stats_model_advance(w->dev, w->now);
+    }
+    rx[i] = in;
+  }
+}
+
+void stats_wire_init(StatsWire *w, StatsModel *dev, uint32_t sckHz, int lsbFirst)
+{
+  w->dev = dev;
+  w->sckHz = sckHz;
+  w->lsbFirst = lsbFirst;
+  w->now = dev->now;
+  w->busyNs = 0;
+}
+
+StatsTransport stats_wire_transport(StatsWire *w)
+{
+  StatsTransport t = { wireAt, wireCs, wireXfer, w };
+  return t;
+}
+
+//------------------------------------------------------------------------------
+// Sim: SpiBusOps in virtual time
+//------------------------------------------------------------------------------
+#define NEVER (~0ull)
+
+static uint8_t *xferRx;
+static uint8_t  xferBuf[2];
+static int      xferFail;
+
+// One device, so SPI2's settings are the wire's already
+static void simConfigure(const SpiDevCfg *cfg, uint32_t br) { (void)cfg; (void)br; }
+
+static uint32_t simRand(void)
+{
+  sim->rng ^= sim->rng << 13;
+  sim->rng ^= sim->rng >> 17;
+  sim->rng ^= sim->rng << 5;
+  return sim->rng;
+}
+
+static void simCs(const SpiDevCfg *cfg, int level)
+{
+  (void)cfg;
+  sim->tp.at(sim->tp.ctx, sim->now);
+  sim->tp.cs(sim->tp.ctx, level);
+  if (level == 0) {
+    sim->csFellAt = sim->now;
+  } else if (sim->csFellAt != NEVER) {
+    sim->csLowNs += sim->now - sim->csFellAt;
+    sim->csFellAt = NEVER;
+  }
+}
+
+static void simDelay(uint32_t us) { sim->timerAt = sim->now + us * 1000ull; }
+
+static void simXfer(const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+  (void)len;                               // always 2: stats_txn frames
+  xferRx = rx;
+  xferFail = sim->failEvery && simRand() % sim->failEvery == 0;
+  if (xferFail) {
+    xferBuf[0] = xferBuf[1] = 0;           // DMA error: nothing clocked
+  } else {
+    sim->tp.at(sim->tp.ctx, sim->now);
+    sim->tp.xfer(sim->tp.ctx, tx, xferBuf, 2);
+  }
+  sim->xferAt = sim->now + 16ull * 1000000000ull / sim->sckHz;
+}
+
+static void simKick(void) { spi_bus_kick(&sim->bus); }
+
+static const SpiBusOps simOps = { simConfigure, simCs, simDelay, simXfer, simKick };
+
+void stats_sim_init(StatsSim *s, StatsTransport tp, uint32_t sckHz)
+{
+  sim = s;
+  s->tp = tp;
+  s->sckHz = sckHz;
+  s->now = 1000000000ull;
+  s->timerAt = s->xferAt = NEVER;
+  s->csLowNs = 0;
+  s->csFellAt = NEVER;
+  s->failEvery = 0;
+  s->rng = 2463534242u;
+  spi_bus_init(&s->bus, &simOps, 2u * sckHz);        // SCK = PCLK / 2
+  stats_txn_init(&s->txn, &s->bus, NULL, 0, sckHz);
+}
+
+void stats_sim_run_until(StatsSim *s, uint64_t t)
+{
+  for (;;) {
+    uint64_t next = s->timerAt < s->xferAt ? s->timerAt : s->xferAt;
+    if (next > t) break;
+    s->now = next;
+    if (next == s->xferAt) {
+      s->xferAt = NEVER;
+      xferRx[0] = xferBuf[0];
+      xferRx[1] = xferBuf[1];
+      spi_bus_xfer_done(&s->bus, !xferFail);
+    } else {
+      s->timerAt = NEVER;
+      spi_bus_timer(&s->bus);
+    }
+  }
+  s->now = t;
+  s->tp.at(s->tp.ctx, t);
+}
+
+void stats_sim_step(StatsSim *s, uint32_t loopNs)
+{
+  stats_txn_poll(&s->txn);
+  stats_sim_run_until(s, s->now + loopNs);
+}
+
+void stats_sim_drain(StatsSim *s, uint32_t loopNs)
+{
+  while (!stats_txn_idle(&s->txn)) stats_sim_step(s, loopNs);
+}
+
+uint64_t stats_sim_now_us(void) { return sim->now / 1000u; }
@@ -0,0 +1,137 @@
+// stats_model.h  (host model of the STaTS board, for Lab03 driver tests)
+//
+// Three layers, each usable on its own:
+//
+//   StatsModel   the device, driven bit by bit like the real pins: CS, and
+//                one MOSI bit in / one MISO bit out per SCK. Frames are 2
+//                bytes; the header is bit 0 WE, bits 1-4 the register
+//                address (datasheet numbering, first bit on the wire is its
+//                MSB), so with an LSB-first master the header byte is
+//                (reg << 1) | we in task4's remapped register numbers. STS
+//                is shifted out during the header, the register value (read)
+//                or its previous value (write) during the data byte.
+//   StatsWire    a virtual-time SPI master with a bit order and SCK rate;
+//                its StatsTransport moves bytes through a StatsModel.
+//   StatsSim     SpiBusOps for Lab03/src/spi_bus.c on any StatsTransport,
+//                with the STaTS added to the bus by stats_txn and the CS
+//                delays and transfers as events in virtual time, so the
+//                driver (bus engine, stats_txn, cache, task4-style logic)
+//                runs unchanged on Linux.
+//
+// Device behaviour, as the driver assumes it (STaTS register protocol):
+//   - CH_BUF reads pop the keyboard FIFO (0x00 when empty), writes go to the
+//     terminal. NCHBF1:0 = FIFO level, 3 meaning three or more; CHBOV is set
+//     when a key arrives with the FIFO full and cleared by the next pop or
+//     CTL_CHBCLR.
+//   - CTL_RDTMP starts a conversion: TBUSY for tconvUs, then TMP_LO/HI hold
+//     the 12-bit result and TRDY is set until TMP_HI is read. TMP_AVG is the
+//     mean of the last 8 results, raw >> 4.
+//   - CTL_ULKDID lets the next frame write DEVID; any other frame locks it
+//     again.
+//   - CTL_RST clears everything but VERSION/DEVID and holds RDY low for
+//     STATS_MODEL_RST_US.
+//   - Frames that are not exactly 16 bits do nothing (counted).
+// What the datasheet leaves open (NCHBF scale, TMP_AVG format, timings) is
+// a choice made here, marked in the defines.
+
+#ifndef STATS_MODEL_H
+#define STATS_MODEL_H
+
+#include "stats_txn.h"
+#include <stdint.h>
+
+#define STATS_MODEL_FIFO      16u        // keyboard FIFO depth
+#define STATS_MODEL_TERM      1024u      // terminal bytes kept
+#define STATS_MODEL_TCONV_US  50000u     // default conversion time
+#define STATS_MODEL_RST_US    1000u      // RDY low after CTL_RST
+
+typedef struct {
+  uint32_t frames;           // good 16-bit frames
+  uint32_t badFrames;        // CS high after != 16 bits
+  uint32_t reads[16];        // per datasheet address
+  uint32_t writes[16];
+  uint32_t pops;             // CH_BUF bytes handed to the master
+  uint32_t keys, overflows;  // keys typed, keys lost to a full FIFO
+  uint32_t conversions;
+} StatsModelStats;
+
+typedef struct {
+  // registers and state
+  uint8_t  version, devid, dig, attr;
+  uint8_t  lgt, tbusy, trdy, chbov, unlocked;
+  uint16_t tempRaw;          // what the sensor reads now (12 bits)
+  uint16_t tmp;              // last conversion result
+  uint16_t hist[8];
+  uint32_t nHist;
+  uint32_t tconvUs;
+  uint64_t tDone, rdyAt;     // ns
+  uint8_t  fifo[STATS_MODEL_FIFO];
+  uint32_t fHead, fTail;
+  char     term[STATS_MODEL_TERM];
+  uint32_t termLen;
+  uint64_t now;              // ns, set by stats_model_advance
+
+  // shift register
+  int      cs;               // 1 = deselected
+  uint32_t bits;
+  uint8_t  in[2], out[2];
+  uint8_t  we, addr;
+  uint8_t  popping;          // CH_BUF read that shifted a byte out
+
+  StatsModelStats st;
+} StatsModel;
+
+void    stats_model_init(StatsModel *m);
+void    stats_model_advance(StatsModel *m, uint64_t nowNs);   // never goes back
+void    stats_model_cs(StatsModel *m, int level);
+int     stats_model_sck(StatsModel *m, int mosi);             // returns MISO
+
+// The world outside the SPI pins
+void    stats_model_key(StatsModel *m, uint8_t c);            // typed on the STaTS keyboard
+void    stats_model_set_dig(StatsModel *m, uint8_t dp);
+void    stats_model_set_temp(StatsModel *m, uint16_t raw12);
+uint8_t stats_model_sts(const StatsModel *m);
+
+// What a master needs from the wire: the time (ns, before each bus action),
+// CS, and n bytes full duplex
+typedef struct {
+  void (*at)(void *ctx, uint64_t nowNs);
+  void (*cs)(void *ctx, int level);
+  void (*xfer)(void *ctx, const uint8_t *tx, uint8_t *rx, uint32_t n);
+  void *ctx;
+} StatsTransport;
+
+typedef struct {
+  StatsModel *dev;
+  uint32_t    sckHz;
+  int         lsbFirst;      // task4: 1
+  uint64_t    now;           // ns; xfer advances it by 8 SCK per byte
+  uint64_t    busyNs;        // time spent clocking
+} StatsWire;
+
+void stats_wire_init(StatsWire *w, StatsModel *dev, uint32_t sckHz, int lsbFirst);
+StatsTransport stats_wire_transport(StatsWire *w);
+
+// Virtual-time bus port with stats_txn on it. One instance (SpiBusOps has
+// no context). The transfer happens on the wire when it starts; its result
+// is handed to the engine 16 SCK periods later. A failed transfer clocks
+// nothing, so the device sees a frame with no bits.
+typedef struct {
+  SpiBus         bus;
+  StatsTxn       txn;
+  StatsTransport tp;
+  uint32_t       sckHz;
+  uint64_t       now;        // ns
+  uint64_t       timerAt, xferAt;
+  uint64_t       csLowNs, csFellAt;   // bus utilisation
+  uint32_t       failEvery;  // 0, or fail one transfer in n (DMA error)
+  uint32_t       rng;
+} StatsSim;
+
+void     stats_sim_init(StatsSim *s, StatsTransport tp, uint32_t sckHz);
+void     stats_sim_run_until(StatsSim *s, uint64_t t);  // fire events up to t
+void     stats_sim_step(StatsSim *s, uint32_t loopNs);  // poll, then run loopNs
+void     stats_sim_drain(StatsSim *s, uint32_t loopNs); // step until idle
+uint64_t stats_sim_now_us(void);                        // for stats_cache
+
+#endif // STATS_MODEL_H
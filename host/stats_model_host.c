@@ -0,0 +1,347 @@
+// stats_model_host.c  (checks for host/stats_model.c, and the Lab03 STaTS
+// driver running on it)
+//
+//   gcc -O2 -DHOST_BUILD -ILab03/src -Ihost -o stats_model_host
+//       host/stats_model_host.c host/stats_model.c
+//       Lab03/src/stats_txn.c Lab03/src/stats_cache.c Lab03/src/spi_bus.c
+//
+// 1. Protocol, frame by frame on the wire model: header layout and bit
+//    order, STS during the header, previous value on writes, CH_BUF FIFO
+//    with NCHBF/CHBOV (and a key arriving mid-pop, which must wait for the
+//    next one), conversion timing with TRDY, TMP_AVG, DEVID unlock, reset,
+//    short frames.
+// 2. The driver (stats_txn + stats_cache) on the model through StatsSim,
+//    doing what task4 does: version, DEVID set + read back, temperature
+//    trigger / TRDY / LO+HI, TX to the terminal, RX pops, with failing
+//    transfers thrown in.
+// 3. Throughput and bus utilisation at task4's SCK, back to back and for
+//    the 80 ms poll cycle with and without the cache.
+// Exits non-zero on a failed check.
+
+#include "stats_model.h"
+#include "stats_cache.h"
+#include "stats_regs.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SCK_HZ   (54000000u / 256u)
+#define LOOP_NS  2000u
+
+static int bad;
+
+#define CHECK(c, ...) do { if (!(c)) { if (bad++ < 10) { printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+//------------------------------------------------------------------------------
+// 1. Protocol
+//------------------------------------------------------------------------------
+static StatsModel dev;
+static StatsWire  wire;
+
+static void frame(uint8_t we, uint8_t reg, uint8_t din, uint8_t *sts, uint8_t *data)
+{
+  uint8_t tx[2] = { (uint8_t)((reg << 1) | we), din }, rx[2];
+  StatsTransport tp = stats_wire_transport(&wire);
+  tp.at(tp.ctx, wire.now + 4000);
+  tp.cs(tp.ctx, 0);
+  tp.xfer(tp.ctx, tx, rx, 2);
+  tp.cs(tp.ctx, 1);
+  if (sts)  *sts = rx[0];
+  if (data) *data = rx[1];
+}
+
+static uint8_t rd(uint8_t reg)              { uint8_t d; frame(0, reg, 0, NULL, &d); return d; }
+static uint8_t wr(uint8_t reg, uint8_t v)   { uint8_t d; frame(1, reg, v, NULL, &d); return d; }
+static uint8_t sts(void)                    { uint8_t s; frame(0, REG_VERSION, 0, &s, NULL); return s; }
+static void    wait_us(uint32_t us)         { stats_model_advance(&dev, wire.now += us * 1000ull); }
+
+static void checkProtocol(void)
+{
+  uint8_t s, d;
+  stats_model_init(&dev);
+  stats_wire_init(&wire, &dev, SCK_HZ, 1);
+
+  // Header (reg << 1) | we, LSB first; STS in the header byte
+  frame(0, REG_VERSION, 0, &s, &d);
+  CHECK(d == 0x23 && s == STS_RDY, "VERSION read: sts %02X data %02X", s, d);
+  CHECK(dev.st.reads[8] == 1, "REG_VERSION did not land on address 8");
+  CHECK(rd(REG_DEVID) == 0x11, "DEVID");
+
+  // MSB-first master hits a different register
+  stats_wire_init(&wire, &dev, SCK_HZ, 0);
+  CHECK(rd(REG_VERSION) != 0x23, "MSB-first read still found VERSION");
+  stats_wire_init(&wire, &dev, SCK_HZ, 1);
+
+  // Writes return the previous value; read-only registers ignore writes
+  CHECK(wr(REG_TXT_ATTR, 0x5A) == 0x00 && wr(REG_TXT_ATTR, 0x07) == 0x5A, "TXT_ATTR previous value");
+  CHECK(wr(REG_VERSION, 0x99) == 0x23 && rd(REG_VERSION) == 0x23, "VERSION writable");
+
+  // CH_BUF: FIFO, NCHBF, CHBOV
+  CHECK(rd(REG_CH_BUF) == 0x00 && ((sts() >> 5) & 3u) == 0, "empty FIFO");
+  stats_model_key(&dev, 'a');
+  stats_model_key(&dev, 'b');
+  CHECK(((sts() >> 5) & 3u) == 2, "NCHBF after 2 keys: %u", (sts() >> 5) & 3u);
+  for (int i = 0; i < 18; i++) stats_model_key(&dev, (uint8_t)('c' + i));
+  s = sts();
+  CHECK(((s >> 5) & 3u) == 3 && (s & STS_CHBOV) && dev.st.overflows == 4, "full FIFO: sts %02X", s);
+  CHECK(rd(REG_CH_BUF) == 'a' && !(sts() & STS_CHBOV), "pop clears CHBOV");
+  for (int i = 1; i < 16; i++) {
+    d = rd(REG_CH_BUF);
+    CHECK(d == (uint8_t)('a' + i), "pop %d: %02X", i, d);
+  }
+  CHECK(rd(REG_CH_BUF) == 0x00 && ((sts() >> 5) & 3u) == 0, "FIFO not empty after 16 pops");
+
+  // A key landing after the data byte was latched (here: between the last
+  // SCK and CS rise) was not shifted out, so the frame must not pop it
+  {
+    uint8_t tx[2] = { (uint8_t)(REG_CH_BUF << 1), 0 }, rx[2];
+    StatsTransport tp = stats_wire_transport(&wire);
+    tp.at(tp.ctx, wire.now + 4000);
+    tp.cs(tp.ctx, 0);
+    tp.xfer(tp.ctx, tx, rx, 1);
+    stats_model_key(&dev, 'x');                     // after the header: value already latched
+    tp.xfer(tp.ctx, tx + 1, rx + 1, 1);
+    stats_model_key(&dev, 'y');                     // after the last bit
+    tp.cs(tp.ctx, 1);
+    CHECK(rx[1] == 0x00, "late key shifted out: %02X", rx[1]);
+    d = rd(REG_CH_BUF);
+    CHECK(d == 'x' && rd(REG_CH_BUF) == 'y', "key landing mid-frame lost: %02X", d);
+    CHECK(rd(REG_CH_BUF) == 0x00, "FIFO not empty after the late keys");
+  }
+
+  // CH_BUF writes reach the terminal
+  wr(REG_CH_BUF, 'h');
+  wr(REG_CH_BUF, 'i');
+  CHECK(dev.termLen == 2 && !memcmp(dev.term, "hi", 2), "terminal");
+
+  // Temperature: TBUSY for the conversion, then TRDY until TMP_HI is read
+  stats_model_set_temp(&dev, 0x5C3);
+  wr(REG_CTL, CTL_RDTMP);
+  s = sts();
+  CHECK((s & STS_TBUSY) && !(s & STS_TRDY), "conversion start: sts %02X", s);
+  wait_us(STATS_MODEL_TCONV_US - 1000u);
+  CHECK(sts() & STS_TBUSY, "conversion ended early");
+  wait_us(2000u);
+  s = sts();
+  CHECK(!(s & STS_TBUSY) && (s & STS_TRDY), "conversion end: sts %02X", s);
+  CHECK(rd(REG_TMP_LO) == 0xC3 && (sts() & STS_TRDY), "TMP_LO / TRDY after LO");
+  CHECK(rd(REG_TMP_HI) == 0x05 && !(sts() & STS_TRDY), "TMP_HI / TRDY after HI");
+  for (int i = 0; i < 7; i++) { wr(REG_CTL, CTL_RDTMP); wait_us(STATS_MODEL_TCONV_US + 10u); }
+  CHECK(rd(REG_TMP_AVG) == 0x5C, "TMP_AVG %02X", rd(REG_TMP_AVG));
+
+  // DEVID: only the frame right after CTL_ULKDID may write it
+  wr(REG_DEVID, 0x42);
+  CHECK(rd(REG_DEVID) == 0x11, "DEVID written while locked");
+  wr(REG_CTL, CTL_ULKDID);
+  rd(REG_VERSION);
+  wr(REG_DEVID, 0x42);
+  CHECK(rd(REG_DEVID) == 0x11, "DEVID unlock survived another frame");
+  wr(REG_CTL, CTL_ULKDID);
+  wr(REG_DEVID, 0x42);
+  CHECK(rd(REG_DEVID) == 0x42, "DEVID unlock + write");
+
+  // Light, reset
+  wr(REG_CTL, CTL_LGT_TGL);
+  stats_model_key(&dev, 'z');
+  CHECK((sts() & STS_LGT_ON) && ((sts() >> 5) & 3u) == 1, "LGT / key before reset");
+  wr(REG_CTL, CTL_RST);
+  s = sts();
+  CHECK(!(s & (STS_RDY | STS_LGT_ON)) && !((s >> 5) & 3u), "during reset: sts %02X", s);
+  wait_us(STATS_MODEL_RST_US);
+  CHECK(sts() == STS_RDY && rd(REG_DEVID) == 0x42, "after reset");
+
+  // A short frame does nothing
+  uint32_t frames = dev.st.frames;
+  uint8_t tx[1] = { (uint8_t)((REG_CTL << 1) | 1u) }, rx[1];
+  StatsTransport tp = stats_wire_transport(&wire);
+  tp.cs(tp.ctx, 0);
+  tp.xfer(tp.ctx, tx, rx, 1);
+  tp.cs(tp.ctx, 1);
+  CHECK(dev.st.badFrames == 1 && dev.st.frames == frames, "short frame counted as good");
+}
+
+//------------------------------------------------------------------------------
+// 2. Driver on the model
+//------------------------------------------------------------------------------
+static StatsSim   sim;
+static StatsCache cache;
+
+static void simReset(void)
+{
+  stats_model_init(&dev);
+  stats_wire_init(&wire, &dev, SCK_HZ, 1);
+  stats_sim_init(&sim, stats_wire_transport(&wire), SCK_HZ);
+  stats_cache_init(&cache, &sim.txn, stats_sim_now_us);
+}
+
+static uint8_t last, lastSts;
+static int8_t  lastStatus;
+
+static void onOp(const StatsOp *op, void *ctx)
+{
+  (void)ctx;
+  last = op->data;
+  lastSts = op->sts;
+  lastStatus = op->status;
+}
+
+// Submit-and-wait, for the checks only; task4 never waits
+static uint8_t sync_read(uint8_t reg)
+{
+  stats_cache_read(&cache, reg, onOp, NULL);
+  stats_sim_drain(&sim, LOOP_NS);
+  return last;
+}
+
+static char     rxGot[64];
+static uint32_t rxLen;
+
+static void onRxChar(const StatsOp *op, void *ctx)
+{
+  (void)ctx;
+  if (op->status == STATS_TXN_OK && op->data && rxLen < sizeof(rxGot)) rxGot[rxLen++] = (char)op->data;
+}
+
+static void checkDriver(void)
+{
+  uint8_t v;
+  simReset();
+
+  // Version, then from the cache
+  CHECK(sync_read(REG_VERSION) == 0x23 && lastStatus == STATS_TXN_OK, "driver VERSION");
+  CHECK(stats_cache_get(&cache, REG_VERSION, &v) && v == 0x23, "VERSION not cached");
+  CHECK(stats_cache_get(&cache, REG_STS, &v) && v == STS_RDY, "STS not cached from the VERSION read");
+
+  // task4's 'i': unlock, write, read back in one burst
+  stats_cache_write(&cache, REG_CTL, CTL_ULKDID, NULL, NULL);
+  stats_cache_write(&cache, REG_DEVID, 0x42, NULL, NULL);
+  stats_cache_read(&cache, REG_DEVID, onOp, NULL);
+  stats_sim_drain(&sim, LOOP_NS);
+  CHECK(last == 0x42 && dev.devid == 0x42, "driver DEVID set: %02X", last);
+
+  // 't' then 'r'
+  stats_model_set_temp(&dev, 0x6A1);
+  stats_cache_write(&cache, REG_CTL, CTL_RDTMP, NULL, NULL);
+  uint32_t polls = 0;
+  do {
+    stats_sim_run_until(&sim, sim.now + 5000000ull);
+    polls++;
+  } while (!(sync_read(REG_STS) & STS_TRDY) && polls < 100);
+  uint8_t lo = sync_read(REG_TMP_LO), hi = sync_read(REG_TMP_HI);
+  CHECK(((hi << 8) | lo) == 0x6A1 && polls >= 9 && polls <= 11, "driver temperature %03X after %u polls", (hi << 8) | lo, polls);
+  CHECK(!(stats_model_sts(&dev) & STS_TRDY), "TRDY still set after TMP_HI");
+
+  // TX: keystrokes to the terminal, back to back
+  const char *msg = "hello, STaTS\n";
+  for (const char *p = msg; *p; p++) stats_cache_write(&cache, REG_CH_BUF, (uint8_t)*p, NULL, NULL);
+  stats_sim_drain(&sim, LOOP_NS);
+  CHECK(dev.termLen == strlen(msg) && !memcmp(dev.term, msg, dev.termLen), "driver TX");
+
+  // RX: keys typed on the board, popped until CH_BUF reads 0
+  const char *keys = "ok 123";
+  for (const char *p = keys; *p; p++) stats_model_key(&dev, (uint8_t)*p);
+  rxLen = 0;
+  for (int i = 0; i < 8; i++) stats_txn_read(&sim.txn, REG_CH_BUF, onRxChar, NULL);
+  stats_sim_drain(&sim, LOOP_NS);
+  CHECK(rxLen == strlen(keys) && !memcmp(rxGot, keys, rxLen), "driver RX: %.*s", (int)rxLen, rxGot);
+
+  // Failing transfers: errors reported, no device effect
+  sim.failEvery = 1;
+  stats_cache_write(&cache, REG_CTL, CTL_LGT_TGL, onOp, NULL);
+  stats_sim_drain(&sim, LOOP_NS);
+  sim.failEvery = 0;
+  CHECK(lastStatus == STATS_TXN_ERR && sim.txn.st.errors == 1, "failed transfer not reported");
+  CHECK(!dev.lgt && dev.st.badFrames == 1, "failed transfer reached the device");
+}
+
+//------------------------------------------------------------------------------
+// 3. Throughput
+//------------------------------------------------------------------------------
+#define POLL_US   80000u
+#define DPX_MASK  (1u << 2)
+
+static uint32_t cycleTxns;
+static int16_t  oldDig = -1;
+
+static void toggleIf(uint8_t dig, uint8_t sts)
+{
+  if (!!(dig & DPX_MASK) != !!(sts & STS_LGT_ON) &&
+      stats_cache_write(&cache, REG_CTL, CTL_LGT_TGL, NULL, NULL))
+    cycleTxns++;
+}
+
+static void onOldDig(const StatsOp *op, void *ctx) { (void)ctx; oldDig = op->status ? -1 : op->data; }
+
+static void onOldSts(const StatsOp *op, void *ctx)
+{
+  (void)ctx;
+  if (oldDig >= 0 && op->status == STATS_TXN_OK) toggleIf((uint8_t)oldDig, op->data);
+}
+
+static void onNewDig(const StatsOp *op, void *ctx)
+{
+  (void)ctx;
+  if (op->status == STATS_TXN_OK) toggleIf(op->data, op->sts);
+}
+
+// task4's poll cycle before (STS, DIG, STS) and after the cache (DIG)
+static void pollRun(int cached)
+{
+  simReset();
+  cycleTxns = 0;
+  uint32_t cycles = 0;
+  uint64_t t0 = sim.now, end = t0 + 10000000000ull, nextPoll = 0;
+  while (sim.now < end) {
+    if (sim.now / 1000u % 700000u < 2u) stats_model_set_dig(&dev, (uint8_t)(dev.dig ^ DPX_MASK));
+    stats_txn_poll(&sim.txn);
+    if (stats_sim_now_us() >= nextPoll) {
+      uint8_t dig, s;
+      cycles++;
+      if (!cached) {
+        cycleTxns += (uint32_t)stats_txn_read(&sim.txn, REG_STS, NULL, NULL);
+        cycleTxns += (uint32_t)stats_txn_read(&sim.txn, REG_DIG, onOldDig, NULL);
+        cycleTxns += (uint32_t)stats_txn_read(&sim.txn, REG_STS, onOldSts, NULL);
+      } else if (stats_cache_get(&cache, REG_DIG, &dig) && stats_cache_get(&cache, REG_STS, &s)) {
+        toggleIf(dig, s);
+      } else {
+        cycleTxns += (uint32_t)stats_cache_read(&cache, REG_DIG, onNewDig, NULL);
+      }
+      nextPoll = stats_sim_now_us() + POLL_US;
+    }
+    stats_sim_run_until(&sim, sim.now + LOOP_NS);
+  }
+  stats_sim_drain(&sim, LOOP_NS);
+  CHECK(!!(dev.dig & DPX_MASK) == dev.lgt, "LD3 mirror out of step");
+  printf("%-7s 80 ms poll, 10 s: %.2f txn/cycle, bus busy %.3f%% (CS low), %.3f%% (SCK)\n",
+         cached ? "cached:" : "old:", (double)cycleTxns / cycles,
+         100.0 * (double)sim.csLowNs / (double)(sim.now - t0),
+         100.0 * (double)wire.busyNs / (double)(sim.now - t0));
+}
+
+static void throughput(void)
+{
+  const uint32_t ops = 10000;
+  uint32_t sent = 0;
+  simReset();
+  uint64_t t0 = sim.now;
+  while (sent < ops || !stats_txn_idle(&sim.txn)) {
+    while (sent < ops && stats_txn_read(&sim.txn, REG_VERSION, NULL, NULL)) sent++;
+    stats_sim_step(&sim, LOOP_NS);
+  }
+  double per = (double)(sim.now - t0) / ops;
+  CHECK(dev.st.frames == ops && dev.st.badFrames == 0, "%u frames, %u bad", dev.st.frames, dev.st.badFrames);
+  printf("back to back at SCK %u Hz: %.1f us per transaction, %.0f txn/s, CS low %.0f%%, SCK %.0f%% of the time\n",
+         SCK_HZ, per / 1000.0, 1e9 / per,
+         100.0 * (double)sim.csLowNs / (double)(sim.now - t0),
+         100.0 * (double)wire.busyNs / (double)(sim.now - t0));
+  pollRun(0);
+  pollRun(1);
+}
+
+int main(void)
+{
+  checkProtocol();
+  checkDriver();
+  throughput();
+  printf("%s\n", bad ? "FAILED" : "all checks passed");
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+// stats_rx_host.c  (host checks and rates for Lab03/src/stats_rx.c)
+//
+//   gcc -O2 -DHOST_BUILD -ILab03/src -Ihost -o stats_rx_host
+//       host/stats_rx_host.c host/stats_model.c Lab03/src/stats_rx.c
+//       Lab03/src/stats_txn.c Lab03/src/stats_cache.c Lab03/src/spi_bus.c
+//
+// The receiver on the driver stack, against the STaTS model (16-byte
+// keyboard FIFO) at task4's SCK. Keys are numbered so loss and reordering
+// show.
+//
+// 1. Random typing (100 keys/s) with pasted bursts of up to 8: every
+//    byte arrives, in order, no CHBOV. A 30-key burst into an idle receiver: CHBOV
+//    counted once, the first 16 keys arrive.
+// 2. Highest key rate with no CHBOV over 3 s, for the old task4 loop (one
+//    pop in flight, 1 ms apart, 25 ms idle poll) and the burst receiver:
+//    ramped up from 0 over 1 s, and stepped from idle.
+// 3. Bus cost while idle.
+// Exits non-zero on a failed check.
+
+#include "stats_model.h"
+#include "stats_rx.h"
+#include "stats_regs.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SCK_HZ   (54000000u / 256u)
+#define LOOP_NS  2000u
+
+static StatsModel dev;
+static StatsWire  wire;
+static StatsSim   sim;
+static StatsCache cache;
+static StatsRx    rx;
+static int        bad;
+
+static uint32_t got, misordered;
+
+static uint8_t keyOf(uint32_t i) { return (uint8_t)(1u + i % 255u); }
+
+static void onChar(uint8_t c, void *ctx)
+{
+  (void)ctx;
+  if (c != keyOf(got)) misordered++;
+  got++;
+}
+
+// The task4 loop before: one pop in flight, 1 ms after a byte, 25 ms after empty
+static uint8_t  oldBusy;
+static uint64_t oldNext;
+
+static void onOldPop(const StatsOp *op, void *ctx)
+{
+  (void)ctx;
+  oldBusy = 0;
+  if (op->status != STATS_TXN_OK || op->data == 0x00) { oldNext = stats_sim_now_us() + 25000u; return; }
+  onChar(op->data, NULL);
+  oldNext = stats_sim_now_us() + 1000u;
+}
+
+static void oldPoll(void)
+{
+  if (!oldBusy && stats_sim_now_us() >= oldNext)
+    oldBusy = (uint8_t)stats_txn_read(&sim.txn, REG_CH_BUF, onOldPop, NULL);
+}
+
+static void reset(void)
+{
+  stats_model_init(&dev);
+  stats_wire_init(&wire, &dev, SCK_HZ, 1);
+  stats_sim_init(&sim, stats_wire_transport(&wire), SCK_HZ);
+  stats_cache_init(&cache, &sim.txn, stats_sim_now_us);
+  stats_rx_init(&rx, &sim.txn, &cache, stats_sim_now_us, onChar, NULL);
+  oldBusy = 0;
+  oldNext = 0;
+  got = misordered = 0;
+}
+
+// Keys at `rate` per second (ramped from 0 over rampNs if set) for durNs,
+// then drained. Returns CHBOV overflows seen by the device.
+static uint32_t run(int burst, double rate, uint64_t rampNs, uint64_t durNs)
+{
+  reset();
+  uint64_t t0 = sim.now, end = t0 + durNs, nextKey = t0 + 30000000ull;   // receiver idle first
+  uint32_t sent = 0;
+  while (sim.now < end + 50000000ull) {
+    while (sim.now < end && sim.now >= nextKey) {
+      stats_model_key(&dev, keyOf(sent++));
+      uint64_t t = nextKey - t0;
+      double r = rampNs && t < rampNs ? rate * (double)t / (double)rampNs : rate;
+      nextKey += (uint64_t)(1e9 / (r > 10.0 ? r : 10.0));
+    }
+    stats_txn_poll(&sim.txn);
+    if (burst) stats_rx_poll(&rx); else oldPoll();
+    stats_sim_run_until(&sim, sim.now + LOOP_NS);
+  }
+  if (!dev.st.overflows && (got != sent || misordered)) {
+    printf("%s at %.0f/s: sent %u, got %u, %u out of order\n", burst ? "burst" : "old", rate, sent, got, misordered);
+    bad++;
+  }
+  return dev.st.overflows;
+}
+
+// Highest rate (to 1%) with no overflow
+static double maxRate(int burst, uint64_t rampNs)
+{
+  double lo = 50, hi = 40000;
+  while (hi - lo > lo * 0.01) {
+    double mid = (lo + hi) / 2;
+    if (run(burst, mid, rampNs, 3000000000ull)) hi = mid; else lo = mid;
+  }
+  return lo;
+}
+
+int main(void)
+{
+  // 1. Random typing with bursts
+  reset();
+  uint32_t sent = 0;
+  for (uint64_t end = sim.now + 20000000000ull; sim.now < end; ) {
+    static uint32_t rng = 521288629u;
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    if (rng % 100000u == 0) {
+      uint32_t n = 1 + (rng >> 8) % 8u;
+      while (n--) stats_model_key(&dev, keyOf(sent++));
+    } else if (rng % 5000u == 1) {
+      stats_model_key(&dev, keyOf(sent++));
+    }
+    stats_txn_poll(&sim.txn);
+    stats_rx_poll(&rx);
+    stats_sim_run_until(&sim, sim.now + LOOP_NS);
+  }
+  for (uint64_t end = sim.now + 100000000ull; sim.now < end; ) {
+    stats_txn_poll(&sim.txn);
+    stats_rx_poll(&rx);
+    stats_sim_run_until(&sim, sim.now + LOOP_NS);
+  }
+  if (got != sent || misordered || rx.st.overflows || dev.st.overflows) {
+    printf("typing: sent %u, got %u, %u out of order, %u overflows\n", sent, got, misordered, rx.st.overflows);
+    bad++;
+  }
+  printf("typing, 20 s: %u bytes, %u pops (%u empty), longest burst %u, %u bursts from a cached STS\n",
+         rx.st.bytes, rx.st.pops, rx.st.empty, rx.st.maxBurst, rx.st.hinted);
+
+  // Overflow into an idle receiver
+  reset();
+  stats_sim_run_until(&sim, sim.now + 30000000ull);
+  for (uint32_t i = 0; i < 30; i++) stats_model_key(&dev, keyOf(i));
+  for (uint64_t end = sim.now + 100000000ull; sim.now < end; ) {
+    stats_txn_poll(&sim.txn);
+    stats_rx_poll(&rx);
+    stats_sim_run_until(&sim, sim.now + LOOP_NS);
+  }
+  if (rx.st.overflows != 1 || got != 16 || misordered) {
+    printf("overflow: %u reported, got %u\n", rx.st.overflows, got);
+    bad++;
+  }
+
+  // 2. Rates
+  double oldRamp = maxRate(0, 1000000000ull), newRamp = maxRate(1, 1000000000ull);
+  double oldStep = maxRate(0, 0), newStep = maxRate(1, 0);
+  printf("max keys/s without CHBOV, ramped over 1 s: old %.0f, burst %.0f (%.1fx)\n", oldRamp, newRamp, newRamp / oldRamp);
+  printf("max keys/s without CHBOV, from idle:        old %.0f, burst %.0f\n", oldStep, newStep);
+  if (newRamp < 4 * oldRamp) bad++;
+
+  // Drain speed: a full FIFO, once seen
+  reset();
+  for (uint32_t i = 0; i < 16; i++) stats_model_key(&dev, keyOf(i));
+  uint64_t t0 = sim.now;
+  while (got < 16) { stats_txn_poll(&sim.txn); stats_rx_poll(&rx); stats_sim_run_until(&sim, sim.now + LOOP_NS); }
+  printf("16 queued bytes drained in %.2f ms (%.1f us per byte)\n", (sim.now - t0) / 1e6, (sim.now - t0) / 16e3);
+
+  // 3. Idle cost
+  reset();
+  for (uint64_t end = sim.now + 10000000000ull; sim.now < end; ) {
+    stats_txn_poll(&sim.txn);
+    stats_rx_poll(&rx);
+    stats_sim_run_until(&sim, sim.now + LOOP_NS);
+  }
+  printf("idle: %.1f pops/s, bus busy %.2f%%\n", rx.st.pops / 10.0, 100.0 * (double)sim.csLowNs / 1e10);
+
+  printf("%s\n", bad ? "FAILED" : "all checks passed");
+  return bad ? 1 : 0;
+}
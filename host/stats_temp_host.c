@@ -0,0 +1,144 @@
+// stats_temp_host.c  (host checks and rates for Lab03/src/stats_temp.c)
+//
+//   gcc -O2 -DHOST_BUILD -ILab03/src -Ihost -o stats_temp_host
+//       host/stats_temp_host.c host/stats_model.c Lab03/src/stats_temp.c
+//       Lab03/src/stats_txn.c Lab03/src/stats_cache.c Lab03/src/spi_bus.c
+//       -lm
+//
+// The sampler on the driver stack against the STaTS model (50 ms
+// conversions), with the sensor drifting between samples and task4's
+// 80 ms DIG poll running alongside (its STS byte is what the sampler
+// mostly uses to see TRDY).
+//
+// 1. Fixed point: stats_temp_mdeg() against the old float formula for
+//    every raw value.
+// 2. Every sample is the model's conversion result; the average matches a
+//    double-precision one. TMP_AVG is compared with the assumed formula
+//    (sum of 8 >> 4); the model implements that same formula, so this
+//    only shows the read lands in the right burst, not that the real
+//    device averages this way.
+// 3. With 1 transfer in 25 failing: samples still come, nothing is
+//    recorded that the device did not produce, and no TMP_AVG read is
+//    compared while a dropped sample is still in the device's window.
+// 4. Samples/s and bus use at the default period and flat out, with and
+//    without the DIG poll supplying STS.
+// Exits non-zero on a failed check.
+
+#include "stats_model.h"
+#include "stats_temp.h"
+#include "stats_regs.h"
+#include <math.h>
+#include <stdio.h>
+
+#define SCK_HZ   (54000000u / 256u)
+#define LOOP_NS  2000u
+
+static StatsModel dev;
+static StatsWire  wire;
+static StatsSim   sim;
+static StatsCache cache;
+static StatsTemp  tmp;
+static int        bad;
+
+static void reset(uint32_t failEvery)
+{
+  stats_model_init(&dev);
+  stats_wire_init(&wire, &dev, SCK_HZ, 1);
+  stats_sim_init(&sim, stats_wire_transport(&wire), SCK_HZ);
+  sim.failEvery = failEvery;
+  stats_cache_init(&cache, &sim.txn, stats_sim_now_us);
+  stats_temp_init(&tmp, &sim.txn, &cache, stats_sim_now_us);
+}
+
+typedef struct { double sps, txnPer, stsPer, busPct, avgDiff; uint32_t wrong; } Result;
+
+// Run for secs; checks each new sample against the model
+static Result run(uint32_t periodUs, int digPoll, uint32_t failEvery, double secs)
+{
+  Result r = { 0, 0, 0, 0, 0, 0 };
+  reset(failEvery);
+  stats_temp_enable(&tmp, 1, periodUs);
+
+  uint64_t t0 = sim.now, end = t0 + (uint64_t)(secs * 1e9), nextPoll = 0;
+  uint32_t seen = 0, sumTxn0 = 0;
+  double hist[STATS_TEMP_AVG_N];
+  uint32_t nh = 0;
+  double drift = 0;
+
+  while (sim.now < end) {
+    drift += 1e-6;
+    stats_model_set_temp(&dev, (uint16_t)(1800.0 + 300.0 * sin(drift)));   // ~6 s per swing step
+
+    stats_txn_poll(&sim.txn);
+    stats_temp_poll(&tmp);
+    if (digPoll && stats_sim_now_us() >= nextPoll) {
+      stats_cache_read(&cache, REG_DIG, NULL, NULL);
+      nextPoll = stats_sim_now_us() + 80000u;
+    }
+    if (tmp.st.samples != seen) {
+      seen = tmp.st.samples;
+      if (tmp.raw != dev.tmp) r.wrong++;
+      hist[nh++ % STATS_TEMP_AVG_N] = tmp.raw;
+      uint32_t n = nh < STATS_TEMP_AVG_N ? nh : STATS_TEMP_AVG_N;
+      double m = 0;
+      for (uint32_t i = 0; i < n; i++) m += hist[i];
+      m = 357.6 - 0.187 * m / n;
+      double d = fabs(stats_temp_avg_mdeg(&tmp) / 1000.0 - m);
+      if (d > r.avgDiff) r.avgDiff = d;
+    }
+    stats_sim_run_until(&sim, sim.now + LOOP_NS);
+  }
+  (void)sumTxn0;
+  double el = (double)(sim.now - t0) / 1e9;
+  double txnNs = (STATS_CS_SETUP_US + STATS_CS_HOLD_US + STATS_CS_GAP_US) * 1000.0 + 16e9 / SCK_HZ;
+  r.sps = tmp.st.samples / el;
+  r.txnPer = tmp.st.samples ? (double)tmp.st.txns / tmp.st.samples : 0;
+  r.stsPer = tmp.st.samples ? (double)tmp.st.stsReads / tmp.st.samples : 0;
+  r.busPct = 100.0 * tmp.st.txns * txnNs / (el * 1e9);
+  return r;
+}
+
+int main(void)
+{
+  // 1. Fixed point vs float
+  double worst = 0;
+  for (uint32_t raw = 0; raw < 4096; raw++) {
+    float f = 357.6f - 0.187f * (float)raw;
+    double d = fabs(stats_temp_mdeg((uint16_t)raw) / 1000.0 - (double)f);
+    if (d > worst) worst = d;
+  }
+  printf("fixed point vs float over 0..4095: worst %.4f C\n", worst);
+  if (worst > 0.001) bad++;
+
+  // 2. Accuracy
+  Result a = run(STATS_TEMP_PERIOD_US, 1, 0, 30);
+  printf("30 s, period %u ms: %u samples, %u wrong, average within %.4f C, TMP_AVG %u/%u match "
+         "the assumed formula\n",
+         STATS_TEMP_PERIOD_US / 1000u, tmp.st.samples, a.wrong, a.avgDiff,
+         tmp.st.avgChecks - tmp.st.avgMismatch, tmp.st.avgChecks);
+  if (a.wrong || a.avgDiff > 0.001 || tmp.st.avgMismatch || tmp.st.avgChecks < 10 || tmp.st.timeouts) bad++;
+
+  // 3. Failing transfers
+  Result f = run(STATS_TEMP_PERIOD_US, 1, 25, 30);
+  printf("1 in 25 transfers failing: %u samples (%.2f/s), %u wrong, %u errors, %u not ready, %u timeouts, "
+         "TMP_AVG %u/%u\n", tmp.st.samples, f.sps, f.wrong, tmp.st.errors, tmp.st.notReady,
+         tmp.st.timeouts, tmp.st.avgChecks - tmp.st.avgMismatch, tmp.st.avgChecks);
+  if (f.wrong || tmp.st.samples < 80 || tmp.st.avgMismatch) bad++;
+
+  // 4. Rates
+  struct { uint32_t period; int dig; const char *name; } cases[] = {
+    { STATS_TEMP_PERIOD_US, 1, "250 ms period, DIG poll on " },
+    { STATS_TEMP_PERIOD_US, 0, "250 ms period, DIG poll off" },
+    { 1, 1,                    "flat out,      DIG poll on " },
+    { 1, 0,                    "flat out,      DIG poll off" },
+  };
+  for (int i = 0; i < 4; i++) {
+    Result r = run(cases[i].period, cases[i].dig, 0, 20);
+    printf("%s: %.2f samples/s, %.2f txn/sample (%.2f STS checks), sampler bus use %.3f%%\n",
+           cases[i].name, r.sps, r.txnPer, r.stsPer, r.busPct);
+    if (r.wrong) bad++;
+  }
+
+  printf("%s\n", bad ? "FAILED" : "all checks passed");
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,265 @@
+// stats_txn_host.c  (host model of Lab03/src/stats_txn.c)
+//
+//   gcc -O2 -DHOST_BUILD -ILab03/src -o stats_txn_host
+//       host/stats_txn_host.c Lab03/src/stats_txn.c Lab03/src/spi_bus.c
+//
+// Runs stats_txn, as the one device on the spi_bus engine, against a
+// simulated STaTS device in virtual time (nanoseconds). The bus port ops
+// schedule events instead of touching hardware: a delay ends after its
+// microseconds, a transfer after 8 SCK periods per byte (SPI2 at
+// 54 MHz / 256, as in task4). Between events the main loop makes a pass
+// every LOOP_NS: it submits work and runs stats_txn_poll().
+//
+// 1. Correctness: random bursts of reads and writes, one transfer in 31
+//    failing. Callbacks must arrive once each, in submission order, with
+//    the STS and data the device produced; failed ops report an error.
+//    The device checks every CS frame: exactly 2 bytes, setup, hold and
+//    gap times met, and SPI2 set to mode 1, LSB first, /256.
+// 2. Queue full: submits beyond STATS_TXN_QUEUE are refused and counted,
+//    nothing queued is lost.
+// 3. Throughput: back-to-back ops in virtual time, main-loop passes made
+//    meanwhile, and host CPU time in the interrupt-side steps.
+// Exits non-zero on a failed check.
+
+#define _POSIX_C_SOURCE 199309L
+#include "stats_txn.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define SCK_HZ    (54000000u / 256u)
+#define LOOP_NS   2000u
+#define NEVER     (~0ull)
+
+static SpiBus   bus;
+static StatsTxn tx;
+static uint64_t now, timerAt = NEVER, xferAt = NEVER;
+static uint32_t failEvery;
+static uint32_t rng = 362436069u;
+static int      bad;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+//------------------------------------------------------------------------------
+// Simulated device: 16 plain registers, STS changes on every transaction
+//------------------------------------------------------------------------------
+typedef struct { uint8_t we, reg, din, sts, data; int ok; } Done;
+
+static struct {
+  uint8_t  reg[16];
+  uint8_t  sts;
+  int      cs;             // 1 = deselected
+  uint64_t csLowAt, csHighAt, xferEnd;
+  int      bytes;          // bytes in this CS frame
+  Done     log[4096];      // what the device did, in order
+  uint32_t logHead, logTail;
+} dev;
+
+static const uint8_t *xTx;
+static uint8_t *xRx;
+static int xFail;
+static int modeOk;
+
+static uint64_t mono_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void fault(const char *what)
+{
+  if (bad++ < 5) printf("t=%llu ns: %s\n", (unsigned long long)now, what);
+}
+
+static void simConfigure(const SpiDevCfg *cfg, uint32_t br)
+{
+  if (!dev.cs) fault("SPI2 reconfigured with CS low");
+  modeOk = !cfg->cpol && cfg->cpha && cfg->lsbFirst && 54000000u / (2u << br) == SCK_HZ;
+}
+
+static void simCs(const SpiDevCfg *cfg, int level)
+{
+  (void)cfg;
+  if (level == dev.cs) return;
+  if (level == 0) {
+    if (now - dev.csHighAt < STATS_CS_GAP_US * 1000ull) fault("CS gap too short");
+    dev.csLowAt = now;
+    dev.bytes = 0;
+  } else {
+    if (dev.bytes != 2) fault("CS frame without 2 bytes");
+    if (now - dev.xferEnd < STATS_CS_HOLD_US * 1000ull) fault("CS hold too short");
+    dev.csHighAt = now;
+  }
+  dev.cs = level;
+}
+
+static void simDelay(uint32_t us)
+{
+  if (timerAt != NEVER) fault("timer restarted while running");
+  timerAt = now + us * 1000ull;
+}
+
+static void simXfer(const uint8_t *t, uint8_t *r, uint32_t len)
+{
+  if (len != 2) fault("frame not 2 bytes");
+  if (!modeOk) fault("SPI2 not in the STaTS mode");
+  if (dev.cs) fault("transfer with CS high");
+  if (now - dev.csLowAt < STATS_CS_SETUP_US * 1000ull) fault("CS setup too short");
+  if (xferAt != NEVER) fault("transfer while busy");
+  xTx = t;
+  xRx = r;
+  xFail = failEvery && xorshift() % failEvery == 0;
+  xferAt = now + 16ull * 1000000000ull / SCK_HZ;
+}
+
+static void simKick(void)
+{
+  spi_bus_kick(&bus);        // on the board this is a pended IRQ
+}
+
+static uint64_t isrNs;      // host time inside the event handlers
+
+static const SpiBusOps simOps = { simConfigure, simCs, simDelay, simXfer, simKick };
+
+// Bytes cross the wire: device acts on them unless the DMA failed
+static void xferEvent(void)
+{
+  xferAt = NEVER;
+  dev.xferEnd = now;
+  if (xFail) {
+    dev.bytes = 2;           // the frame still closes normally
+    spi_bus_xfer_done(&bus, 0);
+    Done d = { (uint8_t)(xTx[0] & 1u), (uint8_t)(xTx[0] >> 1), xTx[1], 0, 0, 0 };
+    dev.log[dev.logHead++ & 4095u] = d;
+    return;
+  }
+  uint8_t we = xTx[0] & 1u, reg = (uint8_t)(xTx[0] >> 1);
+  Done d = { we, reg, xTx[1], dev.sts, dev.reg[reg], 1 };
+  xRx[0] = d.sts;
+  xRx[1] = d.data;
+  if (we) dev.reg[reg] = xTx[1];
+  dev.sts = (uint8_t)(dev.sts * 5u + 1u);
+  dev.bytes += 2;
+  dev.log[dev.logHead++ & 4095u] = d;
+  spi_bus_xfer_done(&bus, 1);
+}
+
+// Advance virtual time to t, firing ISR events on the way
+static void runUntil(uint64_t t)
+{
+  for (;;) {
+    uint64_t next = timerAt < xferAt ? timerAt : xferAt;
+    if (next > t) break;
+    now = next;
+    uint64_t c0 = mono_ns();
+    if (next == xferAt) xferEvent();
+    else { timerAt = NEVER; spi_bus_timer(&bus); }
+    isrNs += mono_ns() - c0;
+  }
+  now = t;
+}
+
+//------------------------------------------------------------------------------
+// Main-loop side
+//------------------------------------------------------------------------------
+static uint32_t submitted, calledBack;
+
+static void onDone(const StatsOp *op, void *ctx)
+{
+  uint32_t seq = (uint32_t)(uintptr_t)ctx;
+  if (seq != calledBack) fault("callback out of order");
+  calledBack++;
+
+  if (dev.logTail == dev.logHead) { fault("callback with no device transaction"); return; }
+  Done d = dev.log[dev.logTail++ & 4095u];
+  if (d.we != op->we || d.reg != op->reg || d.din != op->din) fault("device saw a different op");
+  if (d.ok) {
+    if (op->status != STATS_TXN_OK || op->sts != d.sts || op->data != d.data) fault("wrong result");
+  } else if (op->status != STATS_TXN_ERR) {
+    fault("failed transfer reported ok");
+  }
+}
+
+static int submitRandom(void)
+{
+  uint8_t reg = (uint8_t)(xorshift() & 15u);
+  void *ctx = (void *)(uintptr_t)submitted;
+  int ok = (xorshift() & 1u) ? stats_txn_write(&tx, reg, (uint8_t)xorshift(), onDone, ctx)
+                             : stats_txn_read(&tx, reg, onDone, ctx);
+  if (ok) submitted++;
+  return ok;
+}
+
+static void reset(uint32_t failOneIn)
+{
+  memset(&dev, 0, sizeof(dev));
+  dev.cs = 1;
+  dev.sts = 0x21;
+  now = 1000000;
+  timerAt = xferAt = NEVER;
+  failEvery = failOneIn;
+  submitted = calledBack = 0;
+  modeOk = 0;
+  spi_bus_init(&bus, &simOps, 54000000u);
+  if (!stats_txn_init(&tx, &bus, NULL, 0, SCK_HZ)) fault("bus full");
+}
+
+int main(void)
+{
+  int fail = 0;
+
+  // 1. Random bursts with failures
+  reset(31);
+  while (submitted < 20000 || !stats_txn_idle(&tx)) {
+    if (submitted < 20000 && xorshift() % 400 == 0) {
+      uint32_t n = 1 + xorshift() % 12;
+      while (n-- && submitRandom()) {}
+    }
+    stats_txn_poll(&tx);
+    runUntil(now + LOOP_NS);
+  }
+  if (calledBack != submitted || dev.logTail != dev.logHead || tx.st.ops != submitted) {
+    printf("%u submitted, %u called back, %u ops\n", submitted, calledBack, tx.st.ops);
+    bad++;
+  }
+  printf("bursts: %u ops, %u bursts, %u chained, %u errors, queue peak %u, %u SPI2 setups\n",
+         tx.st.ops, bus.st.bursts, bus.st.chained, tx.st.errors, tx.st.maxQueue, bus.st.reconfigs);
+  if (tx.st.errors == 0 || bus.st.chained == 0 || bus.st.reconfigs != 1) bad++;
+
+  // 2. Queue full
+  reset(0);
+  uint32_t taken = 0;
+  while (submitRandom()) taken++;
+  if (taken != STATS_TXN_QUEUE || tx.st.full != 1) { printf("queue took %u\n", taken); bad++; }
+  while (!stats_txn_idle(&tx)) { stats_txn_poll(&tx); runUntil(now + LOOP_NS); }
+  if (calledBack != taken) { printf("lost ops after full queue\n"); bad++; }
+
+  // 3. Throughput, back to back
+  reset(0);
+  const uint32_t ops = 10000;
+  uint64_t t0 = now, passes = 0;
+  isrNs = 0;
+  while (submitted < ops || !stats_txn_idle(&tx)) {
+    while (submitted < ops && submitRandom()) {}
+    stats_txn_poll(&tx);
+    passes++;
+    runUntil(now + LOOP_NS);
+  }
+  double per = (double)(now - t0) / ops;
+  printf("back to back at SCK %u Hz: %.1f us per transaction (wire %.1f, CS %u+%u+%u), %.0f txn/s\n",
+         SCK_HZ, per / 1000.0, 16e6 / SCK_HZ, STATS_CS_SETUP_US, STATS_CS_HOLD_US, STATS_CS_GAP_US,
+         1e9 / per);
+  printf("main loop: %.1f passes per transaction; ISR steps: %.0f ns host CPU per transaction (incl. simulated device)\n",
+         (double)passes / ops, (double)isrNs / ops);
+
+  fail = bad;
+  printf("%s\n", fail ? "FAILED" : "all checks passed");
+  return fail ? 1 : 0;
+}
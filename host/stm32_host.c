@@ -0,0 +1,108 @@
+// stm32_host.c  (host build of main.c only)
+//
+// See stm32_host.h.
+
+#define _POSIX_C_SOURCE 199309L
+#include "stm32_host.h"
+#include <string.h>
+#include <time.h>
+
+#define HOST_LCD_W     800
+#define HOST_LCD_H     480
+#define HOST_FONT_W    17    // Font24 cell, what the board draws with
+#define HOST_FONT_H    24
+
+uint32_t SystemCoreClock = 216000000u;
+
+GPIO_TypeDef  host_gpioc, host_gpiof, host_gpioh, host_gpioj;
+RCC_TypeDef   host_rcc;
+USART_TypeDef host_usart6;
+TIM_TypeDef   host_tim12;
+
+static uint32_t fb[HOST_LCD_W * HOST_LCD_H];
+static uint32_t text_color = LCD_COLOR_WHITE;
+static uint32_t back_color = LCD_COLOR_BLACK;
+
+static uint64_t mono_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t t0_ns;
+
+void HAL_Init(void)           { t0_ns = mono_ns(); }
+void SystemClock_Config(void) {}
+
+uint32_t HAL_GetTick(void)    { return (uint32_t)((mono_ns() - t0_ns) / 1000000ull); }
+uint32_t host_ticks_ns(void)  { return (uint32_t)mono_ns(); }
+
+void HAL_Delay(uint32_t ms)
+{
+  struct timespec ts = { (time_t)(ms / 1000u), (long)(ms % 1000u) * 1000000L };
+  nanosleep(&ts, 0);
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void) { return SystemCoreClock / 4u; }
+
+// buttons are active-low with pull-ups: read as released
+void HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init) { (void)port; (void)init; }
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin) { (void)port; (void)pin; return GPIO_PIN_SET; }
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *h) { (void)h; return HAL_OK; }
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *h, uint8_t *p, uint16_t n, uint32_t timeout)
+{
+  (void)h; (void)p; (void)n; (void)timeout;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *h) { (void)h; return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *h, TIM_OC_InitTypeDef *oc, uint32_t ch)
+{ (void)h; (void)oc; (void)ch; return HAL_OK; }
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *h, uint32_t ch) { (void)h; (void)ch; return HAL_OK; }
+
+void BSP_LED_Init(Led_TypeDef led)   { (void)led; }
+void BSP_LED_On(Led_TypeDef led)     { (void)led; }
+void BSP_LED_Toggle(Led_TypeDef led) { (void)led; }
+
+uint8_t  BSP_LCD_Init(void) { return LCD_OK; }
+void     BSP_LCD_LayerDefaultInit(uint16_t layer, uint32_t addr) { (void)layer; (void)addr; }
+void     BSP_LCD_SelectLayer(uint32_t layer) { (void)layer; }
+void     BSP_LCD_DisplayOn(void) {}
+void     BSP_LCD_SetBrightness(uint8_t pct) { (void)pct; }
+uint32_t BSP_LCD_GetXSize(void) { return HOST_LCD_W; }
+uint32_t BSP_LCD_GetYSize(void) { return HOST_LCD_H; }
+void     BSP_LCD_SetTextColor(uint32_t c) { text_color = c; }
+void     BSP_LCD_SetBackColor(uint32_t c) { back_color = c; }
+
+static void fill(uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t c)
+{
+  if (x >= HOST_LCD_W || y >= HOST_LCD_H) return;
+  if (x + w > HOST_LCD_W) w = HOST_LCD_W - x;
+  if (y + h > HOST_LCD_H) h = HOST_LCD_H - y;
+
+  for (uint32_t r = 0; r < h; r++)
+  {
+    uint32_t *row = &fb[(y + r) * HOST_LCD_W + x];
+    for (uint32_t i = 0; i < w; i++) row[i] = c;
+  }
+}
+
+void BSP_LCD_Clear(uint32_t c) { fill(0, 0, HOST_LCD_W, HOST_LCD_H, c); }
+
+void BSP_LCD_FillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  fill(x, y, w, h, text_color);
+}
+
+// glyphs are not rasterized; cost is modelled as one cell fill per character
+void BSP_LCD_DisplayStringAt(uint16_t x, uint16_t y, uint8_t *text, int mode)
+{
+  (void)mode;
+  uint32_t n = (uint32_t)strlen((const char *)text);
+  fill(x, y, n * HOST_FONT_W, HOST_FONT_H, back_color);
+  for (uint32_t i = 0; i < n; i++)
+    fill(x + i * HOST_FONT_W + 2, y + 4, HOST_FONT_W - 4, HOST_FONT_H - 8, text_color);
+}
@@ -0,0 +1,156 @@
+// stm32_host.h  (host build of main.c only)
+//
+// Just enough of the STM32F7 HAL / F769I-DISCO BSP for the shooter to compile
+// and run on Linux with -DHOST_BUILD. The LCD is a software ARGB8888
+// framebuffer (so fill cost is real), buttons read as released, USART6 never
+// has RX data and transmits are dropped, HAL_GetTick() is CLOCK_MONOTONIC.
+// Register writes that only configure hardware land in dummy structs.
+
+#ifndef STM32_HOST_H
+#define STM32_HOST_H
+
+#include <stdint.h>
+
+// -------------------- HAL basics --------------------
+typedef enum { HAL_OK = 0, HAL_ERROR } HAL_StatusTypeDef;
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+
+void     HAL_Init(void);
+void     SystemClock_Config(void);
+uint32_t HAL_GetTick(void);
+void     HAL_Delay(uint32_t ms);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t host_ticks_ns(void);
+
+extern uint32_t SystemCoreClock;
+
+// -------------------- GPIO --------------------
+typedef struct { volatile uint32_t IDR, ODR, BSRR; } GPIO_TypeDef;
+extern GPIO_TypeDef host_gpioc, host_gpiof, host_gpioh, host_gpioj;
+#define GPIOC (&host_gpioc)
+#define GPIOF (&host_gpiof)
+#define GPIOH (&host_gpioh)
+#define GPIOJ (&host_gpioj)
+
+#define GPIO_PIN_0  ((uint16_t)0x0001)
+#define GPIO_PIN_1  ((uint16_t)0x0002)
+#define GPIO_PIN_6  ((uint16_t)0x0040)
+#define GPIO_PIN_7  ((uint16_t)0x0080)
+#define GPIO_PIN_8  ((uint16_t)0x0100)
+
+typedef struct {
+  uint32_t Pin, Mode, Pull, Speed, Alternate;
+} GPIO_InitTypeDef;
+
+enum { GPIO_MODE_INPUT, GPIO_MODE_AF_PP };
+enum { GPIO_NOPULL, GPIO_PULLUP };
+enum { GPIO_SPEED_FREQ_LOW, GPIO_SPEED_FREQ_VERY_HIGH };
+enum { GPIO_AF8_USART6 = 8, GPIO_AF9_TIM12 = 9 };
+
+void          HAL_GPIO_Init(GPIO_TypeDef *port, GPIO_InitTypeDef *init);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *port, uint16_t pin);
+
+#define __HAL_RCC_GPIOC_CLK_ENABLE()   ((void)0)
+#define __HAL_RCC_GPIOF_CLK_ENABLE()   ((void)0)
+#define __HAL_RCC_GPIOH_CLK_ENABLE()   ((void)0)
+#define __HAL_RCC_GPIOJ_CLK_ENABLE()   ((void)0)
+#define __HAL_RCC_USART6_CLK_ENABLE()  ((void)0)
+#define __HAL_RCC_TIM12_CLK_ENABLE()   ((void)0)
+
+// -------------------- RCC --------------------
+typedef struct { volatile uint32_t CFGR; } RCC_TypeDef;
+extern RCC_TypeDef host_rcc;
+#define RCC (&host_rcc)
+#define RCC_CFGR_PPRE1       (0x7u << 10)
+#define RCC_CFGR_PPRE1_DIV1  (0x0u << 10)
+
+// -------------------- USART6 --------------------
+typedef struct { volatile uint32_t ISR, ICR, RDR, TDR; } USART_TypeDef;
+extern USART_TypeDef host_usart6;
+#define USART6 (&host_usart6)
+
+#define USART_ISR_PE    (1u << 0)
+#define USART_ISR_FE    (1u << 1)
+#define USART_ISR_NE    (1u << 2)
+#define USART_ISR_ORE   (1u << 3)
+#define USART_ISR_RXNE  (1u << 5)
+#define USART_ICR_PECF  (1u << 0)
+#define USART_ICR_FECF  (1u << 1)
+#define USART_ICR_NCF   (1u << 2)
+#define USART_ICR_ORECF (1u << 3)
+
+typedef struct {
+  uint32_t BaudRate, WordLength, StopBits, Parity, Mode, HwFlowCtl, OverSampling;
+} UART_InitTypeDef;
+
+typedef struct {
+  USART_TypeDef   *Instance;
+  UART_InitTypeDef Init;
+} UART_HandleTypeDef;
+
+enum { UART_WORDLENGTH_8B, UART_STOPBITS_1, UART_PARITY_NONE, UART_MODE_TX_RX,
+       UART_HWCONTROL_NONE, UART_OVERSAMPLING_16 };
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *h);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *h, uint8_t *p, uint16_t n, uint32_t timeout);
+
+// -------------------- TIM12 PWM --------------------
+typedef struct { volatile uint32_t PSC, ARR, CCR1; } TIM_TypeDef;
+extern TIM_TypeDef host_tim12;
+#define TIM12 (&host_tim12)
+
+typedef struct {
+  uint32_t Prescaler, CounterMode, Period, ClockDivision, RepetitionCounter, AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+  TIM_TypeDef         *Instance;
+  TIM_Base_InitTypeDef Init;
+} TIM_HandleTypeDef;
+
+typedef struct { uint32_t OCMode, Pulse, OCPolarity, OCFastMode; } TIM_OC_InitTypeDef;
+
+enum { TIM_CHANNEL_1, TIM_COUNTERMODE_UP, TIM_CLOCKDIVISION_DIV1,
+       TIM_AUTORELOAD_PRELOAD_DISABLE, TIM_OCMODE_PWM1, TIM_OCPOLARITY_HIGH,
+       TIM_OCFAST_DISABLE };
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *h);
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *h, TIM_OC_InitTypeDef *oc, uint32_t ch);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *h, uint32_t ch);
+
+#define __HAL_TIM_SET_COMPARE(h, ch, v)  ((h)->Instance->CCR1 = (v))
+#define __HAL_TIM_SET_PRESCALER(h, v)    ((h)->Instance->PSC = (v))
+#define __HAL_TIM_SET_AUTORELOAD(h, v)   ((h)->Instance->ARR = (v))
+
+// -------------------- BSP LED / LCD --------------------
+typedef enum { LED1 = 0, LED2 } Led_TypeDef;
+void BSP_LED_Init(Led_TypeDef led);
+void BSP_LED_On(Led_TypeDef led);
+void BSP_LED_Toggle(Led_TypeDef led);
+
+#define LCD_OK                        0
+#define LTDC_ACTIVE_LAYER_FOREGROUND  1
+#define LCD_FB_START_ADDRESS          0
+#define LEFT_MODE                     0
+
+#define LCD_COLOR_BLACK      0xFF000000u
+#define LCD_COLOR_WHITE      0xFFFFFFFFu
+#define LCD_COLOR_RED        0xFFFF0000u
+#define LCD_COLOR_GREEN      0xFF00FF00u
+#define LCD_COLOR_YELLOW     0xFFFFFF00u
+#define LCD_COLOR_LIGHTGRAY  0xFFD3D3D3u
+
+uint8_t  BSP_LCD_Init(void);
+void     BSP_LCD_LayerDefaultInit(uint16_t layer, uint32_t fb);
+void     BSP_LCD_SelectLayer(uint32_t layer);
+void     BSP_LCD_DisplayOn(void);
+void     BSP_LCD_SetBrightness(uint8_t pct);
+uint32_t BSP_LCD_GetXSize(void);
+uint32_t BSP_LCD_GetYSize(void);
+void     BSP_LCD_Clear(uint32_t color);
+void     BSP_LCD_SetTextColor(uint32_t color);
+void     BSP_LCD_SetBackColor(uint32_t color);
+void     BSP_LCD_FillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+void     BSP_LCD_DisplayStringAt(uint16_t x, uint16_t y, uint8_t *text, int mode);
+
+#endif // STM32_HOST_H
@@ -0,0 +1,288 @@
+// swtimer_host.c  (host checks and timing for common/swtimer.c)
+//
+//   gcc -O2 -Icommon -o swtimer_host host/swtimer_host.c common/swtimer.c
+//
+// The clock is simulated and starts 0x10000 ticks before the 32-bit wrap,
+// so every run crosses it.
+//
+// 1. swt_advance() soak: 10k timers, one-shot and periodic, delays from 0
+//    to 2^26 ticks (past the 2^24 parking point), random clock jumps of
+//    1..200 and 1..100000 ticks. Callbacks cancel and restart random
+//    timers, themselves included; the main loop does the same between
+//    jumps. Every timer fires exactly at its due tick, only while armed,
+//    never late; *next is never past the earliest due tick; the wheel's
+//    pending count matches.
+// 2. Tickless port: the same load driven only by the compare the wheel
+//    asks for (jump to it, swt_service()), with starts from outside moving
+//    the compare forward. Same checks, and the number of interrupts per
+//    expiry.
+// 3. Timing with 10k pending: start (move), cancel + start, and expiry.
+// Exits non-zero on a failed check.
+
+#define _POSIX_C_SOURCE 199309L
+#include "swtimer.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define N       10000
+#define T_START 0xFFFF0000u
+
+static SwWheel  w;
+static SwTimer  tm[N];
+static uint32_t due[N];
+static uint8_t  armed[N];
+static uint32_t fires, early, late, unarmed, pastNext;
+static uint32_t simNow;
+static int      bad;
+
+static uint64_t rs = 88172645463325252ull;
+
+static uint32_t rnd(void)
+{
+  rs ^= rs << 13;
+  rs ^= rs >> 7;
+  rs ^= rs << 17;
+  return (uint32_t)rs;
+}
+
+static uint64_t mono_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void check(int ok, const char *what)
+{
+  if (!ok) { printf("FAIL: %s\n", what); bad++; }
+}
+
+static uint32_t randomDelay(void)
+{
+  uint32_t r = rnd() % 100;
+  if (r < 50) return rnd() % 64;
+  if (r < 80) return rnd() % 5000;
+  if (r < 97) return rnd() % 1000000;
+  return rnd() % (1u << 26);
+}
+
+// The time start() measures from: the port's clock, or the wheel's
+static uint32_t startTime(void)
+{
+  return w.port.now ? w.port.now() : w.now;
+}
+
+static void startOne(int i, uint32_t delay, uint32_t period)
+{
+  uint32_t base = startTime();
+  swt_start(&w, &tm[i], delay, period);
+  due[i] = base + (delay ? delay : 1);
+  armed[i] = 1;
+}
+
+static void cancelOne(int i)
+{
+  swt_cancel(&w, &tm[i]);
+  armed[i] = 0;
+}
+
+static void onExpire(SwTimer *t, void *arg)
+{
+  int i = (int)(intptr_t)arg;
+  uint32_t at = startTime();
+
+  fires++;
+  if (!armed[i]) unarmed++;
+  else if (at != due[i]) {
+    if ((int32_t)(at - due[i]) < 0) early++;
+    else late++;
+  }
+  if (t->period) due[i] += t->period;
+  else armed[i] = 0;
+
+  uint32_t r = rnd() & 255;
+  if (r == 0) cancelOne(i);                                 // itself
+  else if (r == 1) startOne(i, randomDelay(), 0);           // itself, again
+  if ((rnd() & 15) == 0) {
+    int j = (int)(rnd() % N);
+    if (armed[j]) cancelOne(j);
+  }
+  if ((rnd() & 15) == 0) startOne((int)(rnd() % N), 1 + rnd() % 5000, 0);
+}
+
+static void load(void)
+{
+  for (int i = 0; i < N; i++) {
+    swt_setup(&tm[i], onExpire, (void *)(intptr_t)i);
+    startOne(i, randomDelay(), i % 10 == 0 ? 1 + rnd() % 3000 : 0);
+  }
+}
+
+// Timers overdue at the current time; the earliest due tick otherwise
+static uint32_t overdue(uint32_t now, uint32_t *earliest, uint32_t *pending)
+{
+  uint32_t n = 0, best = 0;
+  int any = 0;
+
+  *pending = 0;
+  for (int i = 0; i < N; i++) {
+    if (!armed[i]) continue;
+    (*pending)++;
+    if ((int32_t)(due[i] - now) <= 0) n++;
+    if (!any || (int32_t)(due[i] - best) < 0) best = due[i];
+    any = 1;
+  }
+  *earliest = best;
+  return n;
+}
+
+static void meddle(void)
+{
+  if ((rnd() & 7) == 0) {
+    int j = (int)(rnd() % N);
+    if (armed[j] && !tm[j].period) cancelOne(j);
+    else startOne(j, randomDelay(), 0);
+  }
+}
+
+//------------------------------------------------------------------------------
+// 1. swt_advance soak
+//------------------------------------------------------------------------------
+static void soak(void)
+{
+  uint32_t missed = 0, countOff = 0, next, earliest, pending;
+
+  memset(armed, 0, sizeof(armed));
+  fires = early = late = unarmed = pastNext = 0;
+  swt_init(&w, NULL);
+  w.now = simNow = T_START;
+  load();
+
+  for (int round = 0; round < 200000; round++) {
+    simNow += (rnd() & 1) ? 1 + rnd() % 200 : 1 + rnd() % 100000;
+    int more = swt_advance(&w, simNow, &next);
+    if ((round & 63) == 0) {
+      missed += overdue(simNow, &earliest, &pending);
+      if (pending != w.active) countOff++;
+      if (pending && (!more || (int32_t)(next - earliest) > 0 || (int32_t)(next - simNow) <= 0)) pastNext++;
+    }
+    meddle();
+  }
+  printf("advance soak: %u expiries over %u ticks (wrapped), early %u, late %u, while disarmed %u, "
+         "missed %u, bad next %u, count off %u\n", fires, simNow - T_START, early, late, unarmed,
+         missed, pastNext, countOff);
+  check(fires > 100000, "too few expiries to mean anything");
+  check(!early && !late && !unarmed && !missed, "timer fired off its tick");
+  check(!pastNext && !countOff, "next event or pending count wrong");
+}
+
+//------------------------------------------------------------------------------
+// 2. Tickless port
+//------------------------------------------------------------------------------
+static uint32_t compare;
+static int      compareSet;
+static uint32_t irqs, rearmForward;
+
+static uint32_t portNow(void) { return simNow; }
+
+static void portArm(uint32_t tick)
+{
+  if (compareSet && (int32_t)(tick - compare) < 0) rearmForward++;
+  compare = tick;
+  compareSet = 1;
+}
+
+static void tickless(void)
+{
+  static const SwTimerPort port = { portNow, portArm };
+  uint32_t missed = 0, earliest, pending;
+
+  memset(armed, 0, sizeof(armed));
+  fires = early = late = unarmed = 0;
+  compareSet = 0;
+  irqs = rearmForward = 0;
+  simNow = T_START;
+  swt_init(&w, &port);
+  load();
+
+  for (int round = 0; round < 200000 && compareSet; round++) {
+    // Somewhere before the compare, the main loop may start or cancel
+    uint32_t gap = compare - simNow;
+    if (gap > 1 && (rnd() & 3) == 0) {
+      simNow += 1 + rnd() % (gap - 1);
+      meddle();
+      continue;
+    }
+    simNow = compare;                                 // the interrupt
+    compareSet = 0;
+    irqs++;
+    swt_service(&w);
+    if ((round & 63) == 0) {
+      missed += overdue(simNow, &earliest, &pending);
+      check(pending == w.active, "pending count off");
+      check(!pending || (compareSet && (int32_t)(compare - earliest) <= 0), "compare past the earliest timer");
+    }
+  }
+  printf("tickless port: %u expiries in %u interrupts (%.2f per interrupt), %u compares brought "
+         "forward by starts; early %u, late %u, while disarmed %u, missed %u\n", fires, irqs,
+         (double)fires / irqs, rearmForward, early, late, unarmed, missed);
+  check(!early && !late && !unarmed && !missed, "timer fired off its tick");
+}
+
+//------------------------------------------------------------------------------
+// 3. Timing
+//------------------------------------------------------------------------------
+static void quiet(SwTimer *t, void *arg)
+{
+  (void)t;
+  (void)arg;
+  fires++;
+}
+
+static void timing(void)
+{
+  const int R = 100;
+  uint32_t next;
+
+  swt_init(&w, NULL);
+  for (int i = 0; i < N; i++) {
+    swt_setup(&tm[i], quiet, NULL);
+    swt_start(&w, &tm[i], 1 + rnd() % 5000000, 0);
+  }
+  uint64_t t0 = mono_ns();
+  for (int r = 0; r < R; r++)
+    for (int i = 0; i < N; i++) swt_start(&w, &tm[i], 1 + rnd() % 5000000, 0);
+  double move = (double)(mono_ns() - t0) / (R * N);
+
+  t0 = mono_ns();
+  for (int r = 0; r < R; r++)
+    for (int i = 0; i < N; i++) {
+      swt_cancel(&w, &tm[i]);
+      swt_start(&w, &tm[i], 1 + rnd() % 5000000, 0);
+    }
+  double cancelStart = (double)(mono_ns() - t0) / (R * N);
+
+  fires = 0;
+  uint32_t calls = 0;
+  t0 = mono_ns();
+  while (swt_advance(&w, w.now, &next)) {
+    swt_advance(&w, next, &next);
+    calls++;
+    if (!w.active) break;
+  }
+  double expire = (double)(mono_ns() - t0) / fires;
+  check(fires == N, "drain lost timers");
+  printf("timing, 10k pending: start (move) %.1f ns, cancel + start %.1f ns, "
+         "expiry %.1f ns per timer (%u advances)\n", move, cancelStart, expire, calls);
+}
+
+int main(void)
+{
+  soak();
+  tickless();
+  timing();
+
+  printf("%s\n", bad ? "FAILED" : "all checks passed");
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,181 @@
+// timebase_host.c  (host checks for common/timebase.c, HOST_BUILD half)
+//
+//   gcc -O2 -DHOST_BUILD -Icommon -o timebase_host host/timebase_host.c
+//       common/timebase.c
+//
+// 1. tb_now_us() against clock_gettime(CLOCK_MONOTONIC): over random
+//    intervals the two deltas agree to within the bracketing reads, and a
+//    second tb_init() does not move the epoch.
+// 2. 5M back-to-back reads never go backwards.
+// 3. tb_cycles() deltas, through tb_cycles_to_us(), agree with tb_now_us()
+//    over the same interval, including a delta across the 32-bit wrap.
+// 4. Sleeps: tb_sleep_us() and tb_sleep_until() never return before the
+//    deadline (overshoot reported); a past deadline returns at once.
+// 5. Deadlines: tb_expired() is false until tb_now_us() reaches the
+//    deadline and true from then on.
+// Exits non-zero on a failed check.
+
+#define _POSIX_C_SOURCE 199309L
+#include "timebase.h"
+#include <stdio.h>
+#include <time.h>
+
+static int bad;
+
+static uint32_t rng = 2463534242u;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static uint64_t mono_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void check(int ok, const char *what)
+{
+  if (!ok) { printf("FAIL: %s\n", what); bad++; }
+}
+
+static void spinUs(uint32_t us)
+{
+  uint64_t end = mono_ns() + (uint64_t)us * 1000u;
+  while (mono_ns() < end) { }
+}
+
+// 1. Both clocks read between bracketing clock_gettime calls
+static void againstClock(void)
+{
+  uint32_t off = 0;
+  int64_t worst = 0;
+
+  for (int i = 0; i < 200; i++) {
+    uint64_t a0 = mono_ns(), t0 = tb_now_us(), a1 = mono_ns();
+    spinUs(xorshift() % 5000);
+    if (i == 100) tb_init();                           // must not reset the epoch
+    uint64_t b0 = mono_ns(), t1 = tb_now_us(), b1 = mono_ns();
+
+    // t1 - t0 lies in [(b0 - a1), (b1 - a0)] ns, give or take the 1 us truncation
+    int64_t d = (int64_t)(t1 - t0) * 1000;
+    int64_t lo = (int64_t)(b0 - a1) - 1000, hi = (int64_t)(b1 - a0) + 1000;
+    if (d < lo || d > hi) off++;
+    int64_t e = d < lo ? lo - d : d > hi ? d - hi : 0;
+    if (e > worst) worst = e;
+  }
+  printf("tb_now_us vs clock_gettime: 200 intervals up to 5 ms, %u outside the bracket "
+         "(worst by %lld ns)\n", off, (long long)worst);
+  check(off == 0, "tb_now_us disagrees with CLOCK_MONOTONIC");
+}
+
+// 2. Monotonic
+static void monotonic(void)
+{
+  uint64_t last = tb_now_us();
+  uint32_t back = 0;
+
+  for (uint32_t i = 0; i < 5000000; i++) {
+    uint64_t t = tb_now_us();
+    back += t < last;
+    last = t;
+  }
+  printf("5M reads: %u went backwards\n", back);
+  check(back == 0, "tb_now_us went backwards");
+}
+
+// 3. Cycle deltas
+static void cycles(void)
+{
+  uint32_t off = 0, wrapped = 0;
+
+  for (int i = 0; i < 100; i++) {
+    uint32_t us = i == 0 ? 20000 : xorshift() % 3000;
+    uint64_t t0 = tb_now_us();
+    uint32_t c0 = tb_cycles();
+    spinUs(us);
+    uint32_t c1 = tb_cycles();
+    uint64_t t1 = tb_now_us();
+    wrapped += c1 < c0;
+    int64_t d = (int64_t)tb_cycles_to_us(c1 - c0) - (int64_t)(t1 - t0);
+    if (d < -2 || d > 2) off++;
+  }
+
+  // a delta across the wrap: the host "cycles" are the low 32 bits of ns
+  uint32_t c0 = 0xFFFFFC18u, c1 = 0x000003E8u;          // 2000 cycles apart
+  check(tb_cycles_to_us(c1 - c0) == 2, "delta across the 32-bit wrap");
+
+  printf("tb_cycles deltas vs tb_now_us: 100 intervals up to 20 ms (%u across a wrap), %u off by "
+         "more than 2 us\n", wrapped, off);
+  check(off == 0, "cycle deltas disagree with tb_now_us");
+}
+
+// 4. Sleeps
+static void sleeps(void)
+{
+  static const uint32_t us[] = { 1, 50, 100, 1000, 5000, 20000 };
+  uint32_t early = 0;
+
+  for (size_t k = 0; k < sizeof(us) / sizeof(us[0]); k++) {
+    uint64_t worst = 0, sum = 0;
+    for (int i = 0; i < 20; i++) {
+      uint64_t t0 = tb_now_us(), dl = t0 + us[k];
+      if (i & 1) tb_sleep_until(dl);
+      else tb_sleep_us(us[k]);
+      uint64_t t1 = tb_now_us();
+      if (t1 < dl) early++;
+      uint64_t over = t1 > dl ? t1 - dl : 0;
+      sum += over;
+      if (over > worst) worst = over;
+    }
+    printf("sleep %5u us: overshoot %llu us average, %llu us worst\n", (unsigned)us[k],
+           (unsigned long long)(sum / 20), (unsigned long long)worst);
+  }
+
+  uint64_t t0 = mono_ns();
+  tb_sleep_until(tb_now_us() > 1000 ? tb_now_us() - 1000 : 0);
+  uint64_t past = mono_ns() - t0;
+  printf("past deadline: returned after %llu ns; early wake-ups %u\n", (unsigned long long)past, early);
+  check(early == 0, "sleep returned before its deadline");
+  check(past < 1000000, "sleep on a past deadline blocked");
+}
+
+// 5. Deadlines
+static void deadlines(void)
+{
+  uint32_t wrong = 0, polls = 0;
+
+  for (int i = 0; i < 50; i++) {
+    uint64_t dl = tb_deadline_us(1 + xorshift() % 2000);
+    for (;;) {
+      uint64_t before = tb_now_us();
+      int ex = tb_expired(dl);
+      uint64_t after = tb_now_us();
+      polls++;
+      if (ex && after < dl) wrong++;                  // expired before it could be
+      if (!ex && before >= dl) wrong++;                // still pending after it passed
+      if (ex) break;
+    }
+    if (!tb_expired(dl)) wrong++;                      // and it stays expired
+  }
+  printf("deadlines: 50 of 1..2000 us, %u polls, %u wrong answers\n", polls, wrong);
+  check(wrong == 0, "tb_expired wrong");
+}
+
+int main(void)
+{
+  tb_init();
+  againstClock();
+  monotonic();
+  cycles();
+  sleeps();
+  deadlines();
+
+  printf("%s\n", bad ? "FAILED" : "all checks passed");
+  return bad ? 1 : 0;
+}
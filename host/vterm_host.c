@@ -0,0 +1,242 @@
+// vterm_host.c  (host checks and byte counts for Lab01/Src/vterm.c)
+//
+//   gcc -O2 -ILab01/Src -Icommon -o vterm_host host/vterm_host.c
+//       Lab01/Src/vterm.c common/fmt.c
+//
+// The sink feeds a small xterm-like terminal (CUP, CUF, CR, LF, 256-colour
+// SGR, pending wrap at the last column). After every flush the terminal
+// must show exactly the back buffer, cell by cell, colours included.
+//
+// 1. The task2 screen layout: first frame, 2000 random keystrokes into the
+//    10 x 72 log (printable ones, and now and then a non-printable one with
+//    the error line and the flash), idle redraws. Bytes per frame are the
+//    numbers quoted for vterm.c: first frame, average and worst keystroke,
+//    idle.
+// 2. Random screens: random cells in random colours over a random earlier
+//    screen, 2000 frames, including the last column and the bottom row.
+// Exits non-zero on a mismatch.
+
+#include "vterm.h"
+#include <stdio.h>
+#include <string.h>
+
+#define LOG_ROWS 10
+#define LOG_COLS 72
+
+enum { A_PLAIN, A_TEXT, A_ERR, A_FLASH };
+
+typedef struct { char ch; uint8_t fg, bg; } Cell;
+
+static VTerm    vt;
+static Cell     term[VT_ROWS][VT_COLS];
+static int      tRow, tCol, tWrap;
+static uint8_t  tFg = 7, tBg = 0;
+static uint32_t termErrors;
+static size_t   sunk;
+
+static uint32_t rng = 2463534242u;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+//------------------------------------------------------------------------------
+// The terminal
+//------------------------------------------------------------------------------
+static void sgr(const int *p, int n)
+{
+  for (int i = 0; i < n; i++) {
+    if (p[i] == 38 && i + 2 < n && p[i + 1] == 5) { tFg = (uint8_t)p[i + 2]; i += 2; }
+    else if (p[i] == 48 && i + 2 < n && p[i + 1] == 5) { tBg = (uint8_t)p[i + 2]; i += 2; }
+    else if (p[i] == 0) { tFg = 7; tBg = 0; }
+  }
+}
+
+static void termFeed(const char *buf, size_t len)
+{
+  for (size_t i = 0; i < len; i++) {
+    char c = buf[i];
+    if (c == '\033') {
+      int p[8] = {0}, n = 0, priv = 0;
+      if (++i >= len || buf[i] != '[') { termErrors++; continue; }
+      if (i + 1 < len && buf[i + 1] == '?') { priv = 1; i++; }
+      for (i++; i < len && ((buf[i] >= '0' && buf[i] <= '9') || buf[i] == ';'); i++) {
+        if (buf[i] == ';') { if (n < 7) n++; }
+        else p[n] = p[n] * 10 + (buf[i] - '0');
+      }
+      n++;
+      if (i >= len) { termErrors++; break; }
+      if (priv) continue;                              // cursor show / hide
+      switch (buf[i]) {
+      case 'H':
+        tRow = (p[0] ? p[0] : 1) - 1;
+        tCol = (n > 1 && p[1] ? p[1] : 1) - 1;
+        tWrap = 0;
+        break;
+      case 'C':
+        tCol += p[0] ? p[0] : 1;
+        if (tCol > VT_COLS - 1) tCol = VT_COLS - 1;
+        tWrap = 0;
+        break;
+      case 'm':
+        sgr(p, n);
+        break;
+      default:
+        termErrors++;
+      }
+    } else if (c == '\r') {
+      tCol = 0;
+      tWrap = 0;
+    } else if (c == '\n') {
+      if (tRow < VT_ROWS - 1) tRow++;
+      else termErrors++;                               // would scroll the screen
+      tWrap = 0;
+    } else {
+      if (tWrap) {
+        tWrap = 0;
+        tCol = 0;
+        if (tRow < VT_ROWS - 1) tRow++;
+        else termErrors++;
+      }
+      term[tRow][tCol].ch = c;
+      term[tRow][tCol].fg = tFg;
+      term[tRow][tCol].bg = tBg;
+      if (tCol < VT_COLS - 1) tCol++;
+      else tWrap = 1;
+    }
+  }
+}
+
+// A frame too big for VT_OUT_MAX comes in several writes, which may split
+// an escape sequence; the terminal sees one stream
+static char frame[1 << 16];
+
+static void sink(const char *buf, size_t len)
+{
+  if (sunk + len <= sizeof(frame)) memcpy(frame + sunk, buf, len);
+  sunk += len;
+}
+
+// Cells where the terminal differs from the back buffer
+static uint32_t differences(void)
+{
+  uint32_t n = 0;
+  for (int r = 0; r < VT_ROWS; r++) {
+    for (int c = 0; c < VT_COLS; c++) {
+      const VtCell *b = &vt.back[r][c];
+      const Cell *t = &term[r][c];
+      if (t->ch != b->ch || t->fg != vt.fg[b->attr] || t->bg != vt.bg[b->attr]) n++;
+    }
+  }
+  return n;
+}
+
+static size_t flush(uint32_t *bad)
+{
+  sunk = 0;
+  vt_flush(&vt);
+  if (sunk > sizeof(frame)) termErrors++;
+  else termFeed(frame, sunk);
+  *bad += differences();
+  return sunk;
+}
+
+//------------------------------------------------------------------------------
+// task2's screen
+//------------------------------------------------------------------------------
+static char     logText[LOG_ROWS][LOG_COLS];
+static uint32_t logPos, printable, nonPrintable;
+
+static void draw(int fault, uint8_t badChar)
+{
+  vt_fill(&vt, ' ', A_PLAIN);
+  vt_puts(&vt, 2, 19, "Enter <ESC> or <CTRL> + [ to terminate", A_TEXT);
+  vt_hline(&vt, 3, 1, 80, '-', A_TEXT);
+  vt_hline(&vt, 14, 1, 80, '-', A_TEXT);
+  for (int i = 0; i < LOG_ROWS; i++) vt_putn(&vt, i + 4, 5, logText[i], LOG_COLS, A_TEXT);
+  vt_hline(&vt, 16, 1, 80, ' ', A_TEXT);
+  vt_puts(&vt, 21, 1, "# of Characters Received:", A_TEXT);
+  vt_puts(&vt, 22, 1, "Printable             Non-Printable", A_TEXT);
+  vt_printf(&vt, 23, 1, A_TEXT, "%d", (int)printable);
+  vt_printf(&vt, 23, 22, A_TEXT, "%d", (int)nonPrintable);
+  if (fault) vt_printf(&vt, 16, 1, A_ERR, "The received value $%x is 'not printable'", badChar);
+}
+
+int main(void)
+{
+  uint32_t bad = 0;
+
+  // 1. task2
+  vt_init(&vt, sink);
+  vt_attr_define(&vt, A_PLAIN, 7, 0);
+  vt_attr_define(&vt, A_TEXT, 220, 24);
+  vt_attr_define(&vt, A_ERR, 196, 24);
+  vt_attr_define(&vt, A_FLASH, 196, 196);
+  memset(logText, '.', sizeof(logText));
+
+  draw(0, 0);
+  size_t first = flush(&bad);
+
+  size_t keyBytes = 0, keyMax = 0, faultBytes = 0;
+  uint32_t keys = 0, faults = 0;
+  for (int k = 0; k < 2000; k++) {
+    if (xorshift() % 20 == 0) {
+      uint8_t c = (uint8_t)(xorshift() % 32);
+      nonPrintable++;
+      draw(1, c);                                     // red text
+      size_t n = flush(&bad);
+      vt_hline(&vt, 16, 1, 80, ' ', A_FLASH);        // red block
+      n += flush(&bad);
+      draw(1, c);                                     // red text again
+      n += flush(&bad);
+      draw(0, 0);
+      n += flush(&bad);
+      faultBytes += n;
+      faults++;
+    } else {
+      logText[(logPos / LOG_COLS) % LOG_ROWS][logPos % LOG_COLS] = (char)(' ' + 1 + xorshift() % 94);
+      logPos++;
+      printable++;
+      draw(0, 0);
+      size_t n = flush(&bad);
+      keyBytes += n;
+      if (n > keyMax) keyMax = n;
+      keys++;
+    }
+  }
+  draw(0, 0);
+  size_t idle = flush(&bad);
+  vt_invalidate(&vt);
+  size_t full = flush(&bad);
+
+  printf("task2 screen: first frame %zu B, keystroke %.1f B average / %zu B worst "
+         "(%u keys), non-printable with flash %.0f B, idle %zu B, full repaint %zu B\n",
+         first, (double)keyBytes / keys, keyMax, keys, (double)faultBytes / faults, idle, full);
+
+  // 2. Random screens
+  for (int a = 0; a < VT_MAX_ATTRS; a++)
+    vt_attr_define(&vt, (uint8_t)a, (uint8_t)(xorshift() % 4), (uint8_t)(xorshift() % 3));
+  vt_invalidate(&vt);                                 // cells on screen keep their old colours
+  size_t total = 0;
+  for (int f = 0; f < 2000; f++) {
+    uint32_t n = 1 + xorshift() % (f % 10 == 0 ? VT_ROWS * VT_COLS : 40);
+    for (uint32_t i = 0; i < n; i++) {
+      int r = 1 + (int)(xorshift() % VT_ROWS), c = 1 + (int)(xorshift() % VT_COLS);
+      if (xorshift() % 4 == 0) c = VT_COLS;           // the pending-wrap column
+      vt_put(&vt, r, c, (char)('A' + xorshift() % 3), (uint8_t)(xorshift() % VT_MAX_ATTRS));
+    }
+    if (xorshift() % 3 == 0) vt_park(&vt, 1 + (int)(xorshift() % VT_ROWS), 1 + (int)(xorshift() % VT_COLS));
+    else vt_park(&vt, 0, 0);
+    total += flush(&bad);
+  }
+  printf("random screens: 2000 frames, %zu B\n", total);
+
+  printf("terminal mismatches %u, bad sequences %u\n", bad, termErrors);
+  int fail = bad || termErrors;
+  printf("%s\n", fail ? "FAILED" : "all checks passed");
+  return fail ? 1 : 0;
+}
@@ -0,0 +1,203 @@
+// word_array_host.c  (host checks and benchmark for Lab03/src/word_array.c)
+//
+//   gcc -O2 -ILab03/src -o word_array_host host/word_array_host.c Lab03/src/word_array.c
+//
+// 1. Output matches the strncat tokenize_to_array() it replaced (copied
+//    below) on random lines, fed whole and in random chunks.
+// 2. Sink mode through a 16-byte staging buffer gives the same bytes.
+// 3. A fixed buffer of every size from 4 up stays a valid array.
+// 4. Timing on 64 KB lines: old vs one-shot vs byte-at-a-time.
+// Exits non-zero on a mismatch.
+
+#define _POSIX_C_SOURCE 199309L
+#include "word_array.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define OLD_LINE_MAX 256
+#define BIG          (64 * 1024)
+
+static uint32_t rng = 12345;
+
+static uint32_t xorshift(void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+static uint64_t mono_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// The Lab03 task3 version, unchanged apart from the name
+static void old_tokenize_to_array(const char* line, char* out, size_t outsz)
+{
+  out[0] = 0;
+  strncat(out, "[", outsz-1);
+  const char* p=line;
+  while (*p && isspace((unsigned char)*p)) p++;
+
+  int first=1;
+  while (*p)
+  {
+    char tok[OLD_LINE_MAX]; size_t tlen=0;
+    while (*p && !isspace((unsigned char)*p) && tlen < OLD_LINE_MAX-1)
+      tok[tlen++] = *p++;
+    tok[tlen] = 0;
+
+    if (tlen>0) {
+      if (!first) strncat(out, ",", outsz-1);
+      strncat(out, "\"", outsz-1);
+      for (size_t i=0;i<tlen;i++){
+        if (tok[i]=='\"' || tok[i]=='\\') strncat(out, "\\", outsz-1);
+        char tmp[2]={tok[i],0}; strncat(out, tmp, outsz-1);
+      }
+      strncat(out, "\"", outsz-1);
+      first=0;
+    }
+    while (*p && isspace((unsigned char)*p)) p++;
+  }
+  strncat(out, "]", outsz-1);
+}
+
+// Printable text with spaces, quotes and backslashes; words < 20 bytes so
+// the old 255-byte token limit never applies
+static void make_line(char *s, size_t n)
+{
+  size_t i = 0;
+  while (i < n) {
+    uint32_t r = xorshift();
+    uint32_t wl = 1 + r % 19;
+    for (uint32_t k = 0; k < wl && i < n; k++) {
+      uint32_t q = xorshift() % 64;
+      s[i++] = q == 0 ? '"' : q == 1 ? '\\' : (char)('a' + q % 26);
+    }
+    uint32_t sp = 1 + (r >> 8) % 3;
+    for (uint32_t k = 0; k < sp && i < n; k++) s[i++] = (r >> 12) & 1 ? ' ' : '\t';
+  }
+  s[n] = '\0';
+}
+
+static size_t encode(const char *line, size_t n, char *out, size_t cap, size_t chunk)
+{
+  WordArray w;
+  word_array_begin(&w, out, cap, NULL, NULL);
+  for (size_t i = 0; i < n; ) {
+    size_t k = chunk ? chunk : 1 + xorshift() % 37;
+    if (k > n - i) k = n - i;
+    word_array_feed(&w, line + i, k);
+    i += k;
+  }
+  return word_array_end(&w);
+}
+
+typedef struct { char *buf; size_t len; } Collect;
+
+static void collect(const char *p, size_t n, void *ctx)
+{
+  Collect *c = ctx;
+  memcpy(c->buf + c->len, p, n);
+  c->len += n;
+}
+
+// Structure check: [ then "..." separated by , then ]
+static int valid_array(const char *s, size_t n)
+{
+  size_t i = 0;
+  if (n < 2 || s[0] != '[' || s[n - 1] != ']') return 0;
+  for (i = 1; i < n - 1; ) {
+    if (s[i] != '"') return 0;
+    for (i++; i < n - 1 && s[i] != '"'; i++) {
+      if (s[i] == '\\') i++;
+    }
+    if (i >= n - 1) return 0;
+    i++;
+    if (i < n - 1 && s[i++] != ',') return 0;
+  }
+  return 1;
+}
+
+int main(void)
+{
+  static char line[BIG + 1], a[4 * BIG], b[4 * BIG], c[4 * BIG], stage[16];
+  int fail = 0;
+
+  // 1. Equivalence with the old code
+  for (int t = 0; t < 300; t++) {
+    size_t n = xorshift() % 600;
+    make_line(line, n);
+    old_tokenize_to_array(line, a, sizeof(a));
+    size_t la = strlen(a);
+    size_t lb = encode(line, n, b, sizeof(b), n ? n : 1);
+    size_t lc = encode(line, n, c, sizeof(c), 0);
+    if (la != lb || memcmp(a, b, la) || lb != lc || memcmp(b, c, lb)) {
+      printf("mismatch on line %d (%zu bytes)\n", t, n);
+      fail++;
+    }
+  }
+
+  // 2. Sink through a tiny staging buffer
+  make_line(line, BIG);
+  size_t lb = encode(line, BIG, b, sizeof(b), BIG);
+  Collect col = { c, 0 };
+  WordArray w;
+  word_array_begin(&w, stage, sizeof(stage), collect, &col);
+  for (size_t i = 0; i < BIG; i++) word_array_putc(&w, line[i]);
+  size_t ls = word_array_end(&w);
+  if (ls != lb || col.len != lb || memcmp(b, c, lb)) { printf("sink mismatch\n"); fail++; }
+
+  // Control bytes
+  const char ctl[] = "a\x01" "b \x7f";
+  encode(ctl, sizeof(ctl) - 1, b, sizeof(b), 1);
+  if (strcmp(b, "[\"a\\u0001b\",\"\\u007f\"]") != 0) { printf("control bytes: %s\n", b); fail++; }
+
+  // 3. Every fixed size stays valid, cut accounting is sane
+  make_line(line, 2000);
+  for (size_t cap = 4; cap < 5000; cap++) {
+    WordArray f;
+    word_array_begin(&f, a, cap, NULL, NULL);
+    word_array_feed(&f, line, 2000);
+    size_t n = word_array_end(&f);
+    if (n >= cap || a[n] != '\0' || !valid_array(a, n) || f.cut > f.words) {
+      printf("cap %zu: len %zu invalid: %.40s...\n", cap, n, a);
+      fail++;
+      break;
+    }
+  }
+
+  // 4. 64 KB lines
+  make_line(line, BIG);
+  uint64_t t0 = mono_ns();
+  old_tokenize_to_array(line, a, sizeof(a));
+  uint64_t tOld = mono_ns() - t0;
+
+  const int reps = 200;
+  t0 = mono_ns();
+  for (int r = 0; r < reps; r++) lb = encode(line, BIG, b, sizeof(b), BIG);
+  uint64_t tOne = (mono_ns() - t0) / reps;
+
+  t0 = mono_ns();
+  for (int r = 0; r < reps; r++) {
+    WordArray f;
+    word_array_begin(&f, b, sizeof(b), NULL, NULL);
+    for (size_t i = 0; i < BIG; i++) word_array_putc(&f, line[i]);
+    word_array_end(&f);
+  }
+  uint64_t tByte = (mono_ns() - t0) / reps;
+
+  if (strlen(a) != lb || memcmp(a, b, lb)) { printf("64 KB mismatch\n"); fail++; }
+  printf("64 KB line -> %zu B array: strncat %.1f ms, streaming %.1f us (one call), "
+         "%.1f us (byte at a time), %.0fx\n",
+         lb, tOld / 1e6, tOne / 1e3, tByte / 1e3, (double)tOld / (double)tOne);
+
+  printf("%s\n", fail ? "FAILED" : "all checks passed");
+  return fail ? 1 : 0;
+}
@@ -0,0 +1,34 @@
+// kinematics.c  (shared by main.c and host builds)
+//
+// See kinematics.h. No HAL dependencies so the same file links on the host.
+
+#include "kinematics.h"
+
+void kin_axis_set(KinAxis *a, int px)
+{
+  a->pos = q16_from_int(px);
+  a->rem = 0;
+}
+
+// pos*1000 + rem always equals start*1000 + vel*65536*elapsed_ms exactly,
+// so the result only depends on total elapsed time, not on how it was sliced.
+void kin_axis_step(KinAxis *a, int32_t vel_px_s, uint32_t dt_ms)
+{
+  int64_t num = (int64_t)vel_px_s * Q16_ONE * (int64_t)dt_ms + a->rem;
+  a->pos += (q16_t)(num / 1000);
+  a->rem  = (int32_t)(num % 1000);
+}
+
+void kin_body_set(KinBody *b, int x, int y, int32_t vx, int32_t vy)
+{
+  kin_axis_set(&b->x, x);
+  kin_axis_set(&b->y, y);
+  b->vx = vx;
+  b->vy = vy;
+}
+
+void kin_body_step(KinBody *b, uint32_t dt_ms)
+{
+  kin_axis_step(&b->x, b->vx, dt_ms);
+  kin_axis_step(&b->y, b->vy, dt_ms);
+}
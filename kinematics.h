@@ -0,0 +1,44 @@
+// kinematics.h  (shared by main.c and host builds)
+//
+// Q16.16 fixed-point kinematics for the shooter.
+//
+// Positions are Q16.16 pixels, velocities are whole pixels per SECOND and the
+// step takes the elapsed time in ms, so game speed no longer depends on the
+// tick rate. Integer-only math keeps both boards (and the host) bit-identical.
+//
+// Each axis carries the sub-Q16 remainder of (v * 65536 * dt) / 1000, so
+// stepping 40 x 25 ms lands on exactly the same position as 20 x 50 ms or
+// 10 x 100 ms. Rendering uses kin_px() (floor of the Q16.16 value).
+
+#ifndef KINEMATICS_H
+#define KINEMATICS_H
+
+#include <stdint.h>
+
+typedef int32_t q16_t;
+
+#define Q16_SHIFT        16
+#define Q16_ONE          ((q16_t)1 << Q16_SHIFT)
+
+static inline q16_t q16_from_int(int v)   { return (q16_t)((uint32_t)v << Q16_SHIFT); }
+static inline int   q16_to_int(q16_t v)   { return (int)(v >> Q16_SHIFT); } // floor
+
+typedef struct {
+  q16_t   pos;   // Q16.16 pixels
+  int32_t rem;   // leftover of (vel * Q16_ONE * ms) in 1/1000 Q16 units, |rem| < 1000
+} KinAxis;
+
+typedef struct {
+  KinAxis x, y;
+  int32_t vx, vy;  // pixels per second
+} KinBody;
+
+void kin_axis_set(KinAxis *a, int px);
+void kin_axis_step(KinAxis *a, int32_t vel_px_s, uint32_t dt_ms);
+
+static inline int kin_px(const KinAxis *a) { return q16_to_int(a->pos); }
+
+void kin_body_set(KinBody *b, int x, int y, int32_t vx, int32_t vy);
+void kin_body_step(KinBody *b, uint32_t dt_ms);
+
+#endif // KINEMATICS_H
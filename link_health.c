@@ -0,0 +1,201 @@
+// link_health.c  (shared by main.c and host builds)
+//
+// See link_health.h.
+
+#include "link_health.h"
+
+static uint8_t wire(uint32_t v) { return (uint8_t)(v % LINK_PAYLOAD_MOD); }
+
+static void tx(LinkHealth *l, uint8_t b)
+{
+  l->send(b);
+  l->stats.tx_bytes++;
+  l->window_tx++;
+}
+
+// Weights are prime to 250, so changing any one byte changes the check
+static uint8_t frame_check(uint8_t ctrl, const uint8_t *p)
+{
+  return wire((uint32_t)ctrl + p[0] + 3u * p[1] + 7u * p[2]);
+}
+
+static void send_state(LinkHealth *l, uint8_t ctrl)
+{
+  uint8_t p[3] = { wire((uint32_t)*l->score_me), wire((uint32_t)*l->score_them),
+                   wire(*l->round) };
+
+  tx(l, ctrl);
+  tx(l, p[0]);
+  tx(l, p[1]);
+  tx(l, p[2]);
+  tx(l, frame_check(ctrl, p));
+}
+
+void link_init(LinkHealth *l, uint8_t is_authority,
+               void (*send)(uint8_t), void (*on_resync)(void),
+               int *score_me, int *score_them, uint32_t *round,
+               uint32_t now_ms)
+{
+  LinkStats zero = {0};
+
+  l->is_authority = is_authority;
+  l->send = send;
+  l->on_resync = on_resync;
+  l->score_me = score_me;
+  l->score_them = score_them;
+  l->round = round;
+  l->stats = zero;
+
+  l->frame = 0;
+  l->need = 0;
+  l->got = 0;
+  l->mismatch_run = 0;
+  l->next_digest_ms = now_ms + LINK_DIGEST_MS;
+  l->window_start_ms = now_ms;
+  l->window_rx = 0;
+  l->window_tx = 0;
+}
+
+void link_note_errors(LinkHealth *l, int ore, int fe, int ne, int pe)
+{
+  if (ore) l->stats.ore++;
+  if (fe)  l->stats.fe++;
+  if (ne)  l->stats.ne++;
+  if (pe)  l->stats.pe++;
+}
+
+void link_note_tx(LinkHealth *l)
+{
+  l->stats.tx_bytes++;
+  l->window_tx++;
+}
+
+// Peer digest is from ITS point of view: its "me" is our "them".
+static void check_digest(LinkHealth *l, const uint8_t *p)
+{
+  l->stats.digests_rx++;
+
+  if (p[0] == wire((uint32_t)*l->score_them) &&
+      p[1] == wire((uint32_t)*l->score_me) &&
+      p[2] == wire(*l->round))
+  {
+    l->mismatch_run = 0;
+    return;
+  }
+
+  l->stats.mismatches++;
+  // one mismatch can be a DIED/RESET still in flight; act on a run of them
+  if (++l->mismatch_run < LINK_MISMATCH_LIMIT) return;
+  l->mismatch_run = 0;
+
+  if (l->is_authority)
+  {
+    send_state(l, LINK_CTRL_RESYNC_SET);
+    l->stats.resyncs++;
+    if (l->on_resync) l->on_resync();
+  }
+  else
+  {
+    tx(l, LINK_CTRL_RESYNC_REQ);
+  }
+}
+
+// The value nearest cur that is p mod LINK_PAYLOAD_MOD (never below 0)
+static int64_t unwrap(int64_t cur, uint8_t p)
+{
+  int64_t r = cur % LINK_PAYLOAD_MOD;
+  if (r < 0) r += LINK_PAYLOAD_MOD;
+  int64_t v = cur + (p - r + LINK_PAYLOAD_MOD * 3 / 2) % LINK_PAYLOAD_MOD - LINK_PAYLOAD_MOD / 2;
+  return v < 0 ? v + LINK_PAYLOAD_MOD : v;
+}
+
+static void apply_set(LinkHealth *l, const uint8_t *p)
+{
+  // authority never adopts the peer's state
+  if (l->is_authority) return;
+
+  *l->score_me   = (int)unwrap(*l->score_me, p[1]);
+  *l->score_them = (int)unwrap(*l->score_them, p[0]);
+  *l->round      = (uint32_t)unwrap(*l->round, p[2]);
+  l->mismatch_run = 0;
+  l->stats.resyncs++;
+
+  tx(l, LINK_CTRL_RESYNC_ACK);
+  if (l->on_resync) l->on_resync();
+}
+
+int link_rx_byte(LinkHealth *l, uint8_t b)
+{
+  l->stats.rx_bytes++;
+  l->window_rx++;
+
+  if (l->frame)
+  {
+    if (b <= LINK_Y_MAX)
+    {
+      l->payload[l->got++] = b;
+      if (l->got < l->need) return 1;
+
+      uint8_t f = l->frame;
+      l->frame = 0;
+      if (l->payload[3] != frame_check(f, l->payload))
+      {
+        l->stats.frames_bad++;        // a payload byte was lost or garbled
+        return 1;
+      }
+      if (f == LINK_CTRL_DIGEST)     check_digest(l, l->payload);
+      if (f == LINK_CTRL_RESYNC_SET) apply_set(l, l->payload);
+      return 1;
+    }
+
+    // control byte inside a frame: a payload byte was lost
+    l->frame = 0;
+    l->stats.frames_dropped++;
+  }
+
+  switch (b)
+  {
+    case LINK_CTRL_DIGEST:
+    case LINK_CTRL_RESYNC_SET:
+      l->frame = b;
+      l->need = LINK_FRAME_PAYLOAD;
+      l->got = 0;
+      return 1;
+
+    case LINK_CTRL_RESYNC_REQ:
+      if (l->is_authority)
+      {
+        send_state(l, LINK_CTRL_RESYNC_SET);
+        l->stats.resyncs++;
+        if (l->on_resync) l->on_resync();
+      }
+      return 1;
+
+    case LINK_CTRL_RESYNC_ACK:
+      l->mismatch_run = 0;
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+void link_poll(LinkHealth *l, uint32_t now_ms)
+{
+  uint32_t elapsed = now_ms - l->window_start_ms;
+  if (elapsed >= LINK_RATE_WINDOW_MS)
+  {
+    l->stats.rx_bps = (l->window_rx * 1000u) / elapsed;
+    l->stats.tx_bps = (l->window_tx * 1000u) / elapsed;
+    l->window_rx = 0;
+    l->window_tx = 0;
+    l->window_start_ms = now_ms;
+  }
+
+  if ((int32_t)(now_ms - l->next_digest_ms) >= 0)
+  {
+    send_state(l, LINK_CTRL_DIGEST);
+    l->stats.digests_tx++;
+    l->next_digest_ms = now_ms + LINK_DIGEST_MS;
+  }
+}
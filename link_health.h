@@ -0,0 +1,101 @@
+// link_health.h  (shared by main.c and host builds)
+//
+// Link-health monitor for the board-to-board USART6 link.
+//
+//   - counts ORE/FE/NE/PE and RX/TX bytes, with a 1 s byte-rate window
+//   - exchanges a state digest (score_me, score_them, round) every LINK_DIGEST_MS
+//   - resyncs automatically when LINK_MISMATCH_LIMIT digests in a row disagree:
+//       non-authority -> RESYNC_REQ
+//       authority     -> RESYNC_SET me them round   (peer adopts, mirrored)
+//       peer          -> RESYNC_ACK
+//     The LEFT board is the authority.
+//
+// Wire format (extends the 1-byte protocol in main.c):
+//   0..249  bullet Y (game byte, passed back to the caller)
+//   250     DIGEST     + 4 payload bytes (me, them, round, check), each mod 250
+//   251     RESYNC_REQ
+//   252     RESYNC_SET + 4 payload bytes
+//   253     RESYNC_ACK
+//   254     I DIED  (game byte)
+//   255     RESET   (game byte)
+// Payload bytes are always <= 249, so a payload byte is never taken for a
+// control byte, and a control byte inside a frame drops the frame. A lost
+// payload byte makes the frame take the next byte (usually a bullet Y) in
+// its place; the check byte, (ctrl + me + 3*them + 7*round) mod 250, then
+// fails but for a 1 in 250 chance, and the frame is dropped with that
+// byte. Only frames that pass the check are compared or applied.
+// A RESYNC_SET value is taken as the full value nearest the peer's own
+// that matches the byte mod 250, so scores and round keep counting past
+// 249 as long as the boards are within 125 of each other.
+//
+// No HAL dependencies: the caller supplies a send() hook and feeds bytes,
+// error flags and the millisecond clock, so the resync logic runs on the host.
+
+#ifndef LINK_HEALTH_H
+#define LINK_HEALTH_H
+
+#include <stdint.h>
+
+#define LINK_Y_MAX           249
+#define LINK_CTRL_DIGEST     250
+#define LINK_CTRL_RESYNC_REQ 251
+#define LINK_CTRL_RESYNC_SET 252
+#define LINK_CTRL_RESYNC_ACK 253
+
+#define LINK_PAYLOAD_MOD     250
+#define LINK_FRAME_PAYLOAD   4      // me, them, round, check
+#define LINK_DIGEST_MS       1000u
+#define LINK_RATE_WINDOW_MS  1000u
+#define LINK_MISMATCH_LIMIT  2
+
+typedef struct {
+  uint32_t ore, fe, ne, pe;      // UART error flags seen
+  uint32_t rx_bytes, tx_bytes;   // totals
+  uint32_t rx_bps, tx_bps;       // bytes per second, last full window
+  uint32_t digests_tx, digests_rx;
+  uint32_t mismatches;           // digests that disagreed
+  uint32_t resyncs;              // SETs applied (or sent, on the authority)
+  uint32_t frames_dropped;       // frames cut short by a control byte
+  uint32_t frames_bad;           // frames dropped by the check byte
+} LinkStats;
+
+typedef struct {
+  uint8_t   is_authority;
+  void    (*send)(uint8_t b);
+  void    (*on_resync)(void);    // called after state was overwritten/confirmed
+  int      *score_me;
+  int      *score_them;
+  uint32_t *round;
+
+  LinkStats stats;
+
+  // internal
+  uint8_t  frame;                // control byte of the frame being parsed, 0 = idle
+  uint8_t  need;
+  uint8_t  got;
+  uint8_t  payload[LINK_FRAME_PAYLOAD];
+  uint8_t  mismatch_run;
+  uint32_t next_digest_ms;
+  uint32_t window_start_ms;
+  uint32_t window_rx, window_tx;
+} LinkHealth;
+
+void link_init(LinkHealth *l, uint8_t is_authority,
+               void (*send)(uint8_t), void (*on_resync)(void),
+               int *score_me, int *score_them, uint32_t *round,
+               uint32_t now_ms);
+
+// Record UART error flags (nonzero = flag was set).
+void link_note_errors(LinkHealth *l, int ore, int fe, int ne, int pe);
+
+// Count a game byte the caller transmitted itself.
+void link_note_tx(LinkHealth *l);
+
+// Feed one received byte. Returns 1 if the link layer consumed it,
+// 0 if it is a game byte (bullet Y, DIED, RESET) for the caller.
+int  link_rx_byte(LinkHealth *l, uint8_t b);
+
+// Periodic work: rate window + digest transmission.
+void link_poll(LinkHealth *l, uint32_t now_ms);
+
+#endif // LINK_HEALTH_H
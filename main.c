@@ -18,16 +18,40 @@
 // Set which side THIS board is (one line only):
 //   Left board:  #define BOARD_IS_LEFT 1
 //   Right board: #define BOARD_IS_LEFT 0
-
+//
+// Also add kinematics.c to the project (Q16.16 positions, px/s velocities)
+// and link_health.c (UART error stats, score digests, auto resync), plus
+// common/gesture.c with common/ on the include path (fire button edges).
+//
+// Stress benchmark: set STRESS_MODE 1 (and add stress.c). It also runs on the
+// host against a software framebuffer (host/stm32_host.c), e.g.
+//   cc -O2 -DHOST_BUILD -DSTRESS_MODE=1 -Ihost -Icommon main.c kinematics.c
+//      link_health.c stress.c common/gesture.c host/stm32_host.c -o shooter_host
+
+#ifdef HOST_BUILD
+#include "stm32_host.h"
+#else
 #include "stm32f7xx_hal.h"
 #include "stm32f769i_discovery.h"
 #include "stm32f769i_discovery_lcd.h"
+#endif
+#include "kinematics.h"
+#include "link_health.h"
+#include "gesture.h"
+#include "stress.h"
 #include <stdio.h>
+#include <stdlib.h>
 
 void SystemClock_Config(void); // defined in init.c (ONLY once)
 
 #define BOARD_IS_LEFT 0   // <-- CHANGE TO 0 ON THE OTHER BOARD
 
+#define LINK_DEBUG_OVERLAY 1   // 1 = show link stats on the bottom line
+
+#ifndef STRESS_MODE
+#define STRESS_MODE 0          // 1 = bullet-storm benchmark (see stress.h)
+#endif
+
 // -------------------- Button pins --------------------
 #define BTN_UP_PORT     GPIOJ
 #define BTN_UP_PIN      GPIO_PIN_1   // D2
@@ -49,8 +73,16 @@ static inline uint8_t pressed(GPIO_TypeDef *port, uint16_t pin)
   return (HAL_GPIO_ReadPin(port, pin) == GPIO_PIN_RESET); // active-low
 }
 
+#define FIRE_DEBOUNCE_MS 20   // ignore fire edges this soon after the last one
+
+static void fire_gesture(const GestureEvent *e, void *ctx)
+{
+  if (e->type == GESTURE_PRESS) *(uint8_t *)ctx = 1;
+}
+
 // -------------------- UART6 on D0/D1 --------------------
 static UART_HandleTypeDef huart6;
+static LinkHealth g_link;
 
 static void UART6_Init(void)
 {
@@ -82,6 +114,9 @@ static void UART6_Init(void)
 static inline void UART6_ClearErrors(void)
 {
   uint32_t isr = USART6->ISR;
+  link_note_errors(&g_link,
+                   (isr & USART_ISR_ORE) != 0, (isr & USART_ISR_FE) != 0,
+                   (isr & USART_ISR_NE)  != 0, (isr & USART_ISR_PE) != 0);
   if (isr & USART_ISR_ORE) USART6->ICR = USART_ICR_ORECF;
   if (isr & USART_ISR_FE)  USART6->ICR = USART_ICR_FECF;
   if (isr & USART_ISR_NE)  USART6->ICR = USART_ICR_NCF;
@@ -100,6 +135,13 @@ static inline int UART6_ReadByte(uint8_t *out)
 }
 
 static inline void UART6_SendByte(uint8_t b)
+{
+  HAL_UART_Transmit(&huart6, &b, 1, 50);
+  link_note_tx(&g_link);
+}
+
+// link_health.c transmits its own frames through this (counts them itself)
+static void UART6_SendRaw(uint8_t b)
 {
   HAL_UART_Transmit(&huart6, &b, 1, 50);
 }
@@ -286,11 +328,25 @@ static void Audio_Update(void)
 
 // -------------------- Game --------------------
 #define TICK_MS       20
+#define MAX_DT_MS     100   // clamp frame dt after stalls (flash_screen etc.)
 #define SHIP_W        80
 #define SHIP_H        56
 #define BULLET_W      4
 #define BULLET_H      8
+#if STRESS_MODE
+#define MAX_BULLETS   2048
+#else
 #define MAX_BULLETS   10
+#endif
+
+// Stress rates at stage 0 (bullets per second, each side)
+#define STRESS_FIRE_HZ   20
+#define STRESS_RX_HZ     20
+
+// Speeds are in pixels per second (Q16.16 positions, see kinematics.h).
+// Old per-tick steps at 20 ms: ship 4 px, bullet 10 px.
+#define SHIP_SPEED_PX_S    200
+#define BULLET_SPEED_PX_S  500
 
 #define COL_BG        LCD_COLOR_BLACK
 #define COL_SHIP      LCD_COLOR_GREEN
@@ -299,29 +355,54 @@ static void Audio_Update(void)
 #define COL_HUD       LCD_COLOR_LIGHTGRAY
 
 // 1-byte protocol (WORKING STYLE):
-//   0..253  = bullet Y encoded
+//   0..249  = bullet Y encoded
+//   250..253= link health frames (digest / resync, see link_health.h)
 //   254     = "I DIED"   (loser -> winner)
 //   255     = "RESET"    (winner -> loser / sync reset)
 #define UART_CTRL_DIED   254
 #define UART_CTRL_RESET  255
-#define UART_Y_MAX       253
+#define UART_Y_MAX       LINK_Y_MAX
 
 static int W, H, MID_X;
 
-typedef struct { int x, y; } Ship;
+typedef struct { KinBody k; } Ship;
 
 typedef struct {
   uint8_t active;
-  int x, y;
-  int vx;
+  KinBody k;
 } Bullet;
 
 static Ship   g_ship;
 static Bullet g_out[MAX_BULLETS];
 static Bullet g_in[MAX_BULLETS];
 
+#if STRESS_MODE
+static StressBench g_stress;
+
+#ifdef HOST_BUILD
+#define FRAME_CLOCK()        host_ticks_ns()
+#define FRAME_TICKS_PER_MS   1000000u
+#else
+#define FRAME_CLOCK()        (DWT->CYCCNT)
+#define FRAME_TICKS_PER_MS   (SystemCoreClock / 1000u)
+#endif
+
+#define STRESS_MARK(ph)      stress_phase_end(&g_stress, (ph), FRAME_CLOCK())
+
+static uint32_t g_rng = 1;
+
+static uint32_t rng_next(void)
+{
+  g_rng = g_rng * 1664525u + 1013904223u;
+  return g_rng >> 8;
+}
+#else
+#define STRESS_MARK(ph)      ((void)0)
+#endif
+
 static int score_me = 0;
 static int score_them = 0;
+static uint32_t g_round = 0;   // completed rounds, part of the link digest
 
 static void bullets_clear(Bullet *b)
 {
@@ -333,8 +414,10 @@ static void game_respawn_and_clear(void)
   bullets_clear(g_out);
   bullets_clear(g_in);
 
-  g_ship.y = (H / 2) - (SHIP_H / 2);
-  g_ship.x = BOARD_IS_LEFT ? 20 : (W - SHIP_W - 20);
+  kin_body_set(&g_ship.k,
+               BOARD_IS_LEFT ? 20 : (W - SHIP_W - 20),
+               (H / 2) - (SHIP_H / 2),
+               0, 0);
 
   BSP_LCD_Clear(COL_BG);
 }
@@ -346,21 +429,26 @@ static void flash_screen(uint32_t color, int ms)
   BSP_LCD_Clear(COL_BG);
 }
 
-static void bullet_spawn(Bullet *pool, int x, int y, int vx)
+static int bullet_spawn(Bullet *pool, int x, int y, int32_t vx_px_s)
 {
   for (int i = 0; i < MAX_BULLETS; i++)
   {
     if (!pool[i].active)
     {
       pool[i].active = 1;
-      pool[i].x = x;
-      pool[i].y = y;
-      pool[i].vx = vx;
-      return;
+      kin_body_set(&pool[i].k, x, y, vx_px_s, 0);
+      return 1;
     }
   }
+#if STRESS_MODE
+  stress_note_spawn_fail(&g_stress);
+#endif
+  return 0;
 }
 
+static inline int bullet_x(const Bullet *b) { return kin_px(&b->k.x); }
+static inline int bullet_y(const Bullet *b) { return kin_px(&b->k.y); }
+
 static void draw_bullet(int x, int y, uint32_t c)
 {
   if (x < 0 || x >= W || y < 0 || y >= H) return;
@@ -397,8 +485,10 @@ static void draw_ship_left(int x, int y, uint32_t c)
 
 static void draw_ship(uint32_t c)
 {
-  if (BOARD_IS_LEFT) draw_ship_right(g_ship.x, g_ship.y, c);
-  else              draw_ship_left (g_ship.x, g_ship.y, c);
+  int x = kin_px(&g_ship.k.x);
+  int y = kin_px(&g_ship.k.y);
+  if (BOARD_IS_LEFT) draw_ship_right(x, y, c);
+  else              draw_ship_left (x, y, c);
 }
 
 static inline int rect_overlap(int ax, int ay, int aw, int ah,
@@ -414,7 +504,7 @@ static inline uint8_t y_to_u8_safe(int y)
   if (y < 0) y = 0;
   if (y > maxY) y = maxY;
 
-  int v = (y * UART_Y_MAX) / maxY; // 0..253
+  int v = (y * UART_Y_MAX) / maxY; // 0..249
   if (v < 0) v = 0;
   if (v > UART_Y_MAX) v = UART_Y_MAX;
   return (uint8_t)v;
@@ -429,54 +519,82 @@ static inline int u8_to_y_safe(uint8_t b)
 }
 
 // -------------------- UART RX: 1-byte protocol --------------------
-static void uart_poll_rx(void)
+static void uart_handle_rx(uint8_t b)
 {
-  uint8_t b;
-  while (UART6_ReadByte(&b))
+  BSP_LED_Toggle(LED1); // RX proof
+
+  if (link_rx_byte(&g_link, b)) return; // digest / resync traffic
+
+  if (b == UART_CTRL_DIED)
   {
-    BSP_LED_Toggle(LED1); // RX proof
+    // opponent died => you score, flash green, then command reset
+    score_me++;
+    g_round++;
+    Audio_Trigger(SFX_WIN, 1);
+    flash_screen(LCD_COLOR_GREEN, 250);
 
-    if (b == UART_CTRL_DIED)
-    {
-      // opponent died => you score, flash green, then command reset
-      score_me++;
-      Audio_Trigger(SFX_WIN, 1);
-      flash_screen(LCD_COLOR_GREEN, 250);
+    UART6_SendByte(UART_CTRL_RESET);
+    Audio_Trigger(SFX_TX, 0);
+    BSP_LED_Toggle(LED2); // TX proof
 
-      UART6_SendByte(UART_CTRL_RESET);
-      Audio_Trigger(SFX_TX, 0);
-      BSP_LED_Toggle(LED2); // TX proof
+    game_respawn_and_clear();
+    return;
+  }
 
-      game_respawn_and_clear();
-      continue;
-    }
+  if (b == UART_CTRL_RESET)
+  {
+    game_respawn_and_clear();
+    return;
+  }
 
-    if (b == UART_CTRL_RESET)
-    {
-      game_respawn_and_clear();
-      continue;
-    }
+  // Bullet byte 0..249
+  int y = u8_to_y_safe(b);
 
-    // Bullet byte 0..253
-    int y = u8_to_y_safe(b);
+  // Spawn at your SCREEN EDGE (not at the player)
+  int spawnX;
+  int32_t vx;
+  if (BOARD_IS_LEFT)
+  {
+    spawnX = W - BULLET_W - 1; // comes from right edge
+    vx = -BULLET_SPEED_PX_S;
+  }
+  else
+  {
+    spawnX = 0; // comes from left edge
+    vx = +BULLET_SPEED_PX_S;
+  }
 
-    // Spawn at your SCREEN EDGE (not at the player)
-    int spawnX, vx;
-    if (BOARD_IS_LEFT)
-    {
-      spawnX = W - BULLET_W - 1; // comes from right edge
-      vx = -10;
-    }
-    else
-    {
-      spawnX = 0; // comes from left edge
-      vx = +10;
-    }
+  bullet_spawn(g_in, spawnX, y, vx);
+  Audio_Trigger(SFX_RX, 0);
+}
+
+static void uart_poll_rx(void)
+{
+  uint8_t b;
+  while (UART6_ReadByte(&b)) uart_handle_rx(b);
+}
 
-    bullet_spawn(g_in, spawnX, y, vx);
-    Audio_Trigger(SFX_RX, 0);
+#if STRESS_MODE
+static void stress_show_report(void)
+{
+  char line[96];
+
+  BSP_LCD_Clear(COL_BG);
+  BSP_LCD_SetTextColor(COL_HUD);
+  for (int i = 0; stress_report_line(&g_stress, i, line, sizeof(line)); i++)
+  {
+    BSP_LCD_DisplayStringAt(0, (uint16_t)(i * 24), (uint8_t*)line, LEFT_MODE);
+    printf("%s\r\n", line);
   }
+  fflush(stdout);
+
+#ifdef HOST_BUILD
+  exit(0);
+#else
+  while (1) { BSP_LED_Toggle(LED2); HAL_Delay(500); }
+#endif
 }
+#endif
 
 // -------------------- MAIN --------------------
 int main(void)
@@ -512,86 +630,148 @@ int main(void)
 
   game_respawn_and_clear();
 
-  uint8_t fireLatch = 0;
+  link_init(&g_link, BOARD_IS_LEFT, UART6_SendRaw, game_respawn_and_clear,
+            &score_me, &score_them, &g_round, HAL_GetTick());
+
+  // fire on the press edge; the recognizer debounces the polled level
+  static const GestureConfig fireCfg = { .debounce_ms = FIRE_DEBOUNCE_MS };
+  Gesture fireBtn;
+  uint8_t fireReq = 0;
+  gesture_init(&fireBtn, 0, &fireCfg, fire_gesture, &fireReq);
+  uint32_t last_ms = HAL_GetTick();
+
+#if STRESS_MODE
+#ifndef HOST_BUILD
+  // free-running cycle counter for phase timing (never reset)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+  stress_init(&g_stress, FRAME_TICKS_PER_MS, TICK_MS, STRESS_FIRE_HZ, STRESS_RX_HZ);
+#endif
 
   while (1)
   {
+#if STRESS_MODE
+    stress_frame_begin(&g_stress, FRAME_CLOCK());
+#endif
     Audio_Update();
     uart_poll_rx();
 
+    // frame dt drives all motion, so TICK_MS only sets the frame rate
+    uint32_t now_ms = HAL_GetTick();
+    uint32_t dt = now_ms - last_ms;
+    last_ms = now_ms;
+    if (dt > MAX_DT_MS) dt = MAX_DT_MS;
+#if STRESS_MODE
+    dt = TICK_MS;   // fixed sim step: same entity load on board and host
+
+    // peer side: fake incoming bullet bytes through the normal decode path
+    for (uint32_t n = stress_rx_count(&g_stress, dt); n; n--)
+      uart_handle_rx((uint8_t)(rng_next() % (UART_Y_MAX + 1)));
+#endif
+
+    link_poll(&g_link, now_ms);
+    STRESS_MARK(PH_RX);
+
     // ---- erase previous frame ----
     draw_ship(COL_BG);
     for (int i = 0; i < MAX_BULLETS; i++)
     {
-      if (g_out[i].active) draw_bullet(g_out[i].x, g_out[i].y, COL_BG);
-      if (g_in[i].active)  draw_bullet(g_in[i].x,  g_in[i].y,  COL_BG);
+      if (g_out[i].active) draw_bullet(bullet_x(&g_out[i]), bullet_y(&g_out[i]), COL_BG);
+      if (g_in[i].active)  draw_bullet(bullet_x(&g_in[i]),  bullet_y(&g_in[i]),  COL_BG);
     }
+    STRESS_MARK(PH_RENDER);
 
     // ---- movement (keep in your half) ----
-    if (pressed(BTN_UP_PORT, BTN_UP_PIN))        g_ship.y -= 4;
-    if (pressed(BTN_DOWN_PORT, BTN_DOWN_PIN))    g_ship.y += 4;
-    if (pressed(BTN_LEFT_PORT, BTN_LEFT_PIN))    g_ship.x -= 4;
-    if (pressed(BTN_RIGHT_PORT, BTN_RIGHT_PIN))  g_ship.x += 4;
+    g_ship.k.vx = 0;
+    g_ship.k.vy = 0;
+    if (pressed(BTN_UP_PORT, BTN_UP_PIN))        g_ship.k.vy -= SHIP_SPEED_PX_S;
+    if (pressed(BTN_DOWN_PORT, BTN_DOWN_PIN))    g_ship.k.vy += SHIP_SPEED_PX_S;
+    if (pressed(BTN_LEFT_PORT, BTN_LEFT_PIN))    g_ship.k.vx -= SHIP_SPEED_PX_S;
+    if (pressed(BTN_RIGHT_PORT, BTN_RIGHT_PIN))  g_ship.k.vx += SHIP_SPEED_PX_S;
+    kin_body_step(&g_ship.k, dt);
 
     // clamp Y
-    if (g_ship.y < 24) g_ship.y = 24;
-    if (g_ship.y > (H - SHIP_H - 1)) g_ship.y = (H - SHIP_H - 1);
+    int sy = kin_px(&g_ship.k.y);
+    if (sy < 24) kin_axis_set(&g_ship.k.y, 24);
+    int maxY = H - SHIP_H - 1 - (LINK_DEBUG_OVERLAY ? 24 : 0);
+    if (sy > maxY) kin_axis_set(&g_ship.k.y, maxY);
 
     // clamp X to your half
+    int sx = kin_px(&g_ship.k.x);
     if (BOARD_IS_LEFT)
     {
-      if (g_ship.x < 0) g_ship.x = 0;
+      if (sx < 0) kin_axis_set(&g_ship.k.x, 0);
       int maxX = MID_X - SHIP_W - 2;
-      if (g_ship.x > maxX) g_ship.x = maxX;
+      if (sx > maxX) kin_axis_set(&g_ship.k.x, maxX);
     }
     else
     {
       int minX = MID_X + 2;
-      if (g_ship.x < minX) g_ship.x = minX;
+      if (sx < minX) kin_axis_set(&g_ship.k.x, minX);
       int maxX = W - SHIP_W - 1;
-      if (g_ship.x > maxX) g_ship.x = maxX;
+      if (sx > maxX) kin_axis_set(&g_ship.k.x, maxX);
     }
+    sx = kin_px(&g_ship.k.x);
+    sy = kin_px(&g_ship.k.y);
 
-    // ---- fire (edge detect) ----
-    uint8_t fireNow = pressed(BTN_FIRE_PORT, BTN_FIRE_PIN);
-    if (fireNow && !fireLatch)
+    // ---- fire (press edge) ----
+    fireReq = 0;
+    gesture_edge(&fireBtn, pressed(BTN_FIRE_PORT, BTN_FIRE_PIN), now_ms);
+    if (fireReq)
     {
-      fireLatch = 1;
-
-      int bx = BOARD_IS_LEFT ? (g_ship.x + SHIP_W - 8) : (g_ship.x + 4);
-      int by = g_ship.y + (SHIP_H / 2);
-      int vx = BOARD_IS_LEFT ? 10 : -10;
+      int bx = BOARD_IS_LEFT ? (sx + SHIP_W - 8) : (sx + 4);
+      int by = sy + (SHIP_H / 2);
+      int32_t vx = BOARD_IS_LEFT ? BULLET_SPEED_PX_S : -BULLET_SPEED_PX_S;
 
       bullet_spawn(g_out, bx, by, vx);
       Audio_Trigger(SFX_FIRE, 0);
     }
-    if (!fireNow) fireLatch = 0;
+
+#if STRESS_MODE
+    // our side: shots from the ship's nose at random heights
+    for (uint32_t n = stress_fire_count(&g_stress, dt); n; n--)
+    {
+      int bx = BOARD_IS_LEFT ? (sx + SHIP_W - 8) : (sx + 4);
+      int by = 24 + (int)(rng_next() % (uint32_t)(H - 24 - BULLET_H));
+      bullet_spawn(g_out, bx, by, BOARD_IS_LEFT ? BULLET_SPEED_PX_S : -BULLET_SPEED_PX_S);
+    }
+#endif
+    STRESS_MARK(PH_INPUT);
+
+    uint32_t live = 0;   // entity count for the stress report
 
     // ---- update OUT bullets: send ONLY when fully leaving your screen ----
     for (int i = 0; i < MAX_BULLETS; i++)
     {
       if (!g_out[i].active) continue;
 
-      g_out[i].x += g_out[i].vx;
+      kin_body_step(&g_out[i].k, dt);
+      int bx = bullet_x(&g_out[i]);
 
       // When it exits the screen edge, transmit the Y and delete local bullet.
-      if (g_out[i].x >= W || (g_out[i].x + BULLET_W) <= 0)
+      if (bx >= W || (bx + BULLET_W) <= 0)
       {
-        uint8_t yb = y_to_u8_safe(g_out[i].y);
-        UART6_SendByte(yb);
+        uint8_t yb = y_to_u8_safe(bullet_y(&g_out[i]));
+        if (!STRESS_MODE) UART6_SendByte(yb);   // stress: peer is simulated
         Audio_Trigger(SFX_TX, 0);
         BSP_LED_Toggle(LED2); // TX proof
         g_out[i].active = 0;
+        continue;
       }
+      live++;
     }
 
     // ---- update IN bullets ----
     for (int i = 0; i < MAX_BULLETS; i++)
     {
       if (!g_in[i].active) continue;
-      g_in[i].x += g_in[i].vx;
-      if (g_in[i].x < -20 || g_in[i].x > (W + 20)) g_in[i].active = 0;
+      kin_body_step(&g_in[i].k, dt);
+      int bx = bullet_x(&g_in[i]);
+      if (bx < -20 || bx > (W + 20)) g_in[i].active = 0;
+      else live++;
     }
+    STRESS_MARK(PH_UPDATE);
 
     // ---- collision: incoming bullets hit ship ----
     int shipDead = 0;
@@ -599,18 +779,23 @@ int main(void)
     {
       if (!g_in[i].active) continue;
 
-      if (rect_overlap(g_ship.x, g_ship.y, SHIP_W, SHIP_H,
-                       g_in[i].x, g_in[i].y, BULLET_W, BULLET_H))
+      if (rect_overlap(sx, sy, SHIP_W, SHIP_H,
+                       bullet_x(&g_in[i]), bullet_y(&g_in[i]), BULLET_W, BULLET_H))
       {
         g_in[i].active = 0;
         shipDead = 1;
       }
     }
 
-    if (shipDead)
+    STRESS_MARK(PH_COLLIDE);
+
+    // stress: hits are still tested but the round never ends
+    if (shipDead && !STRESS_MODE)
     {
       // you died => they score; tell them; then reset yourself
       score_them++;
+      g_round++;
+
       Audio_Trigger(SFX_HIT, 1);
       flash_screen(LCD_COLOR_RED, 250);
 
@@ -626,20 +811,44 @@ int main(void)
     draw_ship(COL_SHIP);
     for (int i = 0; i < MAX_BULLETS; i++)
     {
-      if (g_out[i].active) draw_bullet(g_out[i].x, g_out[i].y, COL_BULLET);
-      if (g_in[i].active)  draw_bullet(g_in[i].x,  g_in[i].y,  COL_IN_BULLET);
+      if (g_out[i].active) draw_bullet(bullet_x(&g_out[i]), bullet_y(&g_out[i]), COL_BULLET);
+      if (g_in[i].active)  draw_bullet(bullet_x(&g_in[i]),  bullet_y(&g_in[i]),  COL_IN_BULLET);
     }
+    STRESS_MARK(PH_RENDER);
 
     // HUD (score)
     BSP_LCD_SetTextColor(COL_BG);
     BSP_LCD_FillRect(0, 0, W, 24);
     BSP_LCD_SetTextColor(COL_HUD);
-    char s[64];
+    char s[112];
+
     snprintf(s, sizeof(s), "%s  ME:%d  THEM:%d",
              BOARD_IS_LEFT ? "LEFT" : "RIGHT",
              score_me, score_them);
     BSP_LCD_DisplayStringAt(0, 0, (uint8_t*)s, LEFT_MODE);
 
+#if LINK_DEBUG_OVERLAY
+    // link stats (bottom line)
+    const LinkStats *ls = &g_link.stats;
+    BSP_LCD_SetTextColor(COL_BG);
+    BSP_LCD_FillRect(0, H - 24, W, 24);
+    BSP_LCD_SetTextColor(COL_HUD);
+    snprintf(s, sizeof(s), "ORE%lu FE%lu NE%lu PE%lu RX%luB/s TX%luB/s MM%lu RS%lu",
+             (unsigned long)ls->ore, (unsigned long)ls->fe,
+             (unsigned long)ls->ne,  (unsigned long)ls->pe,
+             (unsigned long)ls->rx_bps, (unsigned long)ls->tx_bps,
+             (unsigned long)ls->mismatches, (unsigned long)ls->resyncs);
+    BSP_LCD_DisplayStringAt(0, H - 24, (uint8_t*)s, LEFT_MODE);
+#endif
+    STRESS_MARK(PH_HUD);
+
+#if STRESS_MODE
+    // no pacing delay: the frame's work time is what gets compared to TICK_MS
+    if (stress_frame_end(&g_stress, FRAME_CLOCK(), live)) stress_show_report();
+#else
+    (void)live;
     HAL_Delay(TICK_MS);
+#endif
   }
 }
+
@@ -0,0 +1,162 @@
+// stress.c  (shared by main.c and host builds)
+//
+// See stress.h. No HAL dependencies.
+
+#include "stress.h"
+#include <stdio.h>
+
+static const char *const phase_name[PH_COUNT] = {
+  "rx", "input", "update", "collide", "render", "hud"
+};
+
+static void stage_reset(StressBench *s)
+{
+  StressStage zero = {0};
+  s->cur = zero;
+  s->cur.fire_hz = s->fire_hz;
+  s->cur.rx_hz = s->rx_hz;
+  s->entity_sum = 0;
+}
+
+void stress_init(StressBench *s, uint32_t ticks_per_ms, uint32_t budget_ms,
+                 uint32_t fire_hz, uint32_t rx_hz)
+{
+  StressStage zero = {0};
+
+  s->ticks_per_ms = ticks_per_ms;
+  s->budget_ms = budget_ms;
+  s->fire_hz = fire_hz;
+  s->rx_hz = rx_hz;
+  s->fire_acc = 0;
+  s->rx_acc = 0;
+  s->last_ok = zero;
+  s->knee = zero;
+  s->stage_idx = 0;
+  s->done = 0;
+  s->have_ok = 0;
+  stage_reset(s);
+}
+
+static uint32_t spawn_count(uint32_t rate_hz, uint32_t *acc, uint32_t dt_ms)
+{
+  *acc += rate_hz * dt_ms;
+  uint32_t n = *acc / 1000u;
+  *acc -= n * 1000u;
+  return n;
+}
+
+uint32_t stress_fire_count(StressBench *s, uint32_t dt_ms)
+{
+  return spawn_count(s->fire_hz, &s->fire_acc, dt_ms);
+}
+
+uint32_t stress_rx_count(StressBench *s, uint32_t dt_ms)
+{
+  return spawn_count(s->rx_hz, &s->rx_acc, dt_ms);
+}
+
+void stress_note_spawn_fail(StressBench *s)
+{
+  s->cur.spawn_fail++;
+}
+
+void stress_frame_begin(StressBench *s, uint32_t now_ticks)
+{
+  s->t_frame = now_ticks;
+  s->t_mark = now_ticks;
+}
+
+void stress_phase_end(StressBench *s, StressPhase p, uint32_t now_ticks)
+{
+  s->cur.phase_ticks[p] += (uint32_t)(now_ticks - s->t_mark);
+  s->t_mark = now_ticks;
+}
+
+int stress_frame_end(StressBench *s, uint32_t now_ticks, uint32_t entities)
+{
+  if (s->done) return 1;
+
+  uint32_t ft = now_ticks - s->t_frame;
+  s->cur.frame_ticks += ft;
+  if (ft > s->cur.worst_frame_ticks) s->cur.worst_frame_ticks = ft;
+  if (entities > s->cur.max_entities) s->cur.max_entities = entities;
+  s->entity_sum += entities;
+
+  if (++s->cur.frames < STRESS_STAGE_FRAMES) return 0;
+
+  s->cur.avg_entities = (uint32_t)(s->entity_sum / s->cur.frames);
+  uint64_t avg_ticks = s->cur.frame_ticks / s->cur.frames;
+
+  if (avg_ticks > (uint64_t)s->budget_ms * s->ticks_per_ms)
+  {
+    s->knee = s->cur;
+    s->done = 1;
+    return 1;
+  }
+
+  s->last_ok = s->cur;
+  s->have_ok = 1;
+
+  // pool saturation or stage cap: the budget was never crossed
+  if (s->cur.spawn_fail || ++s->stage_idx >= STRESS_MAX_STAGES)
+  {
+    s->knee = s->cur;
+    s->done = 1;
+    return 1;
+  }
+
+  s->fire_hz = (s->fire_hz * STRESS_RAMP_NUM) / STRESS_RAMP_DEN + 1u;
+  s->rx_hz   = (s->rx_hz   * STRESS_RAMP_NUM) / STRESS_RAMP_DEN + 1u;
+  stage_reset(s);
+  return 0;
+}
+
+static unsigned long ticks_to_us(const StressBench *s, uint64_t ticks, uint32_t frames)
+{
+  if (frames == 0) return 0;
+  return (unsigned long)((ticks * 1000u) / ((uint64_t)s->ticks_per_ms * frames));
+}
+
+int stress_report_line(const StressBench *s, int idx, char *buf, size_t n)
+{
+  const StressStage *k = &s->knee;
+
+  if (idx == 0)
+  {
+    const char *why = "KNEE";
+    if (k->frames && k->frame_ticks / k->frames <= (uint64_t)s->budget_ms * s->ticks_per_ms)
+      why = k->spawn_fail ? "POOL FULL" : "CAPPED";
+
+    snprintf(buf, n, "STRESS %s after %lu stages (budget %lu ms)",
+             why, (unsigned long)s->stage_idx, (unsigned long)s->budget_ms);
+    return 1;
+  }
+
+  if (idx == 1)
+  {
+    snprintf(buf, n, "sustainable: %lu entities (max %lu) @ fire %lu/s rx %lu/s",
+             (unsigned long)(s->have_ok ? s->last_ok.avg_entities : 0),
+             (unsigned long)(s->have_ok ? s->last_ok.max_entities : 0),
+             (unsigned long)(s->have_ok ? s->last_ok.fire_hz : 0),
+             (unsigned long)(s->have_ok ? s->last_ok.rx_hz : 0));
+    return 1;
+  }
+  if (idx == 2)
+  {
+    snprintf(buf, n, "knee: %lu entities, frame avg %lu us worst %lu us, pool full %lu",
+             (unsigned long)k->avg_entities,
+             ticks_to_us(s, k->frame_ticks, k->frames),
+             ticks_to_us(s, k->worst_frame_ticks, 1),
+             (unsigned long)k->spawn_fail);
+    return 1;
+  }
+
+  int p = idx - 3;
+  if (p < PH_COUNT)
+  {
+    snprintf(buf, n, "  %-8s %6lu us/frame",
+             phase_name[p], ticks_to_us(s, k->phase_ticks[p], k->frames));
+    return 1;
+  }
+  return 0;
+}
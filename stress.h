@@ -0,0 +1,85 @@
+// stress.h  (shared by main.c and host builds)
+//
+// Bullet-storm stress mode / frame-budget benchmark for the shooter.
+//
+// main.c (built with STRESS_MODE 1) spawns local shots at fire_hz and feeds
+// fake RX bullet bytes at rx_hz through the normal decode path, times each
+// frame phase, and hands the numbers to this module. Every STRESS_STAGE_FRAMES
+// the rates grow by STRESS_RAMP_NUM/STRESS_RAMP_DEN. The first stage whose
+// average work per frame exceeds the budget is the knee; the previous stage's
+// entity count is reported as sustainable, with the per-phase split at the knee.
+// A stage that overflows the bullet pools also ends the run ("POOL FULL").
+//
+// Simulation time advances by a fixed TICK_MS per frame so the entity load is
+// the same on the board and the host; only the measured work time differs.
+// Time is in caller "ticks" (CPU cycles on the board, ns on the host).
+
+#ifndef STRESS_H
+#define STRESS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define STRESS_STAGE_FRAMES  150   // 3 s at 50 Hz: long enough for bullets to cross
+#define STRESS_RAMP_NUM      5     // rates x1.25 per stage
+#define STRESS_RAMP_DEN      4
+#define STRESS_MAX_STAGES    40
+
+typedef enum {
+  PH_RX = 0,      // UART poll + injected RX events
+  PH_INPUT,       // buttons, ship motion, firing
+  PH_UPDATE,      // bullet kinematics
+  PH_COLLIDE,     // hit tests
+  PH_RENDER,      // erase + draw
+  PH_HUD,         // score / overlay text
+  PH_COUNT
+} StressPhase;
+
+typedef struct {
+  uint32_t fire_hz, rx_hz;         // rates used during the stage
+  uint32_t avg_entities;
+  uint32_t max_entities;
+  uint64_t phase_ticks[PH_COUNT];  // summed over the stage
+  uint64_t frame_ticks;            // summed over the stage
+  uint32_t worst_frame_ticks;
+  uint32_t frames;
+  uint32_t spawn_fail;             // pool was full
+} StressStage;
+
+typedef struct {
+  uint32_t ticks_per_ms;
+  uint32_t budget_ms;
+
+  uint32_t fire_hz, rx_hz;
+  uint32_t fire_acc, rx_acc;       // spawn remainders (rate * ms)
+
+  StressStage cur;
+  StressStage last_ok;             // last stage within budget
+  StressStage knee;
+  uint32_t stage_idx;
+  uint64_t entity_sum;
+  uint8_t  done;
+  uint8_t  have_ok;
+
+  uint32_t t_frame, t_mark;
+} StressBench;
+
+void stress_init(StressBench *s, uint32_t ticks_per_ms, uint32_t budget_ms,
+                 uint32_t fire_hz, uint32_t rx_hz);
+
+// Number of local shots / RX events to generate this frame.
+uint32_t stress_fire_count(StressBench *s, uint32_t dt_ms);
+uint32_t stress_rx_count(StressBench *s, uint32_t dt_ms);
+
+void stress_note_spawn_fail(StressBench *s);
+
+void stress_frame_begin(StressBench *s, uint32_t now_ticks);
+void stress_phase_end(StressBench *s, StressPhase p, uint32_t now_ticks);
+
+// Returns 1 once the knee has been found (or STRESS_MAX_STAGES ran out).
+int  stress_frame_end(StressBench *s, uint32_t now_ticks, uint32_t entities);
+
+// Report line idx (0..) into buf; returns 0 when there are no more lines.
+int  stress_report_line(const StressBench *s, int idx, char *buf, size_t n);
+
+#endif // STRESS_H